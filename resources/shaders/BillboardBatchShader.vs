@@ -0,0 +1,31 @@
+#version 330 core
+
+// Input
+layout(location = 0) in vec3 Position;
+layout(location = 2) in vec4 RawColor;
+layout(location = 4) in vec2 Tex0;
+layout(location = 5) in vec2 Tex1;
+
+// Output
+out vec2 TexCoord;
+out vec4 TintColor;
+
+// Uniforms
+layout(std140) uniform MVPBlock
+{
+	mat4 ModelMtx;
+	mat4 ViewMtx;
+	mat4 ProjMtx;
+};
+
+// Main
+void main()
+{
+	// Position is the billboard center; Tex1 is the scaled corner offset, applied in view space
+	vec4 ViewPos = vec4(Position, 1) * ModelMtx * ViewMtx;
+	ViewPos.xy += Tex1;
+	gl_Position = ViewPos * ProjMtx;
+
+	TexCoord = vec2(Tex0.x, -Tex0.y);
+	TintColor = RawColor / 255.0;
+}
@@ -0,0 +1,26 @@
+#version 330 core
+
+// Input
+layout(location = 0) in vec3 Position;
+layout(location = 2) in vec4 RawColor;
+
+// Output
+out vec4 LineColor;
+
+// Uniforms
+layout(std140) uniform MVPBlock
+{
+	mat4 ModelMtx;
+	mat4 ViewMtx;
+	mat4 ProjMtx;
+};
+
+// Main
+void main()
+{
+	mat4 MVP = ModelMtx * ViewMtx * ProjMtx;
+	gl_Position = vec4(Position, 1) * MVP;
+
+	// Colors are passed as unnormalized bytes
+	LineColor = RawColor / 255.0;
+};
@@ -105,6 +105,7 @@ HEADERS += \
     Resource/Model/CStaticModel.h \
     Resource/Model/CVertex.h \
     Resource/Model/SSurface.h \
+    Resource/Model/CSurfaceBVH.h \
     Resource/Script/CScriptLayer.h \
     Resource/Script/CScriptObject.h \
     Resource/Script/CScriptTemplate.h \
@@ -159,6 +160,7 @@ HEADERS += \
     Scene/FShowFlags.h \
     Scene/CScene.h \
     Scene/CSceneIterator.h \
+    Scene/CSceneBVH.h \
     Resource/CPoiToWorld.h \
     Resource/Factory/CPoiToWorldLoader.h \
     Resource/Cooker/CPoiToWorldCooker.h \
@@ -177,6 +179,7 @@ HEADERS += \
     Resource/Collision/CCollisionMaterial.h \
     GameProject/CGameProject.h \
     GameProject/CPackage.h \
+    GameProject/CCompressedAssetCache.h \
     GameProject/CGameExporter.h \
     GameProject/CResourceStore.h \
     GameProject/CVirtualDirectory.h \
@@ -212,6 +215,7 @@ HEADERS += \
     Resource/Cooker/CResourceCooker.h \
     Resource/CAudioMacro.h \
     CompressionUtil.h \
+    ParallelUtil.h \
     Resource/Animation/CSourceAnimData.h \
     Resource/CMapArea.h \
     Resource/CSavedStateID.h \
@@ -260,7 +264,13 @@ HEADERS += \
     Resource/Collision/SCollisionIndexData.h \
     Resource/Collision/CCollisionRenderData.h \
     Resource/Collision/SOBBTreeNode.h \
-    Resource/Collision/CCollidableOBBTree.h
+    Resource/Collision/CCollidableOBBTree.h \
+    Resource/Collision/CCollisionOctree.h \
+    Resource/Cooker/CCollisionCooker.h \
+    Resource/Area/CAreaOctree.h \
+    OpenGL/CGLBackend.h \
+    Render/CInstanceBatcher.h \
+    Resource/Area/CAreaLightGrid.h
 
 # Source Files
 SOURCES += \
@@ -289,6 +299,7 @@ SOURCES += \
     Resource/Model/CModel.cpp \
     Resource/Model/CStaticModel.cpp \
     Resource/Model/SSurface.cpp \
+    Resource/Model/CSurfaceBVH.cpp \
     Resource/Script/CScriptObject.cpp \
     Resource/Script/CScriptTemplate.cpp \
     Resource/Collision/CCollisionMesh.cpp \
@@ -325,6 +336,7 @@ SOURCES += \
     Scene/FShowFlags.cpp \
     Scene/CScene.cpp \
     Scene/CSceneIterator.cpp \
+    Scene/CSceneBVH.cpp \
     Resource/CPoiToWorld.cpp \
     Resource/Factory/CPoiToWorldLoader.cpp \
     Resource/Cooker/CPoiToWorldCooker.cpp \
@@ -344,6 +356,7 @@ SOURCES += \
     GameProject/CVirtualDirectory.cpp \
     GameProject/CResourceEntry.cpp \
     GameProject/CPackage.cpp \
+    GameProject/CCompressedAssetCache.cpp \
     Resource/Factory/CDependencyGroupLoader.cpp \
     GameProject/CDependencyTree.cpp \
     Resource/Factory/CUnsupportedFormatLoader.cpp \
@@ -362,6 +375,7 @@ SOURCES += \
     GameProject/CGameInfo.cpp \
     Resource/CResTypeInfo.cpp \
     CompressionUtil.cpp \
+    ParallelUtil.cpp \
     IUIRelay.cpp \
     GameProject\COpeningBanner.cpp \
     IProgressNotifier.cpp \
@@ -381,7 +395,13 @@ SOURCES += \
     Resource/Cooker/CScanCooker.cpp \
     NCoreTests.cpp \
     Resource/Collision/CCollisionRenderData.cpp \
-    Resource/Collision/CCollidableOBBTree.cpp
+    Resource/Collision/CCollidableOBBTree.cpp \
+    Resource/Collision/CCollisionOctree.cpp \
+    Resource/Cooker/CCollisionCooker.cpp \
+    Resource/Area/CAreaOctree.cpp \
+    OpenGL/CGLBackend.cpp \
+    Render/CInstanceBatcher.cpp \
+    Resource/Area/CAreaLightGrid.cpp
 
 # Codegen
 CODEGEN_DIR = $$EXTERNALS_DIR/CodeGen
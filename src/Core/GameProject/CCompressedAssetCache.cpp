@@ -0,0 +1,290 @@
+#include "CCompressedAssetCache.h"
+#include "CGameProject.h"
+#include <Common/FileIO.h>
+#include <Common/FileUtil.h>
+#include <Common/Hash/CCRC32.h>
+#include <Common/Hash/CFNV1A.h>
+#include <algorithm>
+#include <atomic>
+
+// Size of the header at the start of each cache entry
+const uint32 gkCacheEntryHeaderSize = 0x10;
+
+CCompressedAssetCache::CCompressedAssetCache(CGameProject *pProject, bool UseZlib, uint64 MaxSize /*= skDefaultMaxSize*/)
+    : mCacheDir(pProject->HiddenFilesDir() / "CompressedAssetCache/")
+    , mGame(pProject->Game())
+    , mUseZlib(UseZlib)
+    , mMaxSize(MaxSize)
+    , mUseCounter(0)
+    , mTotalSize(0)
+    , mIndexDirty(false)
+{
+    FileUtil::MakeDirectory(mCacheDir);
+    LoadIndex();
+}
+
+CCompressedAssetCache::~CCompressedAssetCache()
+{
+    Flush();
+}
+
+bool CCompressedAssetCache::Fetch(const std::vector<uint8>& rkCookedData, std::vector<uint8>& rOutCompressedData) const
+{
+    uint64 Hash = HashCookedData(rkCookedData);
+    {
+        std::lock_guard<std::mutex> Lock(mIndexLock);
+        if (mEntries.find(Hash) == mEntries.end())
+            return false;
+    }
+
+    CFileInStream File(CacheFilePath(Hash), EEndian::BigEndian);
+
+    if (!File.IsValid() || File.ReadFourCC() != FOURCC('CCMP'))
+        return false;
+
+    // Verify this is actually the same data, in case of a hash collision
+    uint32 UncompressedSize = File.ReadLong();
+    uint32 Checksum = File.ReadLong();
+
+    if (UncompressedSize != rkCookedData.size() ||
+        Checksum != CCRC32::StaticHashData(rkCookedData.data(), rkCookedData.size()))
+    {
+        return false;
+    }
+
+    uint32 DataSize = File.ReadLong();
+
+    if (DataSize != File.Size() - File.Tell())
+        return false;
+
+    // An empty entry means the asset doesn't compress, in which case the output is left empty
+    rOutCompressedData.resize(DataSize);
+
+    if (DataSize > 0)
+        File.ReadBytes(rOutCompressedData.data(), rOutCompressedData.size());
+
+    MarkUsed(Hash, gkCacheEntryHeaderSize + DataSize);
+    return true;
+}
+
+void CCompressedAssetCache::Store(const std::vector<uint8>& rkCookedData, const std::vector<uint8>& rkCompressedData) const
+{
+    // Assets that don't shrink when compressed are stored as an empty entry; there's no point keeping a copy
+    // of the data when it's going to be stored uncompressed anyway
+    bool Compressible = (!rkCompressedData.empty() && rkCompressedData.size() < rkCookedData.size());
+    uint32 DataSize = (Compressible ? rkCompressedData.size() : 0);
+
+    // Write to a temporary file first so another thread can never read a partially written entry
+    static std::atomic<uint32> sTempFileIndex(0);
+
+    uint64 Hash = HashCookedData(rkCookedData);
+    TString Path = CacheFilePath(Hash);
+    TString TempPath = Path + TString::Format(".%d.tmp", (uint32) sTempFileIndex++);
+    {
+        CFileOutStream File(TempPath, EEndian::BigEndian);
+
+        if (!File.IsValid())
+        {
+            errorf("Failed to write compressed asset cache entry: %s", *TempPath);
+            return;
+        }
+
+        File.WriteFourCC( FOURCC('CCMP') );
+        File.WriteLong(rkCookedData.size());
+        File.WriteLong( CCRC32::StaticHashData(rkCookedData.data(), rkCookedData.size()) );
+        File.WriteLong(DataSize);
+
+        if (DataSize > 0)
+            File.WriteBytes(rkCompressedData.data(), DataSize);
+    }
+
+    // If an identical asset got cached by another thread in the meantime, the move fails and we just discard ours
+    if (!FileUtil::MoveFile(TempPath, Path))
+        FileUtil::DeleteFile(TempPath);
+
+    MarkUsed(Hash, gkCacheEntryHeaderSize + DataSize);
+}
+
+void CCompressedAssetCache::Flush()
+{
+    std::lock_guard<std::mutex> Lock(mIndexLock);
+
+    if (mTotalSize > mMaxSize)
+    {
+        std::vector< std::pair<uint64, uint64> > EntriesByUse; // last use, hash
+        EntriesByUse.reserve(mEntries.size());
+
+        for (auto Iter = mEntries.begin(); Iter != mEntries.end(); Iter++)
+            EntriesByUse.push_back( std::make_pair(Iter->second.LastUse, Iter->first) );
+
+        std::sort(EntriesByUse.begin(), EntriesByUse.end());
+
+        for (uint32 EntryIdx = 0; EntryIdx < EntriesByUse.size() && mTotalSize > mMaxSize; EntryIdx++)
+        {
+            uint64 Hash = EntriesByUse[EntryIdx].second;
+            auto Find = mEntries.find(Hash);
+
+            FileUtil::DeleteFile( CacheFilePath(Hash) );
+            mTotalSize -= Find->second.Size;
+            mEntries.erase(Find);
+        }
+
+        mIndexDirty = true;
+    }
+
+    if (mIndexDirty)
+        SaveIndex();
+}
+
+void CCompressedAssetCache::LoadIndex()
+{
+    {
+        CFileInStream Index(IndexPath(), EEndian::BigEndian);
+
+        if (Index.IsValid() && Index.ReadFourCC() == FOURCC('CCIX'))
+        {
+            mUseCounter = Index.ReadLongLong();
+            uint32 NumEntries = Index.ReadLong();
+
+            for (uint32 EntryIdx = 0; EntryIdx < NumEntries && !Index.EoF(); EntryIdx++)
+            {
+                uint64 Hash = Index.ReadLongLong();
+                uint32 Size = Index.ReadLong();
+                uint64 LastUse = Index.ReadLongLong();
+
+                // Drop entries whose file is missing or doesn't match the index; the rest of the cache is still good
+                TString Path = CacheFilePath(Hash);
+
+                if (!FileUtil::Exists(Path) || FileUtil::FileSize(Path) != Size || Size < gkCacheEntryHeaderSize)
+                {
+                    warnf("Dropping invalid compressed asset cache entry: %s", *Path);
+                    FileUtil::DeleteFile(Path);
+                    mIndexDirty = true;
+                    continue;
+                }
+
+                if (mEntries.find(Hash) == mEntries.end())
+                {
+                    mEntries[Hash] = SEntryInfo { Size, LastUse };
+                    mTotalSize += Size;
+                }
+            }
+
+            if (mEntries.size() != NumEntries)
+                mIndexDirty = true;
+        }
+        else
+            mIndexDirty = true;
+    }
+
+    AddUnindexedEntries();
+}
+
+void CCompressedAssetCache::AddUnindexedEntries()
+{
+    // Entries can be missing from the index if the index is damaged or a cook didn't finish. Rather than
+    // throwing them away, pick up every valid entry in the cache directory that the index doesn't know about.
+    TStringList Files;
+    FileUtil::GetDirectoryContents(mCacheDir, Files, false, true, false);
+
+    for (auto Iter = Files.begin(); Iter != Files.end(); Iter++)
+    {
+        const TString& rkPath = *Iter;
+
+        if (rkPath.GetFileName() == IndexPath().GetFileName())
+            continue;
+
+        TString Name = rkPath.GetFileName(false);
+        bool IsEntry = (rkPath.GetFileExtension() == "bin" && Name.IsHexString(false, 16));
+        uint64 Hash = (IsEntry ? (uint64) Name.ToInt64(16) : 0);
+
+        if (IsEntry && mEntries.find(Hash) != mEntries.end())
+            continue;
+
+        // Leftover temp files and anything else that isn't a well-formed entry gets deleted
+        bool Valid = false;
+        uint32 Size = 0;
+
+        if (IsEntry)
+        {
+            CFileInStream File(rkPath, EEndian::BigEndian);
+            Size = File.Size();
+
+            if (File.IsValid() && Size >= gkCacheEntryHeaderSize && File.ReadFourCC() == FOURCC('CCMP'))
+            {
+                File.Seek(0x8, SEEK_CUR);
+                Valid = (File.ReadLong() == Size - gkCacheEntryHeaderSize);
+            }
+        }
+
+        if (Valid)
+        {
+            // Unindexed entries have no use history, so they're the first to go when the cache is trimmed
+            mEntries[Hash] = SEntryInfo { Size, 0 };
+            mTotalSize += Size;
+        }
+        else
+            FileUtil::DeleteFile(rkPath);
+
+        mIndexDirty = true;
+    }
+}
+
+void CCompressedAssetCache::SaveIndex()
+{
+    CFileOutStream Index(IndexPath(), EEndian::BigEndian);
+
+    if (!Index.IsValid())
+    {
+        errorf("Failed to save compressed asset cache index: %s", *IndexPath());
+        return;
+    }
+
+    Index.WriteFourCC( FOURCC('CCIX') );
+    Index.WriteLongLong(mUseCounter);
+    Index.WriteLong(mEntries.size());
+
+    for (auto Iter = mEntries.begin(); Iter != mEntries.end(); Iter++)
+    {
+        Index.WriteLongLong(Iter->first);
+        Index.WriteLong(Iter->second.Size);
+        Index.WriteLongLong(Iter->second.LastUse);
+    }
+
+    mIndexDirty = false;
+}
+
+void CCompressedAssetCache::MarkUsed(uint64 Hash, uint32 Size) const
+{
+    std::lock_guard<std::mutex> Lock(mIndexLock);
+    auto Find = mEntries.find(Hash);
+
+    if (Find == mEntries.end())
+    {
+        Find = mEntries.insert( std::make_pair(Hash, SEntryInfo { Size, 0 }) ).first;
+        mTotalSize += Size;
+    }
+
+    Find->second.LastUse = ++mUseCounter;
+    mIndexDirty = true;
+}
+
+uint64 CCompressedAssetCache::HashCookedData(const std::vector<uint8>& rkCookedData) const
+{
+    CFNV1A Hash(CFNV1A::k64Bit);
+    Hash.HashLong((int) mGame);
+    Hash.HashByte(mUseZlib ? 1 : 0);
+    Hash.HashLong(rkCookedData.size());
+    Hash.HashData(rkCookedData.data(), rkCookedData.size());
+    return Hash.GetHash64();
+}
+
+TString CCompressedAssetCache::CacheFilePath(uint64 Hash) const
+{
+    return mCacheDir + TString::HexString((uint32) (Hash >> 32), 8, false) + TString::HexString((uint32) Hash, 8, false) + ".bin";
+}
+
+TString CCompressedAssetCache::IndexPath() const
+{
+    return mCacheDir + "CacheIndex.idx";
+}
@@ -0,0 +1,68 @@
+#ifndef CCOMPRESSEDASSETCACHE_H
+#define CCOMPRESSEDASSETCACHE_H
+
+#include <Common/BasicTypes.h>
+#include <Common/EGame.h>
+#include <Common/TString.h>
+#include <map>
+#include <mutex>
+#include <vector>
+
+class CGameProject;
+
+// Persistent cache of compressed asset data used when cooking packages. Entries are keyed by a hash of
+// the cooked asset data plus the game and compression mode, so an asset only needs to be compressed again
+// when its cooked data changes, no matter how many paks it's in. Fetch and Store are safe to call from
+// multiple threads at once.
+//
+// Assets that don't shrink when compressed get an empty entry, so they aren't compressed again either; Fetch
+// succeeds with no data for these and they should be stored uncompressed. The cache is capped at a maximum
+// size; when it grows past the cap, the least recently used entries are evicted by Flush(), which should only
+// be called once no other thread is using the cache. It also runs when the cache is destroyed.
+class CCompressedAssetCache
+{
+    struct SEntryInfo
+    {
+        uint32 Size;
+        uint64 LastUse;
+    };
+
+    TString mCacheDir;
+    EGame mGame;
+    bool mUseZlib;
+    uint64 mMaxSize;
+
+    // Size and last use of every entry, keyed by hash; saved next to the entries
+    mutable std::mutex mIndexLock;
+    mutable std::map<uint64, SEntryInfo> mEntries;
+    mutable uint64 mUseCounter;
+    mutable uint64 mTotalSize;
+    mutable bool mIndexDirty;
+
+public:
+    static const uint64 skDefaultMaxSize = 512 * 1024 * 1024;
+
+    CCompressedAssetCache(CGameProject *pProject, bool UseZlib, uint64 MaxSize = skDefaultMaxSize);
+    ~CCompressedAssetCache();
+
+    bool Fetch(const std::vector<uint8>& rkCookedData, std::vector<uint8>& rOutCompressedData) const;
+    void Store(const std::vector<uint8>& rkCookedData, const std::vector<uint8>& rkCompressedData) const;
+    void Flush();
+
+    // Accessors
+    inline uint64 MaxSize() const           { return mMaxSize; }
+    inline uint64 TotalSize() const         { return mTotalSize; }
+    inline uint32 NumEntries() const        { return mEntries.size(); }
+    inline void SetMaxSize(uint64 MaxSize)  { mMaxSize = MaxSize; }
+
+protected:
+    void LoadIndex();
+    void AddUnindexedEntries();
+    void SaveIndex();
+    void MarkUsed(uint64 Hash, uint32 Size) const;
+    uint64 HashCookedData(const std::vector<uint8>& rkCookedData) const;
+    TString CacheFilePath(uint64 Hash) const;
+    TString IndexPath() const;
+};
+
+#endif // CCOMPRESSEDASSETCACHE_H
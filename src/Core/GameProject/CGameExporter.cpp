@@ -3,6 +3,7 @@
 #include "CResourceIterator.h"
 #include "CResourceStore.h"
 #include "Core/CompressionUtil.h"
+#include "Core/ParallelUtil.h"
 #include "Core/Resource/CWorld.h"
 #include "Core/Resource/Script/CGameTemplate.h"
 #include <Common/Macros.h>
@@ -11,6 +12,8 @@
 #include <Common/FileUtil.h>
 #include <Common/Serialization/CXMLWriter.h>
 
+#include <algorithm>
+#include <atomic>
 #include <nod/nod.hpp>
 #include <tinyxml2.h>
 
@@ -28,6 +31,7 @@ CGameExporter::CGameExporter(EDiscType DiscType, EGame Game, bool FrontEnd, EReg
     , mDiscType(DiscType)
     , mFrontEnd(FrontEnd)
     , mpProgress(nullptr)
+    , mDependencyOrderedRawExport(true)
 {
     ASSERT(mGame != EGame::Invalid);
     ASSERT(mRegion != ERegion::Unknown);
@@ -92,6 +96,49 @@ bool CGameExporter::Export(nod::DiscBase *pDisc, const TString& rkOutputDir, CAs
     return !mpProgress->ShouldCancel();
 }
 
+bool CGameExporter::RegenerateEditorData(CGameProject *pProject, IProgressNotifier *pProgress)
+{
+    // Generate editor data for an already exported project again, starting from its cooked assets like a
+    // fresh export would. Any raw assets in the project are overwritten, so edits made since the export are lost.
+    SCOPED_TIMER(RegenerateEditorData);
+
+    mpProject = pProject;
+    mpStore = mpProject->ResourceStore();
+    mResourcesDir = mpStore->ResourcesDir();
+    mProjectPath = mpProject->ProjectPath();
+    mpProgress = pProgress;
+    mpProgress->SetNumTasks(eES_NumSteps);
+
+    CResourceStore *pOldStore = gpResourceStore;
+    gpResourceStore = mpStore;
+
+    // The pak duplicate flags can't be recovered from the cooked worlds, so carry them over from the current ones
+    mAreaDuplicateMap.clear();
+
+    for (TResourceIterator<EResourceType::World> It(mpStore); It; ++It)
+    {
+        CWorld *pWorld = (CWorld*) It->Load();
+        if (!pWorld) continue;
+
+        for (uint32 iArea = 0; iArea < pWorld->NumAreas(); iArea++)
+            mAreaDuplicateMap[pWorld->AreaResourceID(iArea)] = pWorld->DoesAreaAllowPakDuplicates(iArea);
+    }
+
+    mpStore->DestroyUnreferencedResources();
+
+    // Assets that are still loaded (like the audio groups) are saved from memory, same as during an export
+    for (CResourceIterator It(mpStore); It; ++It)
+    {
+        if (!It->IsLoaded() && It->HasRawVersion())
+            FileUtil::DeleteFile(It->RawAssetPath());
+    }
+
+    ExportResourceEditorData();
+
+    if (pOldStore) gpResourceStore = pOldStore;
+    return !mpProgress->ShouldCancel();
+}
+
 void CGameExporter::LoadResource(const CAssetID& rkID, std::vector<uint8>& rBuffer)
 {
     SResourceInstance *pInst = FindResourceInstance(rkID);
@@ -312,7 +359,7 @@ void CGameExporter::LoadPaks()
                     uint32 ResOffset = Pak.ReadLong();
 
                     if (mResourceMap.find(ResID) == mResourceMap.end())
-                        mResourceMap[ResID] = SResourceInstance { PakPath, ResID, ResType, ResOffset, ResSize, Compressed, false };
+                        mResourceMap[ResID] = SResourceInstance { PakPath, ResID, ResType, ResOffset, ResSize, Compressed, false, "" };
 
                     // Check for duplicate resources
                     if (ResType == "MREA")
@@ -391,7 +438,7 @@ void CGameExporter::LoadPaks()
                         uint32 Offset = DataStart + Pak.ReadLong();
 
                         if (mResourceMap.find(ResID) == mResourceMap.end())
-                            mResourceMap[ResID] = SResourceInstance { PakPath, ResID, Type, Offset, Size, Compressed, false };
+                            mResourceMap[ResID] = SResourceInstance { PakPath, ResID, Type, Offset, Size, Compressed, false, "" };
 
                         // Check for duplicate resources (unnecessary for DKCR)
                         if (mGame != EGame::DKCReturns)
@@ -430,94 +477,98 @@ void CGameExporter::LoadResource(const SResourceInstance& rkResource, std::vecto
     CFileInStream Pak(rkResource.PakFile, EEndian::BigEndian);
 
     if (Pak.IsValid())
+        ReadResource(rkResource, Pak, rBuffer);
+}
+
+void CGameExporter::ReadResource(const SResourceInstance& rkResource, IInputStream& rPak, std::vector<uint8>& rBuffer) const
+{
+    rPak.Seek(rkResource.PakOffset, SEEK_SET);
+
+    // Handle compression
+    if (rkResource.Compressed)
     {
-        Pak.Seek(rkResource.PakOffset, SEEK_SET);
+        bool ZlibCompressed = (mGame <= EGame::EchoesDemo || mGame == EGame::DKCReturns);
 
-        // Handle compression
-        if (rkResource.Compressed)
+        if (mGame <= EGame::CorruptionProto)
         {
-            bool ZlibCompressed = (mGame <= EGame::EchoesDemo || mGame == EGame::DKCReturns);
+            uint32 UncompressedSize = rPak.ReadLong();
 
-            if (mGame <= EGame::CorruptionProto)
-            {
-                std::vector<uint8> CompressedData(rkResource.PakSize);
+            // Clamp the read so the last asset in a pak can't read past the end of the pak data
+            std::vector<uint8> CompressedData( Math::Min<uint32>(rkResource.PakSize, rPak.Size() - rPak.Tell()) );
+            rBuffer.resize(UncompressedSize);
+            rPak.ReadBytes(CompressedData.data(), CompressedData.size());
 
-                uint32 UncompressedSize = Pak.ReadLong();
-                rBuffer.resize(UncompressedSize);
-                Pak.ReadBytes(CompressedData.data(), CompressedData.size());
-
-                if (ZlibCompressed)
-                {
-                    uint32 TotalOut;
-                    CompressionUtil::DecompressZlib(CompressedData.data(), CompressedData.size(), rBuffer.data(), rBuffer.size(), TotalOut);
-                }
-                else
-                {
-                    CompressionUtil::DecompressSegmentedData(CompressedData.data(), CompressedData.size(), rBuffer.data(), rBuffer.size());
-                }
+            if (ZlibCompressed)
+            {
+                uint32 TotalOut;
+                CompressionUtil::DecompressZlib(CompressedData.data(), CompressedData.size(), rBuffer.data(), rBuffer.size(), TotalOut);
             }
-
             else
             {
-                CFourCC Magic = Pak.ReadLong();
-                ASSERT(Magic == "CMPD");
+                CompressionUtil::DecompressSegmentedData(CompressedData.data(), CompressedData.size(), rBuffer.data(), rBuffer.size());
+            }
+        }
 
-                uint32 NumBlocks = Pak.ReadLong();
+        else
+        {
+            CFourCC Magic = rPak.ReadLong();
+            ASSERT(Magic == "CMPD");
 
-                struct SCompressedBlock {
-                    uint32 CompressedSize; uint32 UncompressedSize;
-                };
-                std::vector<SCompressedBlock> CompressedBlocks;
+            uint32 NumBlocks = rPak.ReadLong();
 
-                uint32 TotalUncompressedSize = 0;
-                for (uint32 iBlock = 0; iBlock < NumBlocks; iBlock++)
-                {
-                    uint32 CompressedSize = (Pak.ReadLong() & 0x00FFFFFF);
-                    uint32 UncompressedSize = Pak.ReadLong();
+            struct SCompressedBlock {
+                uint32 CompressedSize; uint32 UncompressedSize;
+            };
+            std::vector<SCompressedBlock> CompressedBlocks;
 
-                    TotalUncompressedSize += UncompressedSize;
-                    CompressedBlocks.push_back( SCompressedBlock { CompressedSize, UncompressedSize } );
-                }
+            uint32 TotalUncompressedSize = 0;
+            for (uint32 iBlock = 0; iBlock < NumBlocks; iBlock++)
+            {
+                uint32 CompressedSize = (rPak.ReadLong() & 0x00FFFFFF);
+                uint32 UncompressedSize = rPak.ReadLong();
+
+                TotalUncompressedSize += UncompressedSize;
+                CompressedBlocks.push_back( SCompressedBlock { CompressedSize, UncompressedSize } );
+            }
 
-                rBuffer.resize(TotalUncompressedSize);
-                uint32 Offset = 0;
+            rBuffer.resize(TotalUncompressedSize);
+            uint32 Offset = 0;
+
+            for (uint32 iBlock = 0; iBlock < NumBlocks; iBlock++)
+            {
+                uint32 CompressedSize = CompressedBlocks[iBlock].CompressedSize;
+                uint32 UncompressedSize = CompressedBlocks[iBlock].UncompressedSize;
 
-                for (uint32 iBlock = 0; iBlock < NumBlocks; iBlock++)
+                // Block is compressed
+                if (CompressedSize != UncompressedSize)
                 {
-                    uint32 CompressedSize = CompressedBlocks[iBlock].CompressedSize;
-                    uint32 UncompressedSize = CompressedBlocks[iBlock].UncompressedSize;
+                    std::vector<uint8> CompressedData(CompressedBlocks[iBlock].CompressedSize);
+                    rPak.ReadBytes(CompressedData.data(), CompressedData.size());
 
-                    // Block is compressed
-                    if (CompressedSize != UncompressedSize)
+                    if (ZlibCompressed)
                     {
-                        std::vector<uint8> CompressedData(CompressedBlocks[iBlock].CompressedSize);
-                        Pak.ReadBytes(CompressedData.data(), CompressedData.size());
-
-                        if (ZlibCompressed)
-                        {
-                            uint32 TotalOut;
-                            CompressionUtil::DecompressZlib(CompressedData.data(), CompressedData.size(), rBuffer.data() + Offset, UncompressedSize, TotalOut);
-                        }
-                        else
-                        {
-                            CompressionUtil::DecompressSegmentedData(CompressedData.data(), CompressedData.size(), rBuffer.data() + Offset, UncompressedSize);
-                        }
+                        uint32 TotalOut;
+                        CompressionUtil::DecompressZlib(CompressedData.data(), CompressedData.size(), rBuffer.data() + Offset, UncompressedSize, TotalOut);
                     }
-                    // Block is uncompressed
                     else
-                        Pak.ReadBytes(rBuffer.data() + Offset, UncompressedSize);
-
-                    Offset += UncompressedSize;
+                    {
+                        CompressionUtil::DecompressSegmentedData(CompressedData.data(), CompressedData.size(), rBuffer.data() + Offset, UncompressedSize);
+                    }
                 }
+                // Block is uncompressed
+                else
+                    rPak.ReadBytes(rBuffer.data() + Offset, UncompressedSize);
+
+                Offset += UncompressedSize;
             }
         }
+    }
 
-        // Handle uncompressed
-        else
-        {
-            rBuffer.resize(rkResource.PakSize);
-            Pak.ReadBytes(rBuffer.data(), rBuffer.size());
-        }
+    // Handle uncompressed
+    else
+    {
+        rBuffer.resize(rkResource.PakSize);
+        rPak.ReadBytes(rBuffer.data(), rBuffer.size());
     }
 }
 
@@ -527,18 +578,83 @@ void CGameExporter::ExportCookedResources()
     FileUtil::MakeDirectory(mResourcesDir);
 
     mpProgress->SetTask(eES_ExportCooked, "Unpacking cooked assets");
-    int ResIndex = 0;
 
-    for (auto It = mResourceMap.begin(); It != mResourceMap.end() && !mpProgress->ShouldCancel(); It++, ResIndex++)
+    // Register every resource up front and group them by the pak they're unpacked from.
+    // The resource store isn't thread-safe, so registration has to happen on this thread.
+    std::map<TString, std::vector<SResourceInstance*>> PakResourceMap;
+
+    for (auto It = mResourceMap.begin(); It != mResourceMap.end(); It++)
     {
         SResourceInstance& rRes = It->second;
 
-        // Update progress
-        if ((ResIndex & 0x3) == 0)
-            mpProgress->Report(ResIndex, mResourceMap.size(), TString::Format("Unpacking asset %d/%d", ResIndex, mResourceMap.size()) );
+        if (!rRes.Exported)
+        {
+            RegisterResource(rRes);
+            PakResourceMap[rRes.PakFile].push_back(&rRes);
+        }
+    }
+
+    // Unpack one pak at a time. Each pak is read into memory with a single read, then its assets are
+    // decompressed and written out across all cores. Each job only holds the one asset it's working on.
+    const uint NumResources = mResourceMap.size();
+    std::atomic<uint> NumUnpacked(0);
 
-        // Export resource
-        ExportResource(rRes);
+    // Progress notifiers aren't thread-safe, so only the calling thread polls for cancellation;
+    // the other workers check this flag
+    std::atomic<bool> Cancel(mpProgress->ShouldCancel());
+
+    for (auto PakIt = PakResourceMap.begin(); PakIt != PakResourceMap.end() && !Cancel; PakIt++)
+    {
+        std::vector<uint8> PakData;
+        {
+            CFileInStream Pak(PakIt->first, EEndian::BigEndian);
+
+            if (!Pak.IsValid())
+            {
+                errorf("Couldn't open pak: %s", *PakIt->first);
+                continue;
+            }
+
+            PakData.resize(Pak.Size());
+            Pak.ReadBytes(PakData.data(), PakData.size());
+        }
+
+        const std::vector<SResourceInstance*>& rkPakResources = PakIt->second;
+
+        ParallelUtil::ParallelFor(rkPakResources.size(), [&](uint ResIdx, uint ThreadIdx)
+        {
+            if (ThreadIdx == 0 && mpProgress->ShouldCancel())
+                Cancel = true;
+
+            if (Cancel)
+                return;
+
+            SResourceInstance& rRes = *rkPakResources[ResIdx];
+            CMemoryInStream Pak(PakData.data(), PakData.size(), EEndian::BigEndian);
+
+            std::vector<uint8> ResourceData;
+            ReadResource(rRes, Pak, ResourceData);
+            WriteCookedResource(rRes, ResourceData);
+
+            uint Unpacked = ++NumUnpacked;
+
+            // Only report from the thread that owns the notifier
+            if (ThreadIdx == 0 && (Unpacked & 0x3) == 0)
+                mpProgress->Report(Unpacked, NumResources, TString::Format("Unpacking asset %d/%d", Unpacked, NumResources) );
+        });
+    }
+}
+
+// Lower values are processed first when generating editor data in dependency order.
+// Areas and worlds reference the most assets, so starting from them lets their dependencies
+// be processed while they're already in memory.
+static int RawExportRootPriority(EResourceType Type)
+{
+    switch (Type)
+    {
+    case EResourceType::Area:   return 0;
+    case EResourceType::World:  return 1;
+    default:                    return 2;
     }
 }
 
@@ -553,45 +669,43 @@ void CGameExporter::ExportResourceEditorData()
         mpProgress->SetTask(eES_GenerateRaw, "Generating editor data");
         int ResIndex = 0;
 
-        // todo: we're wasting a ton of time loading the same resources over and over because most resources automatically
-        // load all their dependencies and then we just clear it out from memory even though we'll need it again later. we
-        // should really be doing this by dependency order instead of by ID order.
-        for (CResourceIterator It(mpStore); It && !mpProgress->ShouldCancel(); ++It, ++ResIndex)
+        // Walk the dependency graph starting from the assets with the largest dependency trees. Every asset a root
+        // depends on is processed while the root keeps it loaded, so shared dependencies are loaded once per root
+        // instead of being loaded and destroyed again for every asset that uses them.
+        if (mDependencyOrderedRawExport)
         {
-            // Update progress
-            if ((ResIndex & 0x3) == 0 || It->ResourceType() == EResourceType::Area)
-                mpProgress->Report(ResIndex, mpStore->NumTotalResources(), TString::Format("Processing asset %d/%d: %s",
-                    ResIndex, mpStore->NumTotalResources(), *It->CookedAssetPath(true).GetFileName()) );
-
-            // Worlds need some info we can only get from the pak at export time; namely, which areas can
-            // have duplicates, as well as the world's internal name.
-            if (It->ResourceType() == EResourceType::World)
-            {
-                CWorld *pWorld = (CWorld*) It->Load();
+            std::vector<CResourceEntry*> Roots;
+            Roots.reserve(mpStore->NumTotalResources());
 
-                // Set area duplicate flags
-                for (uint32 iArea = 0; iArea < pWorld->NumAreas(); iArea++)
-                {
-                    CAssetID AreaID = pWorld->AreaResourceID(iArea);
-                    auto Find = mAreaDuplicateMap.find(AreaID);
+            for (CResourceIterator It(mpStore); It; ++It)
+                Roots.push_back(*It);
 
-                    if (Find != mAreaDuplicateMap.end())
-                        pWorld->SetAreaAllowsPakDuplicates(iArea, Find->second);
-                }
+            std::stable_sort(Roots.begin(), Roots.end(), [](CResourceEntry *pLeft, CResourceEntry *pRight) -> bool {
+                return RawExportRootPriority(pLeft->ResourceType()) < RawExportRootPriority(pRight->ResourceType());
+            });
+
+            std::set<CAssetID> ProcessedIDs;
 
-                // Set world name
-                TString WorldName = MakeWorldName(pWorld->ID());
-                pWorld->SetName(WorldName);
+            for (uint32 RootIdx = 0; RootIdx < Roots.size() && !mpProgress->ShouldCancel(); RootIdx++)
+            {
+                ExportResourceEditorDataRecursive(Roots[RootIdx], ProcessedIDs, ResIndex);
+                mpStore->DestroyUnreferencedResources();
             }
+        }
 
-            // Save raw resource + generate dependencies
-            if (It->TypeInfo()->CanBeSerialized())
-                It->Save(true);
-            else
-                It->UpdateDependencies();
+        // Process assets one at a time in asset ID order. This is the original approach; it's kept so the two can
+        // be compared (see NCoreTests::BenchmarkEditorDataExport), and produces the same output.
+        else
+        {
+            for (CResourceIterator It(mpStore); It && !mpProgress->ShouldCancel(); ++It, ++ResIndex)
+            {
+                // Update progress
+                if ((ResIndex & 0x3) == 0 || It->ResourceType() == EResourceType::Area)
+                    mpProgress->Report(ResIndex, mpStore->NumTotalResources(), TString::Format("Processing asset %d/%d: %s",
+                        ResIndex, mpStore->NumTotalResources(), *It->CookedAssetPath(true).GetFileName()) );
 
-            // Set flags, save metadata
-            It->SaveMetadata(true);
+                ExportResourceEditorData(*It);
+            }
         }
     }
 
@@ -608,47 +722,126 @@ void CGameExporter::ExportResourceEditorData()
     }
 }
 
-void CGameExporter::ExportResource(SResourceInstance& rRes)
+void CGameExporter::ExportResourceEditorDataRecursive(CResourceEntry *pEntry, std::set<CAssetID>& rProcessedIDs, int& rResIndex)
+{
+    if (mpProgress->ShouldCancel() || rProcessedIDs.find(pEntry->ID()) != rProcessedIDs.end())
+        return;
+
+    rProcessedIDs.insert(pEntry->ID());
+
+    // Update progress
+    if ((rResIndex & 0x3) == 0 || pEntry->ResourceType() == EResourceType::Area)
+        mpProgress->Report(rResIndex, mpStore->NumTotalResources(), TString::Format("Processing asset %d/%d: %s",
+            rResIndex, mpStore->NumTotalResources(), *pEntry->CookedAssetPath(true).GetFileName()) );
+
+    rResIndex++;
+
+    // Lock the resource so it (and everything it references) stays loaded while we process its dependencies.
+    // Because the resource is already loaded, Save/UpdateDependencies won't garbage collect it either.
+    CResource *pResource = (pEntry->TypeInfo()->CanHaveDependencies() ? pEntry->Load() : nullptr);
+
+    if (pResource)
+        pResource->Lock();
+
+    ExportResourceEditorData(pEntry);
+
+    if (pResource)
+    {
+        CDependencyTree *pTree = pEntry->Dependencies();
+
+        if (pTree)
+        {
+            std::set<CAssetID> DependencyIDs;
+            pTree->GetAllResourceReferences(DependencyIDs);
+
+            for (auto Iter = DependencyIDs.begin(); Iter != DependencyIDs.end(); Iter++)
+            {
+                CResourceEntry *pDependency = mpStore->FindEntry(*Iter);
+
+                if (pDependency)
+                    ExportResourceEditorDataRecursive(pDependency, rProcessedIDs, rResIndex);
+            }
+        }
+
+        pResource->Release();
+    }
+}
+
+void CGameExporter::ExportResourceEditorData(CResourceEntry *pEntry)
 {
-    if (!rRes.Exported)
+    // Worlds need some info we can only get from the pak at export time; namely, which areas can
+    // have duplicates, as well as the world's internal name.
+    if (pEntry->ResourceType() == EResourceType::World)
     {
-        std::vector<uint8> ResourceData;
-        LoadResource(rRes, ResourceData);
+        CWorld *pWorld = (CWorld*) pEntry->Load();
 
-        // Register resource and write to file
-        TString Directory, Name;
-        bool AutoDir, AutoName;
+        // Set area duplicate flags
+        for (uint32 iArea = 0; iArea < pWorld->NumAreas(); iArea++)
+        {
+            CAssetID AreaID = pWorld->AreaResourceID(iArea);
+            auto Find = mAreaDuplicateMap.find(AreaID);
+
+            if (Find != mAreaDuplicateMap.end())
+                pWorld->SetAreaAllowsPakDuplicates(iArea, Find->second);
+        }
+
+        // Set world name
+        TString WorldName = MakeWorldName(pWorld->ID());
+        pWorld->SetName(WorldName);
+    }
+
+    // Save raw resource + generate dependencies
+    if (pEntry->TypeInfo()->CanBeSerialized())
+        pEntry->Save(true);
+    else
+        pEntry->UpdateDependencies();
+
+    // Set flags, save metadata
+    pEntry->SaveMetadata(true);
+}
+
+void CGameExporter::RegisterResource(SResourceInstance& rRes)
+{
+    // Register resource
+    TString Directory, Name;
+    bool AutoDir, AutoName;
 
 #if USE_ASSET_NAME_MAP
-        mpNameMap->GetNameInfo(rRes.ResourceID, Directory, Name, AutoDir, AutoName);
+    mpNameMap->GetNameInfo(rRes.ResourceID, Directory, Name, AutoDir, AutoName);
 #else
-        Directory = mpStore->DefaultAssetDirectoryPath(mpStore->Game());
-        Name = rRes.ResourceID.ToString();
+    Directory = mpStore->DefaultAssetDirectoryPath(mpStore->Game());
+    Name = rRes.ResourceID.ToString();
 #endif
 
-        CResourceEntry *pEntry = mpStore->CreateNewResource(rRes.ResourceID,
-                                                            CResTypeInfo::TypeForCookedExtension(mGame, rRes.ResourceType)->Type(),
-                                                            Directory, Name, true);
+    CResourceEntry *pEntry = mpStore->CreateNewResource(rRes.ResourceID,
+                                                        CResTypeInfo::TypeForCookedExtension(mGame, rRes.ResourceType)->Type(),
+                                                        Directory, Name, true);
 
-        // Set flags
-        pEntry->SetFlag(EResEntryFlag::IsBaseGameResource);
-        pEntry->SetFlagEnabled(EResEntryFlag::AutoResDir, AutoDir);
-        pEntry->SetFlagEnabled(EResEntryFlag::AutoResName, AutoName);
+    // Set flags
+    pEntry->SetFlag(EResEntryFlag::IsBaseGameResource);
+    pEntry->SetFlagEnabled(EResEntryFlag::AutoResDir, AutoDir);
+    pEntry->SetFlagEnabled(EResEntryFlag::AutoResName, AutoName);
 
-#if EXPORT_COOKED
-        // Save cooked asset
-        TString OutCookedPath = pEntry->CookedAssetPath();
-        FileUtil::MakeDirectory(OutCookedPath.GetFileDirectory());
-        CFileOutStream Out(OutCookedPath, EEndian::BigEndian);
+    // Create the output directory now so the cooked file can be written from any thread later
+    rRes.CookedPath = pEntry->CookedAssetPath();
+    FileUtil::MakeDirectory(rRes.CookedPath.GetFileDirectory());
+}
+
+void CGameExporter::WriteCookedResource(SResourceInstance& rRes, const std::vector<uint8>& rkData)
+{
+    // This is called from unpack jobs, so it must not touch the resource store.
+    ASSERT(!rRes.CookedPath.IsEmpty());
 
-        if (Out.IsValid())
-            Out.WriteBytes(ResourceData.data(), ResourceData.size());
+#if EXPORT_COOKED
+    CFileOutStream Out(rRes.CookedPath, EEndian::BigEndian);
 
-        ASSERT(pEntry->HasCookedVersion());
+    if (Out.IsValid())
+        Out.WriteBytes(rkData.data(), rkData.size());
+    else
+        errorf("Failed to write cooked asset: %s", *rRes.CookedPath);
 #endif
 
-        rRes.Exported = true;
-    }
+    rRes.Exported = true;
 }
 
 TString CGameExporter::MakeWorldName(CAssetID WorldID)
@@ -9,6 +9,7 @@
 #include <Common/Flags.h>
 #include <Common/TString.h>
 #include <map>
+#include <set>
 #include <nod/nod.hpp>
 
 enum class EDiscType
@@ -57,12 +58,16 @@ class CGameExporter
         uint32 PakSize;
         bool Compressed;
         bool Exported;
+        TString CookedPath;
     };
     std::map<CAssetID, SResourceInstance> mResourceMap;
 
     // Progress
     IProgressNotifier *mpProgress;
 
+    // Settings
+    bool mDependencyOrderedRawExport;
+
     enum EExportStep
     {
         eES_ExtractDisc,
@@ -75,19 +80,25 @@ class CGameExporter
 public:
     CGameExporter(EDiscType DiscType, EGame Game, bool FrontEnd, ERegion Region, const TString& rkGameName, const TString& rkGameID, float BuildVersion);
     bool Export(nod::DiscBase *pDisc, const TString& rkOutputDir, CAssetNameMap *pNameMap, CGameInfo *pGameInfo, IProgressNotifier *pProgress);
+    bool RegenerateEditorData(CGameProject *pProject, IProgressNotifier *pProgress);
     void LoadResource(const CAssetID& rkID, std::vector<uint8>& rBuffer);
     bool ShouldExportDiscNode(const nod::Node *pkNode, bool IsInRoot);
 
-    inline TString ProjectPath() const  { return mProjectPath; }
+    inline TString ProjectPath() const                              { return mProjectPath; }
+    inline void SetDependencyOrderedRawExport(bool DependencyOrder) { mDependencyOrderedRawExport = DependencyOrder; }
 
 protected:
     bool ExtractDiscData();
     bool ExtractDiscNodeRecursive(const nod::Node *pkNode, const TString& rkDir, bool RootNode, const nod::ExtractionContext& rkContext);
     void LoadPaks();
     void LoadResource(const SResourceInstance& rkResource, std::vector<uint8>& rBuffer);
+    void ReadResource(const SResourceInstance& rkResource, IInputStream& rPak, std::vector<uint8>& rBuffer) const;
     void ExportCookedResources();
     void ExportResourceEditorData();
-    void ExportResource(SResourceInstance& rRes);
+    void ExportResourceEditorDataRecursive(CResourceEntry *pEntry, std::set<CAssetID>& rProcessedIDs, int& rResIndex);
+    void ExportResourceEditorData(CResourceEntry *pEntry);
+    void RegisterResource(SResourceInstance& rRes);
+    void WriteCookedResource(SResourceInstance& rRes, const std::vector<uint8>& rkData);
     TString MakeWorldName(CAssetID WorldID);
 
     // Convenience Functions
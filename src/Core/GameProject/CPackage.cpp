@@ -1,12 +1,19 @@
 #include "CPackage.h"
+#include "CCompressedAssetCache.h"
 #include "DependencyListBuilders.h"
 #include "CGameProject.h"
 #include "Core/CompressionUtil.h"
+#include "Core/ParallelUtil.h"
 #include "Core/Resource/Cooker/CWorldCooker.h"
 #include <Common/Macros.h>
 #include <Common/FileIO.h>
 #include <Common/FileUtil.h>
+#include <Common/Hash/CCRC32.h>
+#include <Common/Hash/CFNV1A.h>
+#include <Common/Serialization/Binary.h>
 #include <Common/Serialization/XML.h>
+#include <memory>
+#include <mutex>
 
 using namespace tinyxml2;
 
@@ -63,12 +70,197 @@ void CPackage::MarkDirty()
 {
     if (!mNeedsRecook)
     {
+        // The dependency cache is rebuilt lazily by ContainsAsset; rebuilding it here would load every world and area in the package.
         mNeedsRecook = true;
+        mCacheDirty = true;
         Save();
-        UpdateDependencyCache();
     }
 }
 
+// Cooked asset data, prepared to be written to a pak
+struct SPackageAssetData
+{
+    CResourceEntry *pEntry;
+    CAssetID ID;
+    EResourceType Type;
+    TString CookedPath;
+    std::vector<uint8> Data;
+    uint64 DataHash;
+    uint32 Checksum;
+    uint32 UncompressedSize;
+    uint64 ModifiedTime;
+    bool Compressed;
+    bool CopiedFromOldPak; // Data is the full asset span from the previous cook, including header and padding
+};
+
+// Shared state for the threads preparing asset data
+struct SPackageCookContext
+{
+    EGame Game;
+    const CCompressedAssetCache *pCompressionCache;
+    const std::map<CAssetID, SPackageManifestEntry> *pOldManifest;
+    CFileInStream *pOldPak;     // Opened once per cook; reads must hold pOldPakLock
+    std::mutex *pOldPakLock;
+};
+
+static bool ShouldCompressPackageAsset(EGame Game, EResourceType Type, uint32 ResourceSize)
+{
+    // Check if this asset should be compressed; there are a few resource types that are
+    // always compressed, and some types that are compressed if they're over a certain size
+    uint32 CompressThreshold = (Game <= EGame::CorruptionProto ? 0x400 : 0x80);
+
+    bool ShouldAlwaysCompress = (Type == EResourceType::Texture || Type == EResourceType::Model ||
+                                 Type == EResourceType::Skin || Type == EResourceType::AnimSet ||
+                                 Type == EResourceType::Animation || Type == EResourceType::Font);
+
+    if (Game >= EGame::Corruption)
+    {
+        ShouldAlwaysCompress = ShouldAlwaysCompress ||
+                               (Type == EResourceType::Character || Type == EResourceType::SourceAnimData ||
+                                Type == EResourceType::Scan || Type == EResourceType::AudioSample ||
+                                Type == EResourceType::StringTable || Type == EResourceType::AudioAmplitudeData ||
+                                Type == EResourceType::DynamicCollision);
+    }
+
+    bool ShouldCompressConditional = !ShouldAlwaysCompress &&
+            (Type == EResourceType::Particle || Type == EResourceType::ParticleElectric ||
+             Type == EResourceType::ParticleSwoosh || Type == EResourceType::ParticleWeapon ||
+             Type == EResourceType::ParticleDecal || Type == EResourceType::ParticleCollisionResponse ||
+             Type == EResourceType::ParticleSpawn || Type == EResourceType::ParticleSorted ||
+             Type == EResourceType::BurstFireData);
+
+    return ShouldAlwaysCompress || (ShouldCompressConditional && ResourceSize >= CompressThreshold);
+}
+
+static bool UsesZlibCompression(EGame Game)
+{
+    return (Game <= EGame::EchoesDemo || Game == EGame::DKCReturns);
+}
+
+static uint64 HashCookedAssetData(const std::vector<uint8>& rkData)
+{
+    CFNV1A Hash(CFNV1A::k64Bit);
+    Hash.HashData(rkData.data(), rkData.size());
+    return Hash.GetHash64();
+}
+
+// Copies an asset's data from the previous cook's pak. Asset spans are aligned and padded, so they can be moved to a new offset as-is.
+static bool CopyAssetFromOldPak(const SPackageCookContext& rkContext, const SPackageManifestEntry& rkOldEntry, SPackageAssetData& rAsset)
+{
+    CFileInStream *pOldPak = rkContext.pOldPak;
+    if (!pOldPak) return false;
+
+    std::lock_guard<std::mutex> Lock(*rkContext.pOldPakLock);
+
+    if (!pOldPak->IsValid() || rkOldEntry.Offset + rkOldEntry.Size > pOldPak->Size())
+        return false;
+
+    rAsset.Data.resize(rkOldEntry.Size);
+    pOldPak->Seek(rkOldEntry.Offset, SEEK_SET);
+    pOldPak->ReadBytes(rAsset.Data.data(), rAsset.Data.size());
+    rAsset.Compressed = rkOldEntry.Compressed;
+    rAsset.CopiedFromOldPak = true;
+    return true;
+}
+
+// Reads and (if applicable) compresses a cooked asset. This runs on worker threads, so it must not access the resource store.
+static void PreparePackageAssetData(const SPackageCookContext& rkContext, SPackageAssetData& rAsset)
+{
+    EGame Game = rkContext.Game;
+    const CCompressedAssetCache& rkCache = *rkContext.pCompressionCache;
+
+    auto OldIter = rkContext.pOldManifest->find(rAsset.ID);
+    const SPackageManifestEntry *pkOldEntry = (OldIter != rkContext.pOldManifest->end() ? &OldIter->second : nullptr);
+
+    rAsset.Compressed = false;
+    rAsset.CopiedFromOldPak = false;
+    rAsset.ModifiedTime = FileUtil::LastModifiedTime(rAsset.CookedPath);
+
+    // If the cooked file hasn't been written since the last cook, don't bother reading it
+    if (pkOldEntry && pkOldEntry->CookedModifiedTime == rAsset.ModifiedTime &&
+        pkOldEntry->CookedSize == (uint32) FileUtil::FileSize(rAsset.CookedPath) &&
+        CopyAssetFromOldPak(rkContext, *pkOldEntry, rAsset))
+    {
+        rAsset.DataHash = pkOldEntry->DataHash;
+        rAsset.Checksum = pkOldEntry->CookedChecksum;
+        rAsset.UncompressedSize = pkOldEntry->CookedSize;
+        return;
+    }
+
+    // Load resource data
+    CFileInStream CookedAsset(rAsset.CookedPath, EEndian::BigEndian);
+    ASSERT(CookedAsset.IsValid());
+    uint32 ResourceSize = CookedAsset.Size();
+
+    std::vector<uint8> ResourceData(ResourceSize);
+    CookedAsset.ReadBytes(ResourceData.data(), ResourceData.size());
+
+    rAsset.UncompressedSize = ResourceSize;
+    rAsset.DataHash = HashCookedAssetData(ResourceData);
+    rAsset.Checksum = CCRC32::StaticHashData(ResourceData.data(), ResourceData.size());
+
+    // If the asset was rewritten but its data is the same as in the last cook, copy it out of the old pak.
+    // The size and checksum are compared along with the hash so a hash collision can't pull in the wrong asset.
+    if (pkOldEntry && pkOldEntry->CookedSize == ResourceSize &&
+        pkOldEntry->DataHash == rAsset.DataHash && pkOldEntry->CookedChecksum == rAsset.Checksum &&
+        CopyAssetFromOldPak(rkContext, *pkOldEntry, rAsset))
+    {
+        return;
+    }
+
+    if (ShouldCompressPackageAsset(Game, rAsset.Type, ResourceSize))
+    {
+        // Skip compression entirely if this exact data has been compressed before. No data means it didn't compress.
+        std::vector<uint8> CachedData;
+
+        if (rkCache.Fetch(ResourceData, CachedData))
+        {
+            if (CachedData.empty())
+                rAsset.Data = std::move(ResourceData);
+            else
+            {
+                rAsset.Data = std::move(CachedData);
+                rAsset.Compressed = true;
+            }
+            return;
+        }
+
+        uint32 CompressedSize;
+        std::vector<uint8> CompressedData(ResourceData.size() * 2);
+        bool Success = false;
+
+        if (UsesZlibCompression(Game))
+            Success = CompressionUtil::CompressZlib(ResourceData.data(), ResourceData.size(), CompressedData.data(), CompressedData.size(), CompressedSize);
+        else
+            Success = CompressionUtil::CompressLZOSegmented(ResourceData.data(), ResourceData.size(), CompressedData.data(), CompressedSize, false);
+
+        // Make sure that the compressed data is actually smaller, accounting for padding + uncompressed size value
+        if (Success)
+        {
+            uint32 Alignment = (Game <= EGame::CorruptionProto ? 0x20 : 0x40);
+            uint32 AlignmentMinusOne = Alignment - 1;
+            uint32 CompressionHeaderSize = (Game <= EGame::CorruptionProto ? 4 : 0x10);
+            uint32 PaddedUncompressedSize = (ResourceSize + AlignmentMinusOne) & ~AlignmentMinusOne;
+            uint32 PaddedCompressedSize = (CompressedSize + CompressionHeaderSize + AlignmentMinusOne) & ~AlignmentMinusOne;
+            Success = (PaddedCompressedSize < PaddedUncompressedSize);
+        }
+
+        if (Success)
+        {
+            CompressedData.resize(CompressedSize);
+            rkCache.Store(ResourceData, CompressedData);
+            rAsset.Data = std::move(CompressedData);
+            rAsset.Compressed = true;
+            return;
+        }
+
+        // Remember that this asset doesn't compress so the next cook doesn't try again
+        rkCache.Store(ResourceData, std::vector<uint8>());
+    }
+
+    rAsset.Data = std::move(ResourceData);
+}
+
 void CPackage::Cook(IProgressNotifier *pProgress)
 {
     SCOPED_TIMER(CookPackage);
@@ -81,9 +273,15 @@ void CPackage::Cook(IProgressNotifier *pProgress)
     Builder.BuildDependencyList(true, AssetList);
     debugf("%d assets in %s.pak", AssetList.size(), *Name());
 
-    // Write new pak
+    // Load the manifest from the previous cook. Assets that haven't changed since then are copied
+    // from the old pak instead of being compressed and laid out again.
     TString PakPath = CookedPackagePath(false);
-    CFileOutStream Pak(PakPath, EEndian::BigEndian);
+    std::map<CAssetID, SPackageManifestEntry> OldManifest;
+    LoadManifest(OldManifest);
+
+    // Write new pak. This goes to a temporary file first, since the old pak needs to stay readable until we're done.
+    TString TempPakPath = PakPath + ".tmp";
+    CFileOutStream Pak(TempPakPath, EEndian::BigEndian);
 
     if (!Pak.IsValid())
     {
@@ -93,7 +291,6 @@ void CPackage::Cook(IProgressNotifier *pProgress)
 
     EGame Game = mpProject->Game();
     uint32 Alignment = (Game <= EGame::CorruptionProto ? 0x20 : 0x40);
-    uint32 AlignmentMinusOne = Alignment - 1;
 
     uint32 TocOffset = 0;
     uint32 NamesSize = 0;
@@ -172,13 +369,14 @@ void CPackage::Cook(IProgressNotifier *pProgress)
         bool Compressed;
     };
     std::vector<SResourceTableInfo> ResourceTableData(AssetList.size());
-    uint32 ResIdx = 0;
     uint32 ResDataOffset = Pak.Tell();
 
+    // Recook any assets that need it first. This goes through the resource store, so it has to happen on this thread.
+    std::vector<SPackageAssetData> Assets(AssetList.size());
+    uint32 ResIdx = 0;
+
     for (auto Iter = AssetList.begin(); Iter != AssetList.end() && !pProgress->ShouldCancel(); Iter++, ResIdx++)
     {
-        // Initialize entry, recook assets if needed
-        uint32 AssetOffset = Pak.Tell();
         CAssetID ID = *Iter;
         CResourceEntry *pEntry = gpResourceStore->FindEntry(ID);
         ASSERT(pEntry != nullptr);
@@ -189,86 +387,68 @@ void CPackage::Cook(IProgressNotifier *pProgress)
             pEntry->Cook();
         }
 
-        // Update progress bar
-        if (ResIdx & 0x1 || ResIdx == AssetList.size() - 1)
-        {
-            pProgress->Report(ResIdx, AssetList.size(), TString::Format("Writing asset %d/%d: %s", ResIdx+1, AssetList.size(), *(pEntry->Name() + "." + pEntry->CookedExtension())));
-        }
-
-        // Update table info
-        SResourceTableInfo& rTableInfo = ResourceTableData[ResIdx];
-        rTableInfo.pEntry = pEntry;
-        rTableInfo.Offset = (Game <= EGame::Echoes ? AssetOffset : AssetOffset - ResDataOffset);
-
-        // Load resource data
-        CFileInStream CookedAsset(pEntry->CookedAssetPath(), EEndian::BigEndian);
-        ASSERT(CookedAsset.IsValid());
-        uint32 ResourceSize = CookedAsset.Size();
+        Assets[ResIdx].pEntry = pEntry;
+        Assets[ResIdx].ID = ID;
+        Assets[ResIdx].Type = pEntry->ResourceType();
+        Assets[ResIdx].CookedPath = pEntry->CookedAssetPath();
+    }
 
-        std::vector<uint8> ResourceData(ResourceSize);
-        CookedAsset.ReadBytes(ResourceData.data(), ResourceData.size());
+    // Read and compress assets in batches across all cores, then write each batch to the pak in asset list order.
+    // Batching bounds how much asset data is held in memory at once.
+    const uint32 kBatchSize = ParallelUtil::NumThreads() * 4;
+    CCompressedAssetCache CompressionCache(mpProject, UsesZlibCompression(Game));
 
-        // Check if this asset should be compressed; there are a few resource types that are
-        // always compressed, and some types that are compressed if they're over a certain size
-        EResourceType Type = pEntry->ResourceType();
-        uint32 CompressThreshold = (Game <= EGame::CorruptionProto ? 0x400 : 0x80);
+    // The old pak is only read when there are assets to reuse from it
+    std::unique_ptr<CFileInStream> pOldPak;
+    std::mutex OldPakLock;
 
-        bool ShouldAlwaysCompress = (Type == EResourceType::Texture || Type == EResourceType::Model ||
-                                     Type == EResourceType::Skin || Type == EResourceType::AnimSet ||
-                                     Type == EResourceType::Animation || Type == EResourceType::Font);
+    if (!OldManifest.empty())
+        pOldPak.reset( new CFileInStream(PakPath, EEndian::BigEndian) );
 
-        if (Game >= EGame::Corruption)
-        {
-            ShouldAlwaysCompress = ShouldAlwaysCompress ||
-                                   (Type == EResourceType::Character || Type == EResourceType::SourceAnimData ||
-                                    Type == EResourceType::Scan || Type == EResourceType::AudioSample ||
-                                    Type == EResourceType::StringTable || Type == EResourceType::AudioAmplitudeData ||
-                                    Type == EResourceType::DynamicCollision);
-        }
+    SPackageCookContext Context { Game, &CompressionCache, &OldManifest, pOldPak.get(), &OldPakLock };
 
-        bool ShouldCompressConditional = !ShouldAlwaysCompress &&
-                (Type == EResourceType::Particle || Type == EResourceType::ParticleElectric ||
-                 Type == EResourceType::ParticleSwoosh || Type == EResourceType::ParticleWeapon ||
-                 Type == EResourceType::ParticleDecal || Type == EResourceType::ParticleCollisionResponse ||
-                 Type == EResourceType::ParticleSpawn || Type == EResourceType::ParticleSorted ||
-                 Type == EResourceType::BurstFireData);
+    std::vector<SPackageManifestEntry> NewManifest(AssetList.size());
+    uint32 NumReusedAssets = 0;
 
-        bool ShouldCompress = ShouldAlwaysCompress || (ShouldCompressConditional && ResourceSize >= CompressThreshold);
+    for (uint32 BatchStart = 0; BatchStart < Assets.size() && !pProgress->ShouldCancel(); BatchStart += kBatchSize)
+    {
+        uint32 BatchEnd = Math::Min<uint32>(BatchStart + kBatchSize, Assets.size());
 
-        // Write resource data to pak
-        if (!ShouldCompress)
+        ParallelUtil::ParallelFor(BatchEnd - BatchStart, [&](uint Index, uint)
         {
-            Pak.WriteBytes(ResourceData.data(), ResourceSize);
-            rTableInfo.Compressed = false;
-        }
+            PreparePackageAssetData(Context, Assets[BatchStart + Index]);
+        });
 
-        else
+        for (ResIdx = BatchStart; ResIdx < BatchEnd; ResIdx++)
         {
-            uint32 CompressedSize;
-            std::vector<uint8> CompressedData(ResourceData.size() * 2);
-            bool Success = false;
-
-            if (Game <= EGame::EchoesDemo || Game == EGame::DKCReturns)
-                Success = CompressionUtil::CompressZlib(ResourceData.data(), ResourceData.size(), CompressedData.data(), CompressedData.size(), CompressedSize);
-            else
-                Success = CompressionUtil::CompressLZOSegmented(ResourceData.data(), ResourceData.size(), CompressedData.data(), CompressedSize, false);
+            SPackageAssetData& rAsset = Assets[ResIdx];
+            CResourceEntry *pEntry = rAsset.pEntry;
+            uint32 AssetOffset = Pak.Tell();
 
-            // Make sure that the compressed data is actually smaller, accounting for padding + uncompressed size value
-            if (Success)
+            // Update progress bar
+            if (ResIdx & 0x1 || ResIdx == AssetList.size() - 1)
             {
-                uint32 CompressionHeaderSize = (Game <= EGame::CorruptionProto ? 4 : 0x10);
-                uint32 PaddedUncompressedSize = (ResourceSize + AlignmentMinusOne) & ~AlignmentMinusOne;
-                uint32 PaddedCompressedSize = (CompressedSize + CompressionHeaderSize + AlignmentMinusOne) & ~AlignmentMinusOne;
-                Success = (PaddedCompressedSize < PaddedUncompressedSize);
+                pProgress->Report(ResIdx, AssetList.size(), TString::Format("Writing asset %d/%d: %s", ResIdx+1, AssetList.size(), *(pEntry->Name() + "." + pEntry->CookedExtension())));
             }
 
-            // Write file to pak
-            if (Success)
+            // Update table info
+            SResourceTableInfo& rTableInfo = ResourceTableData[ResIdx];
+            rTableInfo.pEntry = pEntry;
+            rTableInfo.Offset = (Game <= EGame::Echoes ? AssetOffset : AssetOffset - ResDataOffset);
+            rTableInfo.Compressed = rAsset.Compressed;
+
+            // Write resource data to pak
+            if (rAsset.CopiedFromOldPak)
+            {
+                // Header and padding are already included in the copied data
+                NumReusedAssets++;
+            }
+            else if (rAsset.Compressed)
             {
                 // Write MP1/2 compressed asset
                 if (Game <= EGame::CorruptionProto)
                 {
-                    Pak.WriteLong(ResourceSize);
+                    Pak.WriteLong(rAsset.UncompressedSize);
                 }
                 // Write MP3/DKCR compressed asset
                 else
@@ -279,27 +459,32 @@ void CPackage::Cook(IProgressNotifier *pProgress)
                     // multiple blocks or not, so for the sake of simplicity we compress everything to one block.
                     Pak.WriteFourCC( FOURCC('CMPD') );
                     Pak.WriteLong(1);
-                    Pak.WriteLong(0xA0000000 | CompressedSize);
-                    Pak.WriteLong(ResourceSize);
+                    Pak.WriteLong(0xA0000000 | (uint32) rAsset.Data.size());
+                    Pak.WriteLong(rAsset.UncompressedSize);
                 }
-                Pak.WriteBytes(CompressedData.data(), CompressedSize);
             }
-            else
-                Pak.WriteBytes(ResourceData.data(), ResourceSize);
 
-            rTableInfo.Compressed = Success;
-        }
+            Pak.WriteBytes(rAsset.Data.data(), rAsset.Data.size());
+            Pak.WriteToBoundary(Alignment, 0xFF);
+            rTableInfo.Size = Pak.Tell() - AssetOffset;
 
-        Pak.WriteToBoundary(Alignment, 0xFF);
-        rTableInfo.Size = Pak.Tell() - AssetOffset;
+            NewManifest[ResIdx] = SPackageManifestEntry { rAsset.ID, rAsset.DataHash, rAsset.Checksum, rAsset.UncompressedSize, rAsset.ModifiedTime,
+                                                          AssetOffset, rTableInfo.Size, rAsset.Compressed };
+
+            // Free the data now that it's been written
+            std::vector<uint8>().swap(rAsset.Data);
+        }
     }
     ResDataSize = Pak.Tell() - ResDataOffset;
 
+    // Every asset has been prepared by now, so trim the compression cache and save its index
+    CompressionCache.Flush();
+
     // If we cancelled, don't finish writing the pak; delete the file instead and make sure the package is flagged for recook
     if (pProgress->ShouldCancel())
     {
         Pak.Close();
-        FileUtil::DeleteFile(PakPath);
+        FileUtil::DeleteFile(TempPakPath);
         mNeedsRecook = true;
     }
 
@@ -333,9 +518,47 @@ void CPackage::Cook(IProgressNotifier *pProgress)
             Pak.WriteLong(rkInfo.Offset);
         }
 
-        // Clear recook flag
-        mNeedsRecook = false;
-        debugf("Finished writing %s", *PakPath);
+        // Replace the old pak with the new one. The old pak is moved to a backup first so it can be put back if the move fails.
+        Pak.Close();
+        pOldPak.reset();
+
+        TString BackupPakPath = PakPath + ".bak";
+        bool HasBackup = false;
+        bool Success = true;
+
+        if (FileUtil::Exists(PakPath))
+        {
+            if (FileUtil::Exists(BackupPakPath))
+                FileUtil::DeleteFile(BackupPakPath);
+
+            HasBackup = FileUtil::MoveFile(PakPath, BackupPakPath);
+            Success = HasBackup;
+        }
+
+        if (Success)
+        {
+            Success = FileUtil::MoveFile(TempPakPath, PakPath);
+
+            if (!Success && HasBackup && !FileUtil::MoveFile(BackupPakPath, PakPath))
+                errorf("Failed to restore the previous package from %s", *BackupPakPath);
+        }
+
+        if (Success)
+        {
+            if (HasBackup)
+                FileUtil::DeleteFile(BackupPakPath);
+
+            SaveManifest(NewManifest);
+
+            // Clear recook flag
+            mNeedsRecook = false;
+            debugf("Finished writing %s (%d/%d assets reused from previous cook)", *PakPath, NumReusedAssets, (uint32) AssetList.size());
+        }
+        else
+        {
+            errorf("Couldn't cook package %s; unable to move package into place. The new package was left at %s", *CookedPackagePath(true), *TempPakPath);
+            mNeedsRecook = true;
+        }
     }
 
     Save();
@@ -344,6 +567,53 @@ void CPackage::Cook(IProgressNotifier *pProgress)
     mpProject->ResourceStore()->ConditionalSaveStore();
 }
 
+bool CPackage::LoadManifest(std::map<CAssetID, SPackageManifestEntry>& rOutEntries) const
+{
+    TString PakPath = CookedPackagePath(false);
+
+    if (!FileUtil::Exists(PakPath))
+        return false;
+
+    CBasicBinaryReader Reader(ManifestPath(), FOURCC('PKMF'));
+
+    if (!Reader.IsValid() || Reader.Game() != mpProject->Game() || Reader.FileVersion() != (uint16) EPackageManifestVersion::Current)
+        return false;
+
+    uint64 PakSize = 0;
+    std::vector<SPackageManifestEntry> Entries;
+    Reader << SerialParameter("PakSize", PakSize)
+           << SerialParameter("Assets", Entries);
+
+    // If the pak doesn't match the manifest then it was changed outside of the editor and the manifest is stale
+    if (PakSize != FileUtil::FileSize(PakPath))
+        return false;
+
+    for (auto Iter = Entries.begin(); Iter != Entries.end(); Iter++)
+        rOutEntries[Iter->ID] = *Iter;
+
+    return true;
+}
+
+bool CPackage::SaveManifest(const std::vector<SPackageManifestEntry>& rkEntries) const
+{
+    TString Path = ManifestPath();
+    FileUtil::MakeDirectory(Path.GetFileDirectory());
+
+    CBasicBinaryWriter Writer(Path, FOURCC('PKMF'), (uint16) EPackageManifestVersion::Current, mpProject->Game());
+
+    if (!Writer.IsValid())
+    {
+        errorf("Failed to save package manifest: %s", *Path);
+        return false;
+    }
+
+    uint64 PakSize = FileUtil::FileSize( CookedPackagePath(false) );
+    std::vector<SPackageManifestEntry> Entries = rkEntries;
+    Writer << SerialParameter("PakSize", PakSize)
+           << SerialParameter("Assets", Entries);
+    return true;
+}
+
 void CPackage::CompareOriginalAssetList(const std::list<CAssetID>& rkNewList)
 {
     // Debug - take the newly generated rkNewList and compare it with the asset list
@@ -462,3 +732,8 @@ TString CPackage::CookedPackagePath(bool Relative) const
     TString RelPath = mPakPath + mPakName + ".pak";
     return Relative ? RelPath : mpProject->DiscFilesystemRoot(false) + RelPath;
 }
+
+TString CPackage::ManifestPath() const
+{
+    return mpProject->HiddenFilesDir() / "PackageManifests/" + mPakPath + mPakName + ".pkm";
+}
@@ -6,6 +6,7 @@
 #include <Common/TString.h>
 #include <Common/Serialization/IArchive.h>
 #include "Core/IProgressNotifier.h"
+#include <map>
 
 class CGameProject;
 
@@ -18,6 +19,16 @@ enum class EPackageDefinitionVersion
     Current = EPackageDefinitionVersion::Max - 1
 };
 
+enum class EPackageManifestVersion
+{
+    Initial,
+    CookedFileInfo,
+    // Add new versions before this line
+
+    Max,
+    Current = EPackageManifestVersion::Max - 1
+};
+
 struct SNamedResource
 {
     TString Name;
@@ -32,6 +43,31 @@ struct SNamedResource
     }
 };
 
+// Where an asset was written in a cooked pak; recorded after each cook so the next cook can reuse unchanged asset data
+struct SPackageManifestEntry
+{
+    CAssetID ID;
+    uint64 DataHash;
+    uint32 CookedChecksum;
+    uint32 CookedSize;
+    uint64 CookedModifiedTime;
+    uint32 Offset;
+    uint32 Size;
+    bool Compressed;
+
+    void Serialize(IArchive& rArc)
+    {
+        rArc << SerialParameter("ID", ID)
+             << SerialParameter("DataHash", DataHash)
+             << SerialParameter("CookedChecksum", CookedChecksum)
+             << SerialParameter("CookedSize", CookedSize)
+             << SerialParameter("CookedModifiedTime", CookedModifiedTime)
+             << SerialParameter("Offset", Offset)
+             << SerialParameter("Size", Size)
+             << SerialParameter("Compressed", Compressed);
+    }
+};
+
 class CPackage
 {
     CGameProject *mpProject;
@@ -63,11 +99,14 @@ public:
     void MarkDirty();
 
     void Cook(IProgressNotifier *pProgress);
+    bool LoadManifest(std::map<CAssetID, SPackageManifestEntry>& rOutEntries) const;
+    bool SaveManifest(const std::vector<SPackageManifestEntry>& rkEntries) const;
     void CompareOriginalAssetList(const std::list<CAssetID>& rkNewList);
     bool ContainsAsset(const CAssetID& rkID) const;
 
     TString DefinitionPath(bool Relative) const;
     TString CookedPackagePath(bool Relative) const;
+    TString ManifestPath() const;
 
     // Accessors
     inline TString Name() const                                         { return mPakName; }
@@ -7,6 +7,7 @@
 #include <Common/FileIO.h>
 #include <Common/FileUtil.h>
 #include <Common/TString.h>
+#include <Common/Serialization/Binary.h>
 #include <Common/Serialization/CXMLReader.h>
 #include <Common/Serialization/CXMLWriter.h>
 
@@ -19,6 +20,8 @@ CResourceEntry::CResourceEntry(CResourceStore *pStore)
     , mpDirectory(nullptr)
     , mMetadataDirty(false)
     , mCachedSize(-1)
+    , mpPackedDependencies(nullptr)
+    , mPackedDependenciesSize(0)
 {}
 
 // Static constructors
@@ -67,19 +70,18 @@ CResourceEntry* CResourceEntry::BuildFromArchive(CResourceStore *pStore, IArchiv
 }
 
 CResourceEntry* CResourceEntry::BuildFromDirectory(CResourceStore *pStore, CResTypeInfo *pTypeInfo,
-                                                   const TString& rkDirPath, const TString& rkName)
+                                                   CVirtualDirectory *pDir, const TString& rkName)
 {
     // Initialize as much entry info as possible from the input data, then load the rest from the metadata file.
-    ASSERT(pTypeInfo);
+    // This doesn't modify the store or the directory, so it's safe to call from worker threads; the caller is
+    // responsible for adding the entry to its directory afterwards.
+    ASSERT(pTypeInfo && pDir);
 
     CResourceEntry *pEntry = new CResourceEntry(pStore);
     pEntry->mpTypeInfo = pTypeInfo;
     pEntry->mName = rkName;
     pEntry->mCachedUppercaseName = rkName.ToUpper();
-
-    pEntry->mpDirectory = pStore->GetVirtualDirectory(rkDirPath, true);
-    ASSERT(pEntry->mpDirectory);
-    pEntry->mpDirectory->AddChild("", pEntry);
+    pEntry->mpDirectory = pDir;
 
     // Make sure we're valid, then load the remaining data from the metadata file
     ASSERT(pEntry->HasCookedVersion() || pEntry->HasRawVersion());
@@ -89,6 +91,26 @@ CResourceEntry* CResourceEntry::BuildFromDirectory(CResourceStore *pStore, CResT
     return pEntry;
 }
 
+CResourceEntry* CResourceEntry::BuildFromDatabase(CResourceStore *pStore, const CAssetID& rkID, CResTypeInfo *pTypeInfo,
+                                                  FResEntryFlags Flags, CVirtualDirectory *pDir, const TString& rkName,
+                                                  uint8 *pPackedDependencies, uint32 PackedDependenciesSize)
+{
+    // Initialize entry from the flat resource database. The dependency tree is left packed until something needs it.
+    ASSERT(pTypeInfo && pDir);
+
+    CResourceEntry *pEntry = new CResourceEntry(pStore);
+    pEntry->mID = rkID;
+    pEntry->mpTypeInfo = pTypeInfo;
+    pEntry->mFlags = Flags;
+    pEntry->mName = rkName;
+    pEntry->mCachedUppercaseName = rkName.ToUpper();
+    pEntry->mpDirectory = pDir;
+    pEntry->mpDirectory->AddChild("", pEntry);
+    pEntry->mpPackedDependencies = pPackedDependencies;
+    pEntry->mPackedDependenciesSize = PackedDependenciesSize;
+    return pEntry;
+}
+
 CResourceEntry::~CResourceEntry()
 {
     if (mpResource) delete mpResource;
@@ -154,6 +176,10 @@ void CResourceEntry::SerializeEntryInfo(IArchive& rArc, bool MetadataOnly)
     // Serialize extra data that we exclude from the metadata file
     if (!MetadataOnly)
     {
+        // Make sure packed dependencies are decoded so they get written
+        if (rArc.IsWriter())
+            Dependencies();
+
         TString Dir = (mpDirectory ? mpDirectory->FullPath() : "");
 
         rArc << SerialParameter("Name", mName)
@@ -171,8 +197,11 @@ void CResourceEntry::SerializeEntryInfo(IArchive& rArc, bool MetadataOnly)
 
 void CResourceEntry::UpdateDependencies()
 {
-    if (mpDependencies)
+    std::set<CAssetID> OldDependencies;
+
+    if (Dependencies())
     {
+        mpDependencies->GetAllResourceReferences(OldDependencies);
         delete mpDependencies;
         mpDependencies = nullptr;
     }
@@ -180,6 +209,7 @@ void CResourceEntry::UpdateDependencies()
     if (!mpTypeInfo->CanHaveDependencies())
     {
         mpDependencies = new CDependencyTree();
+        mpStore->UpdateReverseDependencies(mID, OldDependencies, std::set<CAssetID>());
         return;
     }
 
@@ -192,16 +222,72 @@ void CResourceEntry::UpdateDependencies()
     {
         errorf("Unable to update cached dependencies; failed to load resource");
         mpDependencies = new CDependencyTree();
+        mpStore->UpdateReverseDependencies(mID, OldDependencies, std::set<CAssetID>());
         return;
     }
 
     mpDependencies = mpResource->BuildDependencyTree();
     mpStore->SetCacheDirty();
 
+    std::set<CAssetID> NewDependencies;
+    mpDependencies->GetAllResourceReferences(NewDependencies);
+    mpStore->UpdateReverseDependencies(mID, OldDependencies, NewDependencies);
+
     if (!WasLoaded)
         mpStore->DestroyUnreferencedResources();
 }
 
+CDependencyTree* CResourceEntry::Dependencies() const
+{
+    if (!mpDependencies && mpPackedDependencies)
+    {
+        CBasicBinaryReader Reader(mpPackedDependencies, mPackedDependenciesSize, CSerialVersion(IArchive::skCurrentArchiveVersion, 0, Game()));
+        Reader << SerialParameter("Dependencies", mpDependencies);
+        ClearPackedDependencies();
+    }
+
+    return mpDependencies;
+}
+
+void CResourceEntry::WritePackedDependencies(std::vector<uint8>& rOut) const
+{
+    // If the dependencies were never decoded, then they haven't changed and we can copy the packed data as-is
+    if (mpPackedDependencies)
+    {
+        rOut.insert(rOut.end(), mpPackedDependencies, mpPackedDependencies + mPackedDependenciesSize);
+    }
+    else if (mpDependencies)
+    {
+        CVectorOutStream DepStream;
+        CBasicBinaryWriter Writer(&DepStream, CSerialVersion(IArchive::skCurrentArchiveVersion, 0, Game()));
+        Writer << SerialParameter("Dependencies", mpDependencies);
+
+        const uint8 *pkData = static_cast<const uint8*>(DepStream.Data());
+        rOut.insert(rOut.end(), pkData, pkData + DepStream.Size());
+    }
+}
+
+void CResourceEntry::RegisterReverseDependencies(bool Register) const
+{
+    // Adds this entry's dependencies to the store's reverse dependency index, or removes them
+    std::set<CAssetID> DependencyIDs;
+    CDependencyTree *pTree = Dependencies();
+
+    if (pTree)
+        pTree->GetAllResourceReferences(DependencyIDs);
+
+    if (Register)
+        mpStore->UpdateReverseDependencies(mID, std::set<CAssetID>(), DependencyIDs);
+    else
+        mpStore->UpdateReverseDependencies(mID, DependencyIDs, std::set<CAssetID>());
+}
+
+void CResourceEntry::ClearPackedDependencies() const
+{
+    mpPackedDependencies = nullptr;
+    mPackedDependenciesSize = 0;
+}
+
 bool CResourceEntry::HasRawVersion() const
 {
     return FileUtil::Exists(RawAssetPath());
@@ -342,13 +428,17 @@ bool CResourceEntry::Save(bool SkipCacheSave /*= false*/, bool FlagForRecook /*=
     }
 
     // Flag dirty any packages that contain this resource.
+    // This uses the store's reverse dependency index so we don't need to walk every package's dependencies.
     if (FlagForRecook)
     {
-        for (uint32 iPkg = 0; iPkg < mpStore->Project()->NumPackages(); iPkg++)
+        std::vector<CPackage*> Packages;
+        mpStore->GetPackagesContainingAsset(ID(), Packages);
+
+        for (uint32 iPkg = 0; iPkg < Packages.size(); iPkg++)
         {
-            CPackage *pPkg = mpStore->Project()->PackageByIndex(iPkg);
+            CPackage *pPkg = Packages[iPkg];
 
-            if (!pPkg->NeedsRecook() && pPkg->ContainsAsset(ID()))
+            if (!pPkg->NeedsRecook())
                 pPkg->MarkDirty();
         }
     }
@@ -600,11 +690,16 @@ bool CResourceEntry::MoveAndRename(const TString& rkDir, const TString& rkName,
     {
         if (mpDirectory != pOldDir && pOldDir != nullptr)
         {
-            FSMoveSuccess = pOldDir->RemoveChildResource(this);
+            // The old directory has us indexed under our old name
+            FSMoveSuccess = pOldDir->RemoveChildResource(this, OldName);
             ASSERT(FSMoveSuccess == true); // this shouldn't be able to fail
             mpDirectory->AddChild("", this);
             SetFlagEnabled(EResEntryFlag::AutoResDir, IsAutoGenDir);
         }
+        else if (mName != OldName)
+        {
+            mpDirectory->RenameChildResource(this, OldName);
+        }
 
         if (mName != OldName)
         {
@@ -660,6 +755,9 @@ void CResourceEntry::MarkDeleted(bool InDeleted)
     {
         SetFlagEnabled(EResEntryFlag::MarkedForDeletion, InDeleted);
 
+        // Deleted entries don't reference anything as far as the reverse dependency index is concerned
+        RegisterReverseDependencies(!InDeleted);
+
         // Restore old name/directory if un-deleting
         if (!InDeleted)
         {
@@ -692,10 +790,9 @@ void CResourceEntry::MarkDeleted(bool InDeleted)
             // means it is not safe to access later. Separating the name and the path with
             // the '|' character is safe because this character is not allowed in filenames
             // (which is enforced in FileUtil::IsValidName()).
-            mName = mName + "|" + mpDirectory->FullPath();
-
-            // Remove from parent directory.
+            // Remove from parent directory first, since it looks us up by name.
             mpDirectory->RemoveChildResource(this);
+            mName = mName + "|" + mpDirectory->FullPath();
             mpDirectory = nullptr;
 
             // Move any resource files out of the project into a temporary folder.
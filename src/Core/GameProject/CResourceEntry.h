@@ -8,6 +8,7 @@
 #include <Common/CAssetID.h>
 #include <Common/CFourCC.h>
 #include <Common/Flags.h>
+#include <vector>
 
 class CResource;
 class CGameProject;
@@ -30,7 +31,7 @@ class CResourceEntry
     CResource *mpResource;
     CResTypeInfo *mpTypeInfo;
     CResourceStore *mpStore;
-    CDependencyTree *mpDependencies;
+    mutable CDependencyTree *mpDependencies;
     CAssetID mID;
     CVirtualDirectory *mpDirectory;
     TString mName;
@@ -40,6 +41,11 @@ class CResourceEntry
     mutable uint64 mCachedSize;
     mutable TString mCachedUppercaseName; // This is used to speed up case-insensitive sorting and filtering.
 
+    // Serialized dependency tree from the resource database. This points into the database buffer
+    // owned by the resource store, and is only decoded the first time the dependencies are requested.
+    mutable uint8 *mpPackedDependencies;
+    mutable uint32 mPackedDependenciesSize;
+
     // Private constructor
     CResourceEntry(CResourceStore *pStore);
 
@@ -49,13 +55,19 @@ public:
                                              EResourceType Type, bool ExistingResource = false);
     static CResourceEntry* BuildFromArchive(CResourceStore *pStore, IArchive& rArc);
     static CResourceEntry* BuildFromDirectory(CResourceStore *pStore, CResTypeInfo *pTypeInfo,
-                                              const TString& rkDirPath, const TString& rkName);
+                                              CVirtualDirectory *pDir, const TString& rkName);
+    static CResourceEntry* BuildFromDatabase(CResourceStore *pStore, const CAssetID& rkID, CResTypeInfo *pTypeInfo,
+                                             FResEntryFlags Flags, CVirtualDirectory *pDir, const TString& rkName,
+                                             uint8 *pPackedDependencies, uint32 PackedDependenciesSize);
     ~CResourceEntry();
 
     bool LoadMetadata();
     bool SaveMetadata(bool ForceSave = false);
     void SerializeEntryInfo(IArchive& rArc, bool MetadataOnly);
     void UpdateDependencies();
+    CDependencyTree* Dependencies() const;
+    void WritePackedDependencies(std::vector<uint8>& rOut) const;
+    void RegisterReverseDependencies(bool Register) const;
 
     bool HasRawVersion() const;
     bool HasCookedVersion() const;
@@ -90,6 +102,7 @@ public:
 
     inline void SetDirty()                          { SetFlag(EResEntryFlag::NeedsRecook); }
     inline void SetHidden(bool Hidden)              { SetFlagEnabled(EResEntryFlag::Hidden, Hidden); }
+    inline FResEntryFlags Flags() const             { return mFlags; }
     inline bool HasFlag(EResEntryFlag Flag) const   { return mFlags.HasFlag(Flag); }
     inline bool IsHidden() const                    { return HasFlag(EResEntryFlag::Hidden); }
     inline bool IsMarkedForDeletion() const         { return HasFlag(EResEntryFlag::MarkedForDeletion); }
@@ -100,7 +113,6 @@ public:
     inline CResource* Resource() const              { return mpResource; }
     inline CResTypeInfo* TypeInfo() const           { return mpTypeInfo; }
     inline CResourceStore* ResourceStore() const    { return mpStore; }
-    inline CDependencyTree* Dependencies() const    { return mpDependencies; }
     inline CAssetID ID() const                      { return mID; }
     inline CVirtualDirectory* Directory() const     { return mpDirectory; }
     inline TString DirectoryPath() const            { return mpDirectory->FullPath(); }
@@ -110,6 +122,7 @@ public:
 
 protected:
     CResource* InternalLoad(IInputStream& rInput);
+    void ClearPackedDependencies() const;
 };
 
 #endif // CRESOURCEENTRY_H
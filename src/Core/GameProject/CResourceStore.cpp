@@ -4,7 +4,9 @@
 #include "CResourceIterator.h"
 #include "Core/IUIRelay.h"
 #include "Core/Resource/CResource.h"
+#include "Core/ParallelUtil.h"
 #include <Common/Macros.h>
+#include <Common/CTimer.h>
 #include <Common/FileUtil.h>
 #include <Common/Log.h>
 #include <Common/Serialization/Binary.h>
@@ -20,6 +22,9 @@ CResourceStore::CResourceStore(const TString& rkDatabasePath)
     : mpProj(nullptr)
     , mGame(EGame::Prime)
     , mDatabaseCacheDirty(false)
+    , mReverseDependenciesBuilt(false)
+    , mpPackedReverseDependencies(nullptr)
+    , mPackedReverseDependenciesSize(0)
 {
     mpDatabaseRoot = new CVirtualDirectory(this);
     mDatabasePath = FileUtil::MakeAbsolute(rkDatabasePath.GetFileDirectory());
@@ -32,6 +37,9 @@ CResourceStore::CResourceStore(CGameProject *pProject)
     , mGame(EGame::Invalid)
     , mpDatabaseRoot(nullptr)
     , mDatabaseCacheDirty(false)
+    , mReverseDependenciesBuilt(false)
+    , mpPackedReverseDependencies(nullptr)
+    , mPackedReverseDependenciesSize(0)
 {
     SetProject(pProject);
 }
@@ -47,7 +55,7 @@ CResourceStore::~CResourceStore()
 
 void RecursiveGetListOfEmptyDirectories(CVirtualDirectory *pDir, TStringList& rOutList)
 {
-    // Helper function for SerializeResourceDatabase
+    // Helper function for SaveDatabaseCache
     if (pDir->IsEmpty(false))
     {
         rOutList.push_back(pDir->FullPath());
@@ -59,81 +67,168 @@ void RecursiveGetListOfEmptyDirectories(CVirtualDirectory *pDir, TStringList& rO
     }
 }
 
-bool CResourceStore::SerializeDatabaseCache(IArchive& rArc)
+bool CResourceStore::LoadLegacyDatabaseCache(IArchive& rArc)
 {
-    // Serialize resources
+    // Databases are only written in the flat format now; this reads databases saved by older versions
+    ASSERT(rArc.IsReader());
+
+    // Load resources
     if (rArc.ParamBegin("Resources", 0))
     {
-        // Serialize resources
-        uint32 ResourceCount = mResourceEntries.size();
-
-        if (rArc.IsWriter())
-        {
-            // Make sure deleted resources aren't included in the count.
-            // We can't use CResourceIterator because it skips MarkedForDeletion resources.
-            for (auto Iter = mResourceEntries.begin(); Iter != mResourceEntries.end(); Iter++)
-            {
-                CResourceEntry* pEntry = Iter->second;
-
-                if (pEntry->IsMarkedForDeletion())
-                {
-                    ResourceCount--;
-                }
-            }
-        }
-
+        uint32 ResourceCount = 0;
         rArc << SerialParameter("ResourceCount", ResourceCount);
 
-        if (rArc.IsReader())
-        {
-            for (uint32 ResIdx = 0; ResIdx < ResourceCount; ResIdx++)
-            {
-                if (rArc.ParamBegin("Resource", 0))
-                {
-                    CResourceEntry *pEntry = CResourceEntry::BuildFromArchive(this, rArc);
-                    ASSERT( FindEntry(pEntry->ID()) == nullptr );
-                    mResourceEntries[pEntry->ID()] = pEntry;
-                    rArc.ParamEnd();
-                }
-            }
-        }
-        else
+        for (uint32 ResIdx = 0; ResIdx < ResourceCount; ResIdx++)
         {
-            for (CResourceIterator It(this); It; ++It)
+            if (rArc.ParamBegin("Resource", 0))
             {
-                if (!It->IsMarkedForDeletion())
-                {
-                    if (rArc.ParamBegin("Resource", 0))
-                    {
-                        It->SerializeEntryInfo(rArc, false);
-                        rArc.ParamEnd();
-                    }
-                }
+                CResourceEntry *pEntry = CResourceEntry::BuildFromArchive(this, rArc);
+                ASSERT( FindEntry(pEntry->ID()) == nullptr );
+                mResourceEntries[pEntry->ID()] = pEntry;
+                rArc.ParamEnd();
             }
         }
         rArc.ParamEnd();
     }
 
-    // Serialize empty directory list
+    // Load empty directory list
     TStringList EmptyDirectories;
+    rArc << SerialParameter("EmptyDirectories", EmptyDirectories);
 
-    if (!rArc.IsReader())
-        RecursiveGetListOfEmptyDirectories(mpDatabaseRoot, EmptyDirectories);
+    for (auto Iter = EmptyDirectories.begin(); Iter != EmptyDirectories.end(); Iter++)
+    {
+        // Don't create empty virtual directories that don't actually exist in the filesystem
+        TString AbsPath = ResourcesDir() + *Iter;
 
-    rArc << SerialParameter("EmptyDirectories", EmptyDirectories);
+        if (FileUtil::Exists(AbsPath))
+            CreateVirtualDirectory(*Iter);
+    }
+
+    return true;
+}
 
-    if (rArc.IsReader())
+bool CResourceStore::LoadFlatDatabaseCache(const TString& rkPath)
+{
+    // Read the whole database in one go. Entries are built straight out of the buffer; strings are
+    // referenced by offset and dependency trees are left packed until they are first requested.
+    // Every record still gets an entry up front, since the virtual directory tree and resource
+    // iterators expect the full set of entries to exist as soon as the database is loaded.
+    uint64 FileSize = FileUtil::FileSize(rkPath);
+    if (FileSize < 0x28) return false;
+
+    CFileInStream File(rkPath, EEndian::BigEndian);
+    if (!File.IsValid()) return false;
+
+    mDatabaseBuffer.resize((uint32) FileSize);
+    File.ReadBytes(mDatabaseBuffer.data(), mDatabaseBuffer.size());
+    File.Close();
+
+    CMemoryInStream DB(mDatabaseBuffer.data(), mDatabaseBuffer.size(), EEndian::BigEndian);
+    CFourCC Magic = DB.ReadFourCC();
+    uint32 Version = DB.ReadLong();
+
+    // FlatLayout databases are still readable; they just don't have a reverse dependency index
+    if (Magic != FOURCC('RSDB') || Version < (uint32) EDatabaseVersion::FlatLayout || Version > (uint32) EDatabaseVersion::Current)
     {
-        for (auto Iter = EmptyDirectories.begin(); Iter != EmptyDirectories.end(); Iter++)
-        {
-            // Don't create empty virtual directories that don't actually exist in the filesystem
-            TString AbsPath = ResourcesDir() + *Iter;
+        mDatabaseBuffer.clear();
+        return false;
+    }
+
+    EGame Game = (EGame) DB.ReadLong();
+    EIDLength IDLength = CAssetID::GameIDLength(Game);
+    uint32 NumEntries = DB.ReadLong();
+    uint32 NumEmptyDirs = DB.ReadLong();
+    uint32 StringTableOffset = DB.ReadLong();
+    uint32 StringTableSize = DB.ReadLong();
+    uint32 DependencyDataOffset = DB.ReadLong();
+    uint32 DependencyDataSize = DB.ReadLong();
+    uint32 ReverseDependencyOffset = 0;
+    uint32 ReverseDependencySize = 0;
+
+    if (Version >= (uint32) EDatabaseVersion::ReverseDependencies)
+    {
+        ReverseDependencyOffset = DB.ReadLong();
+        ReverseDependencySize = DB.ReadLong();
+    }
+
+    DB.Seek(Version >= (uint32) EDatabaseVersion::ReverseDependencies ? 0x30 : 0x28, SEEK_SET); // Skip header padding
+
+    if (StringTableOffset + StringTableSize > mDatabaseBuffer.size() ||
+        DependencyDataOffset + DependencyDataSize > mDatabaseBuffer.size() ||
+        ReverseDependencyOffset + ReverseDependencySize > mDatabaseBuffer.size() ||
+        StringTableSize == 0 || mDatabaseBuffer[StringTableOffset + StringTableSize - 1] != 0)
+    {
+        errorf("Resource database is corrupt: %s", *rkPath);
+        mDatabaseBuffer.clear();
+        return false;
+    }
+
+    if (mpProj)
+    {
+        ASSERT(mpProj->Game() == Game);
+    }
+    mGame = Game;
+
+    const char *pkStrings = reinterpret_cast<const char*>(&mDatabaseBuffer[StringTableOffset]);
+    uint8 *pDependencyData = &mDatabaseBuffer[DependencyDataOffset];
+
+    // Many entries share a directory, so only resolve each directory string once
+    std::map<uint32, CVirtualDirectory*> DirectoryCache;
 
-            if (FileUtil::Exists(AbsPath))
-                CreateVirtualDirectory(*Iter);
+    for (uint32 EntryIdx = 0; EntryIdx < NumEntries; EntryIdx++)
+    {
+        CAssetID ID(DB, IDLength);
+        EResourceType Type = (EResourceType) DB.ReadLong();
+        FResEntryFlags Flags = FResEntryFlags( DB.ReadLong() );
+        uint32 NameOffset = DB.ReadLong();
+        uint32 DirOffset = DB.ReadLong();
+        uint32 DepOffset = DB.ReadLong();
+        uint32 DepSize = DB.ReadLong();
+
+        CResTypeInfo *pTypeInfo = CResTypeInfo::FindTypeInfo(Type);
+        ASSERT(pTypeInfo);
+        ASSERT(NameOffset < StringTableSize && DirOffset < StringTableSize);
+        ASSERT(DepOffset + DepSize <= DependencyDataSize);
+
+        auto DirIter = DirectoryCache.find(DirOffset);
+        CVirtualDirectory *pDir;
+
+        if (DirIter == DirectoryCache.end())
+        {
+            pDir = GetVirtualDirectory(&pkStrings[DirOffset], true);
+            DirectoryCache[DirOffset] = pDir;
         }
+        else
+            pDir = DirIter->second;
+
+        CResourceEntry *pEntry = CResourceEntry::BuildFromDatabase(this, ID, pTypeInfo, Flags, pDir, &pkStrings[NameOffset],
+                                                                   DepSize > 0 ? pDependencyData + DepOffset : nullptr, DepSize);
+        ASSERT( FindEntry(pEntry->ID()) == nullptr );
+        mResourceEntries[pEntry->ID()] = pEntry;
+    }
+
+    for (uint32 DirIdx = 0; DirIdx < NumEmptyDirs; DirIdx++)
+    {
+        // Don't create empty virtual directories that don't actually exist in the filesystem
+        uint32 DirOffset = DB.ReadLong();
+        ASSERT(DirOffset < StringTableSize);
+        TString Dir = &pkStrings[DirOffset];
+
+        if (FileUtil::Exists(ResourcesDir() + Dir))
+            CreateVirtualDirectory(Dir);
+    }
+
+    // The reverse dependency index is decoded on first use
+    if (ReverseDependencySize > 0)
+    {
+        mpPackedReverseDependencies = &mDatabaseBuffer[ReverseDependencyOffset];
+        mPackedReverseDependenciesSize = ReverseDependencySize;
     }
 
+    // Upgrade older databases on the next save
+    if (Version != (uint32) EDatabaseVersion::Current)
+        mDatabaseCacheDirty = true;
+
     return true;
 }
 
@@ -145,28 +240,49 @@ bool CResourceStore::LoadDatabaseCache()
     if (!mpDatabaseRoot)
         mpDatabaseRoot = new CVirtualDirectory(this);
 
-    // Load the resource database
-    CBasicBinaryReader Reader(Path, FOURCC('CACH'));
+    // Check for the flat database format first
+    bool IsFlatDatabase = false;
+    {
+        CFileInStream File(Path, EEndian::BigEndian);
+        IsFlatDatabase = File.IsValid() && File.Size() >= 4 && File.ReadFourCC() == FOURCC('RSDB');
+    }
 
-    if (!Reader.IsValid() || !SerializeDatabaseCache(Reader))
+    if (IsFlatDatabase)
     {
-        if (gpUIRelay->AskYesNoQuestion("Error", "Failed to load the resource database. Attempt to build from the directory? (This may take a while.)"))
-        {
-            if (!BuildFromDirectory(true))
-                return false;
-        }
-        else return false;
+        if (LoadFlatDatabaseCache(Path))
+            return true;
+
+        // Drop anything that was loaded before the failure
+        ClearDatabase();
+        mDatabaseCacheDirty = false;
     }
     else
     {
-        // Database is successfully loaded at this point
-        if (mpProj)
+        // Load the legacy resource database
+        CBasicBinaryReader Reader(Path, FOURCC('CACH'));
+
+        if (Reader.IsValid() && LoadLegacyDatabaseCache(Reader))
         {
-            ASSERT(mpProj->Game() == Reader.Game());
+            // Database is successfully loaded at this point
+            if (mpProj)
+            {
+                ASSERT(mpProj->Game() == Reader.Game());
+            }
+
+            mGame = Reader.Game();
+
+            // Upgrade to the flat format on the next save
+            mDatabaseCacheDirty = true;
+            return true;
         }
+    }
 
-        mGame = Reader.Game();
+    if (gpUIRelay->AskYesNoQuestion("Error", "Failed to load the resource database. Attempt to build from the directory? (This may take a while.)"))
+    {
+        if (!BuildFromDirectory(true))
+            return false;
     }
+    else return false;
 
     return true;
 }
@@ -176,12 +292,165 @@ bool CResourceStore::SaveDatabaseCache()
     TString Path = DatabasePath();
     debugf("Saving database cache...");
 
-    CBasicBinaryWriter Writer(Path, FOURCC('CACH'), 0, mGame);
+    // Build the string table and the dependency blob. Strings are deduplicated since most entries share a directory.
+    std::vector<char> StringTable;
+    std::map<TString, uint32> StringOffsets;
+    std::vector<uint8> DependencyData;
+
+    auto AddString = [&StringTable, &StringOffsets](const TString& rkString) -> uint32
+    {
+        auto Iter = StringOffsets.find(rkString);
+        if (Iter != StringOffsets.end()) return Iter->second;
+
+        uint32 Offset = StringTable.size();
+        StringTable.insert(StringTable.end(), *rkString, *rkString + rkString.Size() + 1);
+        StringOffsets[rkString] = Offset;
+        return Offset;
+    };
+
+    struct SFlatEntry
+    {
+        CResourceEntry *pEntry;
+        uint32 NameOffset;
+        uint32 DirOffset;
+        uint32 DepOffset;
+        uint32 DepSize;
+    };
+    std::vector<SFlatEntry> Entries;
+    Entries.reserve(mResourceEntries.size());
+
+    // Make sure deleted resources aren't included.
+    // We can't use CResourceIterator because it skips MarkedForDeletion resources.
+    for (auto Iter = mResourceEntries.begin(); Iter != mResourceEntries.end(); Iter++)
+    {
+        CResourceEntry *pEntry = Iter->second;
+        if (pEntry->IsMarkedForDeletion()) continue;
+
+        SFlatEntry Entry;
+        Entry.pEntry = pEntry;
+        Entry.NameOffset = AddString(pEntry->Name());
+        Entry.DirOffset = AddString(pEntry->Directory() ? pEntry->DirectoryPath() : "");
+        Entry.DepOffset = DependencyData.size();
+        pEntry->WritePackedDependencies(DependencyData);
+        Entry.DepSize = DependencyData.size() - Entry.DepOffset;
+        Entries.push_back(Entry);
+    }
+
+    TStringList EmptyDirectories;
+    RecursiveGetListOfEmptyDirectories(mpDatabaseRoot, EmptyDirectories);
+
+    std::vector<uint32> EmptyDirOffsets;
+    for (auto Iter = EmptyDirectories.begin(); Iter != EmptyDirectories.end(); Iter++)
+        EmptyDirOffsets.push_back( AddString(*Iter) );
+
+    // Pack the reverse dependency index. If it hasn't been touched since it was loaded, the packed copy is still valid.
+    std::vector<uint8> ReverseDependencyData;
+    EIDLength IDLength = CAssetID::GameIDLength(mGame);
+
+    if (!mReverseDependenciesBuilt && mpPackedReverseDependencies)
+    {
+        ReverseDependencyData.assign(mpPackedReverseDependencies, mpPackedReverseDependencies + mPackedReverseDependenciesSize);
+    }
+    else
+    {
+        EnsureReverseDependencyIndex();
+
+        CVectorOutStream ReverseStream(EEndian::BigEndian);
+        ReverseStream.WriteLong(mReverseDependencies.size());
+
+        for (auto Iter = mReverseDependencies.begin(); Iter != mReverseDependencies.end(); Iter++)
+        {
+            Iter->first.Write(ReverseStream, IDLength);
+            ReverseStream.WriteLong(Iter->second.size());
+
+            for (auto RefIter = Iter->second.begin(); RefIter != Iter->second.end(); RefIter++)
+                RefIter->Write(ReverseStream, IDLength);
+        }
+
+        const uint8 *pkData = static_cast<const uint8*>(ReverseStream.Data());
+        ReverseDependencyData.assign(pkData, pkData + ReverseStream.Size());
+    }
+
+    // Write to a temp file first so a failed save doesn't clobber the existing database;
+    // entries loaded from it may still be pointing into our copy of it, but the file itself must stay intact.
+    TString TempPath = Path + ".tmp";
+    CFileOutStream DB(TempPath, EEndian::BigEndian);
 
-    if (!Writer.IsValid())
+    if (!DB.IsValid())
         return false;
 
-    SerializeDatabaseCache(Writer);
+    uint32 IDSize = (IDLength == k64Bit ? 8 : 4);
+    uint32 HeaderSize = 0x30;
+    uint32 EntryTableSize = Entries.size() * (IDSize + 0x18);
+    uint32 StringTableOffset = HeaderSize + EntryTableSize + (EmptyDirOffsets.size() * 4);
+    uint32 DependencyDataOffset = StringTableOffset + StringTable.size();
+    uint32 ReverseDependencyOffset = DependencyDataOffset + DependencyData.size();
+
+    DB.WriteFourCC( FOURCC('RSDB') );
+    DB.WriteLong( (uint32) EDatabaseVersion::Current );
+    DB.WriteLong( (uint32) mGame );
+    DB.WriteLong( Entries.size() );
+    DB.WriteLong( EmptyDirOffsets.size() );
+    DB.WriteLong( StringTableOffset );
+    DB.WriteLong( StringTable.size() );
+    DB.WriteLong( DependencyDataOffset );
+    DB.WriteLong( DependencyData.size() );
+    DB.WriteLong( ReverseDependencyOffset );
+    DB.WriteLong( ReverseDependencyData.size() );
+    DB.WriteToBoundary(0x10, 0); // padding
+    ASSERT(DB.Tell() == HeaderSize);
+
+    for (const SFlatEntry& rkEntry : Entries)
+    {
+        rkEntry.pEntry->ID().Write(DB, IDLength);
+        DB.WriteLong( (uint32) rkEntry.pEntry->ResourceType() );
+        DB.WriteLong( (uint32) rkEntry.pEntry->Flags() );
+        DB.WriteLong( rkEntry.NameOffset );
+        DB.WriteLong( rkEntry.DirOffset );
+        DB.WriteLong( rkEntry.DepOffset );
+        DB.WriteLong( rkEntry.DepSize );
+    }
+
+    for (uint32 Offset : EmptyDirOffsets)
+        DB.WriteLong(Offset);
+
+    ASSERT(DB.Tell() == StringTableOffset);
+    DB.WriteBytes(StringTable.data(), StringTable.size());
+    DB.WriteBytes(DependencyData.data(), DependencyData.size());
+    DB.WriteBytes(ReverseDependencyData.data(), ReverseDependencyData.size());
+    DB.Close();
+
+    // Move the old database out of the way rather than deleting it, so it can be put back if the new one can't be moved into place
+    TString BackupPath = Path + ".bak";
+    bool HasBackup = false;
+
+    if (FileUtil::Exists(Path))
+    {
+        if (FileUtil::Exists(BackupPath))
+            FileUtil::DeleteFile(BackupPath);
+
+        if (!FileUtil::MoveFile(Path, BackupPath))
+        {
+            errorf("Failed to replace resource database: %s; the new database was left at %s", *Path, *TempPath);
+            return false;
+        }
+
+        HasBackup = true;
+    }
+
+    if (!FileUtil::MoveFile(TempPath, Path))
+    {
+        errorf("Failed to replace resource database: %s; the new database was left at %s", *Path, *TempPath);
+
+        if (HasBackup && !FileUtil::MoveFile(BackupPath, Path))
+            errorf("Failed to restore the previous resource database from %s", *BackupPath);
+
+        return false;
+    }
+
+    if (HasBackup)
+        FileUtil::DeleteFile(BackupPath);
+
     mDatabaseCacheDirty = false;
     return true;
 }
@@ -246,6 +515,12 @@ void CResourceStore::CloseProject()
         It = mResourceEntries.erase(It);
     }
 
+    mReverseDependencies.clear();
+    mReverseDependenciesBuilt = false;
+    mpPackedReverseDependencies = nullptr;
+    mPackedReverseDependenciesSize = 0;
+    mDatabaseBuffer.clear();
+
     // Clear deleted files from previous runs
     TString DeletedPath = DeletedResourcePath();
 
@@ -352,6 +627,12 @@ void CResourceStore::ClearDatabase()
         delete Iter->second;
     mResourceEntries.clear();
 
+    mReverseDependencies.clear();
+    mReverseDependenciesBuilt = false;
+    mpPackedReverseDependencies = nullptr;
+    mPackedReverseDependenciesSize = 0;
+    mDatabaseBuffer.clear();
+
     delete mpDatabaseRoot;
     mpDatabaseRoot = new CVirtualDirectory(this);
 
@@ -361,8 +642,19 @@ void CResourceStore::ClearDatabase()
 bool CResourceStore::BuildFromDirectory(bool ShouldGenerateCacheFile)
 {
     ASSERT(mResourceEntries.empty());
+    double StartTime = CTimer::GlobalTime();
+
+    // Scan the resources directory. This creates all virtual directories up front,
+    // so the directory tree is read-only while the metadata files are being parsed.
+    struct SPendingEntry
+    {
+        CResTypeInfo *pTypeInfo;
+        CVirtualDirectory *pDir;
+        TString Name;
+        CResourceEntry *pEntry;
+    };
+    std::vector<SPendingEntry> PendingEntries;
 
-    // Get list of resources
     TString ResDir = ResourcesDir();
     TStringList ResourceList;
     FileUtil::GetDirectoryContents(ResDir, ResourceList);
@@ -390,21 +682,44 @@ bool CResourceStore::BuildFromDirectory(bool ShouldGenerateCacheFile)
                 continue;
             }
 
-            // Create resource entry
-            CResourceEntry *pEntry = CResourceEntry::BuildFromDirectory(this, pTypeInfo, DirPath, ResName);
-
-            // Validate the entry
-            CAssetID ID = pEntry->ID();
-            ASSERT( mResourceEntries.find(ID) == mResourceEntries.end() );
-            ASSERT( ID.Length() == CAssetID::GameIDLength(mGame) );
-
-            mResourceEntries[ID] = pEntry;
+            CVirtualDirectory *pDir = GetVirtualDirectory(DirPath, true);
+            ASSERT(pDir);
+            PendingEntries.push_back( SPendingEntry { pTypeInfo, pDir, ResName, nullptr } );
         }
 
         else if (FileUtil::IsDirectory(Path))
             CreateVirtualDirectory(RelPath);
     }
 
+    double ScanEndTime = CTimer::GlobalTime();
+
+    // Create entries and parse their metadata files in parallel
+    ParallelUtil::ParallelFor(PendingEntries.size(), [this, &PendingEntries](uint Index, uint)
+    {
+        SPendingEntry& rPending = PendingEntries[Index];
+        rPending.pEntry = CResourceEntry::BuildFromDirectory(this, rPending.pTypeInfo, rPending.pDir, rPending.Name);
+    });
+
+    double MetadataEndTime = CTimer::GlobalTime();
+
+    // Register the new entries in scan order so the directory contents are deterministic
+    for (uint32 EntryIdx = 0; EntryIdx < PendingEntries.size(); EntryIdx++)
+    {
+        CResourceEntry *pEntry = PendingEntries[EntryIdx].pEntry;
+        pEntry->Directory()->AddChild("", pEntry);
+
+        // Validate the entry
+        CAssetID ID = pEntry->ID();
+        ASSERT( mResourceEntries.find(ID) == mResourceEntries.end() );
+        ASSERT( ID.Length() == CAssetID::GameIDLength(mGame) );
+
+        mResourceEntries[ID] = pEntry;
+    }
+
+    double RegisterEndTime = CTimer::GlobalTime();
+    debugf("Registered %d resources from directory (scan %.3fs, metadata %.3fs, register %.3fs)",
+           (uint32) mResourceEntries.size(), ScanEndTime - StartTime, MetadataEndTime - ScanEndTime, RegisterEndTime - MetadataEndTime);
+
     // Generate new cache file
     if (ShouldGenerateCacheFile)
     {
@@ -416,13 +731,74 @@ bool CResourceStore::BuildFromDirectory(bool ShouldGenerateCacheFile)
         if (mpProj)
             mpProj->AudioManager()->LoadAssets();
 
-        // Update dependencies
+        // Update dependencies. Loading a resource recurses back into the store and resource ref counts
+        // aren't atomic, so resources are still loaded on this thread, but cooked data is read ahead of
+        // time on the worker threads in batches so the loads don't stall on disk access.
+        std::vector<CResourceEntry*> Entries;
+        Entries.reserve(mResourceEntries.size());
+
         for (CResourceIterator It(this); It; ++It)
-            It->UpdateDependencies();
+            Entries.push_back(*It);
+
+        const uint32 kBatchSize = ParallelUtil::NumThreads() * 8;
+        std::vector< std::vector<uint8> > CookedData(kBatchSize);
+        double ReadTime = 0.0;
+        double DependencyTime = 0.0;
+
+        for (uint32 BatchStart = 0; BatchStart < Entries.size(); BatchStart += kBatchSize)
+        {
+            uint32 BatchSize = Math::Min<uint32>(kBatchSize, Entries.size() - BatchStart);
+            double BatchStartTime = CTimer::GlobalTime();
+
+            ParallelUtil::ParallelFor(BatchSize, [&Entries, &CookedData, BatchStart](uint Index, uint)
+            {
+                CResourceEntry *pEntry = Entries[BatchStart + Index];
+                std::vector<uint8>& rData = CookedData[Index];
+                rData.clear();
+
+                // Raw assets are loaded in preference to cooked ones, so only prefetch when there's no raw version
+                if (pEntry->TypeInfo()->CanHaveDependencies() && !pEntry->IsLoaded() &&
+                    !pEntry->HasRawVersion() && pEntry->HasCookedVersion())
+                {
+                    CFileInStream File(pEntry->CookedAssetPath(), EEndian::BigEndian);
+
+                    if (File.IsValid())
+                    {
+                        rData.resize(File.Size());
+                        File.ReadBytes(rData.data(), rData.size());
+                    }
+                }
+            });
+
+            double BatchReadEndTime = CTimer::GlobalTime();
+            ReadTime += BatchReadEndTime - BatchStartTime;
+
+            for (uint32 Index = 0; Index < BatchSize; Index++)
+            {
+                CResourceEntry *pEntry = Entries[BatchStart + Index];
+                std::vector<uint8>& rData = CookedData[Index];
+
+                if (!rData.empty())
+                {
+                    CMemoryInStream Data(rData.data(), rData.size(), EEndian::BigEndian);
+                    pEntry->LoadCooked(Data);
+                    pEntry->UpdateDependencies();
+                    DestroyUnreferencedResources();
+                }
+                else
+                    pEntry->UpdateDependencies();
+            }
+
+            DependencyTime += CTimer::GlobalTime() - BatchReadEndTime;
+        }
+
+        debugf("Updated dependencies for %d resources (read %.3fs, build %.3fs)", (uint32) Entries.size(), ReadTime, DependencyTime);
 
         // Update database file
+        double SaveStartTime = CTimer::GlobalTime();
         mDatabaseCacheDirty = true;
         ConditionalSaveStore();
+        debugf("Saved database cache (%.3fs); total rebuild time %.3fs", CTimer::GlobalTime() - SaveStartTime, CTimer::GlobalTime() - StartTime);
 
         // Restore old gpResourceStore
         gpResourceStore = pOldStore;
@@ -598,6 +974,10 @@ bool CResourceStore::DeleteResourceEntry(CResourceEntry *pEntry)
     if (pEntry->Directory())
         pEntry->Directory()->RemoveChildResource(pEntry);
 
+    // Entries marked for deletion have already been taken out of the reverse dependency index
+    if (!pEntry->IsMarkedForDeletion())
+        pEntry->RegisterReverseDependencies(false);
+
     auto It = mResourceEntries.find(ID);
     ASSERT(It != mResourceEntries.end());
     mResourceEntries.erase(It);
@@ -606,6 +986,144 @@ bool CResourceStore::DeleteResourceEntry(CResourceEntry *pEntry)
     return true;
 }
 
+void CResourceStore::BuildReverseDependencyIndex()
+{
+    mReverseDependencies.clear();
+
+    for (CResourceIterator It(this); It; ++It)
+    {
+        CDependencyTree *pTree = It->Dependencies();
+        if (!pTree) continue;
+
+        std::set<CAssetID> Dependencies;
+        pTree->GetAllResourceReferences(Dependencies);
+
+        for (auto Iter = Dependencies.begin(); Iter != Dependencies.end(); Iter++)
+            mReverseDependencies[*Iter].insert(It->ID());
+    }
+
+    mReverseDependenciesBuilt = true;
+    mpPackedReverseDependencies = nullptr;
+    mPackedReverseDependenciesSize = 0;
+}
+
+void CResourceStore::EnsureReverseDependencyIndex()
+{
+    if (mReverseDependenciesBuilt)
+        return;
+
+    // Without a saved index, fall back on building it from every entry's dependency tree
+    if (!mpPackedReverseDependencies)
+    {
+        BuildReverseDependencyIndex();
+        return;
+    }
+
+    EIDLength IDLength = CAssetID::GameIDLength(mGame);
+    CMemoryInStream Index(mpPackedReverseDependencies, mPackedReverseDependenciesSize, EEndian::BigEndian);
+    uint32 NumAssets = Index.ReadLong();
+
+    for (uint32 AssetIdx = 0; AssetIdx < NumAssets; AssetIdx++)
+    {
+        CAssetID ID(Index, IDLength);
+        uint32 NumReferencers = Index.ReadLong();
+        std::set<CAssetID>& rReferencers = mReverseDependencies[ID];
+
+        for (uint32 RefIdx = 0; RefIdx < NumReferencers; RefIdx++)
+            rReferencers.insert( CAssetID(Index, IDLength) );
+    }
+
+    mReverseDependenciesBuilt = true;
+    mpPackedReverseDependencies = nullptr;
+    mPackedReverseDependenciesSize = 0;
+}
+
+void CResourceStore::UpdateReverseDependencies(const CAssetID& rkID, const std::set<CAssetID>& rkOldDependencies, const std::set<CAssetID>& rkNewDependencies)
+{
+    // If the index isn't available yet then there's nothing to update; it'll be built from the new dependencies later.
+    // A saved index has to be decoded first, though, or it'd be saved back out without this change.
+    if (!mReverseDependenciesBuilt)
+    {
+        if (!mpPackedReverseDependencies)
+            return;
+
+        EnsureReverseDependencyIndex();
+    }
+
+    for (auto Iter = rkOldDependencies.begin(); Iter != rkOldDependencies.end(); Iter++)
+    {
+        if (rkNewDependencies.find(*Iter) != rkNewDependencies.end())
+            continue;
+
+        auto Find = mReverseDependencies.find(*Iter);
+
+        if (Find != mReverseDependencies.end())
+        {
+            Find->second.erase(rkID);
+
+            if (Find->second.empty())
+                mReverseDependencies.erase(Find);
+        }
+    }
+
+    for (auto Iter = rkNewDependencies.begin(); Iter != rkNewDependencies.end(); Iter++)
+        mReverseDependencies[*Iter].insert(rkID);
+
+    mDatabaseCacheDirty = true;
+}
+
+void CResourceStore::GetReferencingAssets(const CAssetID& rkID, std::set<CAssetID>& rOutIDs)
+{
+    EnsureReverseDependencyIndex();
+    auto Find = mReverseDependencies.find(rkID);
+
+    if (Find != mReverseDependencies.end())
+        rOutIDs.insert(Find->second.begin(), Find->second.end());
+}
+
+void CResourceStore::GetPackagesContainingAsset(const CAssetID& rkID, std::vector<CPackage*>& rOutPackages)
+{
+    // Find every asset that directly or indirectly references this one, then check which packages
+    // list any of them as named resources. This doesn't account for the filtering the package
+    // dependency list builder does (e.g. unused animset characters), so it may return extra packages.
+    if (!mpProj)
+        return;
+
+    std::set<CAssetID> Visited;
+    std::vector<CAssetID> Pending;
+    Visited.insert(rkID);
+    Pending.push_back(rkID);
+
+    while (!Pending.empty())
+    {
+        CAssetID ID = Pending.back();
+        Pending.pop_back();
+
+        std::set<CAssetID> Referencers;
+        GetReferencingAssets(ID, Referencers);
+
+        for (auto Iter = Referencers.begin(); Iter != Referencers.end(); Iter++)
+        {
+            if (Visited.insert(*Iter).second)
+                Pending.push_back(*Iter);
+        }
+    }
+
+    for (uint32 PkgIdx = 0; PkgIdx < mpProj->NumPackages(); PkgIdx++)
+    {
+        CPackage *pPackage = mpProj->PackageByIndex(PkgIdx);
+
+        for (uint32 ResIdx = 0; ResIdx < pPackage->NumNamedResources(); ResIdx++)
+        {
+            if (Visited.find(pPackage->NamedResourceByIndex(ResIdx).ID) != Visited.end())
+            {
+                rOutPackages.push_back(pPackage);
+                break;
+            }
+        }
+    }
+}
+
 void CResourceStore::ImportNamesFromPakContentsTxt(const TString& rkTxtPath, bool UnnamedOnly)
 {
     // Read file contents -first- then move assets -after-; this
@@ -9,14 +9,18 @@
 #include <Common/TString.h>
 #include <map>
 #include <set>
+#include <vector>
 
 class CGameExporter;
 class CGameProject;
+class CPackage;
 class CResource;
 
 enum class EDatabaseVersion
 {
     Initial,
+    FlatLayout,
+    ReverseDependencies,
     // Add new versions before this line
 
     Max,
@@ -34,6 +38,18 @@ class CResourceStore
     std::map<CAssetID, CResourceEntry*> mLoadedResources;
     bool mDatabaseCacheDirty;
 
+    // Contents of the flat resource database. Entries loaded from it keep pointers to their packed
+    // dependency trees in here, so it has to outlive them.
+    std::vector<uint8> mDatabaseBuffer;
+
+    // Reverse dependency index; maps each asset to the assets that reference it. It's saved with the database
+    // and decoded from mDatabaseBuffer on first use, then kept up to date as dependencies change and entries are
+    // deleted. Databases saved without one build it from the cached dependency trees instead.
+    std::map<CAssetID, std::set<CAssetID>> mReverseDependencies;
+    bool mReverseDependenciesBuilt;
+    const uint8 *mpPackedReverseDependencies;
+    uint32 mPackedReverseDependenciesSize;
+
     // Directory paths
     TString mDatabasePath;
 
@@ -41,7 +57,8 @@ public:
     CResourceStore(const TString& rkDatabasePath);
     CResourceStore(CGameProject *pProject);
     ~CResourceStore();
-    bool SerializeDatabaseCache(IArchive& rArc);
+    bool LoadLegacyDatabaseCache(IArchive& rArc);
+    bool LoadFlatDatabaseCache(const TString& rkPath);
     bool LoadDatabaseCache();
     bool SaveDatabaseCache();
     void ConditionalSaveStore();
@@ -71,6 +88,12 @@ public:
     void DestroyUnreferencedResources();
     bool DeleteResourceEntry(CResourceEntry *pEntry);
 
+    void BuildReverseDependencyIndex();
+    void EnsureReverseDependencyIndex();
+    void UpdateReverseDependencies(const CAssetID& rkID, const std::set<CAssetID>& rkOldDependencies, const std::set<CAssetID>& rkNewDependencies);
+    void GetReferencingAssets(const CAssetID& rkID, std::set<CAssetID>& rOutIDs);
+    void GetPackagesContainingAsset(const CAssetID& rkID, std::vector<CPackage*>& rOutPackages);
+
     void ImportNamesFromPakContentsTxt(const TString& rkTxtPath, bool UnnamedOnly);
 
     static bool IsValidResourcePath(const TString& rkPath, const TString& rkName);
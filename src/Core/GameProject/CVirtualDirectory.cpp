@@ -3,6 +3,40 @@
 #include "CResourceStore.h"
 #include "Core/Resource/CResource.h"
 #include <algorithm>
+#include <cctype>
+
+// Case-folded FNV-1a hash of a name, used to key the child lookup indices
+static uint64 HashChildName(const char *pkName, uint32 NameLength)
+{
+    uint64 Hash = 0xCBF29CE484222325;
+
+    for (uint32 CharIdx = 0; CharIdx < NameLength; CharIdx++)
+    {
+        Hash ^= (uint8) toupper( (uint8) pkName[CharIdx] );
+        Hash *= 0x100000001B3;
+    }
+
+    return Hash;
+}
+
+static uint64 ResourceIndexKey(const TString& rkName, EResourceType Type)
+{
+    return HashChildName(*rkName, rkName.Size()) ^ ((uint64) Type * 0x9E3779B97F4A7C15);
+}
+
+static bool ChildNameMatches(const TString& rkName, const char *pkName, uint32 NameLength)
+{
+    if (rkName.Size() != NameLength)
+        return false;
+
+    for (uint32 CharIdx = 0; CharIdx < NameLength; CharIdx++)
+    {
+        if (toupper( (uint8) rkName[CharIdx] ) != toupper( (uint8) pkName[CharIdx] ))
+            return false;
+    }
+
+    return true;
+}
 
 CVirtualDirectory::CVirtualDirectory(CResourceStore *pStore)
     : mpParent(nullptr), mpStore(pStore)
@@ -18,6 +52,7 @@ CVirtualDirectory::CVirtualDirectory(CVirtualDirectory *pParent, const TString&
     : mpParent(pParent), mName(rkName), mpStore(pStore)
 {
     ASSERT(!mName.IsEmpty() && FileUtil::IsValidName(mName, true));
+    UpdateFullPath();
 }
 
 CVirtualDirectory::~CVirtualDirectory()
@@ -68,12 +103,10 @@ bool CVirtualDirectory::IsSafeToDelete() const
     return true;
 }
 
-TString CVirtualDirectory::FullPath() const
+const TString& CVirtualDirectory::FullPath() const
 {
-    if (IsRoot())
-        return "";
-    else
-        return (mpParent ? mpParent->FullPath() + mName : mName) + '/';
+    // Cached; kept up to date by UpdateFullPath() whenever this directory or one of its parents is renamed or moved
+    return mFullPath;
 }
 
 TString CVirtualDirectory::AbsolutePath() const
@@ -88,30 +121,26 @@ CVirtualDirectory* CVirtualDirectory::GetRoot()
 
 CVirtualDirectory* CVirtualDirectory::FindChildDirectory(const TString& rkName, bool AllowCreate)
 {
-    uint32 SlashIdx = rkName.IndexOf("\\/");
-    TString DirName = (SlashIdx == -1 ? rkName : rkName.SubString(0, SlashIdx));
+    // Walk the path one component at a time without splitting it into new strings
+    const char *pkPath = *rkName;
+    uint32 PathSize = rkName.Size();
+    uint32 Start = 0;
+    CVirtualDirectory *pDir = this;
 
-    for (uint32 iSub = 0; iSub < mSubdirectories.size(); iSub++)
+    while (pDir && Start < PathSize)
     {
-        CVirtualDirectory *pChild = mSubdirectories[iSub];
+        uint32 End = Start;
 
-        if (pChild->Name().CaseInsensitiveCompare(DirName))
-        {
-            if (SlashIdx == -1)
-                return pChild;
-
-            else
-            {
-                TString Remaining = rkName.SubString(SlashIdx + 1, rkName.Size() - SlashIdx);
+        while (End < PathSize && pkPath[End] != '/' && pkPath[End] != '\\')
+            End++;
 
-                if (Remaining.IsEmpty())
-                    return pChild;
-                else
-                    return pChild->FindChildDirectory(Remaining, AllowCreate);
-            }
-        }
+        pDir = pDir->FindSubdirectory(&pkPath[Start], End - Start);
+        Start = End + 1;
     }
 
+    if (pDir && pDir != this)
+        return pDir;
+
     if (AllowCreate)
     {
         if ( AddChild(rkName, nullptr) )
@@ -148,10 +177,14 @@ CResourceEntry* CVirtualDirectory::FindChildResource(const TString& rkPath)
 
 CResourceEntry* CVirtualDirectory::FindChildResource(const TString& rkName, EResourceType Type)
 {
-    for (uint32 iRes = 0; iRes < mResources.size(); iRes++)
+    auto Range = mResourceIndex.equal_range( ResourceIndexKey(rkName, Type) );
+
+    for (auto Iter = Range.first; Iter != Range.second; Iter++)
     {
-        if (rkName.CaseInsensitiveCompare(mResources[iRes]->Name()) && mResources[iRes]->ResourceType() == Type)
-            return mResources[iRes];
+        CResourceEntry *pEntry = Iter->second;
+
+        if (rkName.CaseInsensitiveCompare(pEntry->Name()) && pEntry->ResourceType() == Type)
+            return pEntry;
     }
 
     return nullptr;
@@ -163,7 +196,7 @@ bool CVirtualDirectory::AddChild(const TString &rkPath, CResourceEntry *pEntry)
     {
         if (pEntry)
         {
-            mResources.push_back(pEntry);
+            InsertResource(pEntry);
             return true;
         }
         else
@@ -177,16 +210,7 @@ bool CVirtualDirectory::AddChild(const TString &rkPath, CResourceEntry *pEntry)
         TString Remaining = (SlashIdx == -1 ? "" : rkPath.SubString(SlashIdx + 1, rkPath.Size() - SlashIdx));
 
         // Check if this subdirectory already exists
-        CVirtualDirectory *pSubdir = nullptr;
-
-        for (uint32 iSub = 0; iSub < mSubdirectories.size(); iSub++)
-        {
-            if (mSubdirectories[iSub]->Name() == DirName)
-            {
-                pSubdir = mSubdirectories[iSub];
-                break;
-            }
-        }
+        CVirtualDirectory *pSubdir = FindSubdirectory(*DirName, DirName.Size());
 
         if (!pSubdir)
         {
@@ -199,7 +223,7 @@ bool CVirtualDirectory::AddChild(const TString &rkPath, CResourceEntry *pEntry)
                 return false;
             }
 
-            mSubdirectories.push_back(pSubdir);
+            InsertSubdirectory(pSubdir);
             SortSubdirectories();
 
             // As an optimization, don't recurse here. We've already verified the full path is valid, so we don't need to do it again.
@@ -216,11 +240,11 @@ bool CVirtualDirectory::AddChild(const TString &rkPath, CResourceEntry *pEntry)
                     return false;
                 }
 
-                pSubdir->Parent()->mSubdirectories.push_back(pSubdir);
+                pSubdir->Parent()->InsertSubdirectory(pSubdir);
             }
 
             if (pEntry)
-                pSubdir->mResources.push_back(pEntry);
+                pSubdir->InsertResource(pEntry);
 
             return true;
         }
@@ -243,7 +267,7 @@ bool CVirtualDirectory::AddChild(CVirtualDirectory *pDir)
     if (pDir->Parent() != this) return false;
     if (FindChildDirectory(pDir->Name(), false) != nullptr) return false;
 
-    mSubdirectories.push_back(pDir);
+    InsertSubdirectory(pDir);
     SortSubdirectories();
 
     return true;
@@ -256,6 +280,18 @@ bool CVirtualDirectory::RemoveChildDirectory(CVirtualDirectory *pSubdir)
         if (*It == pSubdir)
         {
             mSubdirectories.erase(It);
+
+            auto Range = mSubdirectoryIndex.equal_range( HashChildName(*pSubdir->mName, pSubdir->mName.Size()) );
+
+            for (auto IndexIt = Range.first; IndexIt != Range.second; IndexIt++)
+            {
+                if (IndexIt->second == pSubdir)
+                {
+                    mSubdirectoryIndex.erase(IndexIt);
+                    break;
+                }
+            }
+
             return true;
         }
     }
@@ -265,11 +301,18 @@ bool CVirtualDirectory::RemoveChildDirectory(CVirtualDirectory *pSubdir)
 
 bool CVirtualDirectory::RemoveChildResource(CResourceEntry *pEntry)
 {
+    return RemoveChildResource(pEntry, pEntry->Name());
+}
+
+bool CVirtualDirectory::RemoveChildResource(CResourceEntry *pEntry, const TString& rkIndexedName)
+{
+    // The indexed name is the name the entry had when it was added here, in case it has since been renamed
     for (auto It = mResources.begin(); It != mResources.end(); It++)
     {
         if (*It == pEntry)
         {
             mResources.erase(It);
+            EraseResourceFromIndex(pEntry, rkIndexedName);
             return true;
         }
     }
@@ -277,6 +320,13 @@ bool CVirtualDirectory::RemoveChildResource(CResourceEntry *pEntry)
     return false;
 }
 
+void CVirtualDirectory::RenameChildResource(CResourceEntry *pEntry, const TString& rkOldName)
+{
+    // Re-index a resource that has been renamed without changing directory
+    EraseResourceFromIndex(pEntry, rkOldName);
+    mResourceIndex.insert( std::make_pair(ResourceIndexKey(pEntry->Name(), pEntry->ResourceType()), pEntry) );
+}
+
 void CVirtualDirectory::SortSubdirectories()
 {
     std::sort(mSubdirectories.begin(), mSubdirectories.end(), [](CVirtualDirectory *pLeft, CVirtualDirectory *pRight) -> bool {
@@ -297,7 +347,10 @@ bool CVirtualDirectory::Rename(const TString& rkNewName)
 
             if (FileUtil::MoveDirectory(AbsPath, NewPath))
             {
+                mpParent->RemoveChildDirectory(this);
                 mName = rkNewName;
+                mpParent->InsertSubdirectory(this);
+                UpdateFullPath();
                 mpStore->SetCacheDirty();
                 mpParent->SortSubdirectories();
                 return true;
@@ -385,6 +438,7 @@ bool CVirtualDirectory::SetParent(CVirtualDirectory *pParent)
     if (mpParent->RemoveChildDirectory(this) && FileUtil::MoveDirectory(AbsOldPath, AbsNewPath))
     {
         mpParent = pParent;
+        UpdateFullPath();
         mpParent->AddChild(this);
         mpStore->SetCacheDirty();
         return true;
@@ -397,6 +451,57 @@ bool CVirtualDirectory::SetParent(CVirtualDirectory *pParent)
     }
 }
 
+// ************ PROTECTED ************
+CVirtualDirectory* CVirtualDirectory::FindSubdirectory(const char *pkName, uint32 NameLength) const
+{
+    auto Range = mSubdirectoryIndex.equal_range( HashChildName(pkName, NameLength) );
+
+    for (auto Iter = Range.first; Iter != Range.second; Iter++)
+    {
+        if (ChildNameMatches(Iter->second->mName, pkName, NameLength))
+            return Iter->second;
+    }
+
+    return nullptr;
+}
+
+void CVirtualDirectory::InsertSubdirectory(CVirtualDirectory *pDir)
+{
+    mSubdirectories.push_back(pDir);
+    mSubdirectoryIndex.insert( std::make_pair(HashChildName(*pDir->mName, pDir->mName.Size()), pDir) );
+}
+
+void CVirtualDirectory::InsertResource(CResourceEntry *pEntry)
+{
+    mResources.push_back(pEntry);
+    mResourceIndex.insert( std::make_pair(ResourceIndexKey(pEntry->Name(), pEntry->ResourceType()), pEntry) );
+}
+
+void CVirtualDirectory::EraseResourceFromIndex(CResourceEntry *pEntry, const TString& rkIndexedName)
+{
+    auto Range = mResourceIndex.equal_range( ResourceIndexKey(rkIndexedName, pEntry->ResourceType()) );
+
+    for (auto Iter = Range.first; Iter != Range.second; Iter++)
+    {
+        if (Iter->second == pEntry)
+        {
+            mResourceIndex.erase(Iter);
+            return;
+        }
+    }
+
+    // Shouldn't happen; the caller passed the wrong name
+    ASSERT(false);
+}
+
+void CVirtualDirectory::UpdateFullPath()
+{
+    mFullPath = (IsRoot() ? "" : mpParent->mFullPath + mName + '/');
+
+    for (CVirtualDirectory *pSubdir : mSubdirectories)
+        pSubdir->UpdateFullPath();
+}
+
 // ************ STATIC ************
 bool CVirtualDirectory::IsValidDirectoryName(const TString& rkName)
 {
@@ -5,6 +5,7 @@
 #include "Core/Resource/EResType.h"
 #include <Common/Macros.h>
 #include <Common/TString.h>
+#include <unordered_map>
 #include <vector>
 
 class CResourceEntry;
@@ -15,9 +16,15 @@ class CVirtualDirectory
     CVirtualDirectory *mpParent;
     CResourceStore *mpStore;
     TString mName;
+    TString mFullPath;
     std::vector<CVirtualDirectory*> mSubdirectories;
     std::vector<CResourceEntry*> mResources;
 
+    // Lookup indices keyed by a case-folded hash of the child's name (and type, for resources).
+    // These mirror mSubdirectories and mResources; lookups still compare names to resolve collisions.
+    std::unordered_multimap<uint64, CVirtualDirectory*> mSubdirectoryIndex;
+    std::unordered_multimap<uint64, CResourceEntry*> mResourceIndex;
+
 public:
     CVirtualDirectory(CResourceStore *pStore);
     CVirtualDirectory(const TString& rkName, CResourceStore *pStore);
@@ -27,7 +34,7 @@ public:
     bool IsEmpty(bool CheckFilesystem) const;
     bool IsDescendantOf(CVirtualDirectory *pDir) const;
     bool IsSafeToDelete() const;
-    TString FullPath() const;
+    const TString& FullPath() const;
     TString AbsolutePath() const;
     CVirtualDirectory* GetRoot();
     CVirtualDirectory* FindChildDirectory(const TString& rkName, bool AllowCreate);
@@ -37,6 +44,8 @@ public:
     bool AddChild(CVirtualDirectory *pDir);
     bool RemoveChildDirectory(CVirtualDirectory *pSubdir);
     bool RemoveChildResource(CResourceEntry *pEntry);
+    bool RemoveChildResource(CResourceEntry *pEntry, const TString& rkIndexedName);
+    void RenameChildResource(CResourceEntry *pEntry, const TString& rkOldName);
     void SortSubdirectories();
     bool Rename(const TString& rkNewName);
     bool Delete();
@@ -44,6 +53,14 @@ public:
     bool CreateFilesystemDirectory();
     bool SetParent(CVirtualDirectory *pParent);
 
+protected:
+    CVirtualDirectory* FindSubdirectory(const char *pkName, uint32 NameLength) const;
+    void InsertSubdirectory(CVirtualDirectory *pDir);
+    void InsertResource(CResourceEntry *pEntry);
+    void EraseResourceFromIndex(CResourceEntry *pEntry, const TString& rkIndexedName);
+    void UpdateFullPath();
+
+public:
     static bool IsValidDirectoryName(const TString& rkName);
     static bool IsValidDirectoryPath(TString Path);
 
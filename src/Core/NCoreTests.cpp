@@ -1,9 +1,41 @@
 #include "NCoreTests.h"
+#include "IProgressNotifier.h"
 #include "IUIRelay.h"
+#include "Core/CRayCollisionTester.h"
+#include "Core/GameProject/CGameExporter.h"
 #include "Core/GameProject/CGameProject.h"
 #include "Core/GameProject/CResourceEntry.h"
 #include "Core/GameProject/CResourceIterator.h"
+#include "Core/OpenGL/CGLBackend.h"
+#include "Core/OpenGL/CIndexBuffer.h"
+#include "Core/OpenGL/CUniformBuffer.h"
+#include "Core/Render/CCamera.h"
+#include "Core/Render/CGraphics.h"
+#include "Core/Render/CInstanceBatcher.h"
+#include "Core/Resource/Area/CGameArea.h"
+#include "Core/Resource/Collision/CCollidableOBBTree.h"
+#include "Core/Resource/Cooker/CCollisionCooker.h"
 #include "Core/Resource/Cooker/CResourceCooker.h"
+#include "Core/Resource/Factory/CCollisionLoader.h"
+#include "Core/Resource/Model/CModel.h"
+#include "Core/Scene/CScene.h"
+#include "Core/Scene/CSceneIterator.h"
+#include <Common/CTimer.h>
+#include <Common/Hash/CFNV1A.h>
+#include <Common/Serialization/Binary.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
 
 namespace NCoreTests
 {
@@ -46,6 +78,33 @@ bool ParseToken(const char* pkToken, int argc, char* argv[])
     return false;
 }
 
+/** Returns the peak amount of memory used by the process so far, in bytes */
+uint64 PeakMemoryUsage()
+{
+#if _WIN32
+    PROCESS_MEMORY_COUNTERS Counters;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters)) ? Counters.PeakWorkingSetSize : 0;
+#else
+    // ru_maxrss is in kilobytes on Linux
+    struct rusage Usage;
+    return getrusage(RUSAGE_SELF, &Usage) == 0 ? (uint64) Usage.ru_maxrss * 1024 : 0;
+#endif
+}
+
+/** Hash the contents of a file; files that don't exist hash to 0 */
+uint64 HashFileContents(const TString& rkPath)
+{
+    CFileInStream File(rkPath, EEndian::BigEndian);
+    if (!File.IsValid()) return 0;
+
+    std::vector<uint8> Data( File.Size() );
+    File.ReadBytes(Data.data(), Data.size());
+
+    CFNV1A Hash(CFNV1A::k64Bit);
+    Hash.HashData(Data.data(), Data.size());
+    return Hash.GetHash64();
+}
+
 /** Check commandline input to see if the user is running a test */
 bool RunTests(int argc, char* argv[])
 {
@@ -67,6 +126,96 @@ bool RunTests(int argc, char* argv[])
         return true;
     }
 
+    if( ParseToken("ValidateAreaCollision", argc, argv) )
+    {
+        if( gpUIRelay->OpenProject(ParseParameter("-project", argc, argv)) )
+        {
+            ValidateAreaCollision();
+        }
+        return true;
+    }
+
+    if( ParseToken("ValidateOBBTrees", argc, argv) )
+    {
+        if( gpUIRelay->OpenProject(ParseParameter("-project", argc, argv)) )
+        {
+            ValidateOBBTrees();
+        }
+        return true;
+    }
+
+    if( ParseToken("ValidateGLStats", argc, argv) )
+    {
+        ValidateGLStats();
+        return true;
+    }
+
+    if( ParseToken("ValidateInstanceBatching", argc, argv) )
+    {
+        ValidateInstanceBatching();
+        return true;
+    }
+
+    if( ParseToken("ValidateDepthSort", argc, argv) )
+    {
+        ValidateDepthSort();
+        return true;
+    }
+
+    if( ParseToken("BenchmarkScenePopulation", argc, argv) )
+    {
+        if( gpUIRelay->OpenProject(ParseParameter("-project", argc, argv)) )
+        {
+            BenchmarkScenePopulation();
+        }
+        return true;
+    }
+
+    if( ParseToken("BenchmarkSceneQueries", argc, argv) )
+    {
+        if( gpUIRelay->OpenProject(ParseParameter("-project", argc, argv)) )
+        {
+            BenchmarkSceneQueries();
+        }
+        return true;
+    }
+
+    if( ParseToken("BenchmarkAreaDependencies", argc, argv) )
+    {
+        if( gpUIRelay->OpenProject(ParseParameter("-project", argc, argv)) )
+        {
+            BenchmarkAreaDependencies();
+        }
+        return true;
+    }
+
+    if( ParseToken("ValidateReverseDependencyIndex", argc, argv) )
+    {
+        if( gpUIRelay->OpenProject(ParseParameter("-project", argc, argv)) )
+        {
+            ValidateReverseDependencyIndex();
+        }
+        return true;
+    }
+
+    if( ParseToken("BenchmarkDatabaseLoad", argc, argv) )
+    {
+        if( gpUIRelay->OpenProject(ParseParameter("-project", argc, argv)) )
+        {
+            BenchmarkDatabaseLoad();
+        }
+        return true;
+    }
+
+    if( ParseToken("BenchmarkEditorDataExport", argc, argv) )
+    {
+        if( gpUIRelay->OpenProject(ParseParameter("-project", argc, argv)) )
+        {
+            BenchmarkEditorDataExport();
+        }
+        return true;
+    }
+
     // No test being run.
     return false;
 }
@@ -204,4 +353,1042 @@ bool ValidateCooker(EResourceType ResourceType, bool DumpInvalidFileContents)
     return TestSuccess;
 }
 
+/** Validate area collision sections round-trip through the collision cooker, and that generated octrees are valid */
+bool ValidateAreaCollision()
+{
+    debugf("Validating area collision cooker...");
+
+    // There must be a project loaded
+    CResourceStore* pStore = gpResourceStore;
+    CGameProject* pProject = (pStore ? pStore->Project() : nullptr);
+
+    if (!pProject)
+    {
+        errorf("Area collision unit test failed; no project loaded");
+        return false;
+    }
+
+    // Generated octrees for even the largest areas should be well within this
+    const double kMaxBuildTime = 1.0;
+    uint NumValid = 0, NumInvalid = 0;
+    uint MaxTriangles = 0;
+    double MaxBuildTime = 0.0;
+
+    for (TResourceIterator<EResourceType::Area> It(pStore); It; ++It)
+    {
+        CGameArea* pArea = (CGameArea*) It->Load();
+        CCollisionMeshGroup* pCollision = (pArea ? pArea->Collision() : nullptr);
+        CGameArea::SSectionView OriginalData = (pArea ? pArea->OriginalCollisionSection() : CGameArea::SSectionView { nullptr, 0 });
+
+        if (!pCollision || pCollision->NumMeshes() == 0 || !OriginalData.pkData)
+            continue;
+
+        TString CookedPath = It->CookedAssetPath(true);
+        const char* pkInvalidReason = nullptr;
+
+        // Rewrite the section using the parsed octree. The original section is padded to 32 bytes.
+        std::vector<char> NewData;
+        CVectorOutStream MemoryStream(&NewData, EEndian::BigEndian);
+        CCollisionCooker::CookAreaCollision(pCollision, It->Game(), MemoryStream, false);
+
+        if( NewData.size() > OriginalData.Size ||
+            ALIGN( (uint) NewData.size(), 32 ) != OriginalData.Size )
+        {
+            pkInvalidReason = "size mismatch";
+        }
+        else if( memcmp(OriginalData.pkData, NewData.data(), NewData.size()) != 0 )
+        {
+            pkInvalidReason = "data mismatch";
+        }
+
+        // Generate a new octree and make sure every triangle lands in a leaf
+        if( !pkInvalidReason )
+        {
+            const CCollisionMesh* pkMesh = pCollision->MeshByIndex(0);
+            uint NumTris = pkMesh->NumTriangles();
+
+            double StartTime = CTimer::GlobalTime();
+            std::unique_ptr<CCollisionOctree> pOctree( CCollisionOctree::Build(*pkMesh, pkMesh->Bounds()) );
+            double BuildTime = CTimer::GlobalTime() - StartTime;
+
+            // Find the leaves that reference each triangle
+            std::vector< std::vector<uint32> > TriangleLeaves(NumTris);
+
+            for (uint NodeIdx = 0; NodeIdx < pOctree->NumNodes(); NodeIdx++)
+            {
+                const CCollisionOctree::SNode& kNode = pOctree->Node(NodeIdx);
+                if (kNode.Type != ECollisionOctreeNodeType::Leaf) continue;
+
+                const uint16* pkTris = pOctree->LeafTriangles(kNode);
+
+                for (uint TriIdx = 0; TriIdx < kNode.Count; TriIdx++)
+                    TriangleLeaves[ pkTris[TriIdx] ].push_back(kNode.LeafIndex);
+            }
+
+            std::vector<uint32> LeafMap;
+            pOctree->BuildTriangleLeafMap(NumTris, LeafMap);
+            uint SharedTri = NumTris;
+
+            for (uint TriIdx = 0; TriIdx < NumTris && !pkInvalidReason; TriIdx++)
+            {
+                if( TriangleLeaves[TriIdx].empty() )
+                    pkInvalidReason = "triangle missing from generated octree";
+                else if( TriangleLeaves[TriIdx].size() == 1 && LeafMap[TriIdx] != TriangleLeaves[TriIdx][0] )
+                    pkInvalidReason = "triangle assigned to the wrong leaf";
+                else if( TriangleLeaves[TriIdx].size() > 1 && SharedTri == NumTris )
+                    SharedTri = TriIdx;
+            }
+
+            // A triangle shared by several leaves must still be drawn when one of its leaves is culled
+            if( !pkInvalidReason && SharedTri != NumTris )
+            {
+                bool WasNullBackend = CGLBackend::IsNullBackend();
+                CGLBackend::SetNullBackend(true);
+                {
+                    CCollisionRenderData RenderData;
+                    RenderData.BuildRenderData(pkMesh->GetIndexData(), pOctree.get());
+
+                    std::vector<uint8> VisibleLeaves(pOctree->NumLeaves(), 1);
+                    VisibleLeaves[ TriangleLeaves[SharedTri][0] ] = 0;
+
+                    uint Material = pkMesh->GetIndexData().TriangleMaterialIndices[SharedTri];
+                    std::pair<uint,uint> TriRange = RenderData.LeafBucketRange(Material, LeafMap[SharedTri]);
+                    bool Drawn = false;
+
+                    RenderData.ForEachVisibleLeafRun(Material, VisibleLeaves, [&](uint FirstIndex, uint NumIndices)
+                    {
+                        if (TriRange.first >= FirstIndex && TriRange.first + TriRange.second <= FirstIndex + NumIndices)
+                            Drawn = true;
+                    });
+
+                    if( TriRange.second == 0 || !Drawn )
+                        pkInvalidReason = "shared triangle culled with one of its leaves";
+                }
+                CGLBackend::SetNullBackend(WasNullBackend);
+            }
+
+            if( BuildTime > MaxBuildTime )
+            {
+                MaxBuildTime = BuildTime;
+                MaxTriangles = NumTris;
+            }
+
+            if( !pkInvalidReason && BuildTime > kMaxBuildTime )
+            {
+                pkInvalidReason = "octree generation too slow";
+            }
+
+            // Cook with a regenerated octree, and make sure the result loads back with the same tree
+            if( !pkInvalidReason )
+            {
+                std::vector<char> RebuiltData;
+                CVectorOutStream RebuiltStream(&RebuiltData, EEndian::BigEndian);
+                CCollisionCooker::CookAreaCollision(pCollision, It->Game(), RebuiltStream, true);
+
+                CMemoryInStream ReloadStream(RebuiltData.data(), RebuiltData.size(), EEndian::BigEndian);
+                std::unique_ptr<CCollisionMeshGroup> pReloaded( CCollisionLoader::LoadAreaCollision(ReloadStream) );
+                CCollisionOctree* pReloadedOctree = (pReloaded ? pReloaded->Octree() : nullptr);
+
+                if( !pReloadedOctree ||
+                    pReloadedOctree->NumNodes() != pOctree->NumNodes() ||
+                    pReloadedOctree->NumLeaves() != pOctree->NumLeaves() ||
+                    pReloaded->MeshByIndex(0)->NumTriangles() != NumTris )
+                {
+                    pkInvalidReason = "generated octree does not reload";
+                }
+            }
+        }
+
+        // Print test results
+        if( !pkInvalidReason )
+        {
+            debugf( "[SUCCESS] %s", *CookedPath );
+            NumValid++;
+        }
+        else
+        {
+            debugf( "[FAILED: %s] %s", pkInvalidReason, *CookedPath );
+            NumInvalid++;
+        }
+    }
+
+    // Test complete
+    bool TestSuccess = (NumInvalid == 0);
+    debugf( "Test %s; checked %d areas, %d passed, %d failed. Slowest octree build took %fs for %d triangles",
+            TestSuccess ? "SUCCEEDED" : "FAILED",
+            NumValid + NumInvalid, NumValid, NumInvalid, MaxBuildTime, MaxTriangles );
+
+    return TestSuccess;
+}
+
+/** Compare OBB tree ray casts and box queries on every dynamic collision mesh against a brute force triangle scan, using both the loaded trees and rebuilt ones */
+bool ValidateOBBTrees()
+{
+    debugf("Validating OBB trees...");
+
+    // There must be a project loaded
+    CResourceStore* pStore = gpResourceStore;
+    CGameProject* pProject = (pStore ? pStore->Project() : nullptr);
+
+    if (!pProject)
+    {
+        errorf("OBB tree unit test failed; no project loaded");
+        return false;
+    }
+
+    // Rays are cast along each axis through a grid over the mesh bounds, plus diagonally; boxes tile the mesh bounds
+    const uint kRayGridSize = 8;
+    const uint kBoxGridSize = 4;
+
+    uint NumValid = 0, NumInvalid = 0;
+    double TotalTreeTime = 0.0, TotalBruteForceTime = 0.0, TotalBuildTime = 0.0;
+
+    // Returns a reason if the tree queries don't match a scan over every triangle
+    auto CompareQueries = [&](const CCollidableOBBTree* pkMesh, double& rTreeTime, double& rBruteForceTime) -> const char*
+    {
+        CAABox Bounds = pkMesh->Bounds();
+        CVector3f Size = Bounds.Size();
+
+        for (uint RayIdx = 0; RayIdx < kRayGridSize * kRayGridSize * 6; RayIdx++)
+        {
+            uint Axis = (RayIdx / (kRayGridSize * kRayGridSize)) % 3;
+            bool Diagonal = (RayIdx >= kRayGridSize * kRayGridSize * 3);
+            float U = ((RayIdx % kRayGridSize) + 0.5f) / kRayGridSize;
+            float V = (((RayIdx / kRayGridSize) % kRayGridSize) + 0.5f) / kRayGridSize;
+
+            // Start outside the mesh bounds and aim through a point on the grid
+            CVector3f Target = Bounds.Center();
+            Target[(Axis + 1) % 3] = Bounds.Min()[(Axis + 1) % 3] + Size[(Axis + 1) % 3] * U;
+            Target[(Axis + 2) % 3] = Bounds.Min()[(Axis + 2) % 3] + Size[(Axis + 2) % 3] * V;
+
+            CVector3f Direction = CVector3f::skZero;
+            Direction[Axis] = 1.f;
+            if (Diagonal) Direction = (Direction + CVector3f(0.5f, 0.25f, 0.125f)).Normalized();
+
+            CRay Ray(Target - Direction * (Size.Magnitude() + 1.f), Direction);
+
+            double StartTime = CTimer::GlobalTime();
+            std::pair<bool,float> TreeResult = pkMesh->IntersectsRay(Ray);
+            rTreeTime += CTimer::GlobalTime() - StartTime;
+
+            StartTime = CTimer::GlobalTime();
+            std::pair<bool,float> BruteForceResult = pkMesh->CCollisionMesh::IntersectsRay(Ray);
+            rBruteForceTime += CTimer::GlobalTime() - StartTime;
+
+            if (TreeResult.first != BruteForceResult.first)
+                return "ray hit mismatch";
+            else if (TreeResult.first && Math::Abs(TreeResult.second - BruteForceResult.second) > 0.001f)
+                return "ray hit distance mismatch";
+        }
+
+        CVector3f CellSize = Size / (float) kBoxGridSize;
+
+        for (uint BoxIdx = 0; BoxIdx < kBoxGridSize * kBoxGridSize * kBoxGridSize; BoxIdx++)
+        {
+            CVector3f Min = Bounds.Min() + CVector3f(CellSize.X * (BoxIdx % kBoxGridSize),
+                                                     CellSize.Y * ((BoxIdx / kBoxGridSize) % kBoxGridSize),
+                                                     CellSize.Z * (BoxIdx / (kBoxGridSize * kBoxGridSize)));
+            CAABox Box(Min, Min + CellSize);
+
+            std::vector<uint> TreeTriangles, BruteForceTriangles;
+
+            double StartTime = CTimer::GlobalTime();
+            pkMesh->FindTrianglesInBox(Box, TreeTriangles);
+            rTreeTime += CTimer::GlobalTime() - StartTime;
+
+            StartTime = CTimer::GlobalTime();
+            pkMesh->CCollisionMesh::FindTrianglesInBox(Box, BruteForceTriangles);
+            rBruteForceTime += CTimer::GlobalTime() - StartTime;
+
+            std::sort(TreeTriangles.begin(), TreeTriangles.end());
+
+            if (TreeTriangles != BruteForceTriangles)
+                return "box query mismatch";
+        }
+
+        return nullptr;
+    };
+
+    for (TResourceIterator<EResourceType::DynamicCollision> It(pStore); It; ++It)
+    {
+        CCollisionMeshGroup* pCollision = (CCollisionMeshGroup*) It->Load();
+        if (!pCollision) continue;
+
+        const char* pkInvalidReason = nullptr;
+        bool FailedOnRebuiltTree = false;
+        double TreeTime = 0.0, RebuiltTreeTime = 0.0, BruteForceTime = 0.0, BuildTime = 0.0;
+
+        for (uint MeshIdx = 0; MeshIdx < pCollision->NumMeshes() && !pkInvalidReason; MeshIdx++)
+        {
+            CCollidableOBBTree* pMesh = dynamic_cast<CCollidableOBBTree*>( pCollision->MeshByIndex(MeshIdx) );
+            if (!pMesh || pMesh->NumTriangles() == 0) continue;
+
+            // Check the tree loaded from the game files first, then one generated by BuildOBBTree
+            pkInvalidReason = CompareQueries(pMesh, TreeTime, BruteForceTime);
+
+            if (!pkInvalidReason)
+            {
+                double StartTime = CTimer::GlobalTime();
+                pMesh->BuildOBBTree();
+                BuildTime += CTimer::GlobalTime() - StartTime;
+
+                double UnusedTime = 0.0;
+                pkInvalidReason = CompareQueries(pMesh, RebuiltTreeTime, UnusedTime);
+                FailedOnRebuiltTree = (pkInvalidReason != nullptr);
+            }
+        }
+
+        TotalTreeTime += TreeTime;
+        TotalBruteForceTime += BruteForceTime;
+        TotalBuildTime += BuildTime;
+
+        // Print test results
+        if( !pkInvalidReason )
+        {
+            debugf( "[SUCCESS] %s: loaded tree %.4fs, rebuilt tree %.4fs, brute force %.4fs; rebuild took %.4fs",
+                    *It->CookedAssetPath(true), TreeTime, RebuiltTreeTime, BruteForceTime, BuildTime );
+            NumValid++;
+        }
+        else
+        {
+            debugf( "[FAILED: %s%s] %s", pkInvalidReason, FailedOnRebuiltTree ? " on rebuilt tree" : "", *It->CookedAssetPath(true) );
+            NumInvalid++;
+        }
+    }
+
+    bool TestSuccess = (NumInvalid == 0);
+    debugf( "Test %s; checked %d collision assets, %d passed, %d failed. Loaded tree queries took %fs, brute force %fs; rebuilding trees took %fs",
+            TestSuccess ? "SUCCEEDED" : "FAILED", NumValid + NumInvalid, NumValid, NumInvalid, TotalTreeTime, TotalBruteForceTime, TotalBuildTime );
+
+    return TestSuccess;
+}
+
+/** Validate GL call counting against the null backend; does not require a GL context */
+bool ValidateGLStats()
+{
+    debugf("Validating GL stats...");
+
+    bool WasNullBackend = CGLBackend::IsNullBackend();
+    CGLBackend::SetNullBackend(true);
+    const char* pkInvalidReason = nullptr;
+
+    SGLStats StartStats = CGLBackend::Stats();
+
+    {
+        // Index buffers upload once, on first use, then draw without further uploads
+        uint16 Indices[6] = { 0, 1, 2, 2, 1, 3 };
+        CIndexBuffer IBO(GL_TRIANGLES);
+        IBO.AddIndices(Indices, 6);
+        IBO.DrawElements();
+        IBO.DrawElements(3, 3);
+
+        // Uniform buffer allocations don't upload anything until data is buffered
+        uint8 UniformData[64] = { 0 };
+        CUniformBuffer UBO(sizeof(UniformData));
+        UBO.Buffer(UniformData);
+        UBO.BufferRange(UniformData, 16, 32);
+
+        CGLBackend::UseProgram(1);
+        CGLBackend::BindTexture(GL_TEXTURE_2D, 1);
+        CGLBackend::BindTexture(GL_TEXTURE_2D, 2);
+        CGLBackend::BindVertexArray(1);
+    }
+
+    SGLStats Stats = CGLBackend::Stats() - StartStats;
+
+    if( Stats.DrawCalls != 2 )
+        pkInvalidReason = "wrong draw call count";
+    else if( Stats.BufferUploads != 3 || Stats.BytesUploaded != 12 + 64 + 32 )
+        pkInvalidReason = "wrong upload count";
+    else if( Stats.ShaderBinds != 1 || Stats.TextureBinds != 2 || Stats.VertexArrayBinds != 1 )
+        pkInvalidReason = "wrong bind count";
+
+    CGLBackend::SetNullBackend(WasNullBackend);
+
+    bool TestSuccess = (pkInvalidReason == nullptr);
+
+    if( TestSuccess )
+        debugf( "Test SUCCEEDED" );
+    else
+        debugf( "Test FAILED: %s", pkInvalidReason );
+
+    return TestSuccess;
+}
+
+/** Validate script object models are grouped into instanced batches correctly; does not require a GL context */
+bool ValidateInstanceBatching()
+{
+    debugf("Validating instance batching...");
+
+    CModel ModelA, ModelB;
+    CInstanceBatcher Batcher;
+    const uint kMaxBatchSize = CGraphics::skMaxInstances;
+    const uint kNumInstancesA = (kMaxBatchSize * 2) + 10;
+
+    // Interleave submissions so grouping can't rely on submission order. The instance
+    // index is stored in the tint color to check that batches keep submission order.
+    for (uint InstIdx = 0; InstIdx < kNumInstancesA; InstIdx++)
+    {
+        SInstance Instance { nullptr, CTransform4f::skIdentity, CColor((float) InstIdx, 0.f, 0.f, 1.f), CAABox::skOne };
+        Batcher.Add( SInstanceKey { &ModelA, 0, 1 }, Instance );
+
+        if( InstIdx == 5 || InstIdx == 100 )
+            Batcher.Add( SInstanceKey { &ModelB, 0, 1 }, Instance );
+    }
+
+    // Same model with a different state hash can't share a draw, and a lone instance isn't worth batching
+    Batcher.Add( SInstanceKey { &ModelA, 0, 2 }, SInstance { nullptr, CTransform4f::skIdentity, CColor(-1.f, 0.f, 0.f, 1.f), CAABox::skOne } );
+    Batcher.Build(kMaxBatchSize);
+
+    const char* pkInvalidReason = nullptr;
+    uint NumBatchedA = 0, NumBatchedB = 0;
+
+    if( Batcher.NumBatches() != 4 )
+        pkInvalidReason = "wrong batch count";
+    else if( Batcher.NumUnbatched() != 1 || Batcher.UnbatchedInstance(0).TintColor.R >= 0.f )
+        pkInvalidReason = "wrong unbatched instances";
+
+    for (uint BatchIdx = 0; BatchIdx < Batcher.NumBatches() && !pkInvalidReason; BatchIdx++)
+    {
+        const SInstanceBatch& kBatch = Batcher.Batch(BatchIdx);
+
+        if( kBatch.NumInstances < 2 || kBatch.NumInstances > kMaxBatchSize )
+            pkInvalidReason = "batch size out of range";
+        else if( kBatch.Key.StateHash != 1 )
+            pkInvalidReason = "instances with different state were batched";
+
+        for (uint InstIdx = 1; InstIdx < kBatch.NumInstances && !pkInvalidReason; InstIdx++)
+        {
+            if( Batcher.BatchInstance(kBatch, InstIdx).TintColor.R <= Batcher.BatchInstance(kBatch, InstIdx - 1).TintColor.R )
+                pkInvalidReason = "batch doesn't preserve submission order";
+        }
+
+        if( kBatch.Key.pModel == &ModelA ) NumBatchedA += kBatch.NumInstances;
+        else                               NumBatchedB += kBatch.NumInstances;
+    }
+
+    if( !pkInvalidReason && (NumBatchedA != kNumInstancesA || NumBatchedB != 2) )
+        pkInvalidReason = "wrong number of batched instances";
+
+    bool TestSuccess = (pkInvalidReason == nullptr);
+
+    if( TestSuccess )
+        debugf( "Test SUCCEEDED" );
+    else
+        debugf( "Test FAILED: %s", pkInvalidReason );
+
+    return TestSuccess;
+}
+
+/** Validate transparent renderables are sorted back to front, including ones whose bounds surround the camera; does not require a GL context */
+bool ValidateDepthSort()
+{
+    debugf("Validating depth sort...");
+
+    CCamera Camera;
+    Camera.Snap(CVector3f::skZero);
+
+    // Two transparent volumes around the camera, like a fog volume with a body of water inside it. Both are
+    // behind the near plane, but the inner one is farther along the view direction, so it must be drawn first
+    // even though it's submitted last.
+    SRenderablePtr Outer = { nullptr, 0, CAABox(CVector3f(-10.f), CVector3f(10.f)), ERenderCommand::DrawMesh, 0 };
+    SRenderablePtr Inner = { nullptr, 1, CAABox(CVector3f(-2.f), CVector3f(2.f)), ERenderCommand::DrawMesh, 0 };
+
+    CRenderBucket Bucket(EDepthGroup::Midground);
+    Bucket.Add(Outer, true);
+    Bucket.Add(Inner, true);
+
+    std::vector<SRenderablePtr> Sorted;
+    Bucket.SortedRenderables(&Camera, true, Sorted);
+    const char* pkInvalidReason = nullptr;
+
+    if( Sorted.size() != 2 )
+        pkInvalidReason = "wrong renderable count";
+    else if( Sorted[0].ComponentIndex != Inner.ComponentIndex || Sorted[1].ComponentIndex != Outer.ComponentIndex )
+        pkInvalidReason = "volumes around the camera drawn in the wrong order";
+
+    bool TestSuccess = (pkInvalidReason == nullptr);
+
+    if( TestSuccess )
+        debugf( "Test SUCCEEDED" );
+    else
+        debugf( "Test FAILED: %s", pkInvalidReason );
+
+    return TestSuccess;
+}
+
+/** Time scene population for every area in the project, and check node IDs and light lookups */
+bool BenchmarkScenePopulation()
+{
+    debugf("Benchmarking scene population...");
+
+    // There must be a project loaded
+    CResourceStore* pStore = gpResourceStore;
+    CGameProject* pProject = (pStore ? pStore->Project() : nullptr);
+
+    if (!pProject)
+    {
+        errorf("Scene population benchmark failed; no project loaded");
+        return false;
+    }
+
+    uint NumValid = 0, NumInvalid = 0;
+    uint MaxNodes = 0;
+    double MaxTime = 0.0, TotalTime = 0.0;
+    CScene Scene;
+
+    for (TResourceIterator<EResourceType::Area> It(pStore); It; ++It)
+    {
+        CGameArea* pArea = (CGameArea*) It->Load();
+        if (!pArea) continue;
+
+        // Area loading isn't included in the time; only node creation. World geometry, collision and lights
+        // are parsed on first use, so load them up front rather than timing them as part of populating the scene.
+        pArea->LoadDeferredSections();
+        double StartTime = CTimer::GlobalTime();
+        Scene.SetActiveArea(nullptr, pArea);
+        double PopulateTime = CTimer::GlobalTime() - StartTime;
+        TotalTime += PopulateTime;
+
+        const char* pkInvalidReason = nullptr;
+        uint NumNodes = 0;
+        std::set<uint32> UsedIDs;
+
+        for (CSceneIterator NodeIt(&Scene, ENodeType::All, true); NodeIt && !pkInvalidReason; ++NodeIt)
+        {
+            NumNodes++;
+
+            if( !UsedIDs.insert(NodeIt->ID()).second )
+                pkInvalidReason = "duplicate node ID";
+            else if( Scene.NodeByID(NodeIt->ID()) != *NodeIt )
+                pkInvalidReason = "node ID lookup mismatch";
+            else if( NodeIt->NodeType() == ENodeType::Light &&
+                     Scene.NodeForLight(static_cast<CLightNode*>(*NodeIt)->Light()) != *NodeIt )
+                pkInvalidReason = "light lookup mismatch";
+        }
+
+        if( PopulateTime > MaxTime )
+        {
+            MaxTime = PopulateTime;
+            MaxNodes = NumNodes;
+        }
+
+        // Print test results
+        if( !pkInvalidReason )
+        {
+            debugf( "[SUCCESS] %s: %d nodes in %.3fs", *It->CookedAssetPath(true), NumNodes, PopulateTime );
+            NumValid++;
+        }
+        else
+        {
+            debugf( "[FAILED: %s] %s", pkInvalidReason, *It->CookedAssetPath(true) );
+            NumInvalid++;
+        }
+    }
+
+    Scene.ClearScene();
+
+    bool TestSuccess = (NumInvalid == 0);
+    debugf( "Test %s; checked %d areas, %d passed, %d failed. Total population time %fs; slowest area took %fs for %d nodes",
+            TestSuccess ? "SUCCEEDED" : "FAILED", NumValid + NumInvalid, NumValid, NumInvalid, TotalTime, MaxTime, MaxNodes );
+
+    return TestSuccess;
+}
+
+/** Time building dependencies for every area with world data parsed on demand and with it parsed up front, and report peak memory use after each */
+bool BenchmarkAreaDependencies()
+{
+    debugf("Benchmarking area dependency building...");
+
+    // There must be a project loaded
+    CResourceStore* pStore = gpResourceStore;
+    CGameProject* pProject = (pStore ? pStore->Project() : nullptr);
+
+    if (!pProject)
+    {
+        errorf("Area dependency benchmark failed; no project loaded");
+        return false;
+    }
+
+    // Every area is loaded and kept loaded for the whole pass, like an export would. Peak memory only ever
+    // goes up, so the on demand pass runs first; the up front pass then shows how much higher the peak gets.
+    std::map< CAssetID, std::set<CAssetID> > DeferredDependencies;
+    uint NumValid = 0, NumInvalid = 0;
+    double PassTimes[2] = { 0.0, 0.0 };
+    uint64 PassPeakMemory[2] = { 0, 0 };
+
+    for (uint Pass = 0; Pass < 2; Pass++)
+    {
+        bool LoadUpFront = (Pass == 1);
+
+        for (TResourceIterator<EResourceType::Area> It(pStore); It; ++It)
+        {
+            if (It->IsLoaded() && !It->Resource()->IsReferenced())
+                It->Unload();
+        }
+
+        for (TResourceIterator<EResourceType::Area> It(pStore); It; ++It)
+        {
+            double StartTime = CTimer::GlobalTime();
+            CGameArea* pArea = (CGameArea*) It->Load();
+            if (!pArea) continue;
+
+            if (LoadUpFront)
+                pArea->LoadDeferredSections();
+
+            std::unique_ptr<CDependencyTree> pTree( pArea->BuildDependencyTree() );
+            PassTimes[Pass] += CTimer::GlobalTime() - StartTime;
+
+            std::set<CAssetID> Dependencies;
+            pTree->GetAllResourceReferences(Dependencies);
+
+            if (!LoadUpFront)
+            {
+                DeferredDependencies[It->ID()] = Dependencies;
+            }
+            else if (Dependencies == DeferredDependencies[It->ID()])
+            {
+                NumValid++;
+            }
+            else
+            {
+                debugf( "[FAILED: %d dependencies with world data parsed on demand, %d parsed up front] %s",
+                        (uint32) DeferredDependencies[It->ID()].size(), (uint32) Dependencies.size(), *It->CookedAssetPath(true) );
+                NumInvalid++;
+            }
+        }
+
+        PassPeakMemory[Pass] = PeakMemoryUsage();
+    }
+
+    bool TestSuccess = (NumInvalid == 0);
+    debugf( "Test %s; checked %d areas, %d passed, %d failed. Parsed on demand: %fs, peak memory %d MB. Parsed up front: %fs, peak memory %d MB",
+            TestSuccess ? "SUCCEEDED" : "FAILED", NumValid + NumInvalid, NumValid, NumInvalid,
+            PassTimes[0], (uint) (PassPeakMemory[0] / (1024 * 1024)), PassTimes[1], (uint) (PassPeakMemory[1] / (1024 * 1024)) );
+
+    return TestSuccess;
+}
+
+/** Validate the reverse dependency index saved with the resource database matches one rebuilt from every dependency tree */
+bool ValidateReverseDependencyIndex()
+{
+    debugf("Validating reverse dependency index...");
+
+    // There must be a project loaded
+    CResourceStore* pStore = gpResourceStore;
+    CGameProject* pProject = (pStore ? pStore->Project() : nullptr);
+
+    if (!pProject)
+    {
+        errorf("Reverse dependency index unit test failed; no project loaded");
+        return false;
+    }
+
+    // Query the index as loaded from the database first
+    std::map<CAssetID, std::set<CAssetID>> SavedIndex;
+
+    double StartTime = CTimer::GlobalTime();
+
+    for (CResourceIterator It(pStore); It; ++It)
+        pStore->GetReferencingAssets(It->ID(), SavedIndex[It->ID()]);
+
+    double SavedTime = CTimer::GlobalTime() - StartTime;
+
+    // Then rebuild it from scratch and compare
+    StartTime = CTimer::GlobalTime();
+    pStore->BuildReverseDependencyIndex();
+    double RebuildTime = CTimer::GlobalTime() - StartTime;
+
+    uint NumValid = 0, NumInvalid = 0;
+
+    for (CResourceIterator It(pStore); It; ++It)
+    {
+        std::set<CAssetID> Referencers;
+        pStore->GetReferencingAssets(It->ID(), Referencers);
+
+        if (Referencers == SavedIndex[It->ID()])
+        {
+            NumValid++;
+        }
+        else
+        {
+            debugf( "[FAILED: %d referencers saved, %d rebuilt] %s", (uint32) SavedIndex[It->ID()].size(), (uint32) Referencers.size(), *It->CookedAssetPath(true) );
+            NumInvalid++;
+        }
+    }
+
+    bool TestSuccess = (NumInvalid == 0);
+    debugf( "Test %s; checked %d assets, %d passed, %d failed. Saved index queried in %fs; rebuilding took %fs",
+            TestSuccess ? "SUCCEEDED" : "FAILED", NumValid + NumInvalid, NumValid, NumInvalid, SavedTime, RebuildTime );
+
+    return TestSuccess;
+}
+
+/** Time loading the resource database from the flat layout and from the legacy archive format, and check both load the same entries */
+bool BenchmarkDatabaseLoad()
+{
+    debugf("Benchmarking resource database loading...");
+
+    // There must be a project loaded
+    CResourceStore* pStore = gpResourceStore;
+    CGameProject* pProject = (pStore ? pStore->Project() : nullptr);
+
+    if (!pProject)
+    {
+        errorf("Resource database benchmark failed; no project loaded");
+        return false;
+    }
+
+    // Make sure the database on disk is current and in the flat layout, then write the same entries out in the
+    // legacy format the way older versions saved it. Empty directories are left out of both loads' results.
+    pStore->ConditionalSaveStore();
+    TString LegacyPath = pProject->HiddenFilesDir() + "LegacyDatabaseBenchmark.bin";
+    {
+        CBasicBinaryWriter Writer(LegacyPath, FOURCC('CACH'), 0, pProject->Game());
+
+        if (!Writer.IsValid())
+        {
+            errorf("Resource database benchmark failed; couldn't write %s", *LegacyPath);
+            return false;
+        }
+
+        if (Writer.ParamBegin("Resources", 0))
+        {
+            uint32 ResourceCount = 0;
+
+            for (CResourceIterator It(pStore); It; ++It)
+                ResourceCount++;
+
+            Writer << SerialParameter("ResourceCount", ResourceCount);
+
+            for (CResourceIterator It(pStore); It; ++It)
+            {
+                if (Writer.ParamBegin("Resource", 0))
+                {
+                    It->SerializeEntryInfo(Writer, false);
+                    Writer.ParamEnd();
+                }
+            }
+            Writer.ParamEnd();
+        }
+
+        TStringList EmptyDirectories;
+        Writer << SerialParameter("EmptyDirectories", EmptyDirectories);
+    }
+
+    // Load each format into its own store. Entries are created for every record either way; the flat layout saves
+    // parsing the archive and decoding every dependency tree, so decoding them all afterwards is timed separately.
+    std::set<CAssetID> LegacyIDs, FlatIDs;
+    double LegacyTime = 0.0, FlatTime = 0.0, DecodeTime = 0.0;
+    bool LoadSuccess = true;
+    {
+        CResourceStore LegacyStore(pProject);
+        double StartTime = CTimer::GlobalTime();
+        CBasicBinaryReader Reader(LegacyPath, FOURCC('CACH'));
+        LoadSuccess &= (Reader.IsValid() && LegacyStore.LoadLegacyDatabaseCache(Reader));
+        LegacyTime = CTimer::GlobalTime() - StartTime;
+
+        for (CResourceIterator It(&LegacyStore); It; ++It)
+            LegacyIDs.insert(It->ID());
+    }
+    {
+        CResourceStore FlatStore(pProject);
+        double StartTime = CTimer::GlobalTime();
+        LoadSuccess &= FlatStore.LoadFlatDatabaseCache(pStore->DatabasePath());
+        FlatTime = CTimer::GlobalTime() - StartTime;
+
+        StartTime = CTimer::GlobalTime();
+
+        for (CResourceIterator It(&FlatStore); It; ++It)
+        {
+            It->Dependencies();
+            FlatIDs.insert(It->ID());
+        }
+
+        DecodeTime = CTimer::GlobalTime() - StartTime;
+    }
+    FileUtil::DeleteFile(LegacyPath);
+
+    uint NumExpected = 0, NumValid = 0, NumInvalid = 0;
+
+    for (CResourceIterator It(pStore); It; ++It)
+    {
+        NumExpected++;
+
+        if (LegacyIDs.find(It->ID()) != LegacyIDs.end() && FlatIDs.find(It->ID()) != FlatIDs.end())
+        {
+            NumValid++;
+        }
+        else
+        {
+            debugf( "[FAILED: missing from the %s database] %s", FlatIDs.find(It->ID()) == FlatIDs.end() ? "flat" : "legacy", *It->CookedAssetPath(true) );
+            NumInvalid++;
+        }
+    }
+
+    bool TestSuccess = (LoadSuccess && NumInvalid == 0 && LegacyIDs.size() == NumExpected && FlatIDs.size() == NumExpected);
+
+    if (!LoadSuccess)
+        debugf("[FAILED: database failed to load]");
+
+    debugf( "Test %s; checked %d entries, %d passed, %d failed. Legacy load: %fs. Flat load: %fs, decoding every dependency tree afterwards: %fs",
+            TestSuccess ? "SUCCEEDED" : "FAILED", NumValid + NumInvalid, NumValid, NumInvalid, LegacyTime, FlatTime, DecodeTime );
+
+    return TestSuccess;
+}
+
+/** Time generating editor data in asset ID order and in dependency order, report peak memory use after each, and check both write identical files */
+bool BenchmarkEditorDataExport()
+{
+    debugf("Benchmarking editor data export...");
+
+    // There must be a project loaded
+    CResourceStore* pStore = gpResourceStore;
+    CGameProject* pProject = (pStore ? pStore->Project() : nullptr);
+
+    if (!pProject)
+    {
+        errorf("Editor data export benchmark failed; no project loaded");
+        return false;
+    }
+
+    // Each pass regenerates the project's raw assets from its cooked assets, so this should only be run on a freshly
+    // exported project. Peak memory only ever goes up, so the asset ID order pass runs first; the dependency order
+    // pass then shows how much higher the peak gets.
+    std::map< CAssetID, std::pair<uint64, uint64> > PassHashes[2]; // raw asset, metadata
+    uint64 DatabaseHashes[2] = { 0, 0 };
+    double PassTimes[2] = { 0.0, 0.0 };
+    uint64 PassPeakMemory[2] = { 0, 0 };
+    bool ExportSuccess = true;
+
+    for (uint Pass = 0; Pass < 2; Pass++)
+    {
+        CGameExporter Exporter(EDiscType::Normal, pProject->Game(), false, pProject->Region(), pProject->Name(), pProject->GameID(), pProject->BuildVersion());
+        Exporter.SetDependencyOrderedRawExport(Pass == 1);
+
+        double StartTime = CTimer::GlobalTime();
+        ExportSuccess &= Exporter.RegenerateEditorData(pProject, gpNullProgress);
+        PassTimes[Pass] = CTimer::GlobalTime() - StartTime;
+        PassPeakMemory[Pass] = PeakMemoryUsage();
+
+        for (CResourceIterator It(pStore); It; ++It)
+            PassHashes[Pass][It->ID()] = std::make_pair( HashFileContents(It->RawAssetPath()), HashFileContents(It->MetadataFilePath()) );
+
+        DatabaseHashes[Pass] = HashFileContents(pStore->DatabasePath());
+    }
+
+    uint NumValid = 0, NumInvalid = 0;
+
+    for (CResourceIterator It(pStore); It; ++It)
+    {
+        const std::pair<uint64, uint64>& rkSerial = PassHashes[0][It->ID()];
+        const std::pair<uint64, uint64>& rkOrdered = PassHashes[1][It->ID()];
+
+        if (rkSerial == rkOrdered)
+        {
+            NumValid++;
+        }
+        else
+        {
+            debugf( "[FAILED: %s differs] %s", rkSerial.first != rkOrdered.first ? "raw asset" : "metadata", *It->CookedAssetPath(true) );
+            NumInvalid++;
+        }
+    }
+
+    if (!ExportSuccess)
+        debugf("[FAILED: editor data export didn't finish]");
+
+    if (DatabaseHashes[0] != DatabaseHashes[1])
+        debugf("[FAILED: resource database differs]");
+
+    bool TestSuccess = (ExportSuccess && NumInvalid == 0 && DatabaseHashes[0] == DatabaseHashes[1]);
+    debugf( "Test %s; checked %d assets, %d passed, %d failed. Asset ID order: %fs, peak memory %d MB. Dependency order: %fs, peak memory %d MB",
+            TestSuccess ? "SUCCEEDED" : "FAILED", NumValid + NumInvalid, NumValid, NumInvalid,
+            PassTimes[0], (uint) (PassPeakMemory[0] / (1024 * 1024)), PassTimes[1], (uint) (PassPeakMemory[1] / (1024 * 1024)) );
+
+    return TestSuccess;
+}
+
+/** Time scene ray casts and frustum culling through the scene BVH against a linear scan over every node, and check both find the same results */
+bool BenchmarkSceneQueries()
+{
+    debugf("Benchmarking scene queries...");
+
+    // There must be a project loaded
+    CResourceStore* pStore = gpResourceStore;
+    CGameProject* pProject = (pStore ? pStore->Project() : nullptr);
+
+    if (!pProject)
+    {
+        errorf("Scene query benchmark failed; no project loaded");
+        return false;
+    }
+
+    // Cameras are placed on a grid through each area, each facing several directions; rays are cast through a grid of screen points
+    const uint kGridSize = 3;
+    const uint kNumYaws = 4;
+    const uint kRayGridSize = 8;
+
+    uint NumValid = 0, NumInvalid = 0;
+    double TotalBVHRayTime = 0.0, TotalLinearRayTime = 0.0;
+    double TotalBVHCullTime = 0.0, TotalLinearCullTime = 0.0;
+    CScene Scene;
+
+    for (TResourceIterator<EResourceType::Area> It(pStore); It; ++It)
+    {
+        CGameArea* pArea = (CGameArea*) It->Load();
+        if (!pArea) continue;
+
+        Scene.SetActiveArea(nullptr, pArea);
+
+        CCamera Camera;
+        SViewInfo ViewInfo;
+        ViewInfo.pScene = &Scene;
+        ViewInfo.pRenderer = nullptr;
+        ViewInfo.pCamera = &Camera;
+        ViewInfo.GameMode = false;
+        ViewInfo.ShowFlags = EShowFlag::All;
+
+        FNodeFlags NodeFlags = CScene::NodeFlagsForShowFlags(ViewInfo.ShowFlags);
+        CAABox AreaBounds = pArea->AABox();
+        CVector3f Step = AreaBounds.Size() / (float) (kGridSize + 1);
+
+        const char* pkInvalidReason = nullptr;
+        uint NumRays = 0, NumFrustums = 0;
+        double BVHRayTime = 0.0, LinearRayTime = 0.0;
+        double BVHCullTime = 0.0, LinearCullTime = 0.0;
+        bool CheckedHiddenNode = false;
+
+        for (uint CamIdx = 0; CamIdx < kGridSize * kGridSize * kGridSize * kNumYaws && !pkInvalidReason; CamIdx++)
+        {
+            uint X = CamIdx % kGridSize;
+            uint Y = (CamIdx / kGridSize) % kGridSize;
+            uint Z = (CamIdx / (kGridSize * kGridSize)) % kGridSize;
+            uint YawIdx = CamIdx / (kGridSize * kGridSize * kGridSize);
+
+            Camera.Snap( AreaBounds.Min() + CVector3f(Step.X * (X + 1), Step.Y * (Y + 1), Step.Z * (Z + 1)) );
+            Camera.SetYaw( Math::skHalfPi * 4.f * YawIdx / kNumYaws );
+            Camera.SetPitch( -0.25f );
+            ViewInfo.ViewFrustum = Camera.FrustumPlanes();
+
+            // Frustum culling. The BVH uses enlarged bounds, so compare the nodes whose actual bounds touch the frustum.
+            auto NodeInFrustum = [&](CSceneNode* pNode)
+            {
+                CAABox Bounds;
+                return !pNode->SceneBounds(Bounds) || !CSceneBVH::IsBoundable(Bounds) || ViewInfo.ViewFrustum.BoxInFrustum(Bounds);
+            };
+
+            std::set<CSceneNode*> BVHNodes, LinearNodes;
+            double StartTime = CTimer::GlobalTime();
+
+            Scene.ForEachNodeInFrustum(ViewInfo.ViewFrustum, NodeFlags, false, [&](CSceneNode* pNode)
+            {
+                if (NodeInFrustum(pNode))
+                    BVHNodes.insert(pNode);
+            });
+
+            BVHCullTime += CTimer::GlobalTime() - StartTime;
+            StartTime = CTimer::GlobalTime();
+
+            for (CSceneIterator NodeIt(&Scene, NodeFlags, false); NodeIt; ++NodeIt)
+            {
+                if (NodeInFrustum(*NodeIt))
+                    LinearNodes.insert(*NodeIt);
+            }
+
+            LinearCullTime += CTimer::GlobalTime() - StartTime;
+            NumFrustums++;
+
+            if (BVHNodes != LinearNodes)
+            {
+                pkInvalidReason = "visible node mismatch";
+                break;
+            }
+
+            // Game mode draws hidden nodes too, so a hidden node must still be visited when they're included
+            if (!CheckedHiddenNode && !BVHNodes.empty())
+            {
+                CSceneNode* pHiddenNode = *BVHNodes.begin();
+                bool WasVisible = pHiddenNode->IsVisible();
+                bool VisitedWhenIncluded = false, VisitedWhenExcluded = false;
+                pHiddenNode->SetVisible(false);
+
+                Scene.ForEachNodeInFrustum(ViewInfo.ViewFrustum, NodeFlags, true, [&](CSceneNode* pNode) {
+                    if (pNode == pHiddenNode) VisitedWhenIncluded = true;
+                });
+                Scene.ForEachNodeInFrustum(ViewInfo.ViewFrustum, NodeFlags, false, [&](CSceneNode* pNode) {
+                    if (pNode == pHiddenNode) VisitedWhenExcluded = true;
+                });
+
+                pHiddenNode->SetVisible(WasVisible);
+                CheckedHiddenNode = true;
+
+                if (!VisitedWhenIncluded || VisitedWhenExcluded)
+                {
+                    pkInvalidReason = "hidden node handled wrong in game mode";
+                    break;
+                }
+            }
+
+            // Ray casts
+            for (uint RayIdx = 0; RayIdx < kRayGridSize * kRayGridSize; RayIdx++)
+            {
+                CVector2f DeviceCoords( ((RayIdx % kRayGridSize) + 0.5f) / kRayGridSize * 2.f - 1.f,
+                                        ((RayIdx / kRayGridSize) + 0.5f) / kRayGridSize * 2.f - 1.f );
+                CRay Ray = Camera.CastRay(DeviceCoords);
+
+                StartTime = CTimer::GlobalTime();
+                SRayIntersection BVHResult = Scene.SceneRayCast(Ray, ViewInfo);
+                BVHRayTime += CTimer::GlobalTime() - StartTime;
+
+                StartTime = CTimer::GlobalTime();
+                CRayCollisionTester Tester(Ray);
+
+                for (CSceneIterator NodeIt(&Scene, NodeFlags, false); NodeIt; ++NodeIt)
+                    NodeIt->RayAABoxIntersectTest(Tester, ViewInfo);
+
+                SRayIntersection LinearResult = Tester.TestNodes(ViewInfo);
+                LinearRayTime += CTimer::GlobalTime() - StartTime;
+                NumRays++;
+
+                // Nodes at exactly the same distance may be reported in either order, so only the distance has to match
+                if (BVHResult.Hit != LinearResult.Hit)
+                    pkInvalidReason = "ray hit mismatch";
+                else if (BVHResult.Hit && Math::Abs(BVHResult.Distance - LinearResult.Distance) > 0.001f)
+                    pkInvalidReason = "ray hit distance mismatch";
+
+                if (pkInvalidReason)
+                    break;
+            }
+        }
+
+        TotalBVHRayTime += BVHRayTime;
+        TotalLinearRayTime += LinearRayTime;
+        TotalBVHCullTime += BVHCullTime;
+        TotalLinearCullTime += LinearCullTime;
+
+        // Print test results
+        if( !pkInvalidReason )
+        {
+            debugf( "[SUCCESS] %s: %d rays, BVH %.4fs / linear %.4fs; %d frustums, BVH %.4fs / linear %.4fs",
+                    *It->CookedAssetPath(true), NumRays, BVHRayTime, LinearRayTime, NumFrustums, BVHCullTime, LinearCullTime );
+            NumValid++;
+        }
+        else
+        {
+            debugf( "[FAILED: %s] %s", pkInvalidReason, *It->CookedAssetPath(true) );
+            NumInvalid++;
+        }
+    }
+
+    Scene.ClearScene();
+
+    bool TestSuccess = (NumInvalid == 0);
+    debugf( "Test %s; checked %d areas, %d passed, %d failed. Ray casts: BVH %fs, linear %fs. Frustum culling: BVH %fs, linear %fs",
+            TestSuccess ? "SUCCEEDED" : "FAILED", NumValid + NumInvalid, NumValid, NumInvalid,
+            TotalBVHRayTime, TotalLinearRayTime, TotalBVHCullTime, TotalLinearCullTime );
+
+    return TestSuccess;
+}
+
 } // end namespace NCoreTests
@@ -13,6 +13,39 @@ bool RunTests(int argc, char *argv[]);
 /** Validate all cooker output for the given resource type matches the original asset data */
 bool ValidateCooker(EResourceType ResourceType, bool DumpInvalidFileContents);
 
+/** Validate area collision sections round-trip through the collision cooker, and that generated octrees are valid */
+bool ValidateAreaCollision();
+
+/** Compare OBB tree ray casts and box queries on every dynamic collision mesh against a brute force triangle scan, using both the loaded trees and rebuilt ones */
+bool ValidateOBBTrees();
+
+/** Validate the GL stats layer counts draws, binds and uploads correctly, using the null backend */
+bool ValidateGLStats();
+
+/** Validate script object models are grouped into instanced batches correctly; does not require a GL context */
+bool ValidateInstanceBatching();
+
+/** Validate transparent renderables are sorted back to front, including ones whose bounds surround the camera; does not require a GL context */
+bool ValidateDepthSort();
+
+/** Time scene population for every area in the project, and check node IDs and light lookups */
+bool BenchmarkScenePopulation();
+
+/** Time scene ray casts and frustum culling through the scene BVH against a linear scan over every node, and check both find the same results */
+bool BenchmarkSceneQueries();
+
+/** Time building dependencies for every area with world data parsed on demand and with it parsed up front, and report peak memory use after each */
+bool BenchmarkAreaDependencies();
+
+/** Validate the reverse dependency index saved with the resource database matches one rebuilt from every dependency tree */
+bool ValidateReverseDependencyIndex();
+
+/** Time loading the resource database from the flat layout and from the legacy archive format, and check both load the same entries */
+bool BenchmarkDatabaseLoad();
+
+/** Time generating editor data in asset ID order and in dependency order, report peak memory use after each, and check both write identical files; regenerates the project's raw assets */
+bool BenchmarkEditorDataExport();
+
 }
 
 #endif // NCORETESTS_H
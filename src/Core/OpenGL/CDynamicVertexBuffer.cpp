@@ -1,5 +1,7 @@
 #include "CDynamicVertexBuffer.h"
+#include "CGLBackend.h"
 #include "CVertexArrayManager.h"
+#include <Common/Macros.h>
 
 static const uint32 gskAttribSize[] = {
     0xC, 0xC, 0x4, 0x4, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8
@@ -32,7 +34,7 @@ void CDynamicVertexBuffer::Bind()
 
 void CDynamicVertexBuffer::Unbind()
 {
-    glBindVertexArray(0);
+    CGLBackend::BindVertexArray(0);
 }
 
 void CDynamicVertexBuffer::SetActiveAttribs(FVertexDescription AttribFlags)
@@ -44,6 +46,13 @@ void CDynamicVertexBuffer::SetActiveAttribs(FVertexDescription AttribFlags)
 
 void CDynamicVertexBuffer::BufferAttrib(EVertexAttribute Attrib, const void *pkData)
 {
+    BufferAttrib(Attrib, pkData, mNumVertices);
+}
+
+void CDynamicVertexBuffer::BufferAttrib(EVertexAttribute Attrib, const void *pkData, uint32 NumVerts)
+{
+    // Uploads the first NumVerts vertices; the rest of the buffer keeps its previous contents
+    ASSERT(NumVerts <= mNumVertices);
     uint32 Index;
 
     switch (Attrib)
@@ -63,8 +72,8 @@ void CDynamicVertexBuffer::BufferAttrib(EVertexAttribute Attrib, const void *pkD
     default:                            return;
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[Index]);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, gskAttribSize[Index] * mNumVertices, pkData);
+    CGLBackend::BindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[Index]);
+    CGLBackend::BufferSubData(GL_ARRAY_BUFFER, 0, gskAttribSize[Index] * NumVerts, pkData);
 }
 
 void CDynamicVertexBuffer::ClearBuffers()
@@ -74,7 +83,7 @@ void CDynamicVertexBuffer::ClearBuffers()
         int Bit = 1 << iAttrib;
 
         if (mBufferedFlags & Bit)
-            glDeleteBuffers(1, &mAttribBuffers[iAttrib]);
+            CGLBackend::DeleteBuffers(1, &mAttribBuffers[iAttrib]);
     }
 
     mBufferedFlags = EVertexAttribute::None;
@@ -83,8 +92,8 @@ void CDynamicVertexBuffer::ClearBuffers()
 GLuint CDynamicVertexBuffer::CreateVAO()
 {
     GLuint VertexArray;
-    glGenVertexArrays(1, &VertexArray);
-    glBindVertexArray(VertexArray);
+    CGLBackend::GenVertexArrays(1, &VertexArray);
+    CGLBackend::BindVertexArray(VertexArray);
 
     for (uint32 iAttrib = 0; iAttrib < 12; iAttrib++)
     {
@@ -92,7 +101,7 @@ GLuint CDynamicVertexBuffer::CreateVAO()
 
         if (HasAttrib)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
+            CGLBackend::BindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
             GLuint NumComponents;
             GLenum DataType;
 
@@ -112,7 +121,7 @@ GLuint CDynamicVertexBuffer::CreateVAO()
         }
     }
 
-    glBindVertexArray(0);
+    CGLBackend::BindVertexArray(0);
     return VertexArray;
 }
 
@@ -127,9 +136,9 @@ void CDynamicVertexBuffer::InitBuffers()
 
         if (HasAttrib)
         {
-            glGenBuffers(1, &mAttribBuffers[iAttrib]);
-            glBindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
-            glBufferData(GL_ARRAY_BUFFER, gskAttribSize[iAttrib] * mNumVertices, NULL, GL_DYNAMIC_DRAW);
+            CGLBackend::GenBuffers(1, &mAttribBuffers[iAttrib]);
+            CGLBackend::BindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
+            CGLBackend::BufferData(GL_ARRAY_BUFFER, gskAttribSize[iAttrib] * mNumVertices, NULL, GL_DYNAMIC_DRAW);
         }
     }
     mBufferedFlags = mAttribFlags;
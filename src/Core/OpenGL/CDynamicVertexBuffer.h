@@ -22,6 +22,8 @@ public:
     void Unbind();
     void SetActiveAttribs(FVertexDescription AttribFlags);
     void BufferAttrib(EVertexAttribute Attrib, const void *pkData);
+    void BufferAttrib(EVertexAttribute Attrib, const void *pkData, uint32 NumVerts);
+    uint32 VertexCount() const { return mNumVertices; }
     void ClearBuffers();
     GLuint CreateVAO();
 private:
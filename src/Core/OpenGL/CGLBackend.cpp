@@ -0,0 +1,155 @@
+#include "CGLBackend.h"
+
+SGLStats CGLBackend::sStats;
+bool CGLBackend::sNullBackend = false;
+GLuint CGLBackend::sNextNullHandle = 1;
+
+// ************ SGLStats ************
+SGLStats& SGLStats::operator+=(const SGLStats& rkOther)
+{
+    DrawCalls += rkOther.DrawCalls;
+    ShaderBinds += rkOther.ShaderBinds;
+    TextureBinds += rkOther.TextureBinds;
+    VertexArrayBinds += rkOther.VertexArrayBinds;
+    BufferUploads += rkOther.BufferUploads;
+    BytesUploaded += rkOther.BytesUploaded;
+    return *this;
+}
+
+SGLStats SGLStats::operator-(const SGLStats& rkOther) const
+{
+    SGLStats Out;
+    Out.DrawCalls = DrawCalls - rkOther.DrawCalls;
+    Out.ShaderBinds = ShaderBinds - rkOther.ShaderBinds;
+    Out.TextureBinds = TextureBinds - rkOther.TextureBinds;
+    Out.VertexArrayBinds = VertexArrayBinds - rkOther.VertexArrayBinds;
+    Out.BufferUploads = BufferUploads - rkOther.BufferUploads;
+    Out.BytesUploaded = BytesUploaded - rkOther.BytesUploaded;
+    return Out;
+}
+
+// ************ COUNTED CALLS ************
+void CGLBackend::DrawElements(GLenum Mode, GLsizei Count, GLenum Type, const void *pkIndices)
+{
+    sStats.DrawCalls++;
+    if (!sNullBackend) glDrawElements(Mode, Count, Type, pkIndices);
+}
+
+void CGLBackend::DrawArrays(GLenum Mode, GLint First, GLsizei Count)
+{
+    sStats.DrawCalls++;
+    if (!sNullBackend) glDrawArrays(Mode, First, Count);
+}
+
+void CGLBackend::DrawElementsInstanced(GLenum Mode, GLsizei Count, GLenum Type, const void *pkIndices, GLsizei NumInstances)
+{
+    sStats.DrawCalls++;
+    if (!sNullBackend) glDrawElementsInstanced(Mode, Count, Type, pkIndices, NumInstances);
+}
+
+void CGLBackend::UseProgram(GLuint Program)
+{
+    sStats.ShaderBinds++;
+    if (!sNullBackend) glUseProgram(Program);
+}
+
+void CGLBackend::BindTexture(GLenum Target, GLuint Texture)
+{
+    sStats.TextureBinds++;
+    if (!sNullBackend) glBindTexture(Target, Texture);
+}
+
+void CGLBackend::BindVertexArray(GLuint VertexArray)
+{
+    sStats.VertexArrayBinds++;
+    if (!sNullBackend) glBindVertexArray(VertexArray);
+}
+
+void CGLBackend::BufferData(GLenum Target, GLsizeiptr Size, const void *pkData, GLenum Usage)
+{
+    // Allocations without data don't transfer anything, so they aren't counted as uploads
+    if (pkData)
+    {
+        sStats.BufferUploads++;
+        sStats.BytesUploaded += Size;
+    }
+
+    if (!sNullBackend) glBufferData(Target, Size, pkData, Usage);
+}
+
+void CGLBackend::BufferSubData(GLenum Target, GLintptr Offset, GLsizeiptr Size, const void *pkData)
+{
+    sStats.BufferUploads++;
+    sStats.BytesUploaded += Size;
+    if (!sNullBackend) glBufferSubData(Target, Offset, Size, pkData);
+}
+
+void CGLBackend::TexImage2D(GLenum Target, GLint Level, GLint InternalFormat, GLsizei Width, GLsizei Height, GLenum Format, GLenum Type, uint32 DataSize, const void *pkData)
+{
+    if (pkData)
+    {
+        sStats.BufferUploads++;
+        sStats.BytesUploaded += DataSize;
+    }
+
+    if (!sNullBackend) glTexImage2D(Target, Level, InternalFormat, Width, Height, 0, Format, Type, pkData);
+}
+
+void CGLBackend::TexImage2DMultisample(GLenum Target, GLsizei Samples, GLenum InternalFormat, GLsizei Width, GLsizei Height)
+{
+    if (!sNullBackend) glTexImage2DMultisample(Target, Samples, InternalFormat, Width, Height, true);
+}
+
+void CGLBackend::CompressedTexImage2D(GLenum Target, GLint Level, GLenum InternalFormat, GLsizei Width, GLsizei Height, GLsizei DataSize, const void *pkData)
+{
+    if (pkData)
+    {
+        sStats.BufferUploads++;
+        sStats.BytesUploaded += DataSize;
+    }
+
+    if (!sNullBackend) glCompressedTexImage2D(Target, Level, InternalFormat, Width, Height, 0, DataSize, pkData);
+}
+
+// ************ OBJECT MANAGEMENT ************
+void CGLBackend::GenBuffers(GLsizei Count, GLuint *pBuffers)
+{
+    if (!sNullBackend)
+        glGenBuffers(Count, pBuffers);
+    else
+        for (GLsizei iBuf = 0; iBuf < Count; iBuf++) pBuffers[iBuf] = sNextNullHandle++;
+}
+
+void CGLBackend::DeleteBuffers(GLsizei Count, const GLuint *pkBuffers)
+{
+    if (!sNullBackend) glDeleteBuffers(Count, pkBuffers);
+}
+
+void CGLBackend::BindBuffer(GLenum Target, GLuint Buffer)
+{
+    if (!sNullBackend) glBindBuffer(Target, Buffer);
+}
+
+void CGLBackend::BindBufferBase(GLenum Target, GLuint Index, GLuint Buffer)
+{
+    if (!sNullBackend) glBindBufferBase(Target, Index, Buffer);
+}
+
+void CGLBackend::GenVertexArrays(GLsizei Count, GLuint *pArrays)
+{
+    if (!sNullBackend)
+        glGenVertexArrays(Count, pArrays);
+    else
+        for (GLsizei iArr = 0; iArr < Count; iArr++) pArrays[iArr] = sNextNullHandle++;
+}
+
+void CGLBackend::DeleteVertexArrays(GLsizei Count, const GLuint *pkArrays)
+{
+    if (!sNullBackend) glDeleteVertexArrays(Count, pkArrays);
+}
+
+// ************ STATS ************
+void CGLBackend::SetNullBackend(bool Enable)
+{
+    sNullBackend = Enable;
+}
@@ -0,0 +1,71 @@
+#ifndef CGLBACKEND_H
+#define CGLBACKEND_H
+
+#include <Common/BasicTypes.h>
+#include <GL/glew.h>
+
+// Counters for the GL work submitted by the renderer
+struct SGLStats
+{
+    uint32 DrawCalls;
+    uint32 ShaderBinds;
+    uint32 TextureBinds;
+    uint32 VertexArrayBinds;
+    uint32 BufferUploads;
+    uint64 BytesUploaded;
+
+    SGLStats() { Reset(); }
+
+    void Reset()
+    {
+        DrawCalls = 0;
+        ShaderBinds = 0;
+        TextureBinds = 0;
+        VertexArrayBinds = 0;
+        BufferUploads = 0;
+        BytesUploaded = 0;
+    }
+
+    SGLStats& operator+=(const SGLStats& rkOther);
+    SGLStats operator-(const SGLStats& rkOther) const;
+};
+
+// Thin layer over the GL calls that draw, change state or upload data. Every call is counted;
+// with the null backend enabled the calls are counted but not forwarded to GL, so rendering
+// code can run without a context (used by the tests). Gen calls return fake handles in that mode.
+class CGLBackend
+{
+    static SGLStats sStats;
+    static bool sNullBackend;
+    static GLuint sNextNullHandle;
+
+public:
+    // Counted calls
+    static void DrawElements(GLenum Mode, GLsizei Count, GLenum Type, const void *pkIndices);
+    static void DrawArrays(GLenum Mode, GLint First, GLsizei Count);
+    static void DrawElementsInstanced(GLenum Mode, GLsizei Count, GLenum Type, const void *pkIndices, GLsizei NumInstances);
+    static void UseProgram(GLuint Program);
+    static void BindTexture(GLenum Target, GLuint Texture);
+    static void BindVertexArray(GLuint VertexArray);
+    static void BufferData(GLenum Target, GLsizeiptr Size, const void *pkData, GLenum Usage);
+    static void BufferSubData(GLenum Target, GLintptr Offset, GLsizeiptr Size, const void *pkData);
+    static void TexImage2D(GLenum Target, GLint Level, GLint InternalFormat, GLsizei Width, GLsizei Height, GLenum Format, GLenum Type, uint32 DataSize, const void *pkData);
+    static void TexImage2DMultisample(GLenum Target, GLsizei Samples, GLenum InternalFormat, GLsizei Width, GLsizei Height);
+    static void CompressedTexImage2D(GLenum Target, GLint Level, GLenum InternalFormat, GLsizei Width, GLsizei Height, GLsizei DataSize, const void *pkData);
+
+    // Object management; not counted, but skipped by the null backend
+    static void GenBuffers(GLsizei Count, GLuint *pBuffers);
+    static void DeleteBuffers(GLsizei Count, const GLuint *pkBuffers);
+    static void BindBuffer(GLenum Target, GLuint Buffer);
+    static void BindBufferBase(GLenum Target, GLuint Index, GLuint Buffer);
+    static void GenVertexArrays(GLsizei Count, GLuint *pArrays);
+    static void DeleteVertexArrays(GLsizei Count, const GLuint *pkArrays);
+
+    // Stats
+    static void SetNullBackend(bool Enable);
+    static bool IsNullBackend()                 { return sNullBackend; }
+    static const SGLStats& Stats()              { return sStats; }
+    static void ResetStats()                    { sStats.Reset(); }
+};
+
+#endif // CGLBACKEND_H
@@ -1,4 +1,5 @@
 #include "CIndexBuffer.h"
+#include "CGLBackend.h"
 
 CIndexBuffer::CIndexBuffer()
     : mBuffered(false)
@@ -14,7 +15,7 @@ CIndexBuffer::CIndexBuffer(GLenum Type)
 CIndexBuffer::~CIndexBuffer()
 {
     if (mBuffered)
-        glDeleteBuffers(1, &mIndexBuffer);
+        CGLBackend::DeleteBuffers(1, &mIndexBuffer);
 }
 
 void CIndexBuffer::AddIndex(uint16 Index)
@@ -37,7 +38,7 @@ void CIndexBuffer::Reserve(uint Size)
 void CIndexBuffer::Clear()
 {
     if (mBuffered)
-        glDeleteBuffers(1, &mIndexBuffer);
+        CGLBackend::DeleteBuffers(1, &mIndexBuffer);
 
     mBuffered = false;
     mIndices.clear();
@@ -46,11 +47,11 @@ void CIndexBuffer::Clear()
 void CIndexBuffer::Buffer()
 {
     if (mBuffered)
-        glDeleteBuffers(1, &mIndexBuffer);
+        CGLBackend::DeleteBuffers(1, &mIndexBuffer);
 
-    glGenBuffers(1, &mIndexBuffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mIndices.size() * sizeof(uint16), mIndices.data(), GL_STATIC_DRAW);
+    CGLBackend::GenBuffers(1, &mIndexBuffer);
+    CGLBackend::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+    CGLBackend::BufferData(GL_ELEMENT_ARRAY_BUFFER, mIndices.size() * sizeof(uint16), mIndices.data(), GL_STATIC_DRAW);
 
     mBuffered = true;
 }
@@ -58,7 +59,7 @@ void CIndexBuffer::Buffer()
 void CIndexBuffer::Bind()
 {
     if (!mBuffered) Buffer();
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+    CGLBackend::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
 }
 
 void CIndexBuffer::Unbind()
@@ -68,14 +69,21 @@ void CIndexBuffer::Unbind()
 void CIndexBuffer::DrawElements()
 {
     Bind();
-    glDrawElements(mPrimitiveType, mIndices.size(), GL_UNSIGNED_SHORT, (void*) 0);
+    CGLBackend::DrawElements(mPrimitiveType, mIndices.size(), GL_UNSIGNED_SHORT, (void*) 0);
     Unbind();
 }
 
 void CIndexBuffer::DrawElements(uint Offset, uint Size)
 {
     Bind();
-    glDrawElements(mPrimitiveType, Size, GL_UNSIGNED_SHORT, (char*)0 + (Offset * 2));
+    CGLBackend::DrawElements(mPrimitiveType, Size, GL_UNSIGNED_SHORT, (char*)0 + (Offset * 2));
+    Unbind();
+}
+
+void CIndexBuffer::DrawElementsInstanced(uint NumInstances)
+{
+    Bind();
+    CGLBackend::DrawElementsInstanced(mPrimitiveType, mIndices.size(), GL_UNSIGNED_SHORT, (void*) 0, NumInstances);
     Unbind();
 }
 
@@ -25,6 +25,7 @@ public:
     void Unbind();
     void DrawElements();
     void DrawElements(uint Offset, uint Size);
+    void DrawElementsInstanced(uint NumInstances);
     bool IsBuffered();
 
     uint GetSize();
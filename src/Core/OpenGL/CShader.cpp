@@ -1,4 +1,5 @@
 #include "CShader.h"
+#include "CGLBackend.h"
 #include "Core/Render/CGraphics.h"
 #include <Common/BasicTypes.h>
 #include <Common/Log.h>
@@ -161,6 +162,7 @@ bool CShader::LinkShaders()
     mPixelBlockIndex = GetUniformBlockIndex("PixelBlock");
     mLightBlockIndex = GetUniformBlockIndex("LightBlock");
     mBoneTransformBlockIndex = GetUniformBlockIndex("BoneTransformBlock");
+    mInstanceBlockIndex = GetUniformBlockIndex("InstanceBlock");
 
     CacheCommonUniforms();
     mProgramExists = true;
@@ -202,7 +204,7 @@ void CShader::SetCurrent()
 {
     if (spCurrentShader != this)
     {
-        glUseProgram(mProgram);
+        CGLBackend::UseProgram(mProgram);
         spCurrentShader = this;
 
         glUniformBlockBinding(mProgram, mMVPBlockIndex, CGraphics::MVPBlockBindingPoint());
@@ -210,6 +212,7 @@ void CShader::SetCurrent()
         glUniformBlockBinding(mProgram, mPixelBlockIndex, CGraphics::PixelBlockBindingPoint());
         glUniformBlockBinding(mProgram, mLightBlockIndex, CGraphics::LightBlockBindingPoint());
         glUniformBlockBinding(mProgram, mBoneTransformBlockIndex, CGraphics::BoneTransformBlockBindingPoint());
+        glUniformBlockBinding(mProgram, mInstanceBlockIndex, CGraphics::InstanceBlockBindingPoint());
     }
 }
 
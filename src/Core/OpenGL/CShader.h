@@ -18,6 +18,7 @@ class CShader
     GLuint mPixelBlockIndex;
     GLuint mLightBlockIndex;
     GLuint mBoneTransformBlockIndex;
+    GLuint mInstanceBlockIndex;
 
     // Cached uniform locations
     GLint mTextureUniforms[8];
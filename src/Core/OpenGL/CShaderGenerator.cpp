@@ -1,4 +1,5 @@
 #include "CShaderGenerator.h"
+#include "Core/Render/CGraphics.h"
 #include <Common/Macros.h>
 #include <iostream>
 #include <fstream>
@@ -145,7 +146,7 @@ CShaderGenerator::~CShaderGenerator()
 {
 }
 
-bool CShaderGenerator::CreateVertexShader(const CMaterial& rkMat)
+bool CShaderGenerator::CreateVertexShader(const CMaterial& rkMat, bool Instanced)
 {
     std::stringstream ShaderCode;
 
@@ -185,6 +186,10 @@ bool CShaderGenerator::CreateVertexShader(const CMaterial& rkMat)
 
     ShaderCode  << "out vec4 COLOR0A0;\n"
                 << "out vec4 COLOR1A1;\n";
+
+    if (Instanced)
+        ShaderCode << "flat out vec4 InstanceTintColor;\n";
+
     ShaderCode  << "\n";
 
     // Uniforms
@@ -222,6 +227,16 @@ bool CShaderGenerator::CreateVertexShader(const CMaterial& rkMat)
                 << "uniform int NumLights;\n"
                 << "\n";
 
+    if (Instanced)
+    {
+        ShaderCode  << "layout(std140) uniform InstanceBlock\n"
+                    << "{\n"
+                    << "    mat4 InstanceModelMtx[" << CGraphics::skMaxInstances << "];\n"
+                    << "    vec4 InstanceTint[" << CGraphics::skMaxInstances << "];\n"
+                    << "};\n"
+                    << "\n";
+    }
+
     bool HasSkinning = (rkMat.VtxDesc().HasAnyFlags(EVertexAttribute::BoneIndices | EVertexAttribute::BoneWeights));
 
     if (HasSkinning)
@@ -236,9 +251,15 @@ bool CShaderGenerator::CreateVertexShader(const CMaterial& rkMat)
     // Main
     ShaderCode  << "// Main\n"
                 << "void main()\n"
-                << "{\n"
-                << "    mat4 MV = ModelMtx * ViewMtx;\n"
-                << "    mat4 MVP = MV * ProjMtx;\n";
+                << "{\n";
+
+    if (Instanced)
+        ShaderCode  << "    mat4 MV = InstanceModelMtx[gl_InstanceID] * ViewMtx;\n"
+                    << "    InstanceTintColor = InstanceTint[gl_InstanceID];\n";
+    else
+        ShaderCode  << "    mat4 MV = ModelMtx * ViewMtx;\n";
+
+    ShaderCode  << "    mat4 MVP = MV * ProjMtx;\n";
 
     if (VtxDesc & EVertexAttribute::Color0)   ShaderCode << "    Color0 = RawColor0;\n";
     if (VtxDesc & EVertexAttribute::Color1)   ShaderCode << "    Color1 = RawColor1;\n";
@@ -366,7 +387,7 @@ bool CShaderGenerator::CreateVertexShader(const CMaterial& rkMat)
     return mpShader->CompileVertexSource(ShaderCode.str().c_str());
 }
 
-bool CShaderGenerator::CreatePixelShader(const CMaterial& rkMat)
+bool CShaderGenerator::CreatePixelShader(const CMaterial& rkMat, bool Instanced)
 {
     std::stringstream ShaderCode;
     ShaderCode << "#version 330 core\n"
@@ -385,8 +406,12 @@ bool CShaderGenerator::CreatePixelShader(const CMaterial& rkMat)
             ShaderCode << "in vec3 Tex" << iPass << ";\n";
 
     ShaderCode << "in vec4 COLOR0A0;\n"
-               << "in vec4 COLOR1A1;\n"
-               << "\n"
+               << "in vec4 COLOR1A1;\n";
+
+    if (Instanced)
+        ShaderCode << "flat in vec4 InstanceTintColor;\n";
+
+    ShaderCode << "\n"
                << "out vec4 PixelColor;\n"
                << "\n"
                << "layout(std140) uniform PixelBlock {\n"
@@ -493,20 +518,20 @@ bool CShaderGenerator::CreatePixelShader(const CMaterial& rkMat)
         }
     }
 
-    ShaderCode << "    PixelColor = Prev.rgba * TintColor;\n"
+    ShaderCode << "    PixelColor = Prev.rgba * " << (Instanced ? "InstanceTintColor" : "TintColor") << ";\n"
                << "}\n\n";
 
     // Done!
     return mpShader->CompilePixelSource(ShaderCode.str().c_str());
 }
 
-CShader* CShaderGenerator::GenerateShader(const CMaterial& rkMat)
+CShader* CShaderGenerator::GenerateShader(const CMaterial& rkMat, bool Instanced /*= false*/)
 {
     CShaderGenerator Generator;
     Generator.mpShader = new CShader();
 
-    bool Success = Generator.CreateVertexShader(rkMat);
-    if (Success) Success = Generator.CreatePixelShader(rkMat);
+    bool Success = Generator.CreateVertexShader(rkMat, Instanced);
+    if (Success) Success = Generator.CreatePixelShader(rkMat, Instanced);
 
     Generator.mpShader->LinkShaders();
     return Generator.mpShader;
@@ -26,11 +26,12 @@ class CShaderGenerator
 
     CShaderGenerator();
     ~CShaderGenerator();
-    bool CreateVertexShader(const CMaterial& rkMat);
-    bool CreatePixelShader(const CMaterial& rkMat);
+    bool CreateVertexShader(const CMaterial& rkMat, bool Instanced);
+    bool CreatePixelShader(const CMaterial& rkMat, bool Instanced);
 
 public:
-    static CShader* GenerateShader(const CMaterial& rkMat);
+    // Instanced shaders read the model matrix and tint color from InstanceBlock instead of MVPBlock/PixelBlock
+    static CShader* GenerateShader(const CMaterial& rkMat, bool Instanced = false);
 };
 
 #endif // SHADERGEN_H
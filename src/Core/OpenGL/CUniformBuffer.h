@@ -1,6 +1,7 @@
 #ifndef CUNIFORMBUFFER_H
 #define CUNIFORMBUFFER_H
 
+#include "CGLBackend.h"
 #include <Common/BasicTypes.h>
 #include <GL/glew.h>
 
@@ -13,49 +14,49 @@ public:
 
     CUniformBuffer()
     {
-        glGenBuffers(1, &mUniformBuffer);
+        CGLBackend::GenBuffers(1, &mUniformBuffer);
         SetBufferSize(0);
     }
 
     CUniformBuffer(uint Size)
     {
-        glGenBuffers(1, &mUniformBuffer);
+        CGLBackend::GenBuffers(1, &mUniformBuffer);
         SetBufferSize(Size);
     }
 
     ~CUniformBuffer()
     {
-        glDeleteBuffers(1, &mUniformBuffer);
+        CGLBackend::DeleteBuffers(1, &mUniformBuffer);
     }
 
     void Bind()
     {
-        glBindBuffer(GL_UNIFORM_BUFFER, mUniformBuffer);
+        CGLBackend::BindBuffer(GL_UNIFORM_BUFFER, mUniformBuffer);
     }
 
     void Unbind()
     {
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        CGLBackend::BindBuffer(GL_UNIFORM_BUFFER, 0);
     }
 
     void BindBase(GLuint Index)
     {
         Bind();
-        glBindBufferBase(GL_UNIFORM_BUFFER, Index, mUniformBuffer);
+        CGLBackend::BindBufferBase(GL_UNIFORM_BUFFER, Index, mUniformBuffer);
         Unbind();
     }
 
     void Buffer(const void *pkData)
     {
         Bind();
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, mBufferSize, pkData);
+        CGLBackend::BufferSubData(GL_UNIFORM_BUFFER, 0, mBufferSize, pkData);
         Unbind();
     }
 
     void BufferRange(const void *pkData, uint Offset, uint Size)
     {
         Bind();
-        glBufferSubData(GL_UNIFORM_BUFFER, Offset, Size, pkData);
+        CGLBackend::BufferSubData(GL_UNIFORM_BUFFER, Offset, Size, pkData);
         Unbind();
     }
 
@@ -74,7 +75,7 @@ private:
     void InitializeBuffer()
     {
         Bind();
-        glBufferData(GL_UNIFORM_BUFFER, mBufferSize, 0, GL_DYNAMIC_DRAW);
+        CGLBackend::BufferData(GL_UNIFORM_BUFFER, mBufferSize, 0, GL_DYNAMIC_DRAW);
         Unbind();
     }
 };
@@ -1,4 +1,5 @@
 #include "CVertexArrayManager.h"
+#include "CGLBackend.h"
 
 // ************ STATIC MEMBER INITIALIZATION ************
 std::vector<CVertexArrayManager*> CVertexArrayManager::sVAManagers;
@@ -37,13 +38,13 @@ void CVertexArrayManager::BindVAO(CVertexBuffer *pVBO)
     auto it = mVBOMap.find(pVBO);
 
     if (it != mVBOMap.end())
-        glBindVertexArray(it->second);
+        CGLBackend::BindVertexArray(it->second);
 
     else
     {
         GLuint VAO = pVBO->CreateVAO();
         mVBOMap[pVBO] = VAO;
-        glBindVertexArray(VAO);
+        CGLBackend::BindVertexArray(VAO);
     }
 }
 
@@ -53,13 +54,13 @@ void CVertexArrayManager::BindVAO(CDynamicVertexBuffer *pVBO)
     auto it = mDynamicVBOMap.find(pVBO);
 
     if (it != mDynamicVBOMap.end())
-        glBindVertexArray(it->second);
+        CGLBackend::BindVertexArray(it->second);
 
     else
     {
         GLuint VAO = pVBO->CreateVAO();
         mDynamicVBOMap[pVBO] = VAO;
-        glBindVertexArray(VAO);
+        CGLBackend::BindVertexArray(VAO);
     }
 }
 
@@ -69,7 +70,7 @@ void CVertexArrayManager::DeleteVAO(CVertexBuffer *pVBO)
 
     if (it != mVBOMap.end())
     {
-        glDeleteVertexArrays(1, &it->second);
+        CGLBackend::DeleteVertexArrays(1, &it->second);
         mVBOMap.erase(it);
     }
 }
@@ -81,7 +82,7 @@ void CVertexArrayManager::DeleteVAO(CDynamicVertexBuffer *pVBO)
 
     if (it != mDynamicVBOMap.end())
     {
-        glDeleteVertexArrays(1, &it->second);
+        CGLBackend::DeleteVertexArrays(1, &it->second);
         mDynamicVBOMap.erase(it);
     }
 }
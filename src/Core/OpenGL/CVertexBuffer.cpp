@@ -1,4 +1,5 @@
 #include "CVertexBuffer.h"
+#include "CGLBackend.h"
 #include "CVertexArrayManager.h"
 
 CVertexBuffer::CVertexBuffer()
@@ -22,7 +23,7 @@ CVertexBuffer::~CVertexBuffer()
     CVertexArrayManager::DeleteAllArraysForVBO(this);
 
     if (mBuffered)
-        glDeleteBuffers(14, mAttribBuffers);
+        CGLBackend::DeleteBuffers(14, mAttribBuffers);
 }
 
 uint16 CVertexBuffer::AddVertex(const CVertex& rkVtx)
@@ -132,7 +133,7 @@ void CVertexBuffer::Reserve(uint16 Size)
 void CVertexBuffer::Clear()
 {
     if (mBuffered)
-        glDeleteBuffers(14, mAttribBuffers);
+        CGLBackend::DeleteBuffers(14, mAttribBuffers);
 
     mBuffered = false;
     mPositions.clear();
@@ -152,12 +153,12 @@ void CVertexBuffer::Buffer()
     // Make sure we don't end up with two buffers for the same data...
     if (mBuffered)
     {
-        glDeleteBuffers(14, mAttribBuffers);
+        CGLBackend::DeleteBuffers(14, mAttribBuffers);
         mBuffered = false;
     }
 
     // Generate buffers
-    glGenBuffers(14, mAttribBuffers);
+    CGLBackend::GenBuffers(14, mAttribBuffers);
 
     for (uint32 iAttrib = 0; iAttrib < 14; iAttrib++)
     {
@@ -169,36 +170,36 @@ void CVertexBuffer::Buffer()
         {
             std::vector<CVector3f> *pBuffer = (iAttrib == 0) ? &mPositions : &mNormals;
 
-            glBindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
-            glBufferData(GL_ARRAY_BUFFER, pBuffer->size() * sizeof(CVector3f), pBuffer->data(), GL_STATIC_DRAW);
+            CGLBackend::BindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
+            CGLBackend::BufferData(GL_ARRAY_BUFFER, pBuffer->size() * sizeof(CVector3f), pBuffer->data(), GL_STATIC_DRAW);
         }
 
         else if (iAttrib < 4)
         {
             uint8 Index = (uint8) (iAttrib - 2);
 
-            glBindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
-            glBufferData(GL_ARRAY_BUFFER, mColors[Index].size() * sizeof(CColor), mColors[Index].data(), GL_STATIC_DRAW);
+            CGLBackend::BindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
+            CGLBackend::BufferData(GL_ARRAY_BUFFER, mColors[Index].size() * sizeof(CColor), mColors[Index].data(), GL_STATIC_DRAW);
         }
 
         else if (iAttrib < 12)
         {
             uint8 Index = (uint8) (iAttrib - 4);
 
-            glBindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
-            glBufferData(GL_ARRAY_BUFFER, mTexCoords[Index].size() * sizeof(CVector2f), mTexCoords[Index].data(), GL_STATIC_DRAW);
+            CGLBackend::BindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
+            CGLBackend::BufferData(GL_ARRAY_BUFFER, mTexCoords[Index].size() * sizeof(CVector2f), mTexCoords[Index].data(), GL_STATIC_DRAW);
         }
 
         else if (iAttrib == 12)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
-            glBufferData(GL_ARRAY_BUFFER, mBoneIndices.size() * sizeof(TBoneIndices), mBoneIndices.data(), GL_STATIC_DRAW);
+            CGLBackend::BindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
+            CGLBackend::BufferData(GL_ARRAY_BUFFER, mBoneIndices.size() * sizeof(TBoneIndices), mBoneIndices.data(), GL_STATIC_DRAW);
         }
 
         else if (iAttrib == 13)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
-            glBufferData(GL_ARRAY_BUFFER, mBoneWeights.size() * sizeof(TBoneWeights), mBoneWeights.data(), GL_STATIC_DRAW);
+            CGLBackend::BindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
+            CGLBackend::BufferData(GL_ARRAY_BUFFER, mBoneWeights.size() * sizeof(TBoneWeights), mBoneWeights.data(), GL_STATIC_DRAW);
         }
     }
 
@@ -213,7 +214,7 @@ void CVertexBuffer::Bind()
 
 void CVertexBuffer::Unbind()
 {
-    glBindVertexArray(0);
+    CGLBackend::BindVertexArray(0);
 }
 
 bool CVertexBuffer::IsBuffered()
@@ -246,8 +247,8 @@ uint32 CVertexBuffer::Size()
 GLuint CVertexBuffer::CreateVAO()
 {
     GLuint VertexArray;
-    glGenVertexArrays(1, &VertexArray);
-    glBindVertexArray(VertexArray);
+    CGLBackend::GenVertexArrays(1, &VertexArray);
+    CGLBackend::BindVertexArray(VertexArray);
 
     for (uint32 iAttrib = 0; iAttrib < 14; iAttrib++)
     {
@@ -257,40 +258,40 @@ GLuint CVertexBuffer::CreateVAO()
 
         if (iAttrib < 2)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
+            CGLBackend::BindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
             glVertexAttribPointer(iAttrib, 3, GL_FLOAT, GL_FALSE, sizeof(CVector3f), (void*) 0);
             glEnableVertexAttribArray(iAttrib);
         }
 
         else if (iAttrib < 4)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
+            CGLBackend::BindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
             glVertexAttribPointer(iAttrib, 1, GL_UNSIGNED_INT, GL_FALSE, sizeof(CColor), (void*) 0);
             glEnableVertexAttribArray(iAttrib);
         }
 
         else if (iAttrib < 12)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
+            CGLBackend::BindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
             glVertexAttribPointer(iAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(CVector2f), (void*) 0);
             glEnableVertexAttribArray(iAttrib);
         }
 
         else if (iAttrib == 12)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
+            CGLBackend::BindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
             glVertexAttribIPointer(iAttrib, 1, GL_UNSIGNED_INT, sizeof(TBoneIndices), (void*) 0);
             glEnableVertexAttribArray(iAttrib);
         }
 
         else if (iAttrib == 13)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
+            CGLBackend::BindBuffer(GL_ARRAY_BUFFER, mAttribBuffers[iAttrib]);
             glVertexAttribPointer(iAttrib, 4, GL_FLOAT, GL_FALSE, sizeof(TBoneWeights), (void*) 0);
             glEnableVertexAttribArray(iAttrib);
         }
     }
 
-    glBindVertexArray(0);
+    CGLBackend::BindVertexArray(0);
     return VertexArray;
 }
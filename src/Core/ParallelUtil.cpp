@@ -0,0 +1,48 @@
+#include "ParallelUtil.h"
+#include <Common/Math/MathUtil.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace ParallelUtil
+{
+    uint NumThreads()
+    {
+        // hardware_concurrency() is allowed to return 0 if the value can't be determined
+        static const uint skNumThreads = Math::Max<uint>(std::thread::hardware_concurrency(), 1);
+        return skNumThreads;
+    }
+
+    void ParallelFor(uint Count, const FJobFunction& rkFunction)
+    {
+        uint NumWorkers = Math::Min(NumThreads(), Count);
+
+        // Don't bother spinning up threads if there's nothing to split
+        if (NumWorkers <= 1)
+        {
+            for (uint JobIdx = 0; JobIdx < Count; JobIdx++)
+                rkFunction(JobIdx, 0);
+
+            return;
+        }
+
+        std::atomic<uint> NextJob(0);
+
+        auto WorkerMain = [&](uint ThreadIdx)
+        {
+            for (uint JobIdx = NextJob++; JobIdx < Count; JobIdx = NextJob++)
+                rkFunction(JobIdx, ThreadIdx);
+        };
+
+        std::vector<std::thread> Workers;
+        Workers.reserve(NumWorkers - 1);
+
+        for (uint ThreadIdx = 1; ThreadIdx < NumWorkers; ThreadIdx++)
+            Workers.emplace_back(WorkerMain, ThreadIdx);
+
+        WorkerMain(0);
+
+        for (std::thread& rWorker : Workers)
+            rWorker.join();
+    }
+}
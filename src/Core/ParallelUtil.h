@@ -0,0 +1,21 @@
+#ifndef PARALLELUTIL_H
+#define PARALLELUTIL_H
+
+#include <Common/BasicTypes.h>
+#include <functional>
+
+namespace ParallelUtil
+{
+    // Job function; receives the job index and the index of the thread running it.
+    // Thread index 0 is always the thread that called ParallelFor.
+    typedef std::function<void(uint Index, uint ThreadIndex)> FJobFunction;
+
+    // Number of threads work is split across, including the calling thread
+    uint NumThreads();
+
+    // Runs every job in [0, Count) across all available threads and returns when all jobs are complete.
+    // The calling thread participates in the work. Jobs are handed out in index order, but may finish in any order.
+    void ParallelFor(uint Count, const FJobFunction& rkFunction);
+}
+
+#endif // PARALLELUTIL_H
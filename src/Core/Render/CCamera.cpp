@@ -261,7 +261,7 @@ void CCamera::UpdateProjection() const
 {
     if (mProjectionDirty)
     {
-        mProjectionMatrix = Math::PerspectiveMatrix(55.f, mAspectRatio, 0.1f, 4096.f);
+        mProjectionMatrix = Math::PerspectiveMatrix(FieldOfView(), mAspectRatio, NearPlane(), FarPlane());
         mProjectionDirty = false;
     }
 }
@@ -272,7 +272,7 @@ void CCamera::UpdateFrustum() const
 
     if (mFrustumPlanesDirty)
     {
-        mFrustumPlanes.SetPlanes(mPosition, mDirection, 55.f, mAspectRatio, 0.1f, 4096.f);
+        mFrustumPlanes.SetPlanes(mPosition, mDirection, FieldOfView(), mAspectRatio, NearPlane(), FarPlane());
         mFrustumPlanesDirty = false;
     }
 }
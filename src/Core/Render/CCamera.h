@@ -76,6 +76,8 @@ public:
     inline float Yaw() const                                { return mYaw; }
     inline float Pitch() const                              { return mPitch; }
     inline float FieldOfView() const                        { return 55.f; }
+    inline float NearPlane() const                          { return 0.1f; }
+    inline float FarPlane() const                           { return 4096.f; }
     inline ECameraMoveMode MoveMode() const                 { return mMode; }
     inline const CMatrix4f& ViewMatrix() const              { UpdateView(); return mViewMatrix; }
     inline const CMatrix4f& ProjectionMatrix() const        { UpdateProjection(); return mProjectionMatrix; }
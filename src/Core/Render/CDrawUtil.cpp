@@ -1,10 +1,16 @@
 #include "CDrawUtil.h"
 #include "CGraphics.h"
 #include "Core/GameProject/CResourceStore.h"
+#include "Core/OpenGL/CGLBackend.h"
 #include <Common/Log.h>
+#include <Common/Math/MathUtil.h>
 #include <Common/Math/CTransform4f.h>
+#include <algorithm>
 #include <iostream>
 
+// Size of the streaming buffers used for batches. Must be a multiple of 6 so lines and billboards never straddle a flush
+static const uint32 gkBatchVertexCount = 0x3000;
+
 // ************ MEMBER INITIALIZATION ************
 CVertexBuffer CDrawUtil::mGridVertices;
 CIndexBuffer CDrawUtil::mGridIndices;
@@ -25,6 +31,13 @@ TResPtr<CModel> CDrawUtil::mpDoubleSidedSphereModel;
 
 TResPtr<CModel> CDrawUtil::mpWireSphereModel;
 
+CDynamicVertexBuffer CDrawUtil::mLineBatchVertices;
+std::vector<CVector3f> CDrawUtil::mLineBatchPositions;
+std::vector<CDrawUtil::SBatchColor> CDrawUtil::mLineBatchColors;
+
+CDynamicVertexBuffer CDrawUtil::mBillboardBatchVertices;
+std::vector<CDrawUtil::SBatchedBillboard> CDrawUtil::mBillboardBatch;
+
 CShader *CDrawUtil::mpColorShader;
 CShader *CDrawUtil::mpColorShaderLighting;
 CShader *CDrawUtil::mpBillboardShader;
@@ -32,6 +45,8 @@ CShader *CDrawUtil::mpLightBillboardShader;
 CShader *CDrawUtil::mpTextureShader;
 CShader *CDrawUtil::mpCollisionShader;
 CShader *CDrawUtil::mpTextShader;
+CShader *CDrawUtil::mpLineBatchShader;
+CShader *CDrawUtil::mpBillboardBatchShader;
 
 TResPtr<CTexture> CDrawUtil::mpCheckerTexture;
 
@@ -290,6 +305,71 @@ void CDrawUtil::DrawLightBillboard(ELightType Type, const CColor& LightColor, co
 
 }
 
+void CDrawUtil::BatchLine(const CVector3f& PointA, const CVector3f& PointB, const CColor& LineColor)
+{
+    SBatchColor Color = PackBatchColor(LineColor);
+    mLineBatchPositions.push_back(PointA);
+    mLineBatchPositions.push_back(PointB);
+    mLineBatchColors.push_back(Color);
+    mLineBatchColors.push_back(Color);
+}
+
+void CDrawUtil::BatchWireCube(const CAABox& AABox, const CColor& Color)
+{
+    const CVector3f& Min = AABox.Min();
+    const CVector3f& Max = AABox.Max();
+
+    CVector3f Corners[8] = {
+        CVector3f(Min.X, Min.Y, Min.Z),
+        CVector3f(Min.X, Max.Y, Min.Z),
+        CVector3f(Max.X, Max.Y, Min.Z),
+        CVector3f(Max.X, Min.Y, Min.Z),
+        CVector3f(Min.X, Min.Y, Max.Z),
+        CVector3f(Max.X, Min.Y, Max.Z),
+        CVector3f(Max.X, Max.Y, Max.Z),
+        CVector3f(Min.X, Max.Y, Max.Z)
+    };
+
+    // Same edge list as the wire cube index buffer
+    static const uint8 skEdges[24] = {
+        0, 1,  1, 2,  2, 3,  3, 0,
+        4, 5,  5, 6,  6, 7,  7, 4,
+        0, 4,  1, 7,  2, 6,  3, 5
+    };
+
+    for (uint32 iEdge = 0; iEdge < 24; iEdge += 2)
+        BatchLine(Corners[ skEdges[iEdge] ], Corners[ skEdges[iEdge + 1] ], Color);
+}
+
+void CDrawUtil::BatchBillboard(CTexture* pTexture, const CVector3f& Position, const CVector2f& Scale /*= CVector2f::skOne*/, const CColor& Tint /*= CColor::skWhite*/)
+{
+    SBatchedBillboard Billboard;
+    Billboard.pTexture = pTexture;
+    Billboard.Position = Position;
+    Billboard.Scale = Scale;
+    Billboard.Tint = PackBatchColor(Tint);
+    mBillboardBatch.push_back(Billboard);
+}
+
+void CDrawUtil::FlushBatches()
+{
+    if (mLineBatchPositions.empty() && mBillboardBatch.empty())
+        return;
+
+    Init();
+
+    CGraphics::sMVPBlock.ModelMatrix = CMatrix4f::skIdentity;
+    CGraphics::UpdateMVPBlock();
+
+    CMaterial::KillCachedMaterial();
+    glBlendFunc(GL_ONE, GL_ZERO);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+
+    FlushLineBatch();
+    FlushBillboardBatch();
+}
+
 void CDrawUtil::UseColorShader(const CColor& kColor)
 {
     Init();
@@ -398,6 +478,7 @@ void CDrawUtil::Init()
         InitWireCube();
         InitSphere();
         InitWireSphere();
+        InitBatches();
         InitShaders();
         InitTextures();
         mDrawUtilInitialized = true;
@@ -552,6 +633,17 @@ void CDrawUtil::InitWireSphere()
     mpWireSphereModel = gpEditorStore->LoadResource("WireSphere.CMDL");
 }
 
+void CDrawUtil::InitBatches()
+{
+    debugf("Creating batch buffers");
+    mLineBatchVertices.SetActiveAttribs(EVertexAttribute::Position | EVertexAttribute::Color0);
+    mLineBatchVertices.SetVertexCount(gkBatchVertexCount);
+
+    mBillboardBatchVertices.SetActiveAttribs(EVertexAttribute::Position | EVertexAttribute::Color0 |
+                                             EVertexAttribute::Tex0 | EVertexAttribute::Tex1);
+    mBillboardBatchVertices.SetVertexCount(gkBatchVertexCount);
+}
+
 void CDrawUtil::InitShaders()
 {
     debugf("Creating shaders");
@@ -562,6 +654,8 @@ void CDrawUtil::InitShaders()
     mpTextureShader        = CShader::FromResourceFile("TextureShader");
     mpCollisionShader      = CShader::FromResourceFile("CollisionShader");
     mpTextShader           = CShader::FromResourceFile("TextShader");
+    mpLineBatchShader      = CShader::FromResourceFile("LineBatchShader");
+    mpBillboardBatchShader = CShader::FromResourceFile("BillboardBatchShader");
 }
 
 void CDrawUtil::InitTextures()
@@ -590,6 +684,118 @@ void CDrawUtil::Shutdown()
         delete mpTextureShader;
         delete mpCollisionShader;
         delete mpTextShader;
+        delete mpLineBatchShader;
+        delete mpBillboardBatchShader;
         mDrawUtilInitialized = false;
     }
 }
+
+void CDrawUtil::FlushLineBatch()
+{
+    uint32 NumVertices = mLineBatchPositions.size();
+    if (NumVertices == 0) return;
+
+    mpLineBatchShader->SetCurrent();
+    glLineWidth(1.f);
+    mLineBatchVertices.Bind();
+
+    for (uint32 First = 0; First < NumVertices; First += gkBatchVertexCount)
+    {
+        uint32 Count = Math::Min(NumVertices - First, gkBatchVertexCount);
+        mLineBatchVertices.BufferAttrib(EVertexAttribute::Position, &mLineBatchPositions[First], Count);
+        mLineBatchVertices.BufferAttrib(EVertexAttribute::Color0, &mLineBatchColors[First], Count);
+        CGLBackend::DrawArrays(GL_LINES, 0, Count);
+    }
+
+    mLineBatchVertices.Unbind();
+    mLineBatchPositions.clear();
+    mLineBatchColors.clear();
+}
+
+void CDrawUtil::FlushBillboardBatch()
+{
+    if (mBillboardBatch.empty()) return;
+
+    // Group by texture so each texture is bound once. Stable so overlapping billboards keep their order.
+    std::stable_sort(mBillboardBatch.begin(), mBillboardBatch.end(), [](const SBatchedBillboard& rkA, const SBatchedBillboard& rkB) {
+        return rkA.pTexture < rkB.pTexture;
+    });
+
+    // Two triangles per billboard, matching the winding of the square strip
+    static const CVector2f skCorners[6] = {
+        CVector2f(-1.f, -1.f), CVector2f( 1.f, -1.f), CVector2f(-1.f,  1.f),
+        CVector2f(-1.f,  1.f), CVector2f( 1.f, -1.f), CVector2f( 1.f,  1.f)
+    };
+
+    static const CVector2f skTexCoords[6] = {
+        CVector2f(0.f, 0.f), CVector2f(1.f, 0.f), CVector2f(0.f, 1.f),
+        CVector2f(0.f, 1.f), CVector2f(1.f, 0.f), CVector2f(1.f, 1.f)
+    };
+
+    const uint32 kMaxBillboards = gkBatchVertexCount / 6;
+    std::vector<CVector3f> Positions;
+    std::vector<SBatchColor> Colors;
+    std::vector<CVector2f> TexCoords;
+    std::vector<CVector2f> Offsets;
+    Positions.reserve(gkBatchVertexCount);
+    Colors.reserve(gkBatchVertexCount);
+    TexCoords.reserve(gkBatchVertexCount);
+    Offsets.reserve(gkBatchVertexCount);
+
+    mpBillboardBatchShader->SetCurrent();
+    mBillboardBatchVertices.Bind();
+
+    uint32 NumBillboards = mBillboardBatch.size();
+    uint32 RunStart = 0;
+
+    while (RunStart < NumBillboards)
+    {
+        CTexture *pTexture = mBillboardBatch[RunStart].pTexture;
+        uint32 RunEnd = RunStart;
+
+        while (RunEnd < NumBillboards && RunEnd - RunStart < kMaxBillboards && mBillboardBatch[RunEnd].pTexture == pTexture)
+            RunEnd++;
+
+        Positions.clear();
+        Colors.clear();
+        TexCoords.clear();
+        Offsets.clear();
+
+        for (uint32 iBill = RunStart; iBill < RunEnd; iBill++)
+        {
+            const SBatchedBillboard& rkBillboard = mBillboardBatch[iBill];
+
+            for (uint32 iVtx = 0; iVtx < 6; iVtx++)
+            {
+                Positions.push_back(rkBillboard.Position);
+                Colors.push_back(rkBillboard.Tint);
+                TexCoords.push_back(skTexCoords[iVtx]);
+                Offsets.push_back(CVector2f(skCorners[iVtx].X * rkBillboard.Scale.X, skCorners[iVtx].Y * rkBillboard.Scale.Y));
+            }
+        }
+
+        uint32 Count = Positions.size();
+        mBillboardBatchVertices.BufferAttrib(EVertexAttribute::Position, Positions.data(), Count);
+        mBillboardBatchVertices.BufferAttrib(EVertexAttribute::Color0, Colors.data(), Count);
+        mBillboardBatchVertices.BufferAttrib(EVertexAttribute::Tex0, TexCoords.data(), Count);
+        mBillboardBatchVertices.BufferAttrib(EVertexAttribute::Tex1, Offsets.data(), Count);
+
+        if (pTexture) pTexture->Bind(0);
+        CGLBackend::DrawArrays(GL_TRIANGLES, 0, Count);
+
+        RunStart = RunEnd;
+    }
+
+    mBillboardBatchVertices.Unbind();
+    mBillboardBatch.clear();
+}
+
+CDrawUtil::SBatchColor CDrawUtil::PackBatchColor(const CColor& Color)
+{
+    SBatchColor Out;
+    Out.R = (uint8) (Math::Clamp(0.f, 1.f, Color.R) * 255.f + 0.5f);
+    Out.G = (uint8) (Math::Clamp(0.f, 1.f, Color.G) * 255.f + 0.5f);
+    Out.B = (uint8) (Math::Clamp(0.f, 1.f, Color.B) * 255.f + 0.5f);
+    Out.A = (uint8) (Math::Clamp(0.f, 1.f, Color.A) * 255.f + 0.5f);
+    return Out;
+}
@@ -6,6 +6,7 @@
 #include "Core/OpenGL/CIndexBuffer.h"
 #include "Core/Resource/model/CModel.h"
 #include "Core/Resource/CLight.h"
+#include <vector>
 
 /**
  * @todo there are a LOT of problems with how this is implemented; trying to
@@ -13,6 +14,10 @@
  * because it goes outside CRenderer to draw stuff, and also it's slow as heck
  * because it issues tons of draw calls instead of batching items together
  * which is a cause of significant performance problems
+ *
+ * Lines, wire boxes and billboards that are drawn during bucket rendering can be
+ * queued with the Batch functions instead. They are collected in world space and
+ * drawn with a handful of draw calls when CRenderer finishes each bucket.
  */
 class CDrawUtil
 {
@@ -42,6 +47,27 @@ class CDrawUtil
     // Wire Sphere
     static TResPtr<CModel> mpWireSphereModel;
 
+    // Batches
+    struct SBatchColor
+    {
+        uint8 R, G, B, A;
+    };
+
+    struct SBatchedBillboard
+    {
+        CTexture *pTexture;
+        CVector3f Position;
+        CVector2f Scale;
+        SBatchColor Tint;
+    };
+
+    static CDynamicVertexBuffer mLineBatchVertices;
+    static std::vector<CVector3f> mLineBatchPositions;
+    static std::vector<SBatchColor> mLineBatchColors;
+
+    static CDynamicVertexBuffer mBillboardBatchVertices;
+    static std::vector<SBatchedBillboard> mBillboardBatch;
+
     // Shaders
     static CShader *mpColorShader;
     static CShader *mpColorShaderLighting;
@@ -50,6 +76,8 @@ class CDrawUtil
     static CShader *mpTextureShader;
     static CShader *mpCollisionShader;
     static CShader *mpTextShader;
+    static CShader *mpLineBatchShader;
+    static CShader *mpBillboardBatchShader;
 
     // Textures
     static TResPtr<CTexture> mpCheckerTexture;
@@ -89,6 +117,11 @@ public:
 
     static void DrawLightBillboard(ELightType Type, const CColor& LightColor, const CVector3f& Position, const CVector2f& Scale = CVector2f::skOne, const CColor& Tint = CColor::skWhite);
 
+    static void BatchLine(const CVector3f& PointA, const CVector3f& PointB, const CColor& LineColor);
+    static void BatchWireCube(const CAABox& AABox, const CColor& Color);
+    static void BatchBillboard(CTexture* pTexture, const CVector3f& Position, const CVector2f& Scale = CVector2f::skOne, const CColor& Tint = CColor::skWhite);
+    static void FlushBatches();
+
     static void UseColorShader(const CColor& Color);
     static void UseColorShaderLighting(const CColor& Color);
     static void UseTextureShader();
@@ -111,8 +144,12 @@ private:
     static void InitWireCube();
     static void InitSphere();
     static void InitWireSphere();
+    static void InitBatches();
     static void InitShaders();
     static void InitTextures();
+    static void FlushLineBatch();
+    static void FlushBillboardBatch();
+    static SBatchColor PackBatchColor(const CColor& Color);
 
 public:
     static void Shutdown();
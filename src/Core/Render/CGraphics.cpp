@@ -2,6 +2,7 @@
 #include "Core/OpenGL/CShader.h"
 #include "Core/Resource/CMaterial.h"
 #include <Common/Log.h>
+#include <Common/Macros.h>
 
 // ************ MEMBER INITIALIZATION ************
 CUniformBuffer* CGraphics::mpMVPBlockBuffer;
@@ -9,6 +10,7 @@ CUniformBuffer* CGraphics::mpVertexBlockBuffer;
 CUniformBuffer* CGraphics::mpPixelBlockBuffer;
 CUniformBuffer* CGraphics::mpLightBlockBuffer;
 CUniformBuffer* CGraphics::mpBoneTransformBuffer;
+CUniformBuffer* CGraphics::mpInstanceBlockBuffer;
 uint32 CGraphics::mContextIndices = 0;
 uint32 CGraphics::mActiveContext = -1;
 bool CGraphics::mInitialized = false;
@@ -19,6 +21,7 @@ CGraphics::SMVPBlock    CGraphics::sMVPBlock;
 CGraphics::SVertexBlock CGraphics::sVertexBlock;
 CGraphics::SPixelBlock  CGraphics::sPixelBlock;
 CGraphics::SLightBlock  CGraphics::sLightBlock;
+CGraphics::SInstanceBlock CGraphics::sInstanceBlock;
 
 CGraphics::ELightingMode CGraphics::sLightMode;
 uint32 CGraphics::sNumLights;
@@ -47,6 +50,7 @@ void CGraphics::Initialize()
         mpPixelBlockBuffer = new CUniformBuffer(sizeof(sPixelBlock));
         mpLightBlockBuffer = new CUniformBuffer(sizeof(sLightBlock));
         mpBoneTransformBuffer = new CUniformBuffer(sizeof(CTransform4f) * 100);
+        mpInstanceBlockBuffer = new CUniformBuffer(sizeof(sInstanceBlock));
 
         sLightMode = ELightingMode::World;
         sNumLights = 0;
@@ -59,6 +63,7 @@ void CGraphics::Initialize()
     mpPixelBlockBuffer->BindBase(2);
     mpLightBlockBuffer->BindBase(3);
     mpBoneTransformBuffer->BindBase(4);
+    mpInstanceBlockBuffer->BindBase(5);
     LoadIdentityBoneTransforms();
 }
 
@@ -72,6 +77,7 @@ void CGraphics::Shutdown()
         delete mpPixelBlockBuffer;
         delete mpLightBlockBuffer;
         delete mpBoneTransformBuffer;
+        delete mpInstanceBlockBuffer;
         mInitialized = false;
     }
 }
@@ -96,6 +102,14 @@ void CGraphics::UpdateLightBlock()
     mpLightBlockBuffer->Buffer(&sLightBlock);
 }
 
+void CGraphics::UpdateInstanceBlock(uint32 NumInstances)
+{
+    // Only upload the instances in use; the tint array starts after the full matrix array
+    ASSERT(NumInstances <= skMaxInstances);
+    mpInstanceBlockBuffer->BufferRange(&sInstanceBlock.ModelMatrices[0], 0, NumInstances * sizeof(CMatrix4f));
+    mpInstanceBlockBuffer->BufferRange(&sInstanceBlock.TintColors[0], sizeof(sInstanceBlock.ModelMatrices), NumInstances * sizeof(CColor));
+}
+
 GLuint CGraphics::MVPBlockBindingPoint()
 {
     return 0;
@@ -121,6 +135,11 @@ GLuint CGraphics::BoneTransformBlockBindingPoint()
     return 4;
 }
 
+GLuint CGraphics::InstanceBlockBindingPoint()
+{
+    return 5;
+}
+
 uint32 CGraphics::GetContextIndex()
 {
     for (uint32 iCon = 0; iCon < 32; iCon++)
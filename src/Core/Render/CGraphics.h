@@ -25,6 +25,7 @@ class CGraphics
     static CUniformBuffer *mpPixelBlockBuffer;
     static CUniformBuffer *mpLightBlockBuffer;
     static CUniformBuffer *mpBoneTransformBuffer;
+    static CUniformBuffer *mpInstanceBlockBuffer;
     static uint32 mContextIndices;
     static uint32 mActiveContext;
     static bool mInitialized;
@@ -78,6 +79,16 @@ public:
     };
     static SLightBlock sLightBlock;
 
+    // SInstanceBlock - per-instance data for instanced draws, indexed by gl_InstanceID
+    static const uint32 skMaxInstances = 128;
+
+    struct SInstanceBlock
+    {
+        CMatrix4f ModelMatrices[skMaxInstances];
+        CColor TintColors[skMaxInstances];
+    };
+    static SInstanceBlock sInstanceBlock;
+
     // Lighting-related
     enum class ELightingMode { None, Basic, World };
     static ELightingMode sLightMode;
@@ -94,11 +105,13 @@ public:
     static void UpdateVertexBlock();
     static void UpdatePixelBlock();
     static void UpdateLightBlock();
+    static void UpdateInstanceBlock(uint32 NumInstances);
     static GLuint MVPBlockBindingPoint();
     static GLuint VertexBlockBindingPoint();
     static GLuint PixelBlockBindingPoint();
     static GLuint LightBlockBindingPoint();
     static GLuint BoneTransformBlockBindingPoint();
+    static GLuint InstanceBlockBindingPoint();
     static uint32 GetContextIndex();
     static uint32 GetActiveContext();
     static void ReleaseContext(uint32 Index);
@@ -0,0 +1,109 @@
+#include "CInstanceBatcher.h"
+#include "CGraphics.h"
+#include "CRenderer.h"
+#include "Core/Resource/Model/CModel.h"
+#include "Core/Scene/CScriptNode.h"
+#include <Common/Macros.h>
+#include <Common/Math/MathUtil.h>
+#include <algorithm>
+
+void CInstanceBatcher::Add(const SInstanceKey& rkKey, const SInstance& rkInstance)
+{
+    mKeys.push_back(rkKey);
+    mInstances.push_back(rkInstance);
+}
+
+void CInstanceBatcher::Build(uint32 MaxBatchSize, uint32 MinBatchSize /*= 2*/)
+{
+    ASSERT(MaxBatchSize > 0);
+    mBatches.clear();
+    mUnbatched.clear();
+    mSortedIndices.resize(mInstances.size());
+
+    for (uint32 iInst = 0; iInst < mSortedIndices.size(); iInst++)
+        mSortedIndices[iInst] = iInst;
+
+    // Stable so that instances within a batch keep their submission order
+    std::stable_sort(mSortedIndices.begin(), mSortedIndices.end(), [this](uint32 Left, uint32 Right) {
+        return mKeys[Left] < mKeys[Right];
+    });
+
+    uint32 RunStart = 0;
+
+    while (RunStart < mSortedIndices.size())
+    {
+        const SInstanceKey& rkKey = mKeys[mSortedIndices[RunStart]];
+        uint32 RunEnd = RunStart + 1;
+
+        while (RunEnd < mSortedIndices.size() && mKeys[mSortedIndices[RunEnd]] == rkKey)
+            RunEnd++;
+
+        if (RunEnd - RunStart < MinBatchSize)
+        {
+            for (uint32 iInst = RunStart; iInst < RunEnd; iInst++)
+                mUnbatched.push_back(mSortedIndices[iInst]);
+        }
+
+        else
+        {
+            // Split runs that don't fit in the instance block into several batches
+            for (uint32 BatchStart = RunStart; BatchStart < RunEnd; BatchStart += MaxBatchSize)
+            {
+                SInstanceBatch Batch;
+                Batch.Key = rkKey;
+                Batch.FirstInstance = BatchStart;
+                Batch.NumInstances = Math::Min(MaxBatchSize, RunEnd - BatchStart);
+                Batch.AABox = mInstances[mSortedIndices[BatchStart]].AABox;
+
+                for (uint32 iInst = 1; iInst < Batch.NumInstances; iInst++)
+                    Batch.AABox.ExpandBounds(mInstances[mSortedIndices[BatchStart + iInst]].AABox);
+
+                mBatches.push_back(Batch);
+            }
+        }
+
+        RunStart = RunEnd;
+    }
+}
+
+void CInstanceBatcher::Clear()
+{
+    mKeys.clear();
+    mInstances.clear();
+    mSortedIndices.clear();
+    mBatches.clear();
+    mUnbatched.clear();
+}
+
+void CInstanceBatcher::AddToRenderer(CRenderer *pRenderer, const SViewInfo& /*rkViewInfo*/)
+{
+    Build(CGraphics::skMaxInstances);
+
+    for (uint32 iBatch = 0; iBatch < mBatches.size(); iBatch++)
+        pRenderer->AddMesh(this, iBatch, mBatches[iBatch].AABox, false, ERenderCommand::DrawMesh);
+
+    // Instances that didn't batch are drawn by their own nodes
+    for (uint32 iInst = 0; iInst < mUnbatched.size(); iInst++)
+    {
+        const SInstance& rkInst = mInstances[mUnbatched[iInst]];
+        pRenderer->AddMesh(rkInst.pNode, -1, rkInst.AABox, false, ERenderCommand::DrawMesh);
+    }
+}
+
+void CInstanceBatcher::Draw(FRenderOptions Options, int ComponentIndex, ERenderCommand /*Command*/, const SViewInfo& rkViewInfo)
+{
+    const SInstanceBatch& rkBatch = mBatches[ComponentIndex];
+
+    // Every instance in the batch shares the same lighting and TEV color, so load them from the first one
+    BatchInstance(rkBatch, 0).pNode->LoadModelDrawState(rkViewInfo);
+
+    for (uint32 iInst = 0; iInst < rkBatch.NumInstances; iInst++)
+    {
+        const SInstance& rkInst = BatchInstance(rkBatch, iInst);
+        CGraphics::sInstanceBlock.ModelMatrices[iInst] = rkInst.Transform;
+        CGraphics::sInstanceBlock.TintColors[iInst] = rkInst.TintColor;
+    }
+
+    CGraphics::UpdateInstanceBlock(rkBatch.NumInstances);
+    rkBatch.Key.pModel->DrawInstanced(Options, rkBatch.Key.MatSet, rkBatch.NumInstances);
+}
@@ -0,0 +1,84 @@
+#ifndef CINSTANCEBATCHER_H
+#define CINSTANCEBATCHER_H
+
+#include "IRenderable.h"
+#include <Common/BasicTypes.h>
+#include <Common/CColor.h>
+#include <Common/Math/CAABox.h>
+#include <Common/Math/CTransform4f.h>
+#include <vector>
+
+class CModel;
+class CScriptNode;
+
+// Instances can only share a draw if they use the same model, material set and
+// per-draw render state (lighting and TEV color); StateHash covers the render state.
+struct SInstanceKey
+{
+    CModel *pModel;
+    uint32 MatSet;
+    uint64 StateHash;
+
+    bool operator==(const SInstanceKey& rkOther) const
+    {
+        return pModel == rkOther.pModel && MatSet == rkOther.MatSet && StateHash == rkOther.StateHash;
+    }
+
+    bool operator<(const SInstanceKey& rkOther) const
+    {
+        if (pModel != rkOther.pModel) return pModel < rkOther.pModel;
+        if (MatSet != rkOther.MatSet) return MatSet < rkOther.MatSet;
+        return StateHash < rkOther.StateHash;
+    }
+};
+
+struct SInstance
+{
+    CScriptNode *pNode;
+    CTransform4f Transform;
+    CColor TintColor;
+    CAABox AABox;
+};
+
+struct SInstanceBatch
+{
+    SInstanceKey Key;
+    uint32 FirstInstance;   // Index into the sorted instance list
+    uint32 NumInstances;
+    CAABox AABox;
+};
+
+/**
+ * Groups script object models that can be drawn with a single instanced draw call.
+ * Instances are collected with Add() while nodes are added to the renderer; Build() then
+ * groups them by key into batches of at most MaxBatchSize. Keys with fewer than MinBatchSize
+ * instances are left unbatched and are drawn by their nodes as usual. Grouping doesn't touch
+ * GL, so it can be run and checked without a context.
+ */
+class CInstanceBatcher : public IRenderable
+{
+    std::vector<SInstanceKey> mKeys;
+    std::vector<SInstance> mInstances;
+    std::vector<uint32> mSortedIndices;
+    std::vector<SInstanceBatch> mBatches;
+    std::vector<uint32> mUnbatched;
+
+public:
+    void Add(const SInstanceKey& rkKey, const SInstance& rkInstance);
+    void Build(uint32 MaxBatchSize, uint32 MinBatchSize = 2);
+    void Clear();
+
+    void AddToRenderer(CRenderer *pRenderer, const SViewInfo& rkViewInfo);
+    void Draw(FRenderOptions Options, int ComponentIndex, ERenderCommand Command, const SViewInfo& rkViewInfo);
+
+    // Accessors
+    inline uint32 NumInstances() const                              { return mInstances.size(); }
+    inline uint32 NumBatches() const                                { return mBatches.size(); }
+    inline const SInstanceBatch& Batch(uint32 Index) const          { return mBatches[Index]; }
+    inline const SInstance& BatchInstance(const SInstanceBatch& rkBatch, uint32 Index) const
+                                                                    { return mInstances[mSortedIndices[rkBatch.FirstInstance + Index]]; }
+    inline uint32 NumUnbatched() const                              { return mUnbatched.size(); }
+    inline const SInstance& UnbatchedInstance(uint32 Index) const   { return mInstances[mUnbatched[Index]]; }
+};
+
+#endif // CINSTANCEBATCHER_H
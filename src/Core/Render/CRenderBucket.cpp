@@ -2,7 +2,19 @@
 #include "CDrawUtil.h"
 #include "CGraphics.h"
 #include "CRenderer.h"
+#include "Core/Resource/CMaterial.h"
+#include <Common/Hash/CFNV1A.h>
+#include <Common/Math/MathUtil.h>
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// Material sort key used for renderables that don't provide a material; sorts them last
+const uint32 gkNoMaterialSortKey = 0xFFFFFFFF;
+
+// Number of bits used for quantized depth in sort keys
+const uint32 gkDepthBits = 24;
+const uint32 gkMaxQuantizedDepth = (1 << gkDepthBits) - 1;
 
 // ************ CSubBucket ************
 void CRenderBucket::CSubBucket::Add(const SRenderablePtr& rkPtr)
@@ -15,20 +27,58 @@ void CRenderBucket::CSubBucket::Add(const SRenderablePtr& rkPtr)
     mSize++;
 }
 
-void CRenderBucket::CSubBucket::Sort(const CCamera* pkCamera, bool DebugVisualization)
+void CRenderBucket::CSubBucket::Sort(const CCamera* pkCamera, EDepthGroup DepthGroup, bool DebugVisualization)
 {
-    std::stable_sort(mRenderables.begin(), mRenderables.begin() + mSize,
-                     [&, pkCamera](const SRenderablePtr& rkLeft, const SRenderablePtr& rkRight) -> bool
+    if (mSize == 0) return;
+
+    // Calculate each renderable's depth once up front and find the depth range for quantization.
+    // Depths can be negative for boxes that surround the camera (water and fog volumes, for instance), and those
+    // still need to keep their order. Depths are clamped to [-FarPlane, FarPlane] so that one far away or broken
+    // bounding box can't stretch the range and leave no precision for the rest. Non-finite depths (from invalid
+    // bounds) are sorted as far away.
+    CVector3f CamPos = pkCamera->Position();
+    CVector3f CamDir = pkCamera->Direction();
+    float FarPlane = pkCamera->FarPlane();
+    float MinDepth = FLT_MAX;
+    float MaxDepth = -FLT_MAX;
+    mDepths.resize(mSize);
+
+    for (uint32 iPtr = 0; iPtr < mSize; iPtr++)
+    {
+        CVector3f Dist = mRenderables[iPtr].AABox.ClosestPointAlongVector(CamDir) - CamPos;
+        float Depth = Dist.Dot(CamDir);
+        Depth = (std::isfinite(Depth) ? Math::Clamp(-FarPlane, FarPlane, Depth) : FarPlane);
+        mDepths[iPtr] = Depth;
+        MinDepth = Math::Min(MinDepth, Depth);
+        MaxDepth = Math::Max(MaxDepth, Depth);
+    }
+
+    float DepthScale = (MaxDepth > MinDepth ? gkMaxQuantizedDepth / (MaxDepth - MinDepth) : 0.f);
+
+    // Build keys
+    uint64 BaseKey = ((uint64) DepthGroup << 62) | ((uint64) (mTransparent ? 1 : 0) << 61);
+    mSortEntries.resize(mSize);
+
+    for (uint32 iPtr = 0; iPtr < mSize; iPtr++)
     {
-        CVector3f CamPos = pkCamera->Position();
-        CVector3f CamDir = pkCamera->Direction();
+        const SRenderablePtr& rkPtr = mRenderables[iPtr];
+        uint64 Depth = (uint64) Math::Min<float>((mDepths[iPtr] - MinDepth) * DepthScale, (float) gkMaxQuantizedDepth);
+        uint64 Key = BaseKey;
+
+        if (mTransparent)
+            Key |= (gkMaxQuantizedDepth - Depth) << 37;
 
-        CVector3f DistL = rkLeft.AABox.ClosestPointAlongVector(CamDir) - CamPos;
-        CVector3f DistR = rkRight.AABox.ClosestPointAlongVector(CamDir) - CamPos;
-        float DotL = DistL.Dot(CamDir);
-        float DotR = DistR.Dot(CamDir);
-        return (DotL > DotR);
-    });
+        else if (rkPtr.MaterialSortKey != gkNoMaterialSortKey)
+            Key |= ((uint64) rkPtr.MaterialSortKey << 29) | (Depth << 5);
+
+        else
+            Key |= ((uint64) gkNoMaterialSortKey << 29);
+
+        mSortEntries[iPtr].Key = Key;
+        mSortEntries[iPtr].Index = iPtr;
+    }
+
+    RadixSort();
 
     if (DebugVisualization)
     {
@@ -52,6 +102,41 @@ void CRenderBucket::CSubBucket::Sort(const CCamera* pkCamera, bool DebugVisualiz
     }
 }
 
+void CRenderBucket::CSubBucket::RadixSort()
+{
+    // LSD radix sort, one byte per pass. Passes where every key has the same byte are skipped,
+    // which is common since the depth group and transparency bits are the same for the whole bucket.
+    mSortScratch.resize(mSize);
+
+    for (uint32 Shift = 0; Shift < 64; Shift += 8)
+    {
+        uint32 Counts[256] = { 0 };
+
+        for (uint32 iEntry = 0; iEntry < mSize; iEntry++)
+            Counts[(mSortEntries[iEntry].Key >> Shift) & 0xFF]++;
+
+        if (Counts[(mSortEntries[0].Key >> Shift) & 0xFF] == mSize)
+            continue;
+
+        uint32 Offset = 0;
+
+        for (uint32 iBin = 0; iBin < 256; iBin++)
+        {
+            uint32 Count = Counts[iBin];
+            Counts[iBin] = Offset;
+            Offset += Count;
+        }
+
+        for (uint32 iEntry = 0; iEntry < mSize; iEntry++)
+        {
+            const SSortEntry& rkEntry = mSortEntries[iEntry];
+            mSortScratch[ Counts[(rkEntry.Key >> Shift) & 0xFF]++ ] = rkEntry;
+        }
+
+        mSortEntries.swap(mSortScratch);
+    }
+}
+
 void CRenderBucket::CSubBucket::Clear()
 {
     mEstSize = mSize;
@@ -59,13 +144,21 @@ void CRenderBucket::CSubBucket::Clear()
     mSize = 0;
 }
 
+void CRenderBucket::CSubBucket::GetSortedRenderables(std::vector<SRenderablePtr>& rOutRenderables) const
+{
+    rOutRenderables.resize(mSize);
+
+    for (uint32 iEntry = 0; iEntry < mSize; iEntry++)
+        rOutRenderables[iEntry] = mRenderables[ mSortEntries[iEntry].Index ];
+}
+
 void CRenderBucket::CSubBucket::Draw(const SViewInfo& rkViewInfo)
 {
     FRenderOptions Options = rkViewInfo.pRenderer->RenderOptions();
 
-    for (uint32 iPtr = 0; iPtr < mSize; iPtr++)
+    for (uint32 iEntry = 0; iEntry < mSize; iEntry++)
     {
-        const SRenderablePtr& rkPtr = mRenderables[iPtr];
+        const SRenderablePtr& rkPtr = mRenderables[ mSortEntries[iEntry].Index ];
 
         // todo: DrawSelection probably shouldn't be a separate function anymore.
         if (rkPtr.Command == ERenderCommand::DrawSelection)
@@ -92,7 +185,38 @@ void CRenderBucket::Clear()
 
 void CRenderBucket::Draw(const SViewInfo& rkViewInfo)
 {
+    mOpaqueSubBucket.Sort(rkViewInfo.pCamera, mDepthGroup, false);
     mOpaqueSubBucket.Draw(rkViewInfo);
-    mTransparentSubBucket.Sort(rkViewInfo.pCamera, mEnableDepthSortDebugVisualization);
+    mTransparentSubBucket.Sort(rkViewInfo.pCamera, mDepthGroup, mEnableDepthSortDebugVisualization);
     mTransparentSubBucket.Draw(rkViewInfo);
 }
+
+void CRenderBucket::SortedRenderables(const CCamera *pkCamera, bool Transparent, std::vector<SRenderablePtr>& rOutRenderables)
+{
+    CSubBucket& rSubBucket = (Transparent ? mTransparentSubBucket : mOpaqueSubBucket);
+    rSubBucket.Sort(pkCamera, mDepthGroup, false);
+    rSubBucket.GetSortedRenderables(rOutRenderables);
+}
+
+uint32 CRenderBucket::MaterialSortKey(CMaterial *pMaterial)
+{
+    if (!pMaterial) return gkNoMaterialSortKey;
+
+    // High 20 bits identify the TEV setup (and therefore the shader), low 12 bits the bound textures
+    uint64 ParamHash = pMaterial->HashParameters();
+    uint32 ShaderBits = (uint32) ((ParamHash ^ (ParamHash >> 32)) & 0xFFFFF);
+
+    CFNV1A TextureHash(CFNV1A::k64Bit);
+
+    for (uint32 iPass = 0; iPass < pMaterial->PassCount(); iPass++)
+    {
+        CTexture *pTexture = pMaterial->Pass(iPass)->Texture();
+        TextureHash.HashData(&pTexture, sizeof(CTexture*));
+    }
+
+    uint32 TextureBits = (uint32) (TextureHash.GetHash64() & 0xFFF);
+    uint32 Key = (ShaderBits << 12) | TextureBits;
+
+    // Keep real materials from colliding with the no-material key
+    return (Key == gkNoMaterialSortKey ? Key - 1 : Key);
+}
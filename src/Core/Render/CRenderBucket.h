@@ -4,45 +4,84 @@
 #include "CCamera.h"
 #include "CDrawUtil.h"
 #include "CGraphics.h"
+#include "EDepthGroup.h"
 #include "FRenderOptions.h"
 #include "SRenderablePtr.h"
 #include <Common/BasicTypes.h>
 #include <algorithm>
 #include <vector>
 
+class CMaterial;
+
+/**
+ * Renderables are drawn in order of a 64-bit sort key built when the bucket is drawn:
+ *   [63:62] depth group
+ *   [61]    transparent
+ *   Opaque:      [60:29] material sort key, [28:5] depth (front to back)
+ *   Transparent: [60:37] depth (back to front)
+ * Opaque draws are grouped by material to cut down on shader and texture changes; renderables
+ * without a material keep their submission order and are drawn after everything else.
+ * The keys are radix sorted, which is stable, so ties keep their submission order.
+ */
 class CRenderBucket
 {
     bool mEnableDepthSortDebugVisualization;
+    EDepthGroup mDepthGroup;
 
     class CSubBucket
     {
+        struct SSortEntry
+        {
+            uint64 Key;
+            uint32 Index;
+        };
+
         std::vector<SRenderablePtr> mRenderables;
+        std::vector<SSortEntry> mSortEntries;
+        std::vector<SSortEntry> mSortScratch;
+        std::vector<float> mDepths;
         uint32 mEstSize;
         uint32 mSize;
+        bool mTransparent;
 
     public:
-        CSubBucket()
+        CSubBucket(bool Transparent)
             : mEstSize(0)
             , mSize(0)
+            , mTransparent(Transparent)
         {}
 
         void Add(const SRenderablePtr &rkPtr);
-        void Sort(const CCamera *pkCamera, bool DebugVisualization);
+        void Sort(const CCamera *pkCamera, EDepthGroup DepthGroup, bool DebugVisualization);
         void Clear();
+        void GetSortedRenderables(std::vector<SRenderablePtr>& rOutRenderables) const;
         void Draw(const SViewInfo& rkViewInfo);
+
+    private:
+        void RadixSort();
     };
 
     CSubBucket mOpaqueSubBucket;
     CSubBucket mTransparentSubBucket;
 
 public:
-    CRenderBucket()
+    CRenderBucket(EDepthGroup DepthGroup)
         : mEnableDepthSortDebugVisualization(false)
+        , mDepthGroup(DepthGroup)
+        , mOpaqueSubBucket(false)
+        , mTransparentSubBucket(true)
     {}
 
     void Add(const SRenderablePtr& rkPtr, bool Transparent);
     void Clear();
     void Draw(const SViewInfo& rkViewInfo);
+
+    // Sorts one sub-bucket without drawing it and returns the renderables in draw order; used by the tests
+    void SortedRenderables(const CCamera *pkCamera, bool Transparent, std::vector<SRenderablePtr>& rOutRenderables);
+
+    inline EDepthGroup DepthGroup() const { return mDepthGroup; }
+
+    static uint32 MaterialSortKey(CMaterial *pMaterial);
 };
 
 #endif // CRENDERBUCKET_H
@@ -17,11 +17,15 @@ uint32 CRenderer::sNumRenderers = 0;
 
 // ************ INITIALIZATION ************
 CRenderer::CRenderer()
-    : mOptions(ERenderOption::EnableUVScroll | ERenderOption::EnableBackfaceCull)
+    : mOptions(ERenderOption::EnableUVScroll | ERenderOption::EnableBackfaceCull | ERenderOption::EnableInstancing)
     , mBloomMode(EBloomMode::NoBloom)
     , mDrawGrid(true)
     , mInitialized(false)
     , mContextIndex(-1)
+    , mBackgroundBucket(EDepthGroup::Background)
+    , mMidgroundBucket(EDepthGroup::Midground)
+    , mForegroundBucket(EDepthGroup::Foreground)
+    , mUIBucket(EDepthGroup::UI)
 {
     sNumRenderers++;
 }
@@ -83,6 +87,12 @@ void CRenderer::ToggleAlphaDisabled(bool Enable)
     else        mOptions &= ~ERenderOption::NoAlpha;
 }
 
+void CRenderer::ToggleInstancing(bool Enable)
+{
+    if (Enable) mOptions |= ERenderOption::EnableInstancing;
+    else        mOptions &= ~ERenderOption::EnableInstancing;
+}
+
 void CRenderer::SetBloom(EBloomMode BloomMode)
 {
     mBloomMode = BloomMode;
@@ -112,6 +122,16 @@ void CRenderer::SetViewportSize(uint32 Width, uint32 Height)
     mBloomVScale = 1.f / mBloomVScale;
 }
 
+const SGLStats& CRenderer::FrameStats() const
+{
+    return mFrameStats;
+}
+
+const SGLStats& CRenderer::BucketStats(EDepthGroup DepthGroup) const
+{
+    return mBucketStats[(int) DepthGroup];
+}
+
 // ************ RENDER ************
 void CRenderer::RenderBuckets(const SViewInfo& rkViewInfo)
 {
@@ -126,21 +146,21 @@ void CRenderer::RenderBuckets(const SViewInfo& rkViewInfo)
     glDepthRange(0.f, 1.f);
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
-    mBackgroundBucket.Draw(rkViewInfo);
-    mBackgroundBucket.Clear();
+    // Group instanced models now that every node has been added
+    mInstanceBatcher.AddToRenderer(this, rkViewInfo);
+
+    DrawBucket(mBackgroundBucket, rkViewInfo);
     ClearDepthBuffer();
-    mMidgroundBucket.Draw(rkViewInfo);
-    mMidgroundBucket.Clear();
+    DrawBucket(mMidgroundBucket, rkViewInfo);
     ClearDepthBuffer();
     RenderBloom();
     ClearDepthBuffer();
     rkViewInfo.pCamera->LoadMatrices();
-    mForegroundBucket.Draw(rkViewInfo);
-    mForegroundBucket.Clear();
+    DrawBucket(mForegroundBucket, rkViewInfo);
     ClearDepthBuffer();
-    mUIBucket.Draw(rkViewInfo);
-    mUIBucket.Clear();
+    DrawBucket(mUIBucket, rkViewInfo);
     ClearDepthBuffer();
+    mInstanceBatcher.Clear();
 }
 
 void CRenderer::RenderBloom()
@@ -285,13 +305,14 @@ void CRenderer::RenderSky(CModel *pSkyboxModel, const SViewInfo& rkViewInfo)
     pSkyboxModel->Draw(mOptions, 0);
 }
 
-void CRenderer::AddMesh(IRenderable *pRenderable, int ComponentIndex, const CAABox& rkAABox, bool Transparent, ERenderCommand Command, EDepthGroup DepthGroup /*= eMidground*/)
+void CRenderer::AddMesh(IRenderable *pRenderable, int ComponentIndex, const CAABox& rkAABox, bool Transparent, ERenderCommand Command, EDepthGroup DepthGroup /*= eMidground*/, CMaterial *pMaterial /*= nullptr*/)
 {
     SRenderablePtr Ptr;
     Ptr.pRenderable = pRenderable;
     Ptr.ComponentIndex = ComponentIndex;
     Ptr.AABox = rkAABox;
     Ptr.Command = Command;
+    Ptr.MaterialSortKey = CRenderBucket::MaterialSortKey(pMaterial);
 
     switch (DepthGroup)
     {
@@ -313,6 +334,11 @@ void CRenderer::AddMesh(IRenderable *pRenderable, int ComponentIndex, const CAAB
     }
 }
 
+void CRenderer::AddInstancedModel(const SInstanceKey& rkKey, const SInstance& rkInstance)
+{
+    mInstanceBatcher.Add(rkKey, rkInstance);
+}
+
 void CRenderer::BeginFrame()
 {
     if (!mInitialized) Init();
@@ -327,6 +353,12 @@ void CRenderer::BeginFrame()
     glViewport(0, 0, mViewportWidth, mViewportHeight);
 
     InitFramebuffer();
+
+    // Other viewports share the GL counters, so stats are measured relative to the start of the frame
+    mFrameStartStats = CGLBackend::Stats();
+
+    for (uint32 iBucket = 0; iBucket < 4; iBucket++)
+        mBucketStats[iBucket].Reset();
 }
 
 void CRenderer::EndFrame()
@@ -336,7 +368,7 @@ void CRenderer::EndFrame()
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mDefaultFramebuffer);
     glViewport(0, 0, mViewportWidth, mViewportHeight);
     glBlitFramebuffer(0, 0, mViewportWidth, mViewportHeight, 0, 0, mViewportWidth, mViewportHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-    gDrawCount = 0;
+    mFrameStats = CGLBackend::Stats() - mFrameStartStats;
 }
 
 void CRenderer::ClearDepthBuffer()
@@ -354,4 +386,11 @@ void CRenderer::InitFramebuffer()
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
-uint32 gDrawCount;
+void CRenderer::DrawBucket(CRenderBucket& rBucket, const SViewInfo& rkViewInfo)
+{
+    SGLStats StartStats = CGLBackend::Stats();
+    rBucket.Draw(rkViewInfo);
+    rBucket.Clear();
+    CDrawUtil::FlushBatches();
+    mBucketStats[(int) rBucket.DepthGroup()] += CGLBackend::Stats() - StartStats;
+}
@@ -7,9 +7,11 @@
 #include "EDepthGroup.h"
 #include "ERenderCommand.h"
 #include "FRenderOptions.h"
+#include "CInstanceBatcher.h"
 #include "SRenderablePtr.h"
 #include "SViewInfo.h"
 #include "Core/OpenGL/CFramebuffer.h"
+#include "Core/OpenGL/CGLBackend.h"
 #include "Core/Resource/CFont.h"
 #include "Core/Resource/CLight.h"
 #include "Core/Resource/CTexture.h"
@@ -42,9 +44,9 @@ enum class EBloomMode
  * just have more abstracted code that gets redirected to OpenGL at a lower level so
  * that other graphics backends could be supported in the future without needing to
  * majorly rewrite everything (but I guess that's the point we're at right now anyway).
- * I'm also pretty sure there's been no attempt made whatsoever to reduce the number of
- * shader/texture state changes needed per frame, outside batching world geometry (via
- * CStaticModel), which might be a performance drain.
+ * Opaque draws are sorted by material when the node passes one to AddMesh (see CRenderBucket),
+ * but most nodes draw several materials per submission, so state changes are only reduced
+ * for world geometry and other per-material submissions.
  *
  * for more complaints about the rendering system implementation, see CSceneNode
  */
@@ -70,6 +72,14 @@ class CRenderer
     CRenderBucket mForegroundBucket;
     CRenderBucket mUIBucket;
 
+    // Script object models that can be drawn with instancing; submitted to the buckets in RenderBuckets()
+    CInstanceBatcher mInstanceBatcher;
+
+    // GL stats for the last completed frame, in total and per depth group
+    SGLStats mFrameStartStats;
+    SGLStats mFrameStats;
+    SGLStats mBucketStats[4];
+
     // Static Members
     static uint32 sNumRenderers;
 
@@ -86,15 +96,19 @@ public:
     void ToggleGrid(bool Enable);
     void ToggleOccluders(bool Enable);
     void ToggleAlphaDisabled(bool Enable);
+    void ToggleInstancing(bool Enable);
     void SetBloom(EBloomMode BloomMode);
     void SetClearColor(const CColor& rkClear);
     void SetViewportSize(uint32 Width, uint32 Height);
+    const SGLStats& FrameStats() const;
+    const SGLStats& BucketStats(EDepthGroup DepthGroup) const;
 
     // Render
     void RenderBuckets(const SViewInfo& rkViewInfo);
     void RenderBloom();
     void RenderSky(CModel *pSkyboxModel, const SViewInfo& rkViewInfo);
-    void AddMesh(IRenderable *pRenderable, int ComponentIndex, const CAABox& rkAABox, bool Transparent, ERenderCommand Command, EDepthGroup DepthGroup = EDepthGroup::Midground);
+    void AddMesh(IRenderable *pRenderable, int ComponentIndex, const CAABox& rkAABox, bool Transparent, ERenderCommand Command, EDepthGroup DepthGroup = EDepthGroup::Midground, CMaterial *pMaterial = nullptr);
+    void AddInstancedModel(const SInstanceKey& rkKey, const SInstance& rkInstance);
     void BeginFrame();
     void EndFrame();
     void ClearDepthBuffer();
@@ -102,8 +116,7 @@ public:
     // Private
 private:
     void InitFramebuffer();
+    void DrawBucket(CRenderBucket& rBucket, const SViewInfo& rkViewInfo);
 };
 
-extern uint32 gDrawCount;
-
 #endif // RENDERMANAGER_H
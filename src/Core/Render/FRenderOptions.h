@@ -11,7 +11,9 @@ enum class ERenderOption
     EnableOccluders     = 0x4,
     NoMaterialSetup     = 0x8,
     EnableBloom         = 0x10,
-    NoAlpha             = 0x20
+    NoAlpha             = 0x20,
+    DrawInstanced       = 0x40,
+    EnableInstancing    = 0x80
 };
 DECLARE_FLAGS_ENUMCLASS(ERenderOption, FRenderOptions)
 
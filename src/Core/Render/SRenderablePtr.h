@@ -12,6 +12,7 @@ struct SRenderablePtr
     uint32 ComponentIndex;
     CAABox AABox;
     ERenderCommand Command;
+    uint32 MaterialSortKey; // Groups opaque draws by material; see CRenderBucket
 };
 
 #endif // SRENDERABLEPTR_H
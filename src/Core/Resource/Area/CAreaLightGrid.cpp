@@ -0,0 +1,197 @@
+#include "CAreaLightGrid.h"
+#include "Core/Resource/CLight.h"
+#include <Common/Macros.h>
+#include <Common/Math/MathUtil.h>
+#include <algorithm>
+#include <cmath>
+
+// Upper limit on the grid resolution along each axis
+const uint32 gkMaxLightGridDims = 32;
+
+CAreaLightGrid::CAreaLightGrid()
+    : mBounds(CAABox::skZero)
+    , mpAmbientLight(nullptr)
+{
+    for (uint32 iAxis = 0; iAxis < 3; iAxis++)
+    {
+        mDims[iAxis] = 1;
+        mCellSize[iAxis] = 1.f;
+    }
+}
+
+void CAreaLightGrid::Build(const std::vector<CLight*>& rkLights)
+{
+    mLights.clear();
+    mGlobalLights.clear();
+    mCellLights.clear();
+    mpAmbientLight = nullptr;
+
+    // Ambient lights apply to the whole layer, so they're kept out of the grid. If there's more
+    // than one, the last one is used.
+    for (uint32 iLight = 0; iLight < rkLights.size(); iLight++)
+    {
+        CLight *pLight = rkLights[iLight];
+
+        if (pLight->Type() == ELightType::LocalAmbient)
+            mpAmbientLight = pLight;
+        else
+            mLights.push_back(pLight);
+    }
+
+    ASSERT(mLights.size() <= 0xFFFF);
+
+    // The grid covers the light positions. Spheres that extend past it are clamped to the edge
+    // cells, and so are queries, so anything outside the bounds still finds the right lights.
+    if (!mLights.empty())
+    {
+        mBounds = CAABox(mLights[0]->Position(), mLights[0]->Position());
+
+        for (uint32 iLight = 1; iLight < mLights.size(); iLight++)
+            mBounds.ExpandBounds(mLights[iLight]->Position());
+    }
+
+    else
+        mBounds = CAABox::skZero;
+
+    CVector3f Size = mBounds.Max() - mBounds.Min();
+    float Extent[3] = { Math::Max(Size.X, 1.f), Math::Max(Size.Y, 1.f), Math::Max(Size.Z, 1.f) };
+
+    // Aim for about one cell per light
+    float TargetCellSize = cbrtf((Extent[0] * Extent[1] * Extent[2]) / Math::Max<float>(mLights.size(), 1.f));
+
+    for (uint32 iAxis = 0; iAxis < 3; iAxis++)
+    {
+        uint32 Dims = (uint32) ceilf(Extent[iAxis] / TargetCellSize);
+        mDims[iAxis] = Math::Clamp<uint32>(1, gkMaxLightGridDims, Dims);
+        mCellSize[iAxis] = Extent[iAxis] / mDims[iAxis];
+    }
+
+    // Find the cell range of each light, then count and fill the cell lists
+    struct SLightCells
+    {
+        uint32 Min[3];
+        uint32 Max[3];
+    };
+    std::vector<SLightCells> LightCells(mLights.size());
+    std::vector<uint32> CellCounts(NumCells(), 0);
+    std::vector<bool> IsGlobal(mLights.size(), false);
+
+    for (uint32 iLight = 0; iLight < mLights.size(); iLight++)
+    {
+        CLight *pLight = mLights[iLight];
+        float Radius = pLight->GetRadius();
+
+        if (!std::isfinite(Radius))
+        {
+            IsGlobal[iLight] = true;
+            continue;
+        }
+
+        CVector3f RadiusVec(Radius, Radius, Radius);
+        SLightCells& rCells = LightCells[iLight];
+        CellRange(CAABox(pLight->Position() - RadiusVec, pLight->Position() + RadiusVec), rCells.Min, rCells.Max);
+
+        // Lights that reach every cell don't need to be stored in all of them
+        bool CoversGrid = true;
+
+        for (uint32 iAxis = 0; iAxis < 3; iAxis++)
+        {
+            if (rCells.Min[iAxis] != 0 || rCells.Max[iAxis] != mDims[iAxis] - 1)
+                CoversGrid = false;
+        }
+
+        if (CoversGrid && NumCells() > 1)
+        {
+            IsGlobal[iLight] = true;
+            continue;
+        }
+
+        for (uint32 Z = rCells.Min[2]; Z <= rCells.Max[2]; Z++)
+            for (uint32 Y = rCells.Min[1]; Y <= rCells.Max[1]; Y++)
+                for (uint32 X = rCells.Min[0]; X <= rCells.Max[0]; X++)
+                    CellCounts[(((Z * mDims[1]) + Y) * mDims[0]) + X]++;
+    }
+
+    mCellStarts.resize(NumCells() + 1);
+    mCellStarts[0] = 0;
+
+    for (uint32 iCell = 0; iCell < NumCells(); iCell++)
+        mCellStarts[iCell + 1] = mCellStarts[iCell] + CellCounts[iCell];
+
+    mCellLights.resize(mCellStarts.back());
+    std::fill(CellCounts.begin(), CellCounts.end(), 0);
+
+    for (uint32 iLight = 0; iLight < mLights.size(); iLight++)
+    {
+        if (IsGlobal[iLight])
+        {
+            mGlobalLights.push_back((uint16) iLight);
+            continue;
+        }
+
+        const SLightCells& rkCells = LightCells[iLight];
+
+        for (uint32 Z = rkCells.Min[2]; Z <= rkCells.Max[2]; Z++)
+            for (uint32 Y = rkCells.Min[1]; Y <= rkCells.Max[1]; Y++)
+                for (uint32 X = rkCells.Min[0]; X <= rkCells.Max[0]; X++)
+                {
+                    uint32 Cell = (((Z * mDims[1]) + Y) * mDims[0]) + X;
+                    mCellLights[mCellStarts[Cell] + CellCounts[Cell]] = (uint16) iLight;
+                    CellCounts[Cell]++;
+                }
+    }
+}
+
+void CAreaLightGrid::FindLights(const CAABox& rkBox, std::vector<CLight*>& rOutLights) const
+{
+    rOutLights.clear();
+    if (mLights.empty()) return;
+
+    uint32 Min[3], Max[3];
+    CellRange(rkBox, Min, Max);
+
+    std::vector<uint16> Indices(mGlobalLights);
+
+    for (uint32 Z = Min[2]; Z <= Max[2]; Z++)
+        for (uint32 Y = Min[1]; Y <= Max[1]; Y++)
+            for (uint32 X = Min[0]; X <= Max[0]; X++)
+            {
+                uint32 Cell = (((Z * mDims[1]) + Y) * mDims[0]) + X;
+                Indices.insert(Indices.end(), mCellLights.begin() + mCellStarts[Cell], mCellLights.begin() + mCellStarts[Cell + 1]);
+            }
+
+    // Lights that span several cells are listed once per cell; sorting also keeps the output in layer order
+    std::sort(Indices.begin(), Indices.end());
+    Indices.erase(std::unique(Indices.begin(), Indices.end()), Indices.end());
+    rOutLights.reserve(Indices.size());
+
+    for (uint32 iIdx = 0; iIdx < Indices.size(); iIdx++)
+        rOutLights.push_back(mLights[Indices[iIdx]]);
+}
+
+void CAreaLightGrid::CellRange(const CAABox& rkBox, uint32 OutMin[3], uint32 OutMax[3]) const
+{
+    const CVector3f& rkGridMin = mBounds.Min();
+    const CVector3f& rkBoxMin = rkBox.Min();
+    const CVector3f& rkBoxMax = rkBox.Max();
+
+    float GridMin[3]    = { rkGridMin.X, rkGridMin.Y, rkGridMin.Z };
+    float BoxMin[3]     = { rkBoxMin.X, rkBoxMin.Y, rkBoxMin.Z };
+    float BoxMax[3]     = { rkBoxMax.X, rkBoxMax.Y, rkBoxMax.Z };
+
+    for (uint32 iAxis = 0; iAxis < 3; iAxis++)
+    {
+        // Clamp before converting so infinite and NaN bounds land on the edge cells
+        float MaxCell = (float) (mDims[iAxis] - 1);
+        float Lo = floorf((BoxMin[iAxis] - GridMin[iAxis]) / mCellSize[iAxis]);
+        float Hi = floorf((BoxMax[iAxis] - GridMin[iAxis]) / mCellSize[iAxis]);
+
+        if (!(Lo > 0.f)) Lo = 0.f;
+        if (!(Lo < MaxCell)) Lo = MaxCell;
+        if (!(Hi > 0.f)) Hi = 0.f;
+        if (!(Hi < MaxCell)) Hi = MaxCell;
+
+        OutMin[iAxis] = (uint32) Lo;
+        OutMax[iAxis] = (uint32) Hi;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef CAREALIGHTGRID_H
+#define CAREALIGHTGRID_H
+
+#include <Common/BasicTypes.h>
+#include <Common/Math/CAABox.h>
+#include <vector>
+
+class CLight;
+
+// Uniform grid over the light spheres of one area light layer. Each cell lists the lights
+// whose sphere bounds overlap it, so the lights that can reach a box are found by visiting
+// only the cells the box covers. Lights are assumed not to move after the grid is built.
+class CAreaLightGrid
+{
+    CAABox mBounds;
+    uint32 mDims[3];
+    float mCellSize[3];
+    std::vector<uint32> mCellStarts;    // Index into mCellLights for each cell, plus one past the end
+    std::vector<uint16> mCellLights;
+    std::vector<uint16> mGlobalLights;  // Lights with no usable bounds; returned from every query
+    std::vector<CLight*> mLights;
+    CLight *mpAmbientLight;
+
+public:
+    CAreaLightGrid();
+    void Build(const std::vector<CLight*>& rkLights);
+
+    // Fills rOutLights with every non-ambient light whose sphere bounds overlap rkBox, without duplicates.
+    // Callers still need to test the light spheres; cells are coarser than the spheres.
+    void FindLights(const CAABox& rkBox, std::vector<CLight*>& rOutLights) const;
+
+    // Accessors
+    inline CLight* AmbientLight() const     { return mpAmbientLight; }
+    inline uint32 NumLights() const         { return mLights.size(); }
+    inline uint32 NumCells() const          { return mDims[0] * mDims[1] * mDims[2]; }
+
+private:
+    void CellRange(const CAABox& rkBox, uint32 OutMin[3], uint32 OutMax[3]) const;
+};
+
+#endif // CAREALIGHTGRID_H
@@ -0,0 +1,91 @@
+#include "CAreaOctree.h"
+
+CAreaOctree::CAreaOctree()
+    : mBounds(CAABox::skInfinite)
+    , mNumMeshes(0)
+    , mBitmapWordCount(0)
+{
+}
+
+uint32 CAreaOctree::FindVisibleMeshes(const CFrustumPlanes& rkFrustum, std::vector<uint8>& rOutVisibleMeshes) const
+{
+    rOutVisibleMeshes.assign(mNumMeshes, 0);
+    if (mNodes.empty()) return 0;
+
+    struct SStackEntry
+    {
+        uint32 NodeIndex;
+        CAABox Bounds;
+    };
+
+    std::vector<SStackEntry> Stack;
+    Stack.reserve(64);
+    Stack.push_back({ 0, mBounds });
+    uint32 NumTested = 0;
+
+    while (!Stack.empty())
+    {
+        SStackEntry Entry = Stack.back();
+        Stack.pop_back();
+
+        const SNode& rkNode = mNodes[Entry.NodeIndex];
+        NumTested++;
+
+        if (!rkFrustum.BoxInFrustum(Entry.Bounds))
+            continue;
+
+        // Leaves flag every mesh in their bitmap
+        if (rkNode.NumChildren == 0)
+        {
+            const uint32 *pkBitmap = &mBitmaps[rkNode.BitmapIndex * mBitmapWordCount];
+
+            for (uint32 iWord = 0; iWord < mBitmapWordCount; iWord++)
+            {
+                uint32 Word = pkBitmap[iWord];
+
+                for (uint32 iBit = 0; Word != 0; iBit++, Word >>= 1)
+                {
+                    uint32 Mesh = (iWord * 32) + iBit;
+
+                    if ((Word & 1) && Mesh < mNumMeshes)
+                        rOutVisibleMeshes[Mesh] = 1;
+                }
+            }
+        }
+
+        else
+        {
+            for (uint32 iChild = 0; iChild < rkNode.NumChildren; iChild++)
+                Stack.push_back({ mChildIndices[rkNode.FirstChild + iChild], ChildBounds(Entry.Bounds, rkNode.SplitAxes, iChild) });
+        }
+    }
+
+    return NumTested;
+}
+
+CAABox CAreaOctree::ChildBounds(const CAABox& rkParentBounds, uint8 SplitAxes, uint32 ChildIndex)
+{
+    // Each split axis consumes one bit of the child index, starting with X
+    const CVector3f& rkMin = rkParentBounds.Min();
+    const CVector3f& rkMax = rkParentBounds.Max();
+    CVector3f Center = rkParentBounds.Center();
+
+    float Min[3]    = { rkMin.X, rkMin.Y, rkMin.Z };
+    float Max[3]    = { rkMax.X, rkMax.Y, rkMax.Z };
+    float Mid[3]    = { Center.X, Center.Y, Center.Z };
+    uint32 Bit = 0;
+
+    for (uint32 iAxis = 0; iAxis < 3; iAxis++)
+    {
+        if ((SplitAxes & (1 << iAxis)) == 0) continue;
+
+        if (ChildIndex & (1 << Bit))
+            Min[iAxis] = Mid[iAxis];
+        else
+            Max[iAxis] = Mid[iAxis];
+
+        Bit++;
+    }
+
+    return CAABox(CVector3f(Min[0], Min[1], Min[2]), CVector3f(Max[0], Max[1], Max[2]));
+}
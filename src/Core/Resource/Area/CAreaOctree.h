@@ -0,0 +1,48 @@
+#ifndef CAREAOCTREE_H
+#define CAREAOCTREE_H
+
+#include <Common/BasicTypes.h>
+#include <Common/Math/CAABox.h>
+#include <Common/Math/CFrustumPlanes.h>
+#include <vector>
+
+// Area render octree (AROT). Each node has a bitmap of the world meshes that overlap it;
+// walking the tree against the view frustum gives the set of meshes that could be visible.
+class CAreaOctree
+{
+    friend class CAreaLoader;
+
+public:
+    struct SNode
+    {
+        uint16 BitmapIndex;
+        uint8 SplitAxes;    // Bit 0 = split on X, bit 1 = split on Y, bit 2 = split on Z. 0 for leaves.
+        uint8 NumChildren;
+        uint32 FirstChild;  // Index into the child index list
+    };
+
+private:
+    CAABox mBounds;
+    uint32 mNumMeshes;
+    uint32 mBitmapWordCount;
+    std::vector<uint32> mBitmaps;
+    std::vector<SNode> mNodes;
+    std::vector<uint16> mChildIndices;
+
+public:
+    CAreaOctree();
+
+    // Fills OutVisibleMeshes with one entry per world mesh; nonzero if the mesh overlaps a visible leaf.
+    // Returns the number of nodes that were tested against the frustum.
+    uint32 FindVisibleMeshes(const CFrustumPlanes& rkFrustum, std::vector<uint8>& rOutVisibleMeshes) const;
+
+    static CAABox ChildBounds(const CAABox& rkParentBounds, uint8 SplitAxes, uint32 ChildIndex);
+
+    // Accessors
+    inline CAABox Bounds() const                { return mBounds; }
+    inline uint32 NumMeshes() const             { return mNumMeshes; }
+    inline uint32 NumNodes() const              { return mNodes.size(); }
+    inline const SNode& Node(uint32 Index) const { return mNodes[Index]; }
+};
+
+#endif // CAREAOCTREE_H
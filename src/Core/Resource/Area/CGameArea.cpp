@@ -1,4 +1,5 @@
 #include "CGameArea.h"
+#include "Core/Resource/Factory/CAreaLoader.h"
 #include "Core/Resource/Script/CScriptLayer.h"
 #include "Core/Render/CRenderer.h"
 
@@ -9,9 +10,11 @@ CGameArea::CGameArea(CResourceEntry *pEntry /*= 0*/)
     , mTriangleCount(0)
     , mTerrainMerged(false)
     , mOriginalWorldMeshCount(0)
+    , mCollisionSectionNum(-1)
     , mUsesCompression(false)
     , mpMaterialSet(nullptr)
     , mpCollision(nullptr)
+    , mCollisionModified(false)
 {
 }
 
@@ -259,3 +262,33 @@ void CGameArea::ClearExtraDependencies()
         Entry()->UpdateDependencies();
     }
 }
+
+void CGameArea::LoadDeferredSections()
+{
+    if (mpDeferredSections)
+        CAreaLoader::LoadDeferredSections(this);
+}
+
+CAreaLightGrid* CGameArea::LightGrid(uint32 LayerIndex)
+{
+    LoadDeferredSections();
+    if (LayerIndex >= mLightLayers.size()) return nullptr;
+    if (mLightGrids.size() != mLightLayers.size()) mLightGrids.resize(mLightLayers.size());
+
+    if (!mLightGrids[LayerIndex])
+    {
+        mLightGrids[LayerIndex] = std::make_unique<CAreaLightGrid>();
+        mLightGrids[LayerIndex]->Build(mLightLayers[LayerIndex]);
+    }
+
+    return mLightGrids[LayerIndex].get();
+}
+
+CGameArea::SSectionView CGameArea::SectionData(uint32 SectionIndex) const
+{
+    if (mSectionOffsets.empty() || SectionIndex >= mSectionOffsets.size() - 1)
+        return SSectionView { nullptr, 0 };
+
+    uint32 Offset = mSectionOffsets[SectionIndex];
+    return SSectionView { mSectionData.data() + Offset, mSectionOffsets[SectionIndex + 1] - Offset };
+}
@@ -1,6 +1,8 @@
 #ifndef CGAMEAREA_H
 #define CGAMEAREA_H
 
+#include "CAreaLightGrid.h"
+#include "CAreaOctree.h"
 #include "Core/Resource/CResource.h"
 #include "Core/Resource/CLight.h"
 #include "Core/Resource/CMaterialSet.h"
@@ -24,6 +26,28 @@ class CGameArea : public CResource
     friend class CAreaLoader;
     friend class CAreaCooker;
 
+public:
+    // View of one section in mSectionData. Only valid while the area is loaded.
+    struct SSectionView
+    {
+        const uint8 *pkData;
+        uint32 Size;
+    };
+
+    // World geometry, collision and lights are parsed from the section data on first use;
+    // see CAreaLoader::LoadDeferredSections()
+    struct SDeferredSections
+    {
+        EGame Version;
+        uint32 NumMeshes;
+        uint32 GeometryBlockNum;
+        uint32 GPUBlockNum;
+        uint32 OctreeBlockNum;
+        uint32 CollisionBlockNum;
+        uint32 LightsBlockNum;
+    };
+
+private:
     uint32 mWorldIndex;
     uint32 mVertexCount;
     uint32 mTriangleCount;
@@ -31,9 +55,13 @@ class CGameArea : public CResource
     CTransform4f mTransform;
     CAABox mAABox;
 
-    // Data saved from the original file to help on recook
-    std::vector<std::vector<uint8>> mSectionDataBuffers;
+    // Data saved from the original file to help on recook. All sections are stored back to back in a
+    // single buffer, which is also the buffer the loader parses from, so they're only held in memory once.
+    std::vector<uint8> mSectionData;
+    std::vector<uint32> mSectionOffsets; // One entry per section, plus the end of the last section
+    std::unique_ptr<SDeferredSections> mpDeferredSections;
     uint32 mOriginalWorldMeshCount;
+    uint32 mCollisionSectionNum;
     bool mUsesCompression;
 
     struct SSectionNumber
@@ -47,13 +75,16 @@ class CGameArea : public CResource
     CMaterialSet *mpMaterialSet;
     std::vector<CModel*> mWorldModels; // TerrainModels is the original version of each model; this is currently mainly used in the POI map editor
     std::vector<CStaticModel*> mStaticWorldModels; // StaticTerrainModels is the merged terrain for faster rendering in the world editor
+    std::unique_ptr<CAreaOctree> mpAreaOctree; // Render octree over the world models; only loaded for Prime
     // Script
     std::vector<CScriptLayer*> mScriptLayers;
     std::unordered_map<uint32, CScriptObject*> mObjectMap;
     // Collision
     std::unique_ptr<CCollisionMeshGroup> mpCollision;
+    bool mCollisionModified; // The collision section is regenerated on cook instead of copied from the original file
     // Lights
     std::vector<std::vector<CLight*>> mLightLayers;
+    std::vector<std::unique_ptr<CAreaLightGrid>> mLightGrids; // Spatial index per light layer; built on first use
     // Path Mesh
     CAssetID mPathID;
     // Portal Area
@@ -84,27 +115,37 @@ public:
     void AddInstanceToArea(CScriptObject *pInstance);
     void DeleteInstance(CScriptObject *pInstance);
     void ClearExtraDependencies();
+    void LoadDeferredSections();
+    CAreaLightGrid* LightGrid(uint32 LayerIndex);
+    SSectionView SectionData(uint32 SectionIndex) const;
 
     // Inline Accessors
     inline uint32 WorldIndex() const                                    { return mWorldIndex; }
     inline CTransform4f Transform() const                               { return mTransform; }
     inline CMaterialSet* Materials() const                              { return mpMaterialSet; }
-    inline uint32 NumWorldModels() const                                { return mWorldModels.size(); }
-    inline uint32 NumStaticModels() const                               { return mStaticWorldModels.size(); }
-    inline CModel* TerrainModel(uint32 iMdl) const                      { return mWorldModels[iMdl]; }
-    inline CStaticModel* StaticModel(uint32 iMdl) const                 { return mStaticWorldModels[iMdl]; }
-    inline CCollisionMeshGroup* Collision() const                       { return mpCollision.get(); }
+    inline uint32 NumWorldModels()                                      { LoadDeferredSections(); return mWorldModels.size(); }
+    inline uint32 NumStaticModels()                                     { LoadDeferredSections(); return mStaticWorldModels.size(); }
+    inline CModel* TerrainModel(uint32 iMdl)                            { LoadDeferredSections(); return mWorldModels[iMdl]; }
+    inline CStaticModel* StaticModel(uint32 iMdl)                       { LoadDeferredSections(); return mStaticWorldModels[iMdl]; }
+    inline CAreaOctree* AreaOctree()                                    { LoadDeferredSections(); return mpAreaOctree.get(); }
+    inline CCollisionMeshGroup* Collision()                             { LoadDeferredSections(); return mpCollision.get(); }
     inline uint32 NumScriptLayers() const                               { return mScriptLayers.size(); }
     inline CScriptLayer* ScriptLayer(uint32 Index) const                { return mScriptLayers[Index]; }
-    inline uint32 NumLightLayers() const                                { return mLightLayers.size(); }
-    inline uint32 NumLights(uint32 LayerIndex) const                    { return (LayerIndex < mLightLayers.size() ? mLightLayers[LayerIndex].size() : 0); }
-    inline CLight* Light(uint32 LayerIndex, uint32 LightIndex) const    { return mLightLayers[LayerIndex][LightIndex]; }
+    inline uint32 NumLightLayers()                                      { LoadDeferredSections(); return mLightLayers.size(); }
+    inline uint32 NumLights(uint32 LayerIndex)                          { LoadDeferredSections(); return (LayerIndex < mLightLayers.size() ? mLightLayers[LayerIndex].size() : 0); }
+    inline CLight* Light(uint32 LayerIndex, uint32 LightIndex)          { LoadDeferredSections(); return mLightLayers[LayerIndex][LightIndex]; }
     inline CAssetID PathID() const                                      { return mPathID; }
     inline CPoiToWorld* PoiToWorldMap() const                           { return mpPoiToWorldMap; }
     inline CAssetID PortalAreaID() const                                { return mPortalAreaID; }
-    inline CAABox AABox() const                                         { return mAABox; }
+    inline CAABox AABox()                                               { LoadDeferredSections(); return mAABox; }
+
+    inline bool IsCollisionModified() const                             { return mCollisionModified; }
+    inline bool HasDeferredSections() const                             { return mpDeferredSections != nullptr; }
+    inline uint32 NumSections() const                                   { return (mSectionOffsets.empty() ? 0 : mSectionOffsets.size() - 1); }
+    inline SSectionView OriginalCollisionSection() const                { return SectionData(mCollisionSectionNum); }
 
     inline void SetWorldIndex(uint32 NewWorldIndex)                     { mWorldIndex = NewWorldIndex; }
+    inline void MarkCollisionModified()                                 { mCollisionModified = true; }
 };
 
 #endif // CGAMEAREA_H
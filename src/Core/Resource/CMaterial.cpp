@@ -13,9 +13,14 @@ uint64 CMaterial::sCurrentMaterial = 0;
 CColor CMaterial::sCurrentTint = CColor::skWhite;
 std::map<uint64, CMaterial::SMaterialShader> CMaterial::smShaderMap;
 
+// Instanced shaders are shared through the same map, keyed by the parameter hash with this mixed in
+static const uint64 gkInstancedShaderSalt = 0x9E3779B97F4A7C15ULL;
+
 CMaterial::CMaterial()
     : mpShader(nullptr)
     , mShaderStatus(EShaderStatus::NoShader)
+    , mpInstancedShader(nullptr)
+    , mInstancedShaderStatus(EShaderStatus::NoShader)
     , mRecalcHash(true)
     , mEnableBloom(false)
     , mVersion(EGame::Invalid)
@@ -33,6 +38,8 @@ CMaterial::CMaterial()
 CMaterial::CMaterial(EGame Version, FVertexDescription VtxDesc)
     : mpShader(nullptr)
     , mShaderStatus(EShaderStatus::NoShader)
+    , mpInstancedShader(nullptr)
+    , mInstancedShaderStatus(EShaderStatus::NoShader)
     , mRecalcHash(true)
     , mEnableBloom(Version == EGame::Corruption)
     , mVersion(Version)
@@ -133,40 +140,108 @@ void CMaterial::GenerateShader(bool AllowRegen /*= true*/)
     }
 }
 
-void CMaterial::ClearShader()
+void CMaterial::GenerateInstancedShader()
 {
-    if (mpShader)
+    HashParameters();
+    uint64 ShaderKey = mParametersHash ^ gkInstancedShaderSalt;
+
+    if (mpInstancedShader)
     {
-        auto Find = smShaderMap.find(mParametersHash);
-        ASSERT(Find != smShaderMap.end());
+        ReleaseSharedShader(ShaderKey, mpInstancedShader);
+        mpInstancedShader = nullptr;
+    }
+
+    auto Find = smShaderMap.find(ShaderKey);
 
-        SMaterialShader& rShader = Find->second;
-        ASSERT(rShader.pShader == mpShader);
+    if (Find != smShaderMap.end())
+    {
+        mpInstancedShader = Find->second.pShader;
+        Find->second.NumReferences++;
+        mInstancedShaderStatus = EShaderStatus::ShaderExists;
+    }
 
-        rShader.NumReferences--;
+    else
+    {
+        mpInstancedShader = CShaderGenerator::GenerateShader(*this, true);
 
-        if (rShader.NumReferences == 0)
+        if (!mpInstancedShader->IsValidProgram())
         {
-            delete mpShader;
-            smShaderMap.erase(Find);
+            mInstancedShaderStatus = EShaderStatus::ShaderFailed;
+            delete mpInstancedShader;
+            mpInstancedShader = nullptr;
         }
 
+        else
+        {
+            mInstancedShaderStatus = EShaderStatus::ShaderExists;
+            smShaderMap[ShaderKey] = SMaterialShader { 1, mpInstancedShader };
+        }
+    }
+}
+
+void CMaterial::ClearShader()
+{
+    if (mpShader)
+    {
+        ReleaseSharedShader(mParametersHash, mpShader);
         mpShader = nullptr;
         mShaderStatus = EShaderStatus::NoShader;
     }
+
+    if (mpInstancedShader)
+    {
+        ReleaseSharedShader(mParametersHash ^ gkInstancedShaderSalt, mpInstancedShader);
+        mpInstancedShader = nullptr;
+    }
+
+    mInstancedShaderStatus = EShaderStatus::NoShader;
+}
+
+void CMaterial::ReleaseSharedShader(uint64 ShaderKey, CShader *pShader)
+{
+    auto Find = smShaderMap.find(ShaderKey);
+    ASSERT(Find != smShaderMap.end());
+
+    SMaterialShader& rShader = Find->second;
+    ASSERT(rShader.pShader == pShader);
+
+    rShader.NumReferences--;
+
+    if (rShader.NumReferences == 0)
+    {
+        delete pShader;
+        smShaderMap.erase(Find);
+    }
 }
 
 bool CMaterial::SetCurrent(FRenderOptions Options)
 {
+    bool Instanced = Options.HasFlag(ERenderOption::DrawInstanced);
+    uint64 MaterialKey = HashParameters();
+    if (Instanced) MaterialKey ^= gkInstancedShaderSalt;
+
     // Skip material setup if the currently bound material is identical
-    if (sCurrentMaterial != HashParameters())
+    if (sCurrentMaterial != MaterialKey)
     {
         // Shader setup
-        if (mShaderStatus == EShaderStatus::NoShader) GenerateShader();
-        mpShader->SetCurrent();
+        if (Instanced)
+        {
+            if (mInstancedShaderStatus == EShaderStatus::NoShader) GenerateInstancedShader();
 
-        if (mShaderStatus == EShaderStatus::ShaderFailed)
-            return false;
+            if (mInstancedShaderStatus == EShaderStatus::ShaderFailed)
+                return false;
+
+            mpInstancedShader->SetCurrent();
+        }
+
+        else
+        {
+            if (mShaderStatus == EShaderStatus::NoShader) GenerateShader();
+            mpShader->SetCurrent();
+
+            if (mShaderStatus == EShaderStatus::ShaderFailed)
+                return false;
+        }
 
         // Set RGB blend equation - force to ZERO/ONE if alpha is disabled
         GLenum srcRGB, dstRGB, srcAlpha, dstAlpha;
@@ -208,7 +283,7 @@ bool CMaterial::SetCurrent(FRenderOptions Options)
         for (uint32 iPass = 0; iPass < mPasses.size(); iPass++)
             mPasses[iPass]->SetAnimCurrent(Options, iPass);
 
-        sCurrentMaterial = HashParameters();
+        sCurrentMaterial = MaterialKey;
     }
 
     // If the passes are otherwise the same, update UV anims that use the model matrix
@@ -274,6 +349,25 @@ void CMaterial::Update()
 {
     mRecalcHash = true;
     mShaderStatus = EShaderStatus::NoShader;
+    mInstancedShaderStatus = EShaderStatus::NoShader;
+}
+
+bool CMaterial::SupportsInstancing() const
+{
+    // Skinning and UV animations that are calculated from the model matrix on the CPU need a draw per instance
+    if (mVtxDesc.HasAnyFlags(EVertexAttribute::BoneIndices | EVertexAttribute::BoneWeights))
+        return false;
+
+    for (uint32 iPass = 0; iPass < mPasses.size(); iPass++)
+    {
+        EUVAnimMode Mode = mPasses[iPass]->AnimMode();
+
+        if ((Mode == EUVAnimMode::InverseMV) || (Mode == EUVAnimMode::InverseMVTranslated) ||
+            (Mode == EUVAnimMode::ModelMatrix) || (Mode == EUVAnimMode::SimpleMode))
+            return false;
+    }
+
+    return true;
 }
 
 void CMaterial::SetNumPasses(uint32 NumPasses)
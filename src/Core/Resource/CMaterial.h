@@ -53,6 +53,8 @@ class CMaterial
     TString mName;                  // Name of the material
     CShader *mpShader;              // This material's generated shader. Created with GenerateShader().
     EShaderStatus mShaderStatus;    // A status variable so that PWE won't crash if a shader fails to compile.
+    CShader *mpInstancedShader;     // Variant of the shader used for instanced draws. Created on first use.
+    EShaderStatus mInstancedShaderStatus;
     uint64 mParametersHash;         // A hash of all the parameters that can identify this TEV setup.
     bool mRecalcHash;               // Indicates the hash needs to be recalculated. Set true when parameters are changed.
     bool mEnableBloom;              // Bool that toggles bloom on or off. On by default on MP3 materials, off by default on MP1 materials.
@@ -85,8 +87,10 @@ public:
 
     CMaterial* Clone();
     void GenerateShader(bool AllowRegen = true);
+    void GenerateInstancedShader();
     void ClearShader();
     bool SetCurrent(FRenderOptions Options);
+    bool SupportsInstancing() const;
     uint64 HashParameters();
     void Update();
     void SetNumPasses(uint32 NumPasses);
@@ -116,6 +120,9 @@ public:
 
     // Static
     inline static void KillCachedMaterial() { sCurrentMaterial = 0; }
+
+private:
+    static void ReleaseSharedShader(uint64 ShaderKey, CShader *pShader);
 };
 
 #endif // MATERIAL_H
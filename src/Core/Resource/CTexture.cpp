@@ -1,4 +1,5 @@
 #include "CTexture.h"
+#include "Core/OpenGL/CGLBackend.h"
 
 CTexture::CTexture(CResourceEntry *pEntry /*= 0*/)
     : CResource(pEntry)
@@ -40,7 +41,7 @@ bool CTexture::BufferGL()
 {
     GLenum BindTarget = (mEnableMultisampling ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D);
     glGenTextures(1, &mTextureID);
-    glBindTexture(BindTarget, mTextureID);
+    CGLBackend::BindTexture(BindTarget, mTextureID);
 
     GLenum GLFormat, GLType;
     bool IsCompressed = false;
@@ -86,12 +87,12 @@ bool CTexture::BufferGL()
         if (!IsCompressed)
         {
             if (mEnableMultisampling)
-                glTexImage2DMultisample(BindTarget, 4, GLFormat, MipW, MipH, true);
+                CGLBackend::TexImage2DMultisample(BindTarget, 4, GLFormat, MipW, MipH);
             else
-                glTexImage2D(BindTarget, iMip, GLFormat, MipW, MipH, 0, GLFormat, GLType, pData);
+                CGLBackend::TexImage2D(BindTarget, iMip, GLFormat, MipW, MipH, GLFormat, GLType, MipSize, pData);
         }
         else
-            glCompressedTexImage2D(BindTarget, iMip, GLFormat, MipW, MipH, 0, MipSize, pData);
+            CGLBackend::CompressedTexImage2D(BindTarget, iMip, GLFormat, MipW, MipH, MipSize, pData);
 
         MipW /= 2;
         MipH /= 2;
@@ -123,7 +124,7 @@ void CTexture::Bind(uint32 GLTextureUnit)
         BufferGL();
 
     GLenum BindTarget = (mEnableMultisampling ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D);
-    glBindTexture(BindTarget, mTextureID);
+    CGLBackend::BindTexture(BindTarget, mTextureID);
 }
 
 void CTexture::Resize(uint32 Width, uint32 Height)
@@ -333,7 +334,7 @@ void CTexture::CopyGLBuffer()
     float BytesPerPixel = FormatBPP(mTexelFormat) / 8.f;
 
     GLenum BindTarget = (mEnableMultisampling ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D);
-    glBindTexture(BindTarget, mTextureID);
+    CGLBackend::BindTexture(BindTarget, mTextureID);
 
     for (uint32 iMip = 0; iMip < mNumMipMaps; iMip++)
     {
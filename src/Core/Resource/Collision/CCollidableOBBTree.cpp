@@ -1,4 +1,121 @@
 #include "CCollidableOBBTree.h"
+#include <Common/Macros.h>
+#include <Common/Math/MathUtil.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+/** Max number of triangles stored in a single leaf */
+static const uint gkMaxLeafTriangles = 4;
+
+/** Amount OBBs are padded by during queries, so triangles lying on a box face aren't lost to rounding error */
+static const float gkOBBPadding = 0.001f;
+
+/** Computes the eigenvectors of a symmetric 3x3 matrix using Jacobi rotations */
+static void ComputeEigenVectors(const float (&kMatrix)[3][3], CVector3f (&OutAxes)[3])
+{
+    float A[3][3];
+    float V[3][3] = { {1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}, {0.f, 0.f, 1.f} };
+    memcpy(A, kMatrix, sizeof(A));
+
+    for (uint Sweep = 0; Sweep < 32; Sweep++)
+    {
+        float OffDiagonal = (A[0][1] * A[0][1]) + (A[0][2] * A[0][2]) + (A[1][2] * A[1][2]);
+        if (OffDiagonal < 1e-12f) break;
+
+        static const int skPairs[3][2] = { {0, 1}, {0, 2}, {1, 2} };
+
+        for (uint PairIdx = 0; PairIdx < 3; PairIdx++)
+        {
+            int P = skPairs[PairIdx][0];
+            int Q = skPairs[PairIdx][1];
+            if (fabsf(A[P][Q]) < 1e-12f) continue;
+
+            // Rotate in the PQ plane to zero out A[P][Q]
+            float Theta = (A[Q][Q] - A[P][P]) / (2.f * A[P][Q]);
+            float T = (Theta >= 0.f ? 1.f : -1.f) / (fabsf(Theta) + sqrtf((Theta * Theta) + 1.f));
+            float C = 1.f / sqrtf((T * T) + 1.f);
+            float S = T * C;
+
+            for (int k = 0; k < 3; k++)
+            {
+                float AKP = A[k][P], AKQ = A[k][Q];
+                A[k][P] = (C * AKP) - (S * AKQ);
+                A[k][Q] = (S * AKP) + (C * AKQ);
+            }
+
+            for (int k = 0; k < 3; k++)
+            {
+                float APK = A[P][k], AQK = A[Q][k];
+                A[P][k] = (C * APK) - (S * AQK);
+                A[Q][k] = (S * APK) + (C * AQK);
+            }
+
+            for (int k = 0; k < 3; k++)
+            {
+                float VKP = V[k][P], VKQ = V[k][Q];
+                V[k][P] = (C * VKP) - (S * VKQ);
+                V[k][Q] = (S * VKP) + (C * VKQ);
+            }
+        }
+    }
+
+    // Eigenvectors are the columns of V. Rebuild the last axis so the basis is right-handed.
+    OutAxes[0] = CVector3f(V[0][0], V[1][0], V[2][0]).Normalized();
+    OutAxes[1] = CVector3f(V[0][1], V[1][1], V[2][1]).Normalized();
+    OutAxes[2] = OutAxes[0].Cross(OutAxes[1]).Normalized();
+}
+
+/** Returns the distance at which the ray enters the OBB, or a negative value if it misses or enters past MaxDist */
+static float RayOBBEntry(const CRay& kRay, const SOBBTreeNode& kNode, float MaxDist)
+{
+    const CTransform4f& kTransform = kNode.Transform;
+    CVector3f Delta = CVector3f(kTransform[0][3], kTransform[1][3], kTransform[2][3]) - kRay.Origin();
+    float TMin = 0.f;
+    float TMax = MaxDist;
+
+    for (int AxisIdx = 0; AxisIdx < 3; AxisIdx++)
+    {
+        CVector3f Axis(kTransform[0][AxisIdx], kTransform[1][AxisIdx], kTransform[2][AxisIdx]);
+        float Radius = kNode.Radii[AxisIdx] + gkOBBPadding;
+        float E = Axis.Dot(Delta);
+        float F = Axis.Dot(kRay.Direction());
+
+        if (fabsf(F) > 1e-8f)
+        {
+            float T1 = (E - Radius) / F;
+            float T2 = (E + Radius) / F;
+            if (T1 > T2) std::swap(T1, T2);
+            TMin = Math::Max(TMin, T1);
+            TMax = Math::Min(TMax, T2);
+            if (TMin > TMax) return -1.f;
+        }
+        // Ray is parallel to this slab; miss if the origin is outside it
+        else if (-E - Radius > 0.f || -E + Radius < 0.f)
+            return -1.f;
+    }
+
+    return TMin;
+}
+
+/** Returns the world space AABB enclosing an OBB */
+static CAABox OBBBounds(const SOBBTreeNode& kNode)
+{
+    const CTransform4f& kTransform = kNode.Transform;
+    CVector3f Center(kTransform[0][3], kTransform[1][3], kTransform[2][3]);
+    CVector3f Radii = kNode.Radii + CVector3f(gkOBBPadding);
+    CVector3f Extent;
+
+    for (int Row = 0; Row < 3; Row++)
+    {
+        Extent[Row] = fabsf(kTransform[Row][0]) * Radii.X +
+                      fabsf(kTransform[Row][1]) * Radii.Y +
+                      fabsf(kTransform[Row][2]) * Radii.Z;
+    }
+
+    return CAABox(Center - Extent, Center + Extent);
+}
 
 void CCollidableOBBTree::BuildRenderData()
 {
@@ -11,4 +128,279 @@ void CCollidableOBBTree::BuildRenderData()
 
 void CCollidableOBBTree::BuildOBBTree()
 {
+    uint NumTris = NumTriangles();
+    ASSERT(NumTris <= 0x10000);
+
+    std::vector<uint16> Triangles(NumTris);
+    std::vector<CVector3f> Centroids(NumTris);
+
+    for (uint TriIdx = 0; TriIdx < NumTris; TriIdx++)
+    {
+        CVector3f A, B, C;
+        GetTriangleVertices(TriIdx, A, B, C);
+        Triangles[TriIdx] = (uint16) TriIdx;
+        Centroids[TriIdx] = (A + B + C) / 3.f;
+    }
+
+    if (NumTris > 0)
+    {
+        mpOBBTree = std::unique_ptr<SOBBTreeNode>( BuildOBBNode(Triangles.data(), NumTris, Centroids) );
+    }
+    else
+    {
+        SOBBTreeLeaf* pLeaf = new SOBBTreeLeaf;
+        pLeaf->Transform = CTransform4f::skIdentity;
+        pLeaf->Radii = CVector3f::skZero;
+        mpOBBTree = std::unique_ptr<SOBBTreeNode>(pLeaf);
+    }
+
+    // Keep the bounding hierarchy visualization in sync if it was already generated
+    if (mRenderData.IsBuilt())
+    {
+        mRenderData.BuildBoundingHierarchyRenderData(mpOBBTree.get());
+    }
+}
+
+SOBBTreeNode* CCollidableOBBTree::BuildOBBNode(uint16* pTriangles, uint NumTriangles, const std::vector<CVector3f>& kCentroids) const
+{
+    if (NumTriangles <= gkMaxLeafTriangles)
+    {
+        SOBBTreeLeaf* pLeaf = new SOBBTreeLeaf;
+        pLeaf->TriangleIndices.assign(pTriangles, pTriangles + NumTriangles);
+        FitOBB(pTriangles, NumTriangles, *pLeaf);
+        return pLeaf;
+    }
+
+    SOBBTreeBranch* pBranch = new SOBBTreeBranch;
+    FitOBB(pTriangles, NumTriangles, *pBranch);
+
+    // Try splitting at the mean centroid along each box axis, longest first.
+    // Reject splits that leave one side nearly empty so the tree depth stays logarithmic.
+    int AxisOrder[3] = { 0, 1, 2 };
+    std::sort(AxisOrder, AxisOrder + 3, [pBranch](int Left, int Right) {
+        return pBranch->Radii[Left] > pBranch->Radii[Right];
+    });
+
+    const uint MinSideSize = Math::Max<uint>(NumTriangles / 8, 1);
+    uint SplitIdx = 0;
+
+    for (int OrderIdx = 0; OrderIdx < 3 && SplitIdx == 0; OrderIdx++)
+    {
+        int AxisIdx = AxisOrder[OrderIdx];
+        CVector3f Axis(pBranch->Transform[0][AxisIdx], pBranch->Transform[1][AxisIdx], pBranch->Transform[2][AxisIdx]);
+        float Mean = 0.f;
+
+        for (uint TriIdx = 0; TriIdx < NumTriangles; TriIdx++)
+            Mean += Axis.Dot( kCentroids[pTriangles[TriIdx]] );
+
+        Mean /= (float) NumTriangles;
+
+        uint16* pMid = std::partition(pTriangles, pTriangles + NumTriangles, [&](uint16 Tri) {
+            return Axis.Dot( kCentroids[Tri] ) < Mean;
+        });
+        uint Split = (uint) (pMid - pTriangles);
+
+        if (Split >= MinSideSize && (NumTriangles - Split) >= MinSideSize)
+            SplitIdx = Split;
+    }
+
+    // Fall back to a median split along the longest axis
+    if (SplitIdx == 0)
+    {
+        int AxisIdx = AxisOrder[0];
+        CVector3f Axis(pBranch->Transform[0][AxisIdx], pBranch->Transform[1][AxisIdx], pBranch->Transform[2][AxisIdx]);
+        SplitIdx = NumTriangles / 2;
+
+        std::nth_element(pTriangles, pTriangles + SplitIdx, pTriangles + NumTriangles, [&](uint16 Left, uint16 Right) {
+            return Axis.Dot( kCentroids[Left] ) < Axis.Dot( kCentroids[Right] );
+        });
+    }
+
+    pBranch->pLeft = std::unique_ptr<SOBBTreeNode>( BuildOBBNode(pTriangles, SplitIdx, kCentroids) );
+    pBranch->pRight = std::unique_ptr<SOBBTreeNode>( BuildOBBNode(pTriangles + SplitIdx, NumTriangles - SplitIdx, kCentroids) );
+    return pBranch;
+}
+
+void CCollidableOBBTree::FitOBB(const uint16* pkTriangles, uint NumTriangles, SOBBTreeNode& OutNode) const
+{
+    std::vector<CVector3f> Points;
+    Points.reserve(NumTriangles * 3);
+
+    for (uint TriIdx = 0; TriIdx < NumTriangles; TriIdx++)
+    {
+        CVector3f A, B, C;
+        GetTriangleVertices(pkTriangles[TriIdx], A, B, C);
+        Points.push_back(A);
+        Points.push_back(B);
+        Points.push_back(C);
+    }
+
+    // Orient the box along the principal axes of the vertex distribution
+    CVector3f Mean = CVector3f::skZero;
+
+    for (const CVector3f& kPoint : Points)
+        Mean = Mean + kPoint;
+
+    Mean = Mean / (float) Points.size();
+    float Covariance[3][3] = {};
+
+    for (const CVector3f& kPoint : Points)
+    {
+        CVector3f Delta = kPoint - Mean;
+
+        for (int Row = 0; Row < 3; Row++)
+            for (int Col = 0; Col < 3; Col++)
+                Covariance[Row][Col] += Delta[Row] * Delta[Col];
+    }
+
+    CVector3f PCAAxes[3];
+    ComputeEigenVectors(Covariance, PCAAxes);
+
+    // Flat or axis-aligned geometry often fits an axis-aligned box better, so keep whichever box is smaller
+    static const CVector3f skWorldAxes[3] = { CVector3f(1.f, 0.f, 0.f), CVector3f(0.f, 1.f, 0.f), CVector3f(0.f, 0.f, 1.f) };
+    const CVector3f* pkAxisSets[2] = { PCAAxes, skWorldAxes };
+    float BestArea = FLT_MAX;
+
+    for (const CVector3f* pkAxes : pkAxisSets)
+    {
+        CVector3f Min(FLT_MAX), Max(-FLT_MAX);
+
+        for (const CVector3f& kPoint : Points)
+        {
+            for (int AxisIdx = 0; AxisIdx < 3; AxisIdx++)
+            {
+                float Projection = pkAxes[AxisIdx].Dot(kPoint);
+                Min[AxisIdx] = Math::Min(Min[AxisIdx], Projection);
+                Max[AxisIdx] = Math::Max(Max[AxisIdx], Projection);
+            }
+        }
+
+        CVector3f Radii = (Max - Min) * 0.5f;
+        float Area = (Radii.X * Radii.Y) + (Radii.Y * Radii.Z) + (Radii.Z * Radii.X);
+
+        if (Area < BestArea)
+        {
+            BestArea = Area;
+            CVector3f LocalCenter = (Min + Max) * 0.5f;
+            CVector3f Center = (pkAxes[0] * LocalCenter.X) + (pkAxes[1] * LocalCenter.Y) + (pkAxes[2] * LocalCenter.Z);
+
+            for (int Row = 0; Row < 3; Row++)
+            {
+                for (int AxisIdx = 0; AxisIdx < 3; AxisIdx++)
+                    OutNode.Transform[Row][AxisIdx] = pkAxes[AxisIdx][Row];
+
+                OutNode.Transform[Row][3] = Center[Row];
+            }
+
+            OutNode.Radii = Radii;
+        }
+    }
+}
+
+/** Spatial queries */
+std::pair<bool,float> CCollidableOBBTree::IntersectsRay(const CRay& kRay, bool AllowBackfaces /*= true*/) const
+{
+    if (!mpOBBTree)
+        return CCollisionMesh::IntersectsRay(kRay, AllowBackfaces);
+
+    bool Hit = false;
+    float HitDist = FLT_MAX;
+
+    std::vector<const SOBBTreeNode*> Stack;
+    Stack.reserve(64);
+    Stack.push_back(mpOBBTree.get());
+
+    while (!Stack.empty())
+    {
+        const SOBBTreeNode* pkNode = Stack.back();
+        Stack.pop_back();
+
+        // Skip nodes that are missed entirely, or that start beyond the closest hit found so far
+        if (RayOBBEntry(kRay, *pkNode, HitDist) < 0.f)
+            continue;
+
+        if (pkNode->NodeType == EOBBTreeNodeType::Leaf)
+        {
+            const SOBBTreeLeaf* pkLeaf = static_cast<const SOBBTreeLeaf*>(pkNode);
+
+            for (uint16 TriIdx : pkLeaf->TriangleIndices)
+            {
+                CVector3f A, B, C;
+                GetTriangleVertices(TriIdx, A, B, C);
+                std::pair<bool,float> TriResult = Math::RayTriangleIntersection(kRay, A, B, C, AllowBackfaces);
+
+                if (TriResult.first && TriResult.second < HitDist)
+                {
+                    Hit = true;
+                    HitDist = TriResult.second;
+                }
+            }
+        }
+        else
+        {
+            // Push the farther child first so the nearer one is visited first
+            const SOBBTreeBranch* pkBranch = static_cast<const SOBBTreeBranch*>(pkNode);
+            const SOBBTreeNode* pkNear = pkBranch->pLeft.get();
+            const SOBBTreeNode* pkFar = pkBranch->pRight.get();
+            float NearDist = RayOBBEntry(kRay, *pkNear, HitDist);
+            float FarDist = RayOBBEntry(kRay, *pkFar, HitDist);
+
+            if (NearDist < 0.f || (FarDist >= 0.f && FarDist < NearDist))
+            {
+                std::swap(pkNear, pkFar);
+                std::swap(NearDist, FarDist);
+            }
+
+            if (FarDist >= 0.f)  Stack.push_back(pkFar);
+            if (NearDist >= 0.f) Stack.push_back(pkNear);
+        }
+    }
+
+    return std::pair<bool,float>(Hit, Hit ? HitDist : 0.f);
+}
+
+void CCollidableOBBTree::FindTrianglesInBox(const CAABox& kBox, std::vector<uint>& OutTriangles) const
+{
+    if (!mpOBBTree)
+    {
+        CCollisionMesh::FindTrianglesInBox(kBox, OutTriangles);
+        return;
+    }
+
+    std::vector<const SOBBTreeNode*> Stack;
+    Stack.reserve(64);
+    Stack.push_back(mpOBBTree.get());
+
+    while (!Stack.empty())
+    {
+        const SOBBTreeNode* pkNode = Stack.back();
+        Stack.pop_back();
+
+        if (!BoxesOverlap(kBox, OBBBounds(*pkNode)))
+            continue;
+
+        if (pkNode->NodeType == EOBBTreeNodeType::Leaf)
+        {
+            const SOBBTreeLeaf* pkLeaf = static_cast<const SOBBTreeLeaf*>(pkNode);
+
+            for (uint16 TriIdx : pkLeaf->TriangleIndices)
+            {
+                CVector3f A, B, C;
+                GetTriangleVertices(TriIdx, A, B, C);
+
+                CAABox TriBox(A, A);
+                TriBox.ExpandBounds(B);
+                TriBox.ExpandBounds(C);
+
+                if (BoxesOverlap(kBox, TriBox))
+                    OutTriangles.push_back(TriIdx);
+            }
+        }
+        else
+        {
+            const SOBBTreeBranch* pkBranch = static_cast<const SOBBTreeBranch*>(pkNode);
+            Stack.push_back(pkBranch->pRight.get());
+            Stack.push_back(pkBranch->pLeft.get());
+        }
+    }
 }
@@ -13,13 +13,22 @@ class CCollidableOBBTree : public CCollisionMesh
 public:
     virtual void BuildRenderData() override;
 
+    /** Rebuild the OBB tree from the current index data */
     void BuildOBBTree();
 
+    /** Spatial queries that walk the OBB tree */
+    virtual std::pair<bool,float> IntersectsRay(const CRay& kRay, bool AllowBackfaces = true) const override;
+    virtual void FindTrianglesInBox(const CAABox& kBox, std::vector<uint>& OutTriangles) const override;
+
     /** Accessors */
     inline SOBBTreeNode* GetOBBTree() const
     {
         return mpOBBTree.get();
     }
+
+protected:
+    SOBBTreeNode* BuildOBBNode(uint16* pTriangles, uint NumTriangles, const std::vector<CVector3f>& kCentroids) const;
+    void FitOBB(const uint16* pkTriangles, uint NumTriangles, SOBBTreeNode& OutNode) const;
 };
 
 #endif // CCOLLIDABLEOBBTREE_H
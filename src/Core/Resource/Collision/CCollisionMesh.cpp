@@ -1,4 +1,5 @@
 #include "CCollisionMesh.h"
+#include <Common/Math/MathUtil.h>
 
 void CCollisionMesh::BuildRenderData()
 {
@@ -7,3 +8,93 @@ void CCollisionMesh::BuildRenderData()
         mRenderData.BuildRenderData(mIndexData);
     }
 }
+
+void CCollisionMesh::BuildRenderData(const CCollisionOctree* pkOctree)
+{
+    if (!mRenderData.IsBuilt())
+    {
+        mRenderData.BuildRenderData(mIndexData, pkOctree);
+    }
+}
+
+/** Triangle access */
+uint CCollisionMesh::NumTriangles() const
+{
+    // Apparently some collision meshes have more triangle indices than actual triangles
+    return Math::Min<uint>(mIndexData.TriangleIndices.size() / 3, mIndexData.TriangleMaterialIndices.size());
+}
+
+void CCollisionMesh::GetTriangleVertices(uint TriIdx, CVector3f& OutA, CVector3f& OutB, CVector3f& OutC) const
+{
+    // Triangles reference edges rather than vertices; recover the vertices from the first two edges
+    uint16 LineA = mIndexData.TriangleIndices[ (TriIdx*3)+0 ];
+    uint16 LineB = mIndexData.TriangleIndices[ (TriIdx*3)+1 ];
+    uint16 LineAVertA = mIndexData.EdgeIndices[ (LineA*2)+0 ];
+    uint16 LineAVertB = mIndexData.EdgeIndices[ (LineA*2)+1 ];
+    uint16 LineBVertA = mIndexData.EdgeIndices[ (LineB*2)+0 ];
+    uint16 LineBVertB = mIndexData.EdgeIndices[ (LineB*2)+1 ];
+    uint16 VertIdx0 = LineAVertA;
+    uint16 VertIdx1 = LineAVertB;
+    uint16 VertIdx2 = (LineBVertA != LineAVertA && LineBVertA != LineAVertB ? LineBVertA : LineBVertB);
+
+    const CCollisionMaterial& kMaterial = mIndexData.Materials[ mIndexData.TriangleMaterialIndices[TriIdx] ];
+
+    if (kMaterial & eCF_FlippedTri)
+    {
+        uint16 Tmp = VertIdx0;
+        VertIdx0 = VertIdx2;
+        VertIdx2 = Tmp;
+    }
+
+    OutA = mIndexData.Vertices[VertIdx0];
+    OutB = mIndexData.Vertices[VertIdx1];
+    OutC = mIndexData.Vertices[VertIdx2];
+}
+
+/** Spatial queries */
+std::pair<bool,float> CCollisionMesh::IntersectsRay(const CRay& kRay, bool AllowBackfaces /*= true*/) const
+{
+    bool Hit = false;
+    float HitDist = 0.f;
+    uint NumTris = NumTriangles();
+
+    for (uint TriIdx = 0; TriIdx < NumTris; TriIdx++)
+    {
+        CVector3f A, B, C;
+        GetTriangleVertices(TriIdx, A, B, C);
+        std::pair<bool,float> TriResult = Math::RayTriangleIntersection(kRay, A, B, C, AllowBackfaces);
+
+        if (TriResult.first && (!Hit || TriResult.second < HitDist))
+        {
+            Hit = true;
+            HitDist = TriResult.second;
+        }
+    }
+
+    return std::pair<bool,float>(Hit, HitDist);
+}
+
+void CCollisionMesh::FindTrianglesInBox(const CAABox& kBox, std::vector<uint>& OutTriangles) const
+{
+    uint NumTris = NumTriangles();
+
+    for (uint TriIdx = 0; TriIdx < NumTris; TriIdx++)
+    {
+        CVector3f A, B, C;
+        GetTriangleVertices(TriIdx, A, B, C);
+
+        CAABox TriBox(A, A);
+        TriBox.ExpandBounds(B);
+        TriBox.ExpandBounds(C);
+
+        if (BoxesOverlap(kBox, TriBox))
+            OutTriangles.push_back(TriIdx);
+    }
+}
+
+bool CCollisionMesh::BoxesOverlap(const CAABox& kA, const CAABox& kB)
+{
+    return (kA.Min().X <= kB.Max().X && kA.Max().X >= kB.Min().X &&
+            kA.Min().Y <= kB.Max().Y && kA.Max().Y >= kB.Min().Y &&
+            kA.Min().Z <= kB.Max().Z && kA.Max().Z >= kB.Min().Z);
+}
@@ -2,9 +2,12 @@
 #define CCOLLISIONMESH_H
 
 #include "CCollisionMaterial.h"
+#include "CCollisionOctree.h"
 #include "CCollisionRenderData.h"
 #include "SCollisionIndexData.h"
 #include <Common/Math/CAABox.h>
+#include <Common/Math/CRay.h>
+#include <vector>
 
 /** Base class of collision geometry */
 class CCollisionMesh
@@ -17,8 +20,20 @@ protected:
     CCollisionRenderData    mRenderData;
 
 public:
+    virtual ~CCollisionMesh() {}
     virtual void BuildRenderData();
 
+    /** Build render data grouped by the leaves of an area collision octree, so it can be culled per leaf */
+    void BuildRenderData(const CCollisionOctree* pkOctree);
+
+    /** Triangle access. Vertices are returned in render winding order (flipped triangles are reversed) */
+    uint NumTriangles() const;
+    void GetTriangleVertices(uint TriIdx, CVector3f& OutA, CVector3f& OutB, CVector3f& OutC) const;
+
+    /** Spatial queries in mesh space. The base implementations test every triangle */
+    virtual std::pair<bool,float> IntersectsRay(const CRay& kRay, bool AllowBackfaces = true) const;
+    virtual void FindTrianglesInBox(const CAABox& kBox, std::vector<uint>& OutTriangles) const;
+
     /** Accessors */
     inline CAABox Bounds() const
     {
@@ -39,6 +54,9 @@ public:
     {
         return mRenderData;
     }
+
+protected:
+    static bool BoxesOverlap(const CAABox& kA, const CAABox& kB);
 };
 
 #endif // CCOLLISIONMESH_H
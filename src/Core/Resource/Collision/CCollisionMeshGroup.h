@@ -2,9 +2,11 @@
 #define CCOLLISIONMESHGROUP_H
 
 #include "CCollisionMesh.h"
+#include "CCollisionOctree.h"
 #include "Core/Resource/CResource.h"
 #include "Core/Resource/TResPtr.h"
 #include <Common/Math/CTransform4f.h>
+#include <memory>
 #include <vector>
 
 class CCollisionMeshGroup : public CResource
@@ -12,6 +14,9 @@ class CCollisionMeshGroup : public CResource
     DECLARE_RESOURCE_TYPE(DynamicCollision)
     std::vector<CCollisionMesh*> mMeshes;
 
+    // Area collision only: octree over the triangles of the first mesh
+    std::unique_ptr<CCollisionOctree> mpOctree;
+
 public:
     CCollisionMeshGroup(CResourceEntry *pEntry = 0) : CResource(pEntry) {}
 
@@ -24,11 +29,19 @@ public:
     inline uint32 NumMeshes() const                         { return mMeshes.size(); }
     inline CCollisionMesh* MeshByIndex(uint32 Index) const  { return mMeshes[Index]; }
     inline void AddMesh(CCollisionMesh *pMesh)              { mMeshes.push_back(pMesh); }
+    inline CCollisionOctree* Octree() const                 { return mpOctree.get(); }
+    inline void SetOctree(CCollisionOctree *pOctree)        { mpOctree.reset(pOctree); }
 
     inline void BuildRenderData()
     {
-        for (auto It = mMeshes.begin(); It != mMeshes.end(); It++)
-            (*It)->BuildRenderData();
+        for (uint32 MeshIdx = 0; MeshIdx < mMeshes.size(); MeshIdx++)
+        {
+            // Area collision render data is grouped by octree leaf so it can be culled
+            if (MeshIdx == 0 && mpOctree)
+                mMeshes[MeshIdx]->BuildRenderData(mpOctree.get());
+            else
+                mMeshes[MeshIdx]->BuildRenderData();
+        }
     }
 
     inline void Draw()
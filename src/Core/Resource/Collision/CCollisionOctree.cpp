@@ -0,0 +1,523 @@
+#include "CCollisionOctree.h"
+#include "CCollisionMesh.h"
+#include "Core/ParallelUtil.h"
+#include <Common/Log.h>
+#include <Common/Math/MathUtil.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <memory>
+
+/** Subdivision limits for generated octrees */
+const uint gkMaxLeafTriangles = 16;
+const uint gkMaxOctreeDepth = 7;
+
+/** Octant boxes are padded by this much when assigning triangles so triangles lying on a split plane go to both sides */
+const float gkOctantEpsilon = 0.001f;
+
+/** Number of levels that are subdivided up front before the remaining subtrees are built in parallel */
+const uint gkSerialBuildLevels = 2;
+
+/** Returns the distance at which the ray enters the box, or a negative value if it misses or enters past MaxDist */
+static float RayBoxEntry(const CRay& kRay, const CAABox& kBox, float MaxDist)
+{
+    const CVector3f& kOrigin = kRay.Origin();
+    const CVector3f& kDir = kRay.Direction();
+    const CVector3f& kMin = kBox.Min();
+    const CVector3f& kMax = kBox.Max();
+    float TMin = 0.f;
+    float TMax = MaxDist;
+
+    for (int Axis = 0; Axis < 3; Axis++)
+    {
+        if (fabsf(kDir[Axis]) > 1e-8f)
+        {
+            float InvDir = 1.f / kDir[Axis];
+            float T1 = (kMin[Axis] - kOrigin[Axis]) * InvDir;
+            float T2 = (kMax[Axis] - kOrigin[Axis]) * InvDir;
+            if (T1 > T2) std::swap(T1, T2);
+            TMin = Math::Max(TMin, T1);
+            TMax = Math::Min(TMax, T2);
+            if (TMin > TMax) return -1.f;
+        }
+        // Ray is parallel to this slab; miss if the origin is outside it
+        else if (kOrigin[Axis] < kMin[Axis] || kOrigin[Axis] > kMax[Axis])
+            return -1.f;
+    }
+
+    return TMin;
+}
+
+/** Triangle/box overlap test using the separating axis theorem; pkTri points to the three triangle vertices */
+static bool TriangleOverlapsBox(const CVector3f* pkTri, const CVector3f& kCenter, const CVector3f& kHalfSize)
+{
+    CVector3f V[3] = { pkTri[0] - kCenter, pkTri[1] - kCenter, pkTri[2] - kCenter };
+
+    // Box face axes
+    for (int Axis = 0; Axis < 3; Axis++)
+    {
+        float Min = Math::Min(V[0][Axis], Math::Min(V[1][Axis], V[2][Axis]));
+        float Max = Math::Max(V[0][Axis], Math::Max(V[1][Axis], V[2][Axis]));
+        if (Min > kHalfSize[Axis] || Max < -kHalfSize[Axis]) return false;
+    }
+
+    // Triangle normal
+    CVector3f Edges[3] = { V[1] - V[0], V[2] - V[1], V[0] - V[2] };
+    CVector3f Normal = Edges[0].Cross(Edges[1]);
+    float PlaneDist = Normal.Dot(V[0]);
+    float PlaneRadius = kHalfSize.X * fabsf(Normal.X) + kHalfSize.Y * fabsf(Normal.Y) + kHalfSize.Z * fabsf(Normal.Z);
+    if (fabsf(PlaneDist) > PlaneRadius) return false;
+
+    // Cross products of the box axes with the triangle edges
+    for (int EdgeIdx = 0; EdgeIdx < 3; EdgeIdx++)
+    {
+        const CVector3f& kEdge = Edges[EdgeIdx];
+        CVector3f Axes[3] = {
+            CVector3f(0.f, -kEdge.Z, kEdge.Y),
+            CVector3f(kEdge.Z, 0.f, -kEdge.X),
+            CVector3f(-kEdge.Y, kEdge.X, 0.f)
+        };
+
+        for (int AxisIdx = 0; AxisIdx < 3; AxisIdx++)
+        {
+            const CVector3f& kAxis = Axes[AxisIdx];
+            float P0 = kAxis.Dot(V[0]);
+            float P1 = kAxis.Dot(V[1]);
+            float P2 = kAxis.Dot(V[2]);
+            float Radius = kHalfSize.X * fabsf(kAxis.X) + kHalfSize.Y * fabsf(kAxis.Y) + kHalfSize.Z * fabsf(kAxis.Z);
+
+            if (Math::Min(P0, Math::Min(P1, P2)) > Radius || Math::Max(P0, Math::Max(P1, P2)) < -Radius)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/** Temporary node used during generation; the finished tree is flattened into the node array */
+struct CCollisionOctree::SBuildNode
+{
+    CAABox                      Bounds;
+    uint                        Depth;
+    bool                        IsLeaf;
+    std::vector<uint16>         Triangles;
+    std::unique_ptr<SBuildNode> Children[8];
+
+    SBuildNode(const CAABox& kBounds, uint NodeDepth)
+        : Bounds(kBounds), Depth(NodeDepth), IsLeaf(false)
+    {}
+};
+
+static bool ShouldSplitBuildNode(const CCollisionOctree::SBuildNode& kNode)
+{
+    return kNode.Triangles.size() > gkMaxLeafTriangles && kNode.Depth < gkMaxOctreeDepth;
+}
+
+/** Distributes the node's triangles between its octants. Empty octants get no child */
+static void SplitBuildNode(CCollisionOctree::SBuildNode& rNode, const std::vector<CVector3f>& kTriVerts)
+{
+    const CVector3f kEpsilon(gkOctantEpsilon, gkOctantEpsilon, gkOctantEpsilon);
+
+    for (uint Octant = 0; Octant < 8; Octant++)
+    {
+        CAABox ChildBounds = CCollisionOctree::OctantBounds(rNode.Bounds, Octant);
+        CVector3f Center = ChildBounds.Center();
+        CVector3f HalfSize = (ChildBounds.Size() * 0.5f) + kEpsilon;
+        std::vector<uint16> ChildTris;
+
+        for (uint16 TriIdx : rNode.Triangles)
+        {
+            if (TriangleOverlapsBox(&kTriVerts[TriIdx * 3], Center, HalfSize))
+                ChildTris.push_back(TriIdx);
+        }
+
+        if (!ChildTris.empty())
+        {
+            rNode.Children[Octant] = std::unique_ptr<CCollisionOctree::SBuildNode>( new CCollisionOctree::SBuildNode(ChildBounds, rNode.Depth + 1) );
+            rNode.Children[Octant]->Triangles = std::move(ChildTris);
+        }
+    }
+
+    std::vector<uint16>().swap(rNode.Triangles);
+}
+
+static void BuildSubtree(CCollisionOctree::SBuildNode& rNode, const std::vector<CVector3f>& kTriVerts)
+{
+    if (!ShouldSplitBuildNode(rNode))
+    {
+        rNode.IsLeaf = true;
+        return;
+    }
+
+    SplitBuildNode(rNode, kTriVerts);
+
+    for (uint Octant = 0; Octant < 8; Octant++)
+    {
+        if (rNode.Children[Octant])
+            BuildSubtree(*rNode.Children[Octant], kTriVerts);
+    }
+}
+
+void CCollisionOctree::Clear()
+{
+    mNodes.clear();
+    mTriangleIndices.clear();
+    mNumLeaves = 0;
+}
+
+/** Generation */
+CCollisionOctree* CCollisionOctree::Build(const CCollisionMesh& kMesh, const CAABox& kBounds)
+{
+    CCollisionOctree* pOctree = new CCollisionOctree;
+    uint NumTris = kMesh.NumTriangles();
+
+    // Leaves reference triangles with 16-bit indices
+    if (NumTris > 0x10000)
+    {
+        errorf("Unable to build collision octree; mesh has %d triangles, maximum is 65536", NumTris);
+        return pOctree;
+    }
+
+    // Cache triangle vertices up front; resolving them through the edge list is comparatively slow
+    std::vector<CVector3f> TriVerts(NumTris * 3);
+
+    for (uint TriIdx = 0; TriIdx < NumTris; TriIdx++)
+        kMesh.GetTriangleVertices(TriIdx, TriVerts[TriIdx*3 + 0], TriVerts[TriIdx*3 + 1], TriVerts[TriIdx*3 + 2]);
+
+    SBuildNode Root(kBounds, 0);
+    Root.Triangles.resize(NumTris);
+
+    for (uint TriIdx = 0; TriIdx < NumTris; TriIdx++)
+        Root.Triangles[TriIdx] = (uint16) TriIdx;
+
+    // Subdivide the top levels serially, then build the resulting subtrees in parallel.
+    // Each subtree only touches its own nodes, and the final layout is decided by the serial
+    // flatten below, so the result does not depend on how jobs are scheduled.
+    std::vector<SBuildNode*> Frontier(1, &Root);
+
+    for (uint Level = 0; Level < gkSerialBuildLevels && !Frontier.empty(); Level++)
+    {
+        std::vector<SBuildNode*> NextFrontier;
+
+        for (SBuildNode* pNode : Frontier)
+        {
+            if (!ShouldSplitBuildNode(*pNode))
+            {
+                pNode->IsLeaf = true;
+                continue;
+            }
+
+            SplitBuildNode(*pNode, TriVerts);
+
+            for (uint Octant = 0; Octant < 8; Octant++)
+            {
+                if (pNode->Children[Octant])
+                    NextFrontier.push_back(pNode->Children[Octant].get());
+            }
+        }
+
+        Frontier = std::move(NextFrontier);
+    }
+
+    ParallelUtil::ParallelFor(Frontier.size(), [&](uint Index, uint)
+    {
+        BuildSubtree(*Frontier[Index], TriVerts);
+    });
+
+    pOctree->mNodes.emplace_back();
+    pOctree->FlattenBuildNode(Root, 0);
+    return pOctree;
+}
+
+void CCollisionOctree::FlattenBuildNode(const SBuildNode& kBuildNode, uint NodeIdx)
+{
+    if (kBuildNode.IsLeaf)
+    {
+        SNode& rNode = mNodes[NodeIdx];
+        rNode.Type = ECollisionOctreeNodeType::Leaf;
+        rNode.Bounds = kBuildNode.Bounds;
+        rNode.Start = mTriangleIndices.size();
+        rNode.Count = (uint16) kBuildNode.Triangles.size();
+        rNode.LeafIndex = mNumLeaves++;
+        rNode.ChildMask = 0;
+        mTriangleIndices.insert(mTriangleIndices.end(), kBuildNode.Triangles.begin(), kBuildNode.Triangles.end());
+        return;
+    }
+
+    // Same layout as parsed trees: children are allocated contiguously, then their subtrees are appended
+    uint8 ChildMask = 0;
+
+    for (uint Octant = 0; Octant < 8; Octant++)
+    {
+        if (kBuildNode.Children[Octant])
+            ChildMask |= (1 << Octant);
+    }
+
+    uint FirstChild = mNodes.size();
+    SNode& rNode = mNodes[NodeIdx];
+    rNode.Type = ECollisionOctreeNodeType::Branch;
+    rNode.Bounds = kBuildNode.Bounds;
+    rNode.Start = FirstChild;
+    rNode.Count = 0;
+    rNode.LeafIndex = 0;
+    rNode.ChildMask = ChildMask;
+    mNodes.resize(FirstChild + NumChildren(rNode));
+
+    uint ChildIdx = FirstChild;
+
+    for (uint Octant = 0; Octant < 8; Octant++)
+    {
+        if (kBuildNode.Children[Octant])
+            FlattenBuildNode(*kBuildNode.Children[Octant], ChildIdx++);
+    }
+}
+
+/** Serialization */
+void CCollisionOctree::Write(IOutputStream& Out) const
+{
+    if (mNodes.empty()) return;
+
+    std::vector<uint32> EncodedSizes;
+    CalculateEncodedSizes(EncodedSizes);
+    WriteNode(Out, 0, EncodedSizes);
+}
+
+uint32 CCollisionOctree::EncodedSize() const
+{
+    if (mNodes.empty()) return 0;
+
+    std::vector<uint32> EncodedSizes;
+    CalculateEncodedSizes(EncodedSizes);
+    return EncodedSizes[0];
+}
+
+ECollisionOctreeNodeType CCollisionOctree::RootType() const
+{
+    return mNodes.empty() ? ECollisionOctreeNodeType::Invalid : mNodes[0].Type;
+}
+
+void CCollisionOctree::CalculateEncodedSizes(std::vector<uint32>& OutSizes) const
+{
+    // Children are always stored after their parent, so a reverse pass sees every subtree before its root
+    OutSizes.assign(mNodes.size(), 0);
+
+    for (uint NodeIdx = mNodes.size(); NodeIdx-- > 0; )
+    {
+        const SNode& kNode = mNodes[NodeIdx];
+
+        if (kNode.Type == ECollisionOctreeNodeType::Leaf)
+            OutSizes[NodeIdx] = 26 + (kNode.Count * 2);
+
+        else if (kNode.Type == ECollisionOctreeNodeType::Branch)
+        {
+            uint32 Size = 36;
+            uint NumChildren = CCollisionOctree::NumChildren(kNode);
+
+            for (uint ChildIdx = 0; ChildIdx < NumChildren; ChildIdx++)
+                Size += OutSizes[kNode.Start + ChildIdx];
+
+            OutSizes[NodeIdx] = Size;
+        }
+    }
+}
+
+void CCollisionOctree::WriteNode(IOutputStream& Out, uint NodeIdx, const std::vector<uint32>& kEncodedSizes) const
+{
+    const SNode& kNode = mNodes[NodeIdx];
+
+    if (kNode.Type == ECollisionOctreeNodeType::Leaf)
+    {
+        kNode.Bounds.Write(Out);
+        Out.WriteShort(kNode.Count);
+
+        const uint16* pkTris = LeafTriangles(kNode);
+
+        for (uint TriIdx = 0; TriIdx < kNode.Count; TriIdx++)
+            Out.WriteShort(pkTris[TriIdx]);
+    }
+
+    else if (kNode.Type == ECollisionOctreeNodeType::Branch)
+    {
+        // Child subtrees are written depth-first in octant order, directly after the branch header
+        uint16 ChildFlags = 0;
+        uint32 ChildOffsets[8] = { 0 };
+        uint32 Offset = 0;
+        uint ChildIdx = kNode.Start;
+
+        for (uint Octant = 0; Octant < 8; Octant++)
+        {
+            if ((kNode.ChildMask & (1 << Octant)) == 0) continue;
+
+            ChildFlags |= ((uint16) mNodes[ChildIdx].Type) << (Octant * 2);
+            ChildOffsets[Octant] = Offset;
+            Offset += kEncodedSizes[ChildIdx];
+            ChildIdx++;
+        }
+
+        Out.WriteShort(ChildFlags);
+        Out.WriteShort(0);
+
+        for (uint Octant = 0; Octant < 8; Octant++)
+            Out.WriteLong(ChildOffsets[Octant]);
+
+        uint NumChildren = CCollisionOctree::NumChildren(kNode);
+
+        for (ChildIdx = 0; ChildIdx < NumChildren; ChildIdx++)
+            WriteNode(Out, kNode.Start + ChildIdx, kEncodedSizes);
+    }
+}
+
+/** Queries */
+std::pair<bool,float> CCollisionOctree::IntersectsRay(const CRay& kRay, const CCollisionMesh& kMesh, bool AllowBackfaces /*= true*/) const
+{
+    if (mNodes.empty())
+        return kMesh.IntersectsRay(kRay, AllowBackfaces);
+
+    bool Hit = false;
+    float HitDist = FLT_MAX;
+    uint NumMeshTris = kMesh.NumTriangles();
+
+    std::vector<uint> Stack;
+    Stack.reserve(64);
+    Stack.push_back(0);
+
+    while (!Stack.empty())
+    {
+        const SNode& kNode = mNodes[Stack.back()];
+        Stack.pop_back();
+
+        if (RayBoxEntry(kRay, kNode.Bounds, HitDist) < 0.f)
+            continue;
+
+        if (kNode.Type == ECollisionOctreeNodeType::Leaf)
+        {
+            const uint16* pkTris = LeafTriangles(kNode);
+
+            for (uint TriIdx = 0; TriIdx < kNode.Count; TriIdx++)
+            {
+                if (pkTris[TriIdx] >= NumMeshTris) continue;
+
+                CVector3f A, B, C;
+                kMesh.GetTriangleVertices(pkTris[TriIdx], A, B, C);
+                std::pair<bool,float> TriResult = Math::RayTriangleIntersection(kRay, A, B, C, AllowBackfaces);
+
+                if (TriResult.first && TriResult.second < HitDist)
+                {
+                    Hit = true;
+                    HitDist = TriResult.second;
+                }
+            }
+        }
+        else if (kNode.Type == ECollisionOctreeNodeType::Branch)
+        {
+            // Visit nearer children first so farther ones can be rejected against the closest hit
+            uint NumChildren = CCollisionOctree::NumChildren(kNode);
+            std::pair<float,uint> Children[8];
+            uint NumHitChildren = 0;
+
+            for (uint ChildIdx = 0; ChildIdx < NumChildren; ChildIdx++)
+            {
+                uint NodeIdx = kNode.Start + ChildIdx;
+                float Entry = RayBoxEntry(kRay, mNodes[NodeIdx].Bounds, HitDist);
+
+                if (Entry >= 0.f)
+                    Children[NumHitChildren++] = std::pair<float,uint>(Entry, NodeIdx);
+            }
+
+            std::sort(Children, Children + NumHitChildren);
+
+            for (uint ChildIdx = NumHitChildren; ChildIdx-- > 0; )
+                Stack.push_back(Children[ChildIdx].second);
+        }
+    }
+
+    return std::pair<bool,float>(Hit, Hit ? HitDist : 0.f);
+}
+
+void CCollisionOctree::FindVisibleLeaves(const CFrustumPlanes& kFrustum, const CTransform4f& kTransform, std::vector<uint8>& OutVisible) const
+{
+    OutVisible.assign(mNumLeaves, 0);
+    if (mNodes.empty()) return;
+
+    std::vector<uint> Stack;
+    Stack.reserve(64);
+    Stack.push_back(0);
+
+    while (!Stack.empty())
+    {
+        const SNode& kNode = mNodes[Stack.back()];
+        Stack.pop_back();
+
+        if (!kFrustum.BoxInFrustum( kNode.Bounds.Transformed(kTransform) ))
+            continue;
+
+        if (kNode.Type == ECollisionOctreeNodeType::Leaf)
+            OutVisible[kNode.LeafIndex] = 1;
+
+        else if (kNode.Type == ECollisionOctreeNodeType::Branch)
+        {
+            uint NumChildren = CCollisionOctree::NumChildren(kNode);
+
+            for (uint ChildIdx = 0; ChildIdx < NumChildren; ChildIdx++)
+                Stack.push_back(kNode.Start + ChildIdx);
+        }
+    }
+}
+
+void CCollisionOctree::BuildTriangleLeafMap(uint NumTriangles, std::vector<uint32>& OutLeafIndices) const
+{
+    // Triangles referenced by exactly one leaf are assigned to that leaf. Triangles that straddle several
+    // leaves, or aren't in any leaf, are assigned to an extra leaf at index NumLeaves(), which is never culled;
+    // otherwise a shared triangle would disappear whenever the one leaf it was assigned to got culled.
+    const uint32 kUnassigned = mNumLeaves + 1;
+    OutLeafIndices.assign(NumTriangles, kUnassigned);
+
+    for (const SNode& kNode : mNodes)
+    {
+        if (kNode.Type != ECollisionOctreeNodeType::Leaf) continue;
+        const uint16* pkTris = LeafTriangles(kNode);
+
+        for (uint TriIdx = 0; TriIdx < kNode.Count; TriIdx++)
+        {
+            uint Tri = pkTris[TriIdx];
+            if (Tri >= NumTriangles) continue;
+
+            if (OutLeafIndices[Tri] == kUnassigned)
+                OutLeafIndices[Tri] = kNode.LeafIndex;
+            else if (OutLeafIndices[Tri] != kNode.LeafIndex)
+                OutLeafIndices[Tri] = mNumLeaves;
+        }
+    }
+
+    for (uint32& rLeaf : OutLeafIndices)
+    {
+        if (rLeaf == kUnassigned)
+            rLeaf = mNumLeaves;
+    }
+}
+
+uint CCollisionOctree::NumChildren(const SNode& kBranch)
+{
+    uint Count = 0;
+
+    for (uint Octant = 0; Octant < 8; Octant++)
+    {
+        if (kBranch.ChildMask & (1 << Octant))
+            Count++;
+    }
+
+    return Count;
+}
+
+CAABox CCollisionOctree::OctantBounds(const CAABox& kParentBounds, uint Octant)
+{
+    // Bit 0 selects the upper half on X, bit 1 on Y, bit 2 on Z
+    CVector3f Min = kParentBounds.Min();
+    CVector3f Max = kParentBounds.Max();
+    CVector3f Center = kParentBounds.Center();
+
+    if (Octant & 1) Min.X = Center.X; else Max.X = Center.X;
+    if (Octant & 2) Min.Y = Center.Y; else Max.Y = Center.Y;
+    if (Octant & 4) Min.Z = Center.Z; else Max.Z = Center.Z;
+    return CAABox(Min, Max);
+}
@@ -0,0 +1,85 @@
+#ifndef CCOLLISIONOCTREE_H
+#define CCOLLISIONOCTREE_H
+
+#include <Common/BasicTypes.h>
+#include <Common/Math/CAABox.h>
+#include <Common/Math/CFrustumPlanes.h>
+#include <Common/Math/CRay.h>
+#include <Common/Math/CTransform4f.h>
+#include <Common/FileIO.h>
+#include <vector>
+
+class CCollisionMesh;
+
+/** Octree node types. Values match the encoding used in MREA collision sections */
+enum class ECollisionOctreeNodeType : uint8
+{
+    Invalid = 0,
+    Branch = 1,
+    Leaf = 2
+};
+
+/** Spatial index over the triangles of an area collision mesh.
+ *  Nodes are stored in a flat array with the root first. The children of a branch are stored
+ *  contiguously in octant order; ChildMask records which of the eight octants are present. */
+class CCollisionOctree
+{
+    friend class CCollisionLoader;
+
+public:
+    struct SNode
+    {
+        CAABox                      Bounds;
+        uint32                      Start;      // Branch: index of the first child node. Leaf: offset into the triangle index list
+        uint32                      LeafIndex;  // Leaf: sequential index of this leaf; used to look up per-leaf data
+        uint16                      Count;      // Leaf: number of triangles
+        uint8                       ChildMask;  // Branch: bit N is set if octant N has a child
+        ECollisionOctreeNodeType    Type;
+    };
+
+    /** Intermediate node used by Build() */
+    struct SBuildNode;
+
+private:
+    std::vector<SNode>  mNodes;
+    std::vector<uint16> mTriangleIndices;
+    uint32              mNumLeaves;
+
+public:
+    CCollisionOctree()
+        : mNumLeaves(0)
+    {}
+
+    void Clear();
+
+    /** Generate an octree over the triangles of kMesh, subdividing kBounds.
+     *  Output only depends on the input mesh, so repeated builds produce identical trees. */
+    static CCollisionOctree* Build(const CCollisionMesh& kMesh, const CAABox& kBounds);
+
+    /** Serialization in the MREA collision section encoding */
+    void Write(IOutputStream& Out) const;
+    uint32 EncodedSize() const;
+    ECollisionOctreeNodeType RootType() const;
+
+    /** Queries. Ray and frustum tests are in mesh space; triangle indices refer to kMesh */
+    std::pair<bool,float> IntersectsRay(const CRay& kRay, const CCollisionMesh& kMesh, bool AllowBackfaces = true) const;
+    void FindVisibleLeaves(const CFrustumPlanes& kFrustum, const CTransform4f& kTransform, std::vector<uint8>& OutVisible) const;
+    void BuildTriangleLeafMap(uint NumTriangles, std::vector<uint32>& OutLeafIndices) const;
+
+    /** Accessors */
+    inline bool IsEmpty() const                         { return mNodes.empty(); }
+    inline uint NumNodes() const                        { return mNodes.size(); }
+    inline uint NumLeaves() const                       { return mNumLeaves; }
+    inline const SNode& Node(uint Index) const          { return mNodes[Index]; }
+    inline const uint16* LeafTriangles(const SNode& kLeaf) const { return mTriangleIndices.data() + kLeaf.Start; }
+
+    static uint NumChildren(const SNode& kBranch);
+    static CAABox OctantBounds(const CAABox& kParentBounds, uint Octant);
+
+protected:
+    void FlattenBuildNode(const SBuildNode& kBuildNode, uint NodeIdx);
+    void CalculateEncodedSizes(std::vector<uint32>& OutSizes) const;
+    void WriteNode(IOutputStream& Out, uint NodeIdx, const std::vector<uint32>& kEncodedSizes) const;
+};
+
+#endif // CCOLLISIONOCTREE_H
@@ -2,7 +2,7 @@
 #include <Core/Render/CDrawUtil.h>
 
 /** Build from collision data */
-void CCollisionRenderData::BuildRenderData(const SCollisionIndexData& kIndexData)
+void CCollisionRenderData::BuildRenderData(const SCollisionIndexData& kIndexData, const CCollisionOctree* pkOctree /*= nullptr*/)
 {
     // Clear any existing data
     if (mBuilt)
@@ -12,6 +12,8 @@ void CCollisionRenderData::BuildRenderData(const SCollisionIndexData& kIndexData
         mWireframeIndexBuffer.Clear();
         mMaterialIndexOffsets.clear();
         mMaterialWireIndexOffsets.clear();
+        mLeafIndexOffsets.clear();
+        mNumLeafBuckets = 0;
         mBuilt = false;
     }
 
@@ -28,10 +30,38 @@ void CCollisionRenderData::BuildRenderData(const SCollisionIndexData& kIndexData
         SortedTris[i] = i;
     }
 
-    std::sort(SortedTris.begin(), SortedTris.end(), [kIndexData](uint16 Left, uint16 Right) -> bool {
-        return kIndexData.TriangleMaterialIndices[Left] < kIndexData.TriangleMaterialIndices[Right];
+    // If there's an octree, group triangles by leaf within each material so visible leaves can be drawn on their own
+    std::vector<uint32> TriLeaves;
+
+    if (pkOctree && !pkOctree->IsEmpty())
+    {
+        pkOctree->BuildTriangleLeafMap(NumTris, TriLeaves);
+        mNumLeafBuckets = pkOctree->NumLeaves() + 1;
+    }
+
+    std::sort(SortedTris.begin(), SortedTris.end(), [&kIndexData, &TriLeaves](uint16 Left, uint16 Right) -> bool {
+        uint8 LeftMat = kIndexData.TriangleMaterialIndices[Left];
+        uint8 RightMat = kIndexData.TriangleMaterialIndices[Right];
+        if (LeftMat != RightMat || TriLeaves.empty()) return LeftMat < RightMat;
+        if (TriLeaves[Left] != TriLeaves[Right]) return TriLeaves[Left] < TriLeaves[Right];
+        return Left < Right;
     });
 
+    if (mNumLeafBuckets > 0)
+    {
+        // Count triangles per (material, leaf) bucket, then convert the counts to index buffer offsets
+        mLeafIndexOffsets.assign((kIndexData.Materials.size() * mNumLeafBuckets) + 1, 0);
+
+        for (uint i=0; i < SortedTris.size(); i++)
+        {
+            uint TriIdx = SortedTris[i];
+            mLeafIndexOffsets[ (kIndexData.TriangleMaterialIndices[TriIdx] * mNumLeafBuckets) + TriLeaves[TriIdx] + 1 ] += 3;
+        }
+
+        for (uint i=1; i < mLeafIndexOffsets.size(); i++)
+            mLeafIndexOffsets[i] += mLeafIndexOffsets[i-1];
+    }
+
     mVertexBuffer.Reserve(SortedTris.size() * 3);
     mIndexBuffer.Reserve(SortedTris.size() * 3);
     mWireframeIndexBuffer.Reserve(SortedTris.size() * 6);
@@ -217,7 +247,7 @@ void CCollisionRenderData::BuildBoundingHierarchyRenderData(const SOBBTreeNode*
 }
 
 /** Render */
-void CCollisionRenderData::Render(bool Wireframe, int MaterialIndex /*= -1*/)
+void CCollisionRenderData::Render(bool Wireframe, int MaterialIndex /*= -1*/, const std::vector<uint8>* pkVisibleLeaves /*= nullptr*/)
 {
     mVertexBuffer.Bind();
 
@@ -228,7 +258,14 @@ void CCollisionRenderData::Render(bool Wireframe, int MaterialIndex /*= -1*/)
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     }
 
-    if (MaterialIndex >= 0)
+    if (MaterialIndex >= 0 && pkVisibleLeaves && !mLeafIndexOffsets.empty())
+    {
+        ForEachVisibleLeafRun(MaterialIndex, *pkVisibleLeaves, [this](uint FirstIndex, uint NumIndices)
+        {
+            mIndexBuffer.DrawElements(FirstIndex, NumIndices);
+        });
+    }
+    else if (MaterialIndex >= 0)
     {
         ASSERT( MaterialIndex < mMaterialIndexOffsets.size()-1 );
         uint FirstIndex = mMaterialIndexOffsets[MaterialIndex];
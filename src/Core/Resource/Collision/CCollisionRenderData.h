@@ -3,8 +3,10 @@
 
 #include "SCollisionIndexData.h"
 #include "SOBBTreeNode.h"
+#include "CCollisionOctree.h"
 #include "Core/OpenGL/CVertexBuffer.h"
 #include "Core/OpenGL/CIndexBuffer.h"
+#include <Common/Macros.h>
 
 class CCollidableOBBTree;
 
@@ -21,6 +23,12 @@ class CCollisionRenderData
     std::vector<uint>   mMaterialIndexOffsets;
     std::vector<uint>   mMaterialWireIndexOffsets;
 
+    /** When built with an octree, triangles are further grouped by octree leaf within each material.
+     *  Entry (Material * NumLeafBuckets) + Leaf is the first index for that leaf, with one extra entry at the end.
+     *  The last bucket of each material holds triangles that aren't in exactly one leaf, and is always drawn. */
+    std::vector<uint>   mLeafIndexOffsets;
+    uint                mNumLeafBuckets;
+
     /** Cached vertex/index buffer for the bounding hierarchy (octree or OBB tree) */
     CVertexBuffer       mBoundingVertexBuffer;
     CIndexBuffer        mBoundingIndexBuffer;
@@ -38,21 +46,65 @@ class CCollisionRenderData
 public:
     /** Default constructor */
     CCollisionRenderData()
-        : mBuilt(false)
+        : mNumLeafBuckets(0)
+        , mBuilt(false)
         , mBoundingHierarchyBuilt(false)
     {}
 
     /** Build from collision data */
-    void BuildRenderData(const SCollisionIndexData& kIndexData);
+    void BuildRenderData(const SCollisionIndexData& kIndexData, const CCollisionOctree* pkOctree = nullptr);
     void BuildBoundingHierarchyRenderData(const SOBBTreeNode* pOBBTree);
 
     /** Render */
-    void Render(bool Wireframe, int MaterialIndex = -1);
+    void Render(bool Wireframe, int MaterialIndex = -1, const std::vector<uint8>* pkVisibleLeaves = nullptr);
     void RenderBoundingHierarchy(int MaxDepthLevel = -1);
     int MaxBoundingHierarchyDepth() const;
 
+    /** Calls rkCallback(FirstIndex, NumIndices) for each run of indices of a material that should be drawn
+     *  with the given leaves visible. Consecutive visible leaves are merged into a single run. */
+    template<typename CallbackT>
+    void ForEachVisibleLeafRun(uint MaterialIndex, const std::vector<uint8>& kVisibleLeaves, const CallbackT& rkCallback) const
+    {
+        ASSERT( kVisibleLeaves.size() + 1 == mNumLeafBuckets );
+        uint FirstBucket = MaterialIndex * mNumLeafBuckets;
+        uint RunStart = 0;
+        uint RunEnd = 0;
+
+        for (uint Leaf = 0; Leaf < mNumLeafBuckets; Leaf++)
+        {
+            bool Visible = (Leaf == mNumLeafBuckets - 1) || kVisibleLeaves[Leaf] != 0;
+            uint Start = mLeafIndexOffsets[FirstBucket + Leaf];
+            uint End = mLeafIndexOffsets[FirstBucket + Leaf + 1];
+
+            if (!Visible || Start == End)
+                continue;
+
+            if (Start != RunEnd)
+            {
+                if (RunEnd > RunStart)
+                    rkCallback(RunStart, RunEnd - RunStart);
+
+                RunStart = Start;
+            }
+
+            RunEnd = End;
+        }
+
+        if (RunEnd > RunStart)
+            rkCallback(RunStart, RunEnd - RunStart);
+    }
+
     /** Accessors */
     inline bool IsBuilt() const                     { return mBuilt; }
+    inline bool HasLeafOffsets() const              { return !mLeafIndexOffsets.empty(); }
+    inline uint NumLeafBuckets() const              { return mNumLeafBuckets; }
+
+    /** First index and number of indices of one material's triangles in a leaf bucket */
+    inline std::pair<uint,uint> LeafBucketRange(uint MaterialIndex, uint Bucket) const
+    {
+        uint Start = mLeafIndexOffsets[(MaterialIndex * mNumLeafBuckets) + Bucket];
+        return std::pair<uint,uint>(Start, mLeafIndexOffsets[(MaterialIndex * mNumLeafBuckets) + Bucket + 1] - Start);
+    }
 };
 
 #endif // CCOLLISIONRENDERDATA_H
@@ -1,6 +1,8 @@
 #include "CAreaCooker.h"
+#include "CCollisionCooker.h"
 #include "CScriptCooker.h"
 #include "Core/CompressionUtil.h"
+#include "Core/ParallelUtil.h"
 #include "Core/GameProject/DependencyListBuilders.h"
 #include <Common/Log.h>
 
@@ -80,12 +82,13 @@ void CAreaCooker::DetermineSectionNumbersPrime()
 void CAreaCooker::DetermineSectionNumbersCorruption()
 {
     // Because we're copying these from the original file (because not all the numbers
-    // are present in every file), we don't care about any of these except SCLY and SCGN.
+    // are present in every file), we only care about the ones for sections we may write ourselves.
     for (uint32 iNum = 0; iNum < mpArea->mSectionNumbers.size(); iNum++)
     {
         CGameArea::SSectionNumber& rNum = mpArea->mSectionNumbers[iNum];
         if      (rNum.SectionID == "SOBJ") mSCLYSecNum = rNum.Index;
         else if (rNum.SectionID == "SGEN") mSCGNSecNum = rNum.Index;
+        else if (rNum.SectionID == "COLI") mCollisionSecNum = rNum.Index;
         else if (rNum.SectionID == "DEPS") mDepsSecNum = rNum.Index;
         else if (rNum.SectionID == "RSOS") mModulesSecNum = rNum.Index;
     }
@@ -99,7 +102,7 @@ void CAreaCooker::WritePrimeHeader(IOutputStream& rOut)
     mpArea->mTransform.Write(rOut);
     rOut.WriteLong(mpArea->mOriginalWorldMeshCount);
     if (mVersion >= EGame::Echoes) rOut.WriteLong(mpArea->mScriptLayers.size());
-    rOut.WriteLong(mpArea->mSectionDataBuffers.size());
+    rOut.WriteLong(mpArea->NumSections());
 
     rOut.WriteLong(mGeometrySecNum);
     rOut.WriteLong(mSCLYSecNum);
@@ -139,7 +142,7 @@ void CAreaCooker::WriteCorruptionHeader(IOutputStream& rOut)
     mpArea->mTransform.Write(rOut);
     rOut.WriteLong(mpArea->mOriginalWorldMeshCount);
     rOut.WriteLong(mpArea->mScriptLayers.size());
-    rOut.WriteLong(mpArea->mSectionDataBuffers.size());
+    rOut.WriteLong(mpArea->NumSections());
     rOut.WriteLong(mCompressedBlocks.size());
     rOut.WriteLong(mpArea->mSectionNumbers.size());
     rOut.WriteToBoundary(32, 0);
@@ -257,6 +260,19 @@ void CAreaCooker::WriteEchoesSCLY(IOutputStream& rOut)
     FinishSection(true);
 }
 
+void CAreaCooker::WriteCollision(IOutputStream& rOut)
+{
+    // The original octree no longer matches edited collision, so generate a new one
+    if (!CCollisionCooker::CookAreaCollision(mpArea->mpCollision.get(), mVersion, rOut, true))
+    {
+        warnf("%s: Failed to regenerate area collision; writing the original section", *mpArea->Entry()->CookedAssetPath(true));
+        CGameArea::SSectionView Original = mpArea->SectionData(mCollisionSecNum);
+        rOut.WriteBytes(Original.pkData, Original.Size);
+    }
+
+    FinishSection(false);
+}
+
 void CAreaCooker::WriteDependencies(IOutputStream& rOut)
 {
     // Build dependency list
@@ -349,47 +365,78 @@ void CAreaCooker::FinishBlock()
 {
     if (mCurBlock.NumSections == 0) return;
 
-    std::vector<uint8> CompressedBuf(mCompressedData.Size() * 2);
+    // Compression is deferred to CompressBlocks() so every block can be compressed at once
+    const uint8 *pkData = (const uint8*) mCompressedData.Data();
+    mBlockData.emplace_back(pkData, pkData + mCompressedData.Size());
+    mCompressedData.Clear();
+    mCompressedBlocks.push_back(mCurBlock);
+    mCurBlock = SCompressedBlock();
+}
+
+void CAreaCooker::CompressBlocks()
+{
     bool EnableCompression = (mVersion >= EGame::Echoes) && mpArea->mUsesCompression && !gkForceDisableCompression;
     bool UseZlib = (mVersion == EGame::DKCReturns);
 
-    uint32 CompressedSize = 0;
-    bool WriteCompressedData = false;
+    // Blocks are independent, so they're compressed in parallel and then written out in order
+    std::vector< std::vector<uint8> > CompressedBufs(mCompressedBlocks.size());
 
     if (EnableCompression)
     {
-        bool Success = CompressionUtil::CompressSegmentedData((uint8*) mCompressedData.Data(), mCompressedData.Size(), CompressedBuf.data(), CompressedSize, UseZlib, true);
-        uint32 PadBytes = (32 - (CompressedSize % 32)) & 0x1F;
-        WriteCompressedData = Success && (CompressedSize + PadBytes < (uint32) mCompressedData.Size());
+        ParallelUtil::ParallelFor(mCompressedBlocks.size(), [&](uint Index, uint)
+        {
+            std::vector<uint8>& rData = mBlockData[Index];
+            std::vector<uint8>& rCompressedBuf = CompressedBufs[Index];
+            rCompressedBuf.resize(rData.size() * 2);
+
+            uint32 CompressedSize = 0;
+            bool Success = CompressionUtil::CompressSegmentedData(rData.data(), rData.size(), rCompressedBuf.data(), CompressedSize, UseZlib, true);
+            uint32 PadBytes = (32 - (CompressedSize % 32)) & 0x1F;
+
+            // An empty buffer means the block is stored uncompressed
+            if (Success && (CompressedSize + PadBytes < (uint32) rData.size()))
+                rCompressedBuf.resize(CompressedSize);
+            else
+                rCompressedBuf.clear();
+        });
     }
 
-    if (WriteCompressedData)
+    for (uint32 iBlock = 0; iBlock < mCompressedBlocks.size(); iBlock++)
     {
-        uint32 PadBytes = 32 - (CompressedSize % 32);
-        PadBytes &= 0x1F;
+        SCompressedBlock& rBlock = mCompressedBlocks[iBlock];
+        const std::vector<uint8>& rkCompressedBuf = CompressedBufs[iBlock];
 
-        for (uint32 iPad = 0; iPad < PadBytes; iPad++)
-            mAreaData.WriteByte(0);
+        if (!rkCompressedBuf.empty())
+        {
+            uint32 CompressedSize = rkCompressedBuf.size();
+            uint32 PadBytes = 32 - (CompressedSize % 32);
+            PadBytes &= 0x1F;
 
-        mAreaData.WriteBytes(CompressedBuf.data(), CompressedSize);
-        mCurBlock.CompressedSize = CompressedSize;
-    }
+            for (uint32 iPad = 0; iPad < PadBytes; iPad++)
+                mAreaData.WriteByte(0);
 
-    else
-    {
-        mAreaData.WriteBytes(mCompressedData.Data(), mCompressedData.Size());
-        mAreaData.WriteToBoundary(32, 0);
-        mCurBlock.CompressedSize = 0;
+            mAreaData.WriteBytes(rkCompressedBuf.data(), CompressedSize);
+            rBlock.CompressedSize = CompressedSize;
+        }
+
+        else
+        {
+            const std::vector<uint8>& rkData = mBlockData[iBlock];
+            mAreaData.WriteBytes(rkData.data(), rkData.size());
+            mAreaData.WriteToBoundary(32, 0);
+            rBlock.CompressedSize = 0;
+        }
     }
 
-    mCompressedData.Clear();
-    mCompressedBlocks.push_back(mCurBlock);
-    mCurBlock = SCompressedBlock();
+    mBlockData.clear();
 }
 
 // ************ STATIC ************
 bool CAreaCooker::CookMREA(CGameArea *pArea, IOutputStream& rOut)
 {
+    // Section numbers depend on the world geometry
+    pArea->LoadDeferredSections();
+
     CAreaCooker Cooker;
     Cooker.mpArea = pArea;
     Cooker.mVersion = pArea->Game();
@@ -407,7 +454,8 @@ bool CAreaCooker::CookMREA(CGameArea *pArea, IOutputStream& rOut)
 
         else
         {
-            Cooker.mSectionData.WriteBytes(pArea->mSectionDataBuffers[iSec].data(), pArea->mSectionDataBuffers[iSec].size());
+            CGameArea::SSectionView Section = pArea->SectionData(iSec);
+            Cooker.mSectionData.WriteBytes(Section.pkData, Section.Size);
             Cooker.FinishSection(false);
         }
     }
@@ -420,19 +468,24 @@ bool CAreaCooker::CookMREA(CGameArea *pArea, IOutputStream& rOut)
 
     // Write post-SCLY data sections
     uint32 PostSCLY = (Cooker.mVersion <= EGame::Prime ? Cooker.mSCLYSecNum + 1 : Cooker.mSCGNSecNum + 1);
-    for (uint32 iSec = PostSCLY; iSec < pArea->mSectionDataBuffers.size(); iSec++)
+    for (uint32 iSec = PostSCLY; iSec < pArea->NumSections(); iSec++)
     {
         if (iSec == Cooker.mModulesSecNum)
             Cooker.WriteModules(Cooker.mSectionData);
 
+        else if (iSec == Cooker.mCollisionSecNum && pArea->IsCollisionModified())
+            Cooker.WriteCollision(Cooker.mSectionData);
+
         else
         {
-            Cooker.mSectionData.WriteBytes(pArea->mSectionDataBuffers[iSec].data(), pArea->mSectionDataBuffers[iSec].size());
+            CGameArea::SSectionView Section = pArea->SectionData(iSec);
+            Cooker.mSectionData.WriteBytes(Section.pkData, Section.Size);
             Cooker.FinishSection(false);
         }
     }
 
     Cooker.FinishBlock();
+    Cooker.CompressBlocks();
 
     // Write to actual file
     if (Cooker.mVersion <= EGame::Echoes)
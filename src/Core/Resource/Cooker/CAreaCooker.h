@@ -44,6 +44,7 @@ class CAreaCooker
     CVectorOutStream mAreaData;
 
     std::vector<SCompressedBlock> mCompressedBlocks;
+    std::vector< std::vector<uint8> > mBlockData; // Uncompressed data for each entry in mCompressedBlocks
 
     CAreaCooker();
     void DetermineSectionNumbersPrime();
@@ -60,6 +61,7 @@ class CAreaCooker
     void WriteEchoesSCLY(IOutputStream& rOut);
 
     // Other Sections
+    void WriteCollision(IOutputStream& rOut);
     void WriteDependencies(IOutputStream& rOut);
     void WriteModules(IOutputStream& rOut);
 
@@ -67,6 +69,7 @@ class CAreaCooker
     void AddSectionToBlock();
     void FinishSection(bool ForceFinishBlock);
     void FinishBlock();
+    void CompressBlocks();
 
 public:
     static bool CookMREA(CGameArea *pArea, IOutputStream& rOut);
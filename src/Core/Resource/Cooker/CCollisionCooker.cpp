@@ -0,0 +1,132 @@
+#include "CCollisionCooker.h"
+#include <Common/Log.h>
+#include <memory>
+
+void CCollisionCooker::WriteCollisionMaterial(IOutputStream& Out, const CCollisionMaterial& kMaterial)
+{
+    // Materials are written from their original flags; the parsed flag set is lossy
+    if (mVersion <= EGame::Prime)
+        Out.WriteLong( (uint32) kMaterial.RawFlags() );
+    else
+        Out.WriteLongLong( kMaterial.RawFlags() );
+}
+
+void CCollisionCooker::WriteCollisionIndices(IOutputStream& Out, const SCollisionIndexData& kData)
+{
+    // Materials
+    Out.WriteLong( kData.Materials.size() );
+
+    for (uint i=0; i<kData.Materials.size(); i++)
+    {
+        WriteCollisionMaterial(Out, kData.Materials[i]);
+    }
+
+    // Property indices for vertices/edges/triangles
+    Out.WriteLong( kData.VertexMaterialIndices.size() );
+    Out.WriteBytes( kData.VertexMaterialIndices.data(), kData.VertexMaterialIndices.size() );
+
+    Out.WriteLong( kData.EdgeMaterialIndices.size() );
+    Out.WriteBytes( kData.EdgeMaterialIndices.data(), kData.EdgeMaterialIndices.size() );
+
+    Out.WriteLong( kData.TriangleMaterialIndices.size() );
+    Out.WriteBytes( kData.TriangleMaterialIndices.data(), kData.TriangleMaterialIndices.size() );
+
+    // Edges
+    Out.WriteLong( kData.EdgeIndices.size() / 2 );
+
+    for (uint i=0; i<kData.EdgeIndices.size(); i++)
+    {
+        Out.WriteShort( kData.EdgeIndices[i] );
+    }
+
+    // Triangles
+    Out.WriteLong( kData.TriangleIndices.size() );
+
+    for (uint i=0; i<kData.TriangleIndices.size(); i++)
+    {
+        Out.WriteShort( kData.TriangleIndices[i] );
+    }
+
+    // Echoes unknown chunk
+    if (mVersion >= EGame::Echoes)
+    {
+        Out.WriteLong( kData.UnknownData.size() );
+
+        for (uint i=0; i<kData.UnknownData.size(); i++)
+        {
+            Out.WriteShort( kData.UnknownData[i] );
+        }
+    }
+
+    // Vertices
+    Out.WriteLong( kData.Vertices.size() );
+
+    for (uint i=0; i<kData.Vertices.size(); i++)
+    {
+        kData.Vertices[i].Write(Out);
+    }
+}
+
+// ************ STATIC ************
+bool CCollisionCooker::CookAreaCollision(CCollisionMeshGroup* pGroup, EGame Game, IOutputStream& Out, bool RebuildOctree /*= false*/)
+{
+    if (!pGroup || pGroup->NumMeshes() == 0)
+    {
+        errorf("Unable to cook area collision; no collision mesh");
+        return false;
+    }
+
+    CCollisionCooker Cooker;
+    Cooker.mVersion = Game;
+
+    const CCollisionMesh* pkMesh = pGroup->MeshByIndex(0);
+    const SCollisionIndexData& kData = pkMesh->GetIndexData();
+    const CCollisionOctree* pkOctree = pGroup->Octree();
+    CAABox Bounds = pkMesh->Bounds();
+    std::unique_ptr<CCollisionOctree> pNewOctree;
+
+    if (RebuildOctree || !pkOctree)
+    {
+        // The mesh may have been edited since it was loaded, so fit the bounds to the current vertices
+        if (!kData.Vertices.empty())
+        {
+            Bounds = CAABox::skInfinite;
+
+            for (uint i=0; i<kData.Vertices.size(); i++)
+                Bounds.ExpandBounds(kData.Vertices[i]);
+        }
+
+        pNewOctree = std::unique_ptr<CCollisionOctree>( CCollisionOctree::Build(*pkMesh, Bounds) );
+        pkOctree = pNewOctree.get();
+    }
+
+    // Header
+    uint32 SectionStart = Out.Tell();
+    Out.WriteLong(0x01000000); // Unknown value; always the same in retail files
+    Out.WriteLong(0); // Section size; filled in at the end
+    Out.WriteLong(0xDEAFBABE);
+    Out.WriteLong( GetFormatVersion(Game) );
+
+    // Octree
+    Bounds.Write(Out);
+    Out.WriteLong( (uint32) pkOctree->RootType() );
+    Out.WriteLong( pkOctree->EncodedSize() );
+    pkOctree->Write(Out);
+
+    // Collision indices
+    Cooker.WriteCollisionIndices(Out, kData);
+
+    // The section size excludes the unknown value and the size itself
+    uint32 SectionEnd = Out.Tell();
+    Out.Seek(SectionStart + 4, SEEK_SET);
+    Out.WriteLong(SectionEnd - SectionStart - 8);
+    Out.Seek(SectionEnd, SEEK_SET);
+    return true;
+}
+
+uint32 CCollisionCooker::GetFormatVersion(EGame Game)
+{
+    if (Game <= EGame::Prime)               return 0x3;
+    else if (Game == EGame::DKCReturns)     return 0x5;
+    else                                    return 0x4;
+}
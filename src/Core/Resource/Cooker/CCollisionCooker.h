@@ -0,0 +1,24 @@
+#ifndef CCOLLISIONCOOKER_H
+#define CCOLLISIONCOOKER_H
+
+#include "Core/Resource/Collision/CCollisionMeshGroup.h"
+#include <Common/EGame.h>
+#include <Common/FileIO.h>
+
+/** Cooker class for writing game-compatible area collision sections */
+class CCollisionCooker
+{
+    EGame mVersion;
+
+    CCollisionCooker() {}
+    void WriteCollisionMaterial(IOutputStream& Out, const CCollisionMaterial& kMaterial);
+    void WriteCollisionIndices(IOutputStream& Out, const SCollisionIndexData& kData);
+
+public:
+    /** Write the MREA collision section for pGroup. If RebuildOctree is set, or the group has no octree,
+     *  a new octree and bounding box are generated from the mesh instead of writing out the existing ones. */
+    static bool CookAreaCollision(CCollisionMeshGroup* pGroup, EGame Game, IOutputStream& Out, bool RebuildOctree = false);
+    static uint32 GetFormatVersion(EGame Game);
+};
+
+#endif // CCOLLISIONCOOKER_H
@@ -4,15 +4,17 @@
 #include "CMaterialLoader.h"
 #include "CScriptLoader.h"
 #include "Core/CompressionUtil.h"
+#include "Core/ParallelUtil.h"
 #include <Common/Log.h>
 
 #include <Common/CFourCC.h>
 
+#include <atomic>
 #include <iostream>
 
 CAreaLoader::CAreaLoader()
     : mpMREA(nullptr)
-    , mHasDecompressedBuffer(false)
+    , mOwnsInputStream(false)
     , mGeometryBlockNum(-1)
     , mScriptLayerBlockNum(-1)
     , mCollisionBlockNum(-1)
@@ -34,11 +36,8 @@ CAreaLoader::CAreaLoader()
 
 CAreaLoader::~CAreaLoader()
 {
-    if (mHasDecompressedBuffer)
-    {
+    if (mOwnsInputStream)
         delete mpMREA;
-        delete[] mpDecmpBuffer;
-    }
 }
 
 // ************ PRIME ************
@@ -60,18 +59,21 @@ void CAreaLoader::ReadHeaderPrime()
     mpSectionMgr = new CSectionMgrIn(mNumBlocks, mpMREA);
     mpMREA->SeekToBoundary(32);
     mpSectionMgr->Init();
-    LoadSectionDataBuffers();
+    LoadSectionData();
 
     mpArea->mOriginalWorldMeshCount = mNumMeshes;
 }
 
-void CAreaLoader::ReadGeometryPrime()
+void CAreaLoader::ReadMaterials()
 {
+    // Materials are needed to build dependencies, so unlike the rest of the geometry they're always loaded up front
     mpSectionMgr->ToSection(mGeometryBlockNum);
-
-    // Materials
     mpArea->mpMaterialSet = CMaterialLoader::LoadMaterialSet(*mpMREA, mVersion);
-    mpSectionMgr->ToNextSection();
+}
+
+void CAreaLoader::ReadGeometryPrime()
+{
+    mpSectionMgr->ToSection(mGeometryBlockNum + 1);
 
     // Geometry
     std::vector<CModel*> FileModels;
@@ -81,8 +83,14 @@ void CAreaLoader::ReadGeometryPrime()
         CModel *pModel = CModelLoader::LoadWorldModel(*mpMREA, *mpSectionMgr, *mpArea->mpMaterialSet, mVersion);
         FileModels.push_back(pModel);
 
+        // Tag surfaces with their mesh index so they can be matched against the area octree after merging
         if (mVersion <= EGame::Prime)
+        {
+            for (uint32 iSurf = 0; iSurf < pModel->GetSurfaceCount(); iSurf++)
+                pModel->GetSurface(iSurf)->MeshID = (uint16) iMesh;
+
             mpArea->AddWorldModel(pModel);
+        }
 
         // For Echoes+, load surface mesh IDs, then skip to the start of the next mesh
         else
@@ -113,6 +121,89 @@ void CAreaLoader::ReadGeometryPrime()
     mpArea->MergeTerrain();
 }
 
+void CAreaLoader::ReadAROT()
+{
+    if (mOctreeBlockNum == -1) return;
+    mpSectionMgr->ToSection(mOctreeBlockNum);
+    uint32 SectionStart = mpMREA->Tell();
+
+    CFourCC AROT(*mpMREA);
+    if (AROT != FOURCC('AROT'))
+    {
+        errorf("%s [0x%X]: Invalid AROT magic: %s", *mpMREA->GetSourceString(), mpMREA->Tell() - 4, *AROT.ToString());
+        return;
+    }
+    mpMREA->Seek(0x4, SEEK_CUR); // Skipping version
+
+    std::unique_ptr<CAreaOctree> pOctree(new CAreaOctree);
+    uint32 NumBitmaps = mpMREA->ReadLong();
+    pOctree->mNumMeshes = mpMREA->ReadLong();
+    uint32 NumNodes = mpMREA->ReadLong();
+    pOctree->mBounds = CAABox(*mpMREA);
+    pOctree->mBitmapWordCount = (pOctree->mNumMeshes + 31) / 32;
+
+    if (pOctree->mNumMeshes != mNumMeshes)
+    {
+        warnf("%s: AROT mesh count (%d) doesn't match area mesh count (%d); ignoring octree", *mpMREA->GetSourceString(), pOctree->mNumMeshes, mNumMeshes);
+        return;
+    }
+
+    // Mesh bitmaps start after the 32-byte aligned header
+    mpMREA->Seek(SectionStart + 0x40, SEEK_SET);
+    pOctree->mBitmaps.resize(NumBitmaps * pOctree->mBitmapWordCount);
+
+    for (uint32 iWord = 0; iWord < pOctree->mBitmaps.size(); iWord++)
+        pOctree->mBitmaps[iWord] = mpMREA->ReadLong();
+
+    // Node offsets, relative to the end of the offset table
+    std::vector<uint32> NodeOffsets(NumNodes);
+
+    for (uint32 iNode = 0; iNode < NumNodes; iNode++)
+        NodeOffsets[iNode] = mpMREA->ReadLong();
+
+    uint32 NodesStart = mpMREA->Tell();
+    pOctree->mNodes.resize(NumNodes);
+
+    for (uint32 iNode = 0; iNode < NumNodes; iNode++)
+    {
+        mpMREA->Seek(NodesStart + NodeOffsets[iNode], SEEK_SET);
+
+        CAreaOctree::SNode& rNode = pOctree->mNodes[iNode];
+        rNode.BitmapIndex = mpMREA->ReadShort();
+        rNode.SplitAxes = (uint8) (mpMREA->ReadShort() & 0x7);
+        rNode.NumChildren = 0;
+        rNode.FirstChild = pOctree->mChildIndices.size();
+
+        // Two children per split axis
+        if (rNode.SplitAxes != 0)
+        {
+            uint32 NumAxes = (rNode.SplitAxes & 1) + ((rNode.SplitAxes >> 1) & 1) + ((rNode.SplitAxes >> 2) & 1);
+            rNode.NumChildren = (uint8) (1 << NumAxes);
+        }
+
+        if (rNode.BitmapIndex >= NumBitmaps)
+        {
+            errorf("%s [0x%X]: AROT node %d references invalid bitmap %d", *mpMREA->GetSourceString(), mpMREA->Tell() - 4, iNode, rNode.BitmapIndex);
+            return;
+        }
+
+        for (uint32 iChild = 0; iChild < rNode.NumChildren; iChild++)
+        {
+            uint16 ChildIndex = mpMREA->ReadShort();
+
+            if (ChildIndex >= NumNodes)
+            {
+                errorf("%s [0x%X]: AROT node %d references invalid child %d", *mpMREA->GetSourceString(), mpMREA->Tell() - 2, iNode, ChildIndex);
+                return;
+            }
+
+            pOctree->mChildIndices.push_back(ChildIndex);
+        }
+    }
+
+    mpArea->mpAreaOctree = std::move(pOctree);
+}
+
 void CAreaLoader::ReadSCLYPrime()
 {
     // Prime, Echoes Demo
@@ -279,7 +370,7 @@ void CAreaLoader::ReadHeaderEchoes()
     }
 
     mpSectionMgr->Init();
-    LoadSectionDataBuffers();
+    LoadSectionData();
 
     mpArea->mOriginalWorldMeshCount = mNumMeshes;
 }
@@ -366,18 +457,14 @@ void CAreaLoader::ReadHeaderCorruption()
     mpMREA->SeekToBoundary(32);
     Decompress();
     mpSectionMgr->Init();
-    LoadSectionDataBuffers();
+    LoadSectionData();
 
     mpArea->mOriginalWorldMeshCount = mNumMeshes;
 }
 
 void CAreaLoader::ReadGeometryCorruption()
 {
-    mpSectionMgr->ToSection(mGeometryBlockNum);
-
-    // Materials
-    mpArea->mpMaterialSet = CMaterialLoader::LoadMaterialSet(*mpMREA, mVersion);
-    mpSectionMgr->ToNextSection();
+    mpSectionMgr->ToSection(mGeometryBlockNum + 1);
 
     // Geometry
     std::vector<CModel*> FileModels;
@@ -564,57 +651,108 @@ void CAreaLoader::Decompress()
     // It should be called at the beginning of the first compressed cluster.
     if (mVersion < EGame::Echoes) return;
 
-    // Decompress clusters
-    mpDecmpBuffer = new uint8[mTotalDecmpSize];
-    uint32 Offset = 0;
+    // Every cluster's output offset is known from the cluster sizes, so the file is read in one
+    // pass and the compressed clusters are then decompressed in parallel, straight into the buffer.
+    mpArea->mSectionData.resize(mTotalDecmpSize);
+    uint8 *pDecmpBuffer = mpArea->mSectionData.data();
+    std::vector<uint32> DecmpOffsets(mClusters.size());
+    std::vector<uint32> CmpOffsets(mClusters.size());
+    uint32 DecmpOffset = 0, CmpSize = 0;
+
+    for (uint32 iClust = 0; iClust < mClusters.size(); iClust++)
+    {
+        DecmpOffsets[iClust] = DecmpOffset;
+        CmpOffsets[iClust] = CmpSize;
+        DecmpOffset += mClusters[iClust].DecompressedSize;
+        CmpSize += mClusters[iClust].CompressedSize;
+    }
+
+    std::vector<uint8> CompressedData(CmpSize);
 
     for (uint32 iClust = 0; iClust < mClusters.size(); iClust++)
     {
         SCompressedCluster *pClust = &mClusters[iClust];
 
         // Is it decompressed already?
-        if (mClusters[iClust].CompressedSize == 0)
-        {
-            mpMREA->ReadBytes(mpDecmpBuffer + Offset, pClust->DecompressedSize);
-            Offset += pClust->DecompressedSize;
-        }
+        if (pClust->CompressedSize == 0)
+            mpMREA->ReadBytes(pDecmpBuffer + DecmpOffsets[iClust], pClust->DecompressedSize);
 
         else
         {
-            uint32 StartOffset = 32 - (mClusters[iClust].CompressedSize % 32); // For some reason they pad the beginning instead of the end
+            uint32 StartOffset = 32 - (pClust->CompressedSize % 32); // For some reason they pad the beginning instead of the end
             if (StartOffset != 32)
                 mpMREA->Seek(StartOffset, SEEK_CUR);
 
-            std::vector<uint8> CompressedBuf(mClusters[iClust].CompressedSize);
-            mpMREA->ReadBytes(CompressedBuf.data(), CompressedBuf.size());
-
-            bool Success = CompressionUtil::DecompressSegmentedData(CompressedBuf.data(), CompressedBuf.size(), mpDecmpBuffer + Offset, pClust->DecompressedSize);
-            if (!Success)
-                throw "Failed to decompress MREA!";
-
-            Offset += pClust->DecompressedSize;
+            mpMREA->ReadBytes(CompressedData.data() + CmpOffsets[iClust], pClust->CompressedSize);
         }
     }
 
+    std::atomic<bool> Success(true);
+
+    ParallelUtil::ParallelFor(mClusters.size(), [&](uint Index, uint)
+    {
+        const SCompressedCluster& rkClust = mClusters[Index];
+        if (rkClust.CompressedSize == 0) return;
+
+        if (!CompressionUtil::DecompressSegmentedData(CompressedData.data() + CmpOffsets[Index], rkClust.CompressedSize,
+                                                      pDecmpBuffer + DecmpOffsets[Index], rkClust.DecompressedSize))
+            Success = false;
+    });
+
+    if (!Success)
+        throw "Failed to decompress MREA!";
+
     TString Source = mpMREA->GetSourceString();
-    mpMREA = new CMemoryInStream(mpDecmpBuffer, mTotalDecmpSize, EEndian::BigEndian);
+    mpMREA = new CMemoryInStream(pDecmpBuffer, mTotalDecmpSize, EEndian::BigEndian);
     mpMREA->SetSourceString(Source);
     mpSectionMgr->SetInputStream(mpMREA);
-    mHasDecompressedBuffer = true;
+    mOwnsInputStream = true;
 }
 
-void CAreaLoader::LoadSectionDataBuffers()
+void CAreaLoader::LoadSectionData()
 {
-   mpArea->mSectionDataBuffers.resize(mpSectionMgr->NumSections());
-   mpSectionMgr->ToSection(0);
-
-   for (uint32 iSec = 0; iSec < mpSectionMgr->NumSections(); iSec++)
-   {
-       uint32 Size = mpSectionMgr->CurrentSectionSize();
-       mpArea->mSectionDataBuffers[iSec].resize(Size);
-       mpMREA->ReadBytes(mpArea->mSectionDataBuffers[iSec].data(), mpArea->mSectionDataBuffers[iSec].size());
-       mpSectionMgr->ToNextSection();
-   }
+    // Should be called at the start of the first section. Compressed areas have already been
+    // decompressed into the area's section buffer; otherwise the sections are read into it here.
+    uint32 NumSections = mpSectionMgr->NumSections();
+    std::vector<uint32>& rOffsets = mpArea->mSectionOffsets;
+    rOffsets.resize(NumSections + 1);
+    rOffsets[0] = 0;
+
+    for (uint32 iSec = 0; iSec < NumSections; iSec++)
+        rOffsets[iSec + 1] = rOffsets[iSec] + mpSectionMgr->SectionSize(iSec);
+
+    if (mOwnsInputStream)
+    {
+        if (rOffsets.back() > mpArea->mSectionData.size())
+            throw "MREA sections don't fit in the decompressed data!";
+    }
+
+    else
+    {
+        mpArea->mSectionData.resize(rOffsets.back());
+        mpMREA->ReadBytes(mpArea->mSectionData.data(), mpArea->mSectionData.size());
+
+        TString Source = mpMREA->GetSourceString();
+        mpMREA = new CMemoryInStream(mpArea->mSectionData.data(), mpArea->mSectionData.size(), EEndian::BigEndian);
+        mpMREA->SetSourceString(Source);
+        mpSectionMgr->SetInputStream(mpMREA);
+        mpSectionMgr->Init();
+        mOwnsInputStream = true;
+    }
+}
+
+void CAreaLoader::DeferSections()
+{
+    std::unique_ptr<CGameArea::SDeferredSections> pDeferred = std::make_unique<CGameArea::SDeferredSections>();
+    pDeferred->Version = mVersion;
+    pDeferred->NumMeshes = mNumMeshes;
+    pDeferred->GeometryBlockNum = mGeometryBlockNum;
+    pDeferred->GPUBlockNum = mGPUBlockNum;
+    pDeferred->OctreeBlockNum = mOctreeBlockNum;
+    pDeferred->CollisionBlockNum = mCollisionBlockNum;
+    pDeferred->LightsBlockNum = mLightsBlockNum;
+    mpArea->mpDeferredSections = std::move(pDeferred);
+    mpArea->mCollisionSectionNum = mCollisionBlockNum;
 }
 
 void CAreaLoader::ReadCollision()
@@ -746,44 +884,37 @@ CGameArea* CAreaLoader::LoadMREA(IInputStream& MREA, CResourceEntry *pEntry)
     Loader.mVersion = GetFormatVersion(Version);
     Loader.mpMREA = &MREA;
 
+    // World geometry, collision and lights are left until they're first accessed; see LoadDeferredSections()
     switch (Loader.mVersion)
     {
         case EGame::PrimeDemo:
         case EGame::Prime:
             Loader.ReadHeaderPrime();
-            Loader.ReadGeometryPrime();
+            Loader.ReadMaterials();
             Loader.ReadSCLYPrime();
-            Loader.ReadCollision();
-            Loader.ReadLightsPrime();
             Loader.ReadPATH();
             break;
         case EGame::EchoesDemo:
             Loader.ReadHeaderEchoes();
-            Loader.ReadGeometryPrime();
+            Loader.ReadMaterials();
             Loader.ReadSCLYPrime();
-            Loader.ReadCollision();
-            Loader.ReadLightsPrime();
             Loader.ReadPATH();
             Loader.ReadPTLA();
             Loader.ReadEGMC();
             break;
         case EGame::Echoes:
             Loader.ReadHeaderEchoes();
-            Loader.ReadGeometryPrime();
+            Loader.ReadMaterials();
             Loader.ReadSCLYEchoes();
-            Loader.ReadCollision();
-            Loader.ReadLightsPrime();
             Loader.ReadPATH();
             Loader.ReadPTLA();
             Loader.ReadEGMC();
             break;
         case EGame::CorruptionProto:
             Loader.ReadHeaderCorruption();
-            Loader.ReadGeometryPrime();
+            Loader.ReadMaterials();
             Loader.ReadDependenciesCorruption();
             Loader.ReadSCLYEchoes();
-            Loader.ReadCollision();
-            Loader.ReadLightsCorruption();
             Loader.ReadPATH();
             Loader.ReadPTLA();
             Loader.ReadEGMC();
@@ -791,13 +922,11 @@ CGameArea* CAreaLoader::LoadMREA(IInputStream& MREA, CResourceEntry *pEntry)
         case EGame::Corruption:
         case EGame::DKCReturns:
             Loader.ReadHeaderCorruption();
-            Loader.ReadGeometryCorruption();
+            Loader.ReadMaterials();
             Loader.ReadDependenciesCorruption();
             Loader.ReadSCLYEchoes();
-            Loader.ReadCollision();
             if (Loader.mVersion == EGame::Corruption)
             {
-                Loader.ReadLightsCorruption();
                 Loader.ReadPATH();
                 Loader.ReadPTLA();
                 Loader.ReadEGMC();
@@ -809,11 +938,76 @@ CGameArea* CAreaLoader::LoadMREA(IInputStream& MREA, CResourceEntry *pEntry)
             return nullptr;
     }
 
+    Loader.DeferSections();
+
     // Cleanup
     delete Loader.mpSectionMgr;
     return Loader.mpArea;
 }
 
+void CAreaLoader::LoadDeferredSections(CGameArea *pArea)
+{
+    // Take the deferred state first so that accessors called during loading don't load again
+    std::unique_ptr<CGameArea::SDeferredSections> pDeferred = std::move(pArea->mpDeferredSections);
+    if (!pDeferred) return;
+
+    CAreaLoader Loader;
+    Loader.mpArea = pArea;
+    Loader.mVersion = pDeferred->Version;
+    Loader.mNumMeshes = pDeferred->NumMeshes;
+    Loader.mGeometryBlockNum = pDeferred->GeometryBlockNum;
+    Loader.mGPUBlockNum = pDeferred->GPUBlockNum;
+    Loader.mOctreeBlockNum = pDeferred->OctreeBlockNum;
+    Loader.mCollisionBlockNum = pDeferred->CollisionBlockNum;
+    Loader.mLightsBlockNum = pDeferred->LightsBlockNum;
+
+    // Parse straight out of the section buffer
+    const std::vector<uint32>& rkOffsets = pArea->mSectionOffsets;
+    std::vector<uint32> SectionSizes(rkOffsets.empty() ? 0 : rkOffsets.size() - 1);
+
+    for (uint32 iSec = 0; iSec < SectionSizes.size(); iSec++)
+        SectionSizes[iSec] = rkOffsets[iSec + 1] - rkOffsets[iSec];
+
+    Loader.mpMREA = new CMemoryInStream(pArea->mSectionData.data(), pArea->mSectionData.size(), EEndian::BigEndian);
+    Loader.mpMREA->SetSourceString(pArea->FullSource());
+    Loader.mOwnsInputStream = true;
+    Loader.mpSectionMgr = new CSectionMgrIn(SectionSizes, Loader.mpMREA);
+    Loader.mpSectionMgr->Init();
+
+    switch (Loader.mVersion)
+    {
+        case EGame::PrimeDemo:
+        case EGame::Prime:
+            Loader.ReadGeometryPrime();
+            Loader.ReadAROT();
+            Loader.ReadCollision();
+            Loader.ReadLightsPrime();
+            break;
+        case EGame::EchoesDemo:
+        case EGame::Echoes:
+            Loader.ReadGeometryPrime();
+            Loader.ReadCollision();
+            Loader.ReadLightsPrime();
+            break;
+        case EGame::CorruptionProto:
+            Loader.ReadGeometryPrime();
+            Loader.ReadCollision();
+            Loader.ReadLightsCorruption();
+            break;
+        case EGame::Corruption:
+        case EGame::DKCReturns:
+            Loader.ReadGeometryCorruption();
+            Loader.ReadCollision();
+            if (Loader.mVersion == EGame::Corruption)
+                Loader.ReadLightsCorruption();
+            break;
+        default:
+            break;
+    }
+
+    delete Loader.mpSectionMgr;
+}
+
 EGame CAreaLoader::GetFormatVersion(uint32 Version)
 {
     switch (Version)
@@ -24,8 +24,7 @@ class CAreaLoader
     std::unordered_map<uint32, std::vector<CLink*>> mConnectionMap;
 
     // Compression
-    uint8 *mpDecmpBuffer;
-    bool mHasDecompressedBuffer;
+    bool mOwnsInputStream;
     std::vector<SCompressedCluster> mClusters;
     uint32 mTotalDecmpSize;
 
@@ -59,6 +58,7 @@ class CAreaLoader
     void ReadGeometryPrime();
     void ReadSCLYPrime();
     void ReadLightsPrime();
+    void ReadAROT();
 
     // Echoes
     void ReadHeaderEchoes();
@@ -71,9 +71,11 @@ class CAreaLoader
     void ReadLightsCorruption();
 
     // Common
+    void ReadMaterials();
     void ReadCompressedBlocks();
     void Decompress();
-    void LoadSectionDataBuffers();
+    void LoadSectionData();
+    void DeferSections();
     void ReadCollision();
     void ReadPATH();
     void ReadPTLA();
@@ -82,6 +84,7 @@ class CAreaLoader
 
 public:
     static CGameArea* LoadMREA(IInputStream& rMREA, CResourceEntry *pEntry);
+    static void LoadDeferredSections(CGameArea *pArea);
     static EGame GetFormatVersion(uint32 Version);
 };
 
@@ -1,27 +1,98 @@
 #include "CCollisionLoader.h"
 #include <Common/Log.h>
+#include <Common/FileIO.h>
 #include <iostream>
 
 CCollisionLoader::CCollisionLoader()
 {
 }
 
-#if 0
-CCollisionMesh::CCollisionOctree* CCollisionLoader::ParseOctree(IInputStream& /*rSrc*/)
+CCollisionOctree* CCollisionLoader::ParseOctree(IInputStream& Src, ECollisionOctreeNodeType RootType, const CAABox& kBounds)
 {
-    return nullptr;
+    CCollisionOctree* pOctree = new CCollisionOctree;
+    if (RootType == ECollisionOctreeNodeType::Invalid) return pOctree;
+
+    pOctree->mNodes.emplace_back();
+
+    if (RootType == ECollisionOctreeNodeType::Branch)
+        ParseOctreeBranch(Src, *pOctree, 0, kBounds);
+    else
+        ParseOctreeLeaf(Src, *pOctree, 0);
+
+    return pOctree;
 }
 
-CCollisionMesh::CCollisionOctree::SBranch* CCollisionLoader::ParseOctreeBranch(IInputStream& /*rSrc*/)
+void CCollisionLoader::ParseOctreeBranch(IInputStream& Src, CCollisionOctree& Octree, uint NodeIdx, const CAABox& kBounds)
 {
-    return nullptr;
+    // Branches are a 16-bit field with two bits per child giving its node type, followed by
+    // eight child offsets that are relative to the end of the branch header
+    uint32 NodeStart = Src.Tell();
+    uint16 ChildFlags = Src.ReadShort();
+    Src.Skip(2);
+
+    uint32 ChildOffsets[8];
+    for (uint Octant = 0; Octant < 8; Octant++)
+        ChildOffsets[Octant] = Src.ReadLong();
+
+    uint8 ChildMask = 0;
+
+    for (uint Octant = 0; Octant < 8; Octant++)
+    {
+        ECollisionOctreeNodeType Type = (ECollisionOctreeNodeType) ((ChildFlags >> (Octant * 2)) & 0x3);
+
+        if (Type == ECollisionOctreeNodeType::Branch || Type == ECollisionOctreeNodeType::Leaf)
+            ChildMask |= (1 << Octant);
+    }
+
+    // Children are allocated contiguously before parsing so their subtrees are appended after them
+    uint FirstChild = Octree.mNodes.size();
+    CCollisionOctree::SNode& rNode = Octree.mNodes[NodeIdx];
+    rNode.Type = ECollisionOctreeNodeType::Branch;
+    rNode.Start = FirstChild;
+    rNode.Count = 0;
+    rNode.LeafIndex = 0;
+    rNode.ChildMask = ChildMask;
+    Octree.mNodes.resize(FirstChild + CCollisionOctree::NumChildren(rNode));
+
+    uint ChildIdx = FirstChild;
+    CAABox Bounds = CAABox::skInfinite;
+
+    for (uint Octant = 0; Octant < 8; Octant++)
+    {
+        if ((ChildMask & (1 << Octant)) == 0) continue;
+
+        ECollisionOctreeNodeType Type = (ECollisionOctreeNodeType) ((ChildFlags >> (Octant * 2)) & 0x3);
+        Src.Seek(NodeStart + 36 + ChildOffsets[Octant], SEEK_SET);
+
+        if (Type == ECollisionOctreeNodeType::Branch)
+            ParseOctreeBranch(Src, Octree, ChildIdx, CCollisionOctree::OctantBounds(kBounds, Octant));
+        else
+            ParseOctreeLeaf(Src, Octree, ChildIdx);
+
+        Bounds.ExpandBounds(Octree.mNodes[ChildIdx].Bounds);
+        ChildIdx++;
+    }
+
+    // Leaves store their own bounds, which can extend past their octant; make sure the branch encloses them
+    Octree.mNodes[NodeIdx].Bounds = (ChildMask != 0 ? Bounds : kBounds);
 }
 
-CCollisionMesh::CCollisionOctree::SLeaf* CCollisionLoader::ParseOctreeLeaf(IInputStream& /*rSrc*/)
+void CCollisionLoader::ParseOctreeLeaf(IInputStream& Src, CCollisionOctree& Octree, uint NodeIdx)
 {
-    return nullptr;
+    CAABox Bounds(Src);
+    uint16 NumTris = Src.ReadShort();
+
+    CCollisionOctree::SNode& rNode = Octree.mNodes[NodeIdx];
+    rNode.Type = ECollisionOctreeNodeType::Leaf;
+    rNode.Bounds = Bounds;
+    rNode.Start = Octree.mTriangleIndices.size();
+    rNode.Count = NumTris;
+    rNode.LeafIndex = Octree.mNumLeaves++;
+    rNode.ChildMask = 0;
+
+    for (uint TriIdx = 0; TriIdx < NumTris; TriIdx++)
+        Octree.mTriangleIndices.push_back( Src.ReadShort() );
 }
-#endif
 
 SOBBTreeNode* CCollisionLoader::ParseOBBNode(IInputStream& DCLN)
 {
@@ -171,11 +242,16 @@ void CCollisionLoader::LoadCollisionIndices(IInputStream& File, SCollisionIndexD
         OutData.TriangleIndices[i] = File.ReadShort();
     }
 
-    // Echoes introduces a new data chunk; don't know what it is yet, skipping for now
+    // Echoes introduces a new data chunk; don't know what it is yet, but keep it so it can be written back out
     if (mVersion >= EGame::Echoes)
     {
         uint UnknownCount = File.ReadLong();
-        File.Skip(UnknownCount * 2);
+        OutData.UnknownData.resize(UnknownCount);
+
+        for (uint i=0; i<UnknownCount; i++)
+        {
+            OutData.UnknownData[i] = File.ReadShort();
+        }
     }
 
     // Vertices
@@ -206,17 +282,22 @@ CCollisionMeshGroup* CCollisionLoader::LoadAreaCollision(IInputStream& rMREA)
     Loader.mVersion = GetFormatVersion(rMREA.ReadLong());
     Loader.mpMesh = new CCollisionMesh;
 
-    // Octree - structure is known, but not coding this right now
+    // Octree
     Loader.mpMesh->mAABox = CAABox(rMREA);
-    rMREA.Skip(0x4);
+    ECollisionOctreeNodeType RootType = (ECollisionOctreeNodeType) rMREA.ReadLong();
     uint32 OctreeSize = rMREA.ReadLong();
-    rMREA.Skip(OctreeSize); // Skipping the octree for now
+
+    std::vector<uint8> OctreeData(OctreeSize);
+    rMREA.ReadBytes(OctreeData.data(), OctreeSize);
+    CMemoryInStream OctreeStream(OctreeData.data(), OctreeData.size(), EEndian::BigEndian);
+    CCollisionOctree* pOctree = Loader.ParseOctree(OctreeStream, RootType, Loader.mpMesh->mAABox);
 
     // Read collision indices and return
     Loader.LoadCollisionIndices(rMREA, Loader.mpMesh->mIndexData);
 
     CCollisionMeshGroup* pOut = new CCollisionMeshGroup();
     pOut->AddMesh(Loader.mpMesh);
+    pOut->SetOctree(pOctree);
     return pOut;
 }
 
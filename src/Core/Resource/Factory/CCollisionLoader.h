@@ -4,6 +4,7 @@
 #include "Core/Resource/Collision/CCollisionMesh.h"
 #include "Core/Resource/Collision/CCollisionMeshGroup.h"
 #include "Core/Resource/Collision/CCollidableOBBTree.h"
+#include "Core/Resource/Collision/CCollisionOctree.h"
 #include <Common/EGame.h>
 
 class CCollisionLoader
@@ -14,11 +15,9 @@ class CCollisionLoader
 
     CCollisionLoader();
 
-#if 0
-    CCollisionMesh::CCollisionOctree* ParseOctree(IInputStream& rSrc);
-    CCollisionMesh::CCollisionOctree::SBranch* ParseOctreeBranch(IInputStream& rSrc);
-    CCollisionMesh::CCollisionOctree::SLeaf* ParseOctreeLeaf(IInputStream& rSrc);
-#endif
+    CCollisionOctree*   ParseOctree(IInputStream& Src, ECollisionOctreeNodeType RootType, const CAABox& kBounds);
+    void                ParseOctreeBranch(IInputStream& Src, CCollisionOctree& Octree, uint NodeIdx, const CAABox& kBounds);
+    void                ParseOctreeLeaf(IInputStream& Src, CCollisionOctree& Octree, uint NodeIdx);
 
     SOBBTreeNode*   ParseOBBNode(IInputStream& DCLN);
     void            LoadCollisionMaterial(IInputStream& Src, CCollisionMaterial& OutMaterial);
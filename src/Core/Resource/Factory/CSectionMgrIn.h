@@ -24,6 +24,11 @@ public:
             mSectionSizes[iSec] = pSrc->ReadLong();
     }
 
+    CSectionMgrIn(const std::vector<uint32>& rkSectionSizes, IInputStream* pSrc)
+        : mpInputStream(pSrc)
+        , mSectionSizes(rkSectionSizes)
+    {}
+
     inline void Init()
     {
         // Initializes the block manager and marks the start of the first block
@@ -53,6 +58,7 @@ public:
     inline uint32 NextOffset()                      { return mCurSecStart + mSectionSizes[mCurSec]; }
     inline uint32 CurrentSection()                  { return mCurSec; }
     inline uint32 CurrentSectionSize()              { return mSectionSizes[mCurSec]; }
+    inline uint32 SectionSize(uint32 SecNum)        { return mSectionSizes[SecNum]; }
     inline uint32 NumSections()                     { return mSectionSizes.size(); }
     inline void SetInputStream(IInputStream *pIn)   { mpInputStream = pIn; }
 };
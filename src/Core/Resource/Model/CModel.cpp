@@ -161,6 +161,35 @@ void CModel::DrawSurface(FRenderOptions Options, uint32 Surface, uint32 MatSet)
     mVBO.Unbind();
 }
 
+void CModel::DrawInstanced(FRenderOptions Options, uint32 MatSet, uint32 NumInstances)
+{
+    // Per-instance transforms and tints are read from CGraphics::sInstanceBlock
+    if (!mBuffered) BufferGL();
+
+    if (MatSet >= mMaterialSets.size())
+        MatSet = mMaterialSets.size() - 1;
+
+    Options |= ERenderOption::DrawInstanced;
+    mVBO.Bind();
+    glLineWidth(1.f);
+
+    for (uint32 iSurf = 0; iSurf < mSurfaces.size(); iSurf++)
+    {
+        CMaterial *pMat = mMaterialSets[MatSet]->MaterialByIndex(mSurfaces[iSurf]->MaterialID);
+
+        if (!Options.HasFlag(ERenderOption::EnableOccluders) && pMat->Options().HasFlag(EMaterialOption::Occluder))
+            continue;
+
+        if (!pMat->SetCurrent(Options))
+            continue;
+
+        for (uint32 iIBO = 0; iIBO < mSurfaceIndexBuffers[iSurf].size(); iIBO++)
+            mSurfaceIndexBuffers[iSurf][iIBO].DrawElementsInstanced(NumInstances);
+    }
+
+    mVBO.Unbind();
+}
+
 void CModel::DrawWireframe(FRenderOptions Options, CColor WireColor /*= CColor::skWhite*/)
 {
     if (!mBuffered) BufferGL();
@@ -277,6 +306,20 @@ bool CModel::IsSurfaceTransparent(uint32 Surface, uint32 MatSet)
     return (mMaterialSets[MatSet]->MaterialByIndex(matID)->Options() & EMaterialOption::Transparent) != 0;
 }
 
+bool CModel::SupportsInstancing(uint32 MatSet)
+{
+    if (IsSkinned())
+        return false;
+
+    if (MatSet >= mMaterialSets.size())
+        MatSet = mMaterialSets.size() - 1;
+
+    for (uint32 iMat = 0; iMat < mMaterialSets[MatSet]->NumMaterials(); iMat++)
+        if (!mMaterialSets[MatSet]->MaterialByIndex(iMat)->SupportsInstancing()) return false;
+
+    return true;
+}
+
 bool CModel::IsLightmapped() const
 {
     for (uint32 iSet = 0; iSet < mMaterialSets.size(); iSet++)
@@ -31,6 +31,7 @@ public:
     void ClearGLBuffer();
     void Draw(FRenderOptions Options, uint32 MatSet);
     void DrawSurface(FRenderOptions Options, uint32 Surface, uint32 MatSet);
+    void DrawInstanced(FRenderOptions Options, uint32 MatSet, uint32 NumInstances);
     void DrawWireframe(FRenderOptions Options, CColor WireColor = CColor::skWhite);
     void SetSkin(CSkin *pSkin);
 
@@ -41,6 +42,7 @@ public:
     CMaterial* GetMaterialBySurface(uint32 MatSet, uint32 Surface);
     bool HasTransparency(uint32 MatSet);
     bool IsSurfaceTransparent(uint32 Surface, uint32 MatSet);
+    bool SupportsInstancing(uint32 MatSet);
     bool IsLightmapped() const;
 
     inline bool IsSkinned() const       { return (mpSkin != nullptr); }
@@ -1,6 +1,7 @@
 #include "CStaticModel.h"
 #include "Core/Render/CDrawUtil.h"
 #include "Core/Render/CRenderer.h"
+#include "Core/OpenGL/CGLBackend.h"
 #include "Core/OpenGL/GLCommon.h"
 
 CStaticModel::CStaticModel()
@@ -119,9 +120,8 @@ void CStaticModel::Draw(FRenderOptions Options)
     {
         CIndexBuffer *pIBO = &mIBOs[iIBO];
         pIBO->Bind();
-        glDrawElements(pIBO->GetPrimitiveType(), pIBO->GetSize(), GL_UNSIGNED_SHORT, (void*) 0);
+        CGLBackend::DrawElements(pIBO->GetPrimitiveType(), pIBO->GetSize(), GL_UNSIGNED_SHORT, (void*) 0);
         pIBO->Unbind();
-        gDrawCount++;
     }
 
     mVBO.Unbind();
@@ -146,7 +146,6 @@ void CStaticModel::DrawSurface(FRenderOptions Options, uint32 Surface)
 
         // Now we have both, so we can draw
         mIBOs[iIBO].DrawElements(Offset, Size);
-        gDrawCount++;
     }
 
     mVBO.Unbind();
@@ -0,0 +1,264 @@
+#include "CSurfaceBVH.h"
+#include "SSurface.h"
+#include <Common/Math/MathUtil.h>
+#include <algorithm>
+#include <cfloat>
+
+// Max number of triangles stored in a single leaf
+static const uint32 gkMaxLeafTriangles = 4;
+
+CSurfaceBVH::CSurfaceBVH(const SSurface& rkSurface)
+{
+    // Unpack every triangle primitive into a flat list, using the same winding as SSurface::IntersectsRay
+    std::vector<STriangle> Triangles;
+    Triangles.reserve(rkSurface.TriangleCount);
+
+    for (const SSurface::SPrimitive& rkPrim : rkSurface.Primitives)
+    {
+        const std::vector<CVertex>& rkVerts = rkPrim.Vertices;
+        uint32 NumVerts = rkVerts.size();
+
+        switch (rkPrim.Type)
+        {
+        case EPrimitiveType::Triangles:
+            for (uint32 iVtx = 0; iVtx + 2 < NumVerts; iVtx += 3)
+                Triangles.push_back( STriangle { rkVerts[iVtx].Position, rkVerts[iVtx+1].Position, rkVerts[iVtx+2].Position } );
+            break;
+
+        case EPrimitiveType::TriangleFan:
+            for (uint32 iTri = 0; iTri + 2 < NumVerts; iTri++)
+                Triangles.push_back( STriangle { rkVerts[0].Position, rkVerts[iTri+1].Position, rkVerts[iTri+2].Position } );
+            break;
+
+        case EPrimitiveType::TriangleStrip:
+            for (uint32 iTri = 0; iTri + 2 < NumVerts; iTri++)
+            {
+                if (iTri & 0x1)
+                    Triangles.push_back( STriangle { rkVerts[iTri+2].Position, rkVerts[iTri+1].Position, rkVerts[iTri].Position } );
+                else
+                    Triangles.push_back( STriangle { rkVerts[iTri].Position, rkVerts[iTri+1].Position, rkVerts[iTri+2].Position } );
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (Triangles.empty())
+        return;
+
+    std::vector<uint32> TriIndices(Triangles.size());
+    std::vector<CVector3f> Centroids(Triangles.size());
+
+    for (uint32 iTri = 0; iTri < Triangles.size(); iTri++)
+    {
+        const STriangle& rkTri = Triangles[iTri];
+        TriIndices[iTri] = iTri;
+        Centroids[iTri] = (rkTri.A + rkTri.B + rkTri.C) / 3.f;
+    }
+
+    mNodes.reserve( (Triangles.size() / gkMaxLeafTriangles + 1) * 2 );
+    BuildNode(TriIndices, Centroids, 0, TriIndices.size());
+
+    // Store triangles in leaf order
+    mTriangles.resize(Triangles.size());
+
+    for (uint32 iTri = 0; iTri < TriIndices.size(); iTri++)
+        mTriangles[iTri] = Triangles[ TriIndices[iTri] ];
+
+    // Compute node bounds bottom-up; children are always stored after their parent
+    for (uint32 iNode = mNodes.size(); iNode-- > 0; )
+    {
+        SNode& rNode = mNodes[iNode];
+
+        if (rNode.Count > 0)
+        {
+            rNode.Min = rNode.Max = mTriangles[rNode.Offset].A;
+
+            for (uint32 iTri = rNode.Offset; iTri < rNode.Offset + rNode.Count; iTri++)
+            {
+                const STriangle& rkTri = mTriangles[iTri];
+                const CVector3f* pkVerts[3] = { &rkTri.A, &rkTri.B, &rkTri.C };
+
+                for (const CVector3f* pkVert : pkVerts)
+                {
+                    rNode.Min = CVector3f( Math::Min(rNode.Min.X, pkVert->X), Math::Min(rNode.Min.Y, pkVert->Y), Math::Min(rNode.Min.Z, pkVert->Z) );
+                    rNode.Max = CVector3f( Math::Max(rNode.Max.X, pkVert->X), Math::Max(rNode.Max.Y, pkVert->Y), Math::Max(rNode.Max.Z, pkVert->Z) );
+                }
+            }
+        }
+        else
+        {
+            const SNode& rkLeft = mNodes[iNode + 1];
+            const SNode& rkRight = mNodes[rNode.Offset];
+            rNode.Min = CVector3f( Math::Min(rkLeft.Min.X, rkRight.Min.X), Math::Min(rkLeft.Min.Y, rkRight.Min.Y), Math::Min(rkLeft.Min.Z, rkRight.Min.Z) );
+            rNode.Max = CVector3f( Math::Max(rkLeft.Max.X, rkRight.Max.X), Math::Max(rkLeft.Max.Y, rkRight.Max.Y), Math::Max(rkLeft.Max.Z, rkRight.Max.Z) );
+        }
+    }
+}
+
+uint32 CSurfaceBVH::BuildNode(std::vector<uint32>& rTriIndices, const std::vector<CVector3f>& rkCentroids, uint32 Start, uint32 End)
+{
+    uint32 NodeIndex = mNodes.size();
+    mNodes.emplace_back();
+
+    uint32 Count = End - Start;
+
+    // Find the bounds of the triangle centroids to choose a split axis
+    CVector3f Min = rkCentroids[ rTriIndices[Start] ];
+    CVector3f Max = Min;
+
+    for (uint32 iTri = Start + 1; iTri < End; iTri++)
+    {
+        const CVector3f& rkCentroid = rkCentroids[ rTriIndices[iTri] ];
+        Min = CVector3f( Math::Min(Min.X, rkCentroid.X), Math::Min(Min.Y, rkCentroid.Y), Math::Min(Min.Z, rkCentroid.Z) );
+        Max = CVector3f( Math::Max(Max.X, rkCentroid.X), Math::Max(Max.Y, rkCentroid.Y), Math::Max(Max.Z, rkCentroid.Z) );
+    }
+
+    CVector3f Extent = Max - Min;
+    float LargestExtent = Math::Max(Extent.X, Math::Max(Extent.Y, Extent.Z));
+
+    // Make a leaf if there are few enough triangles, or if they all share a centroid and can't be split
+    if (Count <= gkMaxLeafTriangles || LargestExtent <= 0.f)
+    {
+        SNode& rNode = mNodes[NodeIndex];
+        rNode.Offset = Start;
+        rNode.Count = Count;
+        return NodeIndex;
+    }
+
+    // Split at the median centroid along the largest axis
+    int Axis = (Extent.X == LargestExtent ? 0 : (Extent.Y == LargestExtent ? 1 : 2));
+    uint32 Mid = Start + (Count / 2);
+
+    std::nth_element(rTriIndices.begin() + Start, rTriIndices.begin() + Mid, rTriIndices.begin() + End,
+                     [&rkCentroids, Axis](uint32 Left, uint32 Right)
+    {
+        return rkCentroids[Left][Axis] < rkCentroids[Right][Axis];
+    });
+
+    BuildNode(rTriIndices, rkCentroids, Start, Mid);
+    uint32 RightChild = BuildNode(rTriIndices, rkCentroids, Mid, End);
+
+    SNode& rNode = mNodes[NodeIndex];
+    rNode.Offset = RightChild;
+    rNode.Count = 0;
+    return NodeIndex;
+}
+
+std::pair<bool,float> CSurfaceBVH::IntersectsRay(const CRay& rkRay, bool AllowBackfaces) const
+{
+    bool Hit = false;
+    float HitDist = 0.f;
+
+    if (mNodes.empty())
+        return std::pair<bool,float>(false, 0.f);
+
+    // Precompute the inverse direction for the slab tests. Zero components are nudged to avoid 0 * inf.
+    const CVector3f& rkOrigin = rkRay.Origin();
+    const CVector3f& rkDir = rkRay.Direction();
+
+    auto SafeInverse = [](float Value) -> float
+    {
+        const float skTiny = 1e-30f;
+        if (Value > -skTiny && Value < skTiny) Value = (Value < 0.f ? -skTiny : skTiny);
+        return 1.f / Value;
+    };
+    CVector3f InvDir( SafeInverse(rkDir.X), SafeInverse(rkDir.Y), SafeInverse(rkDir.Z) );
+
+    // Returns the entry distance of the ray into the node's bounds, or a negative value on a miss
+    auto NodeEntry = [&](const SNode& rkNode) -> float
+    {
+        float TMin = 0.f;
+        float TMax = (Hit ? HitDist : FLT_MAX);
+
+        for (int Axis = 0; Axis < 3; Axis++)
+        {
+            float T1 = (rkNode.Min[Axis] - rkOrigin[Axis]) * InvDir[Axis];
+            float T2 = (rkNode.Max[Axis] - rkOrigin[Axis]) * InvDir[Axis];
+            if (T1 > T2) std::swap(T1, T2);
+            TMin = Math::Max(TMin, T1);
+            TMax = Math::Min(TMax, T2);
+            if (TMin > TMax) return -1.f;
+        }
+
+        return TMin;
+    };
+
+    // Median splits halve the triangle count at every level, so the tree can't get deep enough to overflow this
+    uint32 Stack[64];
+    uint32 StackSize = 0;
+    uint32 NodeIndex = 0;
+
+    if (NodeEntry(mNodes[0]) < 0.f)
+        return std::pair<bool,float>(false, 0.f);
+
+    while (true)
+    {
+        const SNode& rkNode = mNodes[NodeIndex];
+
+        if (rkNode.Count > 0)
+        {
+            for (uint32 iTri = rkNode.Offset; iTri < rkNode.Offset + rkNode.Count; iTri++)
+            {
+                const STriangle& rkTri = mTriangles[iTri];
+                std::pair<bool,float> TriResult = Math::RayTriangleIntersection(rkRay, rkTri.A, rkTri.B, rkTri.C, AllowBackfaces);
+
+                if (TriResult.first && (!Hit || TriResult.second < HitDist))
+                {
+                    Hit = true;
+                    HitDist = TriResult.second;
+                }
+            }
+        }
+
+        else
+        {
+            // Visit the nearer child first so farther subtrees can be skipped once a hit is found
+            uint32 Near = NodeIndex + 1;
+            uint32 Far = rkNode.Offset;
+            float NearDist = NodeEntry(mNodes[Near]);
+            float FarDist = NodeEntry(mNodes[Far]);
+
+            if (NearDist >= 0.f && FarDist >= 0.f && FarDist < NearDist)
+            {
+                std::swap(Near, Far);
+                std::swap(NearDist, FarDist);
+            }
+
+            if (NearDist >= 0.f)
+            {
+                if (FarDist >= 0.f)
+                    Stack[StackSize++] = Far;
+
+                NodeIndex = Near;
+                continue;
+            }
+            else if (FarDist >= 0.f)
+            {
+                NodeIndex = Far;
+                continue;
+            }
+        }
+
+        // Pop the next node, skipping any that are now farther than the closest hit
+        bool Found = false;
+
+        while (StackSize > 0)
+        {
+            NodeIndex = Stack[--StackSize];
+
+            if (NodeEntry(mNodes[NodeIndex]) >= 0.f)
+            {
+                Found = true;
+                break;
+            }
+        }
+
+        if (!Found)
+            break;
+    }
+
+    return std::pair<bool,float>(Hit, HitDist);
+}
@@ -0,0 +1,43 @@
+#ifndef CSURFACEBVH_H
+#define CSURFACEBVH_H
+
+#include <Common/BasicTypes.h>
+#include <Common/Math/CRay.h>
+#include <Common/Math/CVector3f.h>
+#include <vector>
+
+struct SSurface;
+
+// Static bounding volume hierarchy over the triangles of a single surface, used for picking.
+// Triangles are unpacked from strips/fans once when the tree is built and stored in leaf order,
+// and nodes are laid out depth-first in a flat array so traversal walks contiguous memory.
+class CSurfaceBVH
+{
+    struct SNode
+    {
+        CVector3f Min;
+        uint32 Offset;  // Interior nodes: index of the second child (the first child directly follows). Leaves: first triangle index.
+        CVector3f Max;
+        uint32 Count;   // Number of triangles; 0 for interior nodes
+    };
+
+    struct STriangle
+    {
+        CVector3f A, B, C;
+    };
+
+    std::vector<SNode> mNodes;
+    std::vector<STriangle> mTriangles;
+
+public:
+    CSurfaceBVH(const SSurface& rkSurface);
+    std::pair<bool,float> IntersectsRay(const CRay& rkRay, bool AllowBackfaces) const;
+
+    inline uint32 NumNodes() const      { return mNodes.size(); }
+    inline uint32 NumTriangles() const  { return mTriangles.size(); }
+
+protected:
+    uint32 BuildNode(std::vector<uint32>& rTriIndices, const std::vector<CVector3f>& rkCentroids, uint32 Start, uint32 End);
+};
+
+#endif // CSURFACEBVH_H
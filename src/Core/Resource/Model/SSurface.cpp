@@ -1,78 +1,49 @@
 #include "SSurface.h"
+#include "CSurfaceBVH.h"
 #include "Core/Render/CDrawUtil.h"
 #include "Core/CRayCollisionTester.h"
 #include <Common/Math/MathUtil.h>
 
-std::pair<bool,float> SSurface::IntersectsRay(const CRay& rkRay, bool AllowBackfaces, float LineThreshold)
+SSurface::SSurface()
+    : VertexCount(0)
+    , TriangleCount(0)
+    , HasLines(false)
 {
-    bool Hit = false;
-    float HitDist;
+}
 
-    for (uint32 iPrim = 0; iPrim < Primitives.size(); iPrim++)
+SSurface::~SSurface()
+{
+}
+
+std::pair<bool,float> SSurface::IntersectsRay(const CRay& rkRay, bool AllowBackfaces, float LineThreshold)
+{
+    if (!pTriangleBVH)
     {
-        SPrimitive *pPrim = &Primitives[iPrim];
-        uint32 NumVerts = pPrim->Vertices.size();
+        pTriangleBVH = std::make_unique<CSurfaceBVH>(*this);
+        HasLines = false;
 
-        // Triangles
-        if ((pPrim->Type == EPrimitiveType::Triangles) || (pPrim->Type == EPrimitiveType::TriangleFan) || (pPrim->Type == EPrimitiveType::TriangleStrip))
+        for (const SPrimitive& rkPrim : Primitives)
         {
-            uint32 NumTris;
-
-            if (pPrim->Type == EPrimitiveType::Triangles)
-                NumTris = NumVerts / 3;
-            else
-                NumTris = NumVerts - 2;
-
-            for (uint32 iTri = 0; iTri < NumTris; iTri++)
+            if (rkPrim.Type == EPrimitiveType::Lines || rkPrim.Type == EPrimitiveType::LineStrip)
             {
-                CVector3f VtxA, VtxB, VtxC;
-
-                // Get the three vertices that make up the current tri
-                if (pPrim->Type == EPrimitiveType::Triangles)
-                {
-                    uint32 VertIndex = iTri * 3;
-                    VtxA = pPrim->Vertices[VertIndex].Position;
-                    VtxB = pPrim->Vertices[VertIndex+1].Position;
-                    VtxC = pPrim->Vertices[VertIndex+2].Position;
-                }
-
-                else if (pPrim->Type == EPrimitiveType::TriangleFan)
-                {
-                    VtxA = pPrim->Vertices[0].Position;
-                    VtxB = pPrim->Vertices[iTri+1].Position;
-                    VtxC = pPrim->Vertices[iTri+2].Position;
-                }
-
-                else if (pPrim->Type == EPrimitiveType::TriangleStrip)
-                {
-                    if (iTri & 0x1)
-                    {
-                        VtxA = pPrim->Vertices[iTri+2].Position;
-                        VtxB = pPrim->Vertices[iTri+1].Position;
-                        VtxC = pPrim->Vertices[iTri].Position;
-                    }
+                HasLines = true;
+                break;
+            }
+        }
+    }
 
-                    else
-                    {
-                        VtxA = pPrim->Vertices[iTri].Position;
-                        VtxB = pPrim->Vertices[iTri+1].Position;
-                        VtxC = pPrim->Vertices[iTri+2].Position;
-                    }
-                }
+    // Triangles
+    std::pair<bool,float> TriResult = pTriangleBVH->IntersectsRay(rkRay, AllowBackfaces);
+    bool Hit = TriResult.first;
+    float HitDist = TriResult.second;
 
-                // Intersection test
-                std::pair<bool,float> TriResult = Math::RayTriangleIntersection(rkRay, VtxA, VtxB, VtxC, AllowBackfaces);
+    if (!HasLines)
+        return TriResult;
 
-                if (TriResult.first)
-                {
-                    if ((!Hit) || (TriResult.second < HitDist))
-                    {
-                        Hit = true;
-                        HitDist = TriResult.second;
-                    }
-                }
-            }
-        }
+    for (uint32 iPrim = 0; iPrim < Primitives.size(); iPrim++)
+    {
+        SPrimitive *pPrim = &Primitives[iPrim];
+        uint32 NumVerts = pPrim->Vertices.size();
 
         // Lines
         if ((pPrim->Type == EPrimitiveType::Lines) || (pPrim->Type == EPrimitiveType::LineStrip))
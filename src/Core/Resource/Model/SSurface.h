@@ -10,8 +10,11 @@
 #include <Common/Math/CRay.h>
 #include <Common/Math/CTransform4f.h>
 #include <Common/Math/CVector3f.h>
+#include <memory>
 #include <vector>
 
+class CSurfaceBVH;
+
 // Should prolly be a class
 struct SSurface
 {
@@ -30,11 +33,12 @@ struct SSurface
     };
     std::vector<SPrimitive> Primitives;
 
-    SSurface()
-    {
-        VertexCount = 0;
-        TriangleCount = 0;
-    }
+    // Triangle BVH for ray tests; built on the first ray test, so primitives shouldn't change after that
+    std::unique_ptr<CSurfaceBVH> pTriangleBVH;
+    bool HasLines;
+
+    SSurface();
+    ~SSurface();
 
     std::pair<bool,float> IntersectsRay(const CRay& rkRay, bool AllowBackfaces = false, float LineThreshold = 0.02f);
 };
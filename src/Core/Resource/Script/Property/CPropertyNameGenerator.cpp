@@ -2,7 +2,159 @@
 #include "IUIRelay.h"
 #include "Core/Resource/Script/CGameTemplate.h"
 #include "Core/Resource/Script/NPropertyMap.h"
+#include "Core/ParallelUtil.h"
 #include <Common/Hash/CCRC32.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+/** CRC32 tables matching CCRC32 (reflected polynomial 0xEDB88320, initial value 0xFFFFFFFF, no final XOR).
+ *  CRC32 is linear in its state, so appending a fixed string to any state is the same as advancing the state
+ *  by that many zero bytes and then XORing in the string's hash from a zero state. Advancing by N zero bytes is
+ *  itself linear, so it's precomputed per string length as four byte-indexed tables, which makes appending a
+ *  whole word cost four lookups regardless of its length.
+ */
+struct SPropertyHashString
+{
+    TString String;
+    uint32 Hash;
+    uint32 Length;
+};
+
+class CPropertyHashTables
+{
+    /** Standard byte-at-a-time table */
+    uint32 mByteTable[256];
+
+    /** Zero-byte advance tables, 1024 entries per string length */
+    std::vector<uint32> mAdvanceTables;
+    uint32 mNumAdvanceLengths;
+
+public:
+    static const uint32 skInitialState = 0xFFFFFFFF;
+
+    CPropertyHashTables()
+        : mNumAdvanceLengths(0)
+    {
+        for (uint32 Byte = 0; Byte < 256; Byte++)
+        {
+            uint32 Value = Byte;
+
+            for (uint32 Bit = 0; Bit < 8; Bit++)
+                Value = (Value & 1) ? (Value >> 1) ^ 0xEDB88320 : (Value >> 1);
+
+            mByteTable[Byte] = Value;
+        }
+
+        // Length 0 is the identity
+        mAdvanceTables.resize(1024);
+
+        for (uint32 Part = 0; Part < 4; Part++)
+            for (uint32 Value = 0; Value < 256; Value++)
+                mAdvanceTables[Part * 256 + Value] = Value << (Part * 8);
+
+        mNumAdvanceLengths = 1;
+    }
+
+    uint32 HashString(uint32 State, const char* pkString, uint32 Length) const
+    {
+        for (uint32 CharIdx = 0; CharIdx < Length; CharIdx++)
+            State = (State >> 8) ^ mByteTable[(State ^ (uint8) pkString[CharIdx]) & 0xFF];
+
+        return State;
+    }
+
+    SPropertyHashString PrepareString(const TString& rkString)
+    {
+        // Make sure there is an advance table for this length; each one is the previous one advanced by a zero byte
+        while (mNumAdvanceLengths <= rkString.Size())
+        {
+            uint32 PrevStart = (mNumAdvanceLengths - 1) * 1024;
+            mAdvanceTables.resize(mAdvanceTables.size() + 1024);
+
+            for (uint32 Entry = 0; Entry < 1024; Entry++)
+            {
+                uint32 State = mAdvanceTables[PrevStart + Entry];
+                mAdvanceTables[PrevStart + 1024 + Entry] = (State >> 8) ^ mByteTable[State & 0xFF];
+            }
+
+            mNumAdvanceLengths++;
+        }
+
+        SPropertyHashString Out;
+        Out.String = rkString;
+        Out.Hash = HashString(0, *rkString, rkString.Size());
+        Out.Length = rkString.Size();
+        return Out;
+    }
+
+    inline uint32 Append(uint32 State, const SPropertyHashString& rkString) const
+    {
+        const uint32* pkTable = &mAdvanceTables[rkString.Length * 1024];
+
+        return pkTable[State & 0xFF] ^
+               pkTable[256 + ((State >> 8) & 0xFF)] ^
+               pkTable[512 + ((State >> 16) & 0xFF)] ^
+               pkTable[768 + (State >> 24)] ^
+               rkString.Hash;
+    }
+};
+
+/** Flat open-addressing set of property IDs, used to reject candidates before doing any real lookups */
+class CPropertyIDSet
+{
+    std::vector<uint32> mSlots;
+    uint32 mMask;
+    bool mHasZero;
+
+public:
+    CPropertyIDSet(const std::vector<uint32>& rkIDs)
+        : mHasZero(false)
+    {
+        // Keep the load factor at or below 50%
+        uint32 NumSlots = 16;
+
+        while (NumSlots < rkIDs.size() * 2)
+            NumSlots <<= 1;
+
+        mSlots.resize(NumSlots, 0);
+        mMask = NumSlots - 1;
+
+        // Zero marks an empty slot, so it's tracked separately
+        for (uint32 ID : rkIDs)
+        {
+            if (ID == 0)
+            {
+                mHasZero = true;
+                continue;
+            }
+
+            uint32 Slot = ID & mMask;
+
+            while (mSlots[Slot] != 0 && mSlots[Slot] != ID)
+                Slot = (Slot + 1) & mMask;
+
+            mSlots[Slot] = ID;
+        }
+    }
+
+    inline bool Contains(uint32 ID) const
+    {
+        if (ID == 0)
+            return mHasZero;
+
+        // CRCs are already well distributed, so the low bits make a fine hash
+        for (uint32 Slot = ID & mMask; mSlots[Slot] != 0; Slot = (Slot + 1) & mMask)
+        {
+            if (mSlots[Slot] == ID)
+                return true;
+        }
+
+        return false;
+    }
+};
 
 /** Default constructor */
 CPropertyNameGenerator::CPropertyNameGenerator()
@@ -85,173 +237,260 @@ void CPropertyNameGenerator::Generate(const SPropertyNameGenerationParameters& r
     }
 
     // Calculate the number of steps involved in this task.
-    const int kNumWords = mWords.size();
+    const uint kNumWords = mWords.size();
+    const uint kNumTypes = mTypeNames.size();
     const int kMaxWords = rkParams.MaxWords;
-    int TestsDone = 0;
-    int TotalTests = 1;
+    uint64 TotalTests = 0;
+    uint64 TestsAtLength = 1;
 
     for (int i = 0; i < kMaxWords; i++)
-        TotalTests *= kNumWords;
+    {
+        TestsAtLength *= kNumWords;
+        TotalTests += TestsAtLength;
+    }
 
     pProgress->SetOneShotTask("Generating property names");
-    pProgress->Report(TestsDone, TotalTests);
-
-    // Configure params needed to run the name generation!
-    bool WriteToLog = rkParams.PrintToLog;
-    bool SaveResults = true;
+    pProgress->Report(0, 1);
 
-    // The prefix only needs to be hashed this one time
-    CCRC32 PrefixHash;
-    PrefixHash.Hash( *rkParams.Prefix );
+    // Precompute the hash contribution of every string we append. Each word has two variants: one for the
+    // start of the name (which is lowercased for camelCase) and one for every other position (which has a
+    // leading underscore for Snake_Case). The suffix and type name always come together, so they're one string.
+    CPropertyHashTables Tables;
+    std::vector<SPropertyHashString> FirstWords(kNumWords);
+    std::vector<SPropertyHashString> OtherWords(kNumWords);
+    std::vector<SPropertyHashString> Tails(kNumTypes);
 
-    // Use a stack to keep track of the current word we are on. We can use this
-    // to cache the hash of a word and then re-use it later instead of recaculating
-    // the same hashes over and over. Init the stack with the first word.
-    struct SWordCache
+    for (uint WordIdx = 0; WordIdx < kNumWords; WordIdx++)
     {
-        int WordIndex;
-        CCRC32 Hash;
-    };
-    std::vector<SWordCache> WordCache;
+        TString First = mWords[WordIdx].Word;
+        TString Other = mWords[WordIdx].Word;
+
+        if (rkParams.Casing == ENameCasing::camelCase && !First.IsEmpty())
+            First[0] = TString::CharToLower(First[0]);
+
+        if (rkParams.Casing == ENameCasing::Snake_Case)
+            Other = TString("_") + Other;
+
+        FirstWords[WordIdx] = Tables.PrepareString(First);
+        OtherWords[WordIdx] = Tables.PrepareString(Other);
+    }
+
+    for (uint TypeIdx = 0; TypeIdx < kNumTypes; TypeIdx++)
+        Tails[TypeIdx] = Tables.PrepareString(rkParams.Suffix + mTypeNames[TypeIdx]);
 
-    SWordCache FirstWord { -1, CCRC32() };
-    WordCache.push_back(FirstWord);
+    const uint32 kPrefixState = Tables.HashString(CPropertyHashTables::skInitialState, *rkParams.Prefix, rkParams.Prefix.Size());
 
-    while ( true )
+    // Make sure the tables agree with CCRC32 before trusting them with the whole search
+    if (kNumWords > 0)
     {
-        // Increment the current word, handle wrapping back to 0, and update cached hashes as needed.
-        int RecalcIndex = WordCache.size() - 1;
-        WordCache.back().WordIndex++;
+        CCRC32 Check;
+        Check.Hash( *rkParams.Prefix );
+        Check.Hash( *FirstWords[0].String );
+        Check.Hash( *OtherWords[kNumWords - 1].String );
+        Check.Hash( *Tails[0].String );
 
-        while (WordCache[RecalcIndex].WordIndex >= kNumWords)
-        {
-            WordCache[RecalcIndex].WordIndex = 0;
+        uint32 State = Tables.Append(kPrefixState, FirstWords[0]);
+        State = Tables.Append(State, OtherWords[kNumWords - 1]);
+        State = Tables.Append(State, Tails[0]);
 
-            if (RecalcIndex > 0)
-            {
-                RecalcIndex--;
-                WordCache[RecalcIndex].WordIndex++;
-            }
-            else
-            {
-                SWordCache NewWord { 0, CCRC32() };
-                WordCache.push_back(NewWord);
-            }
+        if (State != Check.Digest())
+        {
+            errorf("Property name generator hash tables don't match CCRC32; aborting generation");
+            mIsRunning = false;
+            mFinishedRunning = true;
+            return;
         }
+    }
 
-        // If we've hit the word limit, break out and end the name generation system.
-        if (WordCache.size() > kMaxWords)
-            break;
+    // Gather every ID we might accept. Hitting this set is rare, so candidates that pass it are
+    // re-checked against the full rules (type, already-named, int-as-choice) under the result lock.
+    std::vector<uint32> TargetIDs;
 
-        // Now that all words are updated, calculate the new hashes.
-        CCRC32 LastValidHash = (RecalcIndex > 0 ? WordCache[RecalcIndex-1].Hash : PrefixHash);
+    if (!mValidTypePairMap.empty())
+    {
+        for (auto Iter = mValidTypePairMap.begin(); Iter != mValidTypePairMap.end(); Iter++)
+            TargetIDs.push_back(Iter->first);
+    }
+    else
+    {
+        for (NPropertyMap::CIterator Iter; Iter; ++Iter)
+            TargetIDs.push_back(Iter.ID());
+    }
 
-        for (; RecalcIndex < WordCache.size(); RecalcIndex++)
+    CPropertyIDSet TargetSet(TargetIDs);
+
+    // Split the search into one job per (word count, first word) pair. Results are kept per job so the
+    // final output is in the same order as a serial search, regardless of which thread found what.
+    const uint kNumJobs = kMaxWords * kNumWords;
+    std::vector< std::list<SGeneratedPropertyName> > JobResults(kNumJobs);
+    std::atomic<uint64> TestsDone(0);
+    std::atomic<bool> Cancelled(false);
+    std::atomic<bool> SearchFinished(false);
+    std::mutex ResultLock;
+
+    // Having too many saved results can cause memory issues and crashing, so the total number saved across every
+    // job is capped; anything past the cap is written to the log instead. Once the cap is reached, a new result only
+    // replaces the last saved one in search order, so the saved results are always the first ones found by a serial search.
+    const uint kMaxSavedResults = 10000;
+    std::atomic<uint> NumSavedResults(0);
+    std::set<uint> JobsWithResults;
+    bool TooManyResults = false;
+
+    auto LogResult = [](const SGeneratedPropertyName& rkName)
+    {
+        TString DelimitedXmlList;
+
+        for (auto Iter = rkName.XmlList.begin(); Iter != rkName.XmlList.end(); Iter++)
         {
-            int Index = WordCache[RecalcIndex].WordIndex;
+            DelimitedXmlList += *Iter + "\n";
+        }
 
-            // For camelcase, hash the first letter of the first word as lowercase
-            if (RecalcIndex == 0 && rkParams.Casing == ENameCasing::camelCase)
-            {
-                const char* pkWord = *mWords[Index].Word;
-                LastValidHash.Hash( TString::CharToLower( pkWord[0] ) );
-                LastValidHash.Hash( &pkWord[1] );
-            }
-            else
-            {
-                // Add an underscore for snake case
-                if (RecalcIndex > 0 && rkParams.Casing == ENameCasing::Snake_Case)
-                    LastValidHash.Hash("_");
+        debugf("%s [%s] : 0x%08X\n%s", *rkName.Name, *rkName.Type, rkName.ID, *DelimitedXmlList);
+    };
 
-                LastValidHash.Hash( *mWords[Index].Word );
-            }
+    auto HandleCandidate = [&](uint JobIdx, const std::vector<uint>& rkWordIndices, uint NumWordsUsed, uint TypeIdx, uint32 PropertyID)
+    {
+        std::lock_guard<std::mutex> Lock(ResultLock);
+        const char* pkTypeName = *mTypeNames[TypeIdx];
+
+        if (!IsValidPropertyID(PropertyID, pkTypeName, rkParams))
+            return;
+
+        SGeneratedPropertyName PropertyName;
+        NPropertyMap::RetrieveXMLsWithProperty(PropertyID, pkTypeName, PropertyName.XmlList);
+
+        // Generate a string with the complete name. (We wait to do this until now to avoid needless string allocation)
+        PropertyName.Name = rkParams.Prefix + FirstWords[ rkWordIndices[0] ].String;
 
-            WordCache[RecalcIndex].Hash = LastValidHash;
+        for (uint WordIdx = 1; WordIdx < NumWordsUsed; WordIdx++)
+            PropertyName.Name += OtherWords[ rkWordIndices[WordIdx] ].String;
+
+        PropertyName.Name += rkParams.Suffix;
+        PropertyName.Type = pkTypeName;
+        PropertyName.ID = PropertyID;
+
+        if (rkParams.PrintToLog)
+            LogResult(PropertyName);
+
+        if (NumSavedResults < kMaxSavedResults)
+        {
+            JobResults[JobIdx].push_back(PropertyName);
+            JobsWithResults.insert(JobIdx);
+            NumSavedResults++;
+            return;
         }
 
-        // We got our hash yay! Now hash the suffix and then we can test with each type name
-        CCRC32 BaseHash = LastValidHash;
-        BaseHash.Hash( *rkParams.Suffix );
+        TooManyResults = true;
+        uint LastJob = *JobsWithResults.rbegin();
 
-        for (int TypeIdx = 0; TypeIdx < mTypeNames.size(); TypeIdx++)
+        if (LastJob > JobIdx)
         {
-            CCRC32 FullHash = BaseHash;
-            const char* pkTypeName = *mTypeNames[TypeIdx];
-            FullHash.Hash( pkTypeName );
-            uint32 PropertyID = FullHash.Digest();
+            if (!rkParams.PrintToLog)
+                LogResult(JobResults[LastJob].back());
 
-            // Check if this hash is a property ID
-            if (IsValidPropertyID(PropertyID, pkTypeName, rkParams))
-            {
-                SGeneratedPropertyName PropertyName;
-                NPropertyMap::RetrieveXMLsWithProperty(PropertyID, pkTypeName, PropertyName.XmlList);
+            JobResults[LastJob].pop_back();
+            if (JobResults[LastJob].empty()) JobsWithResults.erase(LastJob);
 
-                // Generate a string with the complete name. (We wait to do this until now to avoid needless string allocation)
-                PropertyName.Name = rkParams.Prefix;
+            JobResults[JobIdx].push_back(PropertyName);
+            JobsWithResults.insert(JobIdx);
+        }
+        else if (!rkParams.PrintToLog)
+            LogResult(PropertyName);
+    };
 
-                for (int WordIdx = 0; WordIdx < WordCache.size(); WordIdx++)
-                {
-                    int Index = WordCache[WordIdx].WordIndex;
+    auto RunJob = [&](uint JobIdx, uint /*ThreadIdx*/)
+    {
+        if (Cancelled) return;
 
-                    if (WordIdx > 0 && rkParams.Casing == ENameCasing::Snake_Case)
-                    {
-                        PropertyName.Name += "_";
-                    }
+        const uint kNumWordsUsed = (JobIdx / kNumWords) + 1;
+        const uint kFirstWord = JobIdx % kNumWords;
 
-                    PropertyName.Name += mWords[Index].Word;
-                }
+        // Hash state after each word, plus the word index at each position
+        std::vector<uint32> States(kNumWordsUsed);
+        std::vector<uint> WordIndices(kNumWordsUsed, 0);
+        WordIndices[0] = kFirstWord;
+        States[0] = Tables.Append(kPrefixState, FirstWords[kFirstWord]);
 
-                if (rkParams.Casing == ENameCasing::camelCase)
-                {
-                    PropertyName.Name[0] = TString::CharToLower( PropertyName.Name[0] );
-                }
+        for (uint WordIdx = 1; WordIdx < kNumWordsUsed; WordIdx++)
+            States[WordIdx] = Tables.Append(States[WordIdx - 1], OtherWords[0]);
 
-                PropertyName.Name += rkParams.Suffix;
-                PropertyName.Type = pkTypeName;
-                PropertyName.ID = PropertyID;
+        uint64 LocalTests = 0;
+        const uint kLast = kNumWordsUsed - 1;
 
-                if (SaveResults)
-                {
-                    mGeneratedNames.push_back(PropertyName);
-
-                    // Check if we have too many saved results. This can cause memory issues and crashing.
-                    // If we have too many saved results, then to avoid crashing we will force enable log output.
-                    if (mGeneratedNames.size() > 9999)
-                    {
-                        gpUIRelay->ShowMessageBoxAsync("Warning", "There are over 10,000 results. Results will no longer print to the screen. Check the log for the remaining output.");
-                        WriteToLog = true;
-                        SaveResults = false;
-                    }
-                }
+        while (true)
+        {
+            // Test the current name against every type
+            uint32 BaseState = States[kLast];
 
-                // Log this out
-                if ( WriteToLog )
-                {
-                    TString DelimitedXmlList;
+            for (uint TypeIdx = 0; TypeIdx < kNumTypes; TypeIdx++)
+            {
+                uint32 PropertyID = Tables.Append(BaseState, Tails[TypeIdx]);
+
+                if (TargetSet.Contains(PropertyID))
+                    HandleCandidate(JobIdx, WordIndices, kNumWordsUsed, TypeIdx, PropertyID);
+            }
 
-                    for (auto Iter = PropertyName.XmlList.begin(); Iter != PropertyName.XmlList.end(); Iter++)
-                    {
-                        DelimitedXmlList += *Iter + "\n";
-                    }
+            // Periodically publish progress and check for cancellation through the shared state
+            LocalTests++;
 
-                    debugf("%s [%s] : 0x%08X\n%s", *PropertyName.Name, *PropertyName.Type, PropertyName.ID, *DelimitedXmlList);
-                }
+            if ( (LocalTests % 4096) == 0 )
+            {
+                TestsDone += 4096;
+                if (Cancelled) break;
             }
-        }
 
-        // Every 250 tests, check with the progress notifier. Update the progress
-        // bar and check whether the user has requested to cancel the operation.
-        TestsDone++;
+            // Advance to the next word combination, rehashing only the words that changed
+            int Position = (int) kLast;
 
-        if ( (TestsDone % 250) == 0 )
-        {
-            if (pProgress->ShouldCancel())
+            while (Position > 0)
+            {
+                WordIndices[Position]++;
+
+                if (WordIndices[Position] < kNumWords)
+                    break;
+
+                WordIndices[Position] = 0;
+                Position--;
+            }
+
+            if (Position == 0)
                 break;
 
-            pProgress->Report(TestsDone, TotalTests);
+            for (uint WordIdx = Position; WordIdx < kNumWordsUsed; WordIdx++)
+                States[WordIdx] = Tables.Append(States[WordIdx - 1], OtherWords[ WordIndices[WordIdx] ]);
         }
+
+        TestsDone += (LocalTests % 4096);
+    };
+
+    // The search runs on its own threads so this thread is free to talk to the progress notifier, which isn't
+    // thread safe. It reports progress and sets the cancel flag, which every worker checks, until the search is done.
+    std::thread SearchThread([&]()
+    {
+        ParallelUtil::ParallelFor(kNumJobs, RunJob);
+        SearchFinished = true;
+    });
+
+    while (!SearchFinished)
+    {
+        if (pProgress->ShouldCancel())
+            Cancelled = true;
+
+        pProgress->Report( (int) ((double) TestsDone / (double) TotalTests * 10000.0), 10000 );
+        std::this_thread::sleep_for( std::chrono::milliseconds(50) );
+    }
+
+    SearchThread.join();
+
+    // Merge results in search order
+    for (std::list<SGeneratedPropertyName>& rResults : JobResults)
+    {
+        mGeneratedNames.splice(mGeneratedNames.end(), rResults);
     }
 
+    if (TooManyResults)
+        gpUIRelay->ShowMessageBoxAsync("Warning", "There are over 10,000 results. Results will no longer print to the screen. Check the log for the remaining output.");
+
     mIsRunning = false;
     mFinishedRunning = true;
 }
@@ -3,6 +3,8 @@
 #include "Core/Render/CDrawUtil.h"
 #include "Core/Render/CGraphics.h"
 #include "Core/Render/CRenderer.h"
+#include "Core/CRayCollisionTester.h"
+#include <Common/Math/MathUtil.h>
 
 CCollisionNode::CCollisionNode(CScene *pScene, uint32 NodeID, CSceneNode *pParent, CCollisionMeshGroup *pCollision)
     : CSceneNode(pScene, NodeID, pParent)
@@ -47,6 +49,14 @@ void CCollisionNode::Draw(FRenderOptions /*Options*/, int /*ComponentIndex*/, ER
 
     CColor BaseTint = TintColor(rkViewInfo);
 
+    // Area collision has an octree; only draw the leaves that are in view
+    CCollisionOctree *pOctree = mpCollision->Octree();
+    bool CullLeaves = (pOctree && !pOctree->IsEmpty() && mpCollision->MeshByIndex(0)->GetRenderData().HasLeafOffsets());
+    std::vector<uint8> VisibleLeaves;
+
+    if (CullLeaves)
+        pOctree->FindVisibleLeaves(rkViewInfo.ViewFrustum, Transform(), VisibleLeaves);
+
     for (uint32 MeshIdx = 0; MeshIdx < mpCollision->NumMeshes(); MeshIdx++)
     {
         CCollisionMesh *pMesh = mpCollision->MeshByIndex(MeshIdx);
@@ -74,10 +84,11 @@ void CCollisionNode::Draw(FRenderOptions /*Options*/, int /*ComponentIndex*/, ER
             bool IsFloor = (rkViewInfo.CollisionSettings.TintUnwalkableTris ? kMat.IsFloor() : true) || Game == EGame::DKCReturns;
             bool IsUnstandable = (rkViewInfo.CollisionSettings.TintUnwalkableTris ? kMat.IsUnstandable(Game) : false) && Game != EGame::DKCReturns;
             CDrawUtil::UseCollisionShader(IsFloor, IsUnstandable, Tint);
-            RenderData.Render(false, MatIdx);
+            const std::vector<uint8>* pkVisibleLeaves = (CullLeaves && MeshIdx == 0 ? &VisibleLeaves : nullptr);
+            RenderData.Render(false, MatIdx, pkVisibleLeaves);
 
             if (rkViewInfo.CollisionSettings.DrawWireframe)
-                RenderData.Render(true, MatIdx);
+                RenderData.Render(true, MatIdx, pkVisibleLeaves);
         }
     }
 
@@ -103,22 +114,71 @@ void CCollisionNode::Draw(FRenderOptions /*Options*/, int /*ComponentIndex*/, ER
     {
         if (Parent() && Parent()->NodeType() == ENodeType::Root && Game != EGame::DKCReturns)
         {
-            CDrawUtil::DrawWireCube( mpCollision->MeshByIndex(0)->Bounds(), CColor::skRed );
+            CDrawUtil::BatchWireCube( mpCollision->MeshByIndex(0)->Bounds(), CColor::skRed );
+        }
+    }
+}
+
+void CCollisionNode::RayAABoxIntersectTest(CRayCollisionTester& rTester, const SViewInfo& rkViewInfo)
+{
+    if (!mpCollision || rkViewInfo.GameMode) return;
+
+    // Actor collision is ray tested by the owning script node, so check it's actually being shown
+    if (Parent() && Parent()->NodeType() == ENodeType::Script && !(rkViewInfo.ShowFlags & EShowFlag::ObjectCollision))
+        return;
+
+    const CRay& rkRay = rTester.Ray();
+    std::pair<bool,float> BoxResult = AABox().IntersectsRay(rkRay);
+
+    if (BoxResult.first)
+    {
+        for (uint32 MeshIdx = 0; MeshIdx < mpCollision->NumMeshes(); MeshIdx++)
+        {
+            std::pair<bool,float> MeshResult = mpCollision->MeshByIndex(MeshIdx)->Bounds().Transformed(Transform()).IntersectsRay(rkRay);
+
+            if (MeshResult.first)
+                rTester.AddNode(this, MeshIdx, MeshResult.second);
         }
     }
 }
 
-void CCollisionNode::RayAABoxIntersectTest(CRayCollisionTester& /*rTester*/, const SViewInfo& /*rkViewInfo*/)
+SRayIntersection CCollisionNode::RayNodeIntersectTest(const CRay& rkRay, uint32 AssetID, const SViewInfo& rkViewInfo)
 {
-    // todo
+    SRayIntersection Out;
+    Out.pNode = this;
+    Out.ComponentIndex = AssetID;
+    Out.Hit = false;
+
+    if (!mpCollision || AssetID >= mpCollision->NumMeshes())
+        return Out;
+
+    // Collision is drawn without backface culling when requested, so match that here
+    bool AllowBackfaces = rkViewInfo.CollisionSettings.DrawBackfaces || mpCollision->Game() == EGame::DKCReturns;
+    CRay TransformedRay = rkRay.Transformed(Transform().Inverse());
+    CCollisionMesh *pMesh = mpCollision->MeshByIndex(AssetID);
+    CCollisionOctree *pOctree = mpCollision->Octree();
+    std::pair<bool,float> Result = (AssetID == 0 && pOctree ?
+                                    pOctree->IntersectsRay(TransformedRay, *pMesh, AllowBackfaces) :
+                                    pMesh->IntersectsRay(TransformedRay, AllowBackfaces));
+
+    if (Result.first)
+    {
+        Out.Hit = true;
+
+        CVector3f HitPoint = TransformedRay.PointOnRay(Result.second);
+        CVector3f WorldHitPoint = Transform() * HitPoint;
+        Out.Distance = Math::Distance(rkRay.Origin(), WorldHitPoint);
+    }
+
+    return Out;
 }
 
-SRayIntersection CCollisionNode::RayNodeIntersectTest(const CRay& /*rkRay*/, uint32 /*AssetID*/, const SViewInfo& /*rkViewInfo*/)
+bool CCollisionNode::SceneBounds(CAABox& rOutBounds) const
 {
-    // todo
-    SRayIntersection Result;
-    Result.Hit = false;
-    return Result;
+    // Nodes with no collision keep infinite bounds, which the scene treats as unbounded
+    if (!mpCollision) return false;
+    rOutBounds = AABox();
+    return true;
 }
 
 void CCollisionNode::SetCollision(CCollisionMeshGroup *pCollision)
@@ -138,4 +198,6 @@ void CCollisionNode::SetCollision(CCollisionMeshGroup *pCollision)
             mLocalAABox.ExpandBounds(pMesh->Bounds());
         }
     }
+
+    MarkTransformChanged();
 }
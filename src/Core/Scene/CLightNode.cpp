@@ -63,6 +63,20 @@ void CLightNode::RayAABoxIntersectTest(CRayCollisionTester& rTester, const SView
     if (BoxResult.first) rTester.AddNode(this, 0, BoxResult.second);
 }
 
+bool CLightNode::SceneBounds(CAABox& rOutBounds) const
+{
+    // The radius sphere drawn while selected isn't covered, so selected lights are always tested
+    if (IsSelected()) return false;
+
+    CVector2f BillScale = BillboardScale();
+    float ScaleXY = (BillScale.X > BillScale.Y ? BillScale.X : BillScale.Y);
+
+    rOutBounds = AABox();
+    rOutBounds.ExpandBounds( CAABox(mPosition + CVector3f(-ScaleXY, -ScaleXY, -BillScale.Y),
+                                    mPosition + CVector3f( ScaleXY,  ScaleXY,  BillScale.Y)) );
+    return true;
+}
+
 SRayIntersection CLightNode::RayNodeIntersectTest(const CRay& rkRay, uint32 AssetID, const SViewInfo& rkViewInfo)
 {
     // todo: come up with a better way to share this code between CScriptNode and CLightNode
@@ -143,7 +157,7 @@ CLight* CLightNode::Light()
     return mpLight;
 }
 
-CVector2f CLightNode::BillboardScale()
+CVector2f CLightNode::BillboardScale() const
 {
     return AbsoluteScale().XZ() * 0.75f;
 }
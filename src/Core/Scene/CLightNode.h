@@ -15,11 +15,12 @@ public:
     void DrawSelection();
     void RayAABoxIntersectTest(CRayCollisionTester& Tester, const SViewInfo& ViewInfo);
     SRayIntersection RayNodeIntersectTest(const CRay &Ray, uint32 AssetID, const SViewInfo& ViewInfo);
+    bool SceneBounds(CAABox& rOutBounds) const;
     CStructRef GetProperties() const;
     void PropertyModified(IProperty* pProperty);
     bool AllowsRotate() const { return false; }
     CLight* Light();
-    CVector2f BillboardScale();
+    CVector2f BillboardScale() const;
 
 protected:
     void CalculateTransform(CTransform4f& rOut) const;
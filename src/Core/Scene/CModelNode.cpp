@@ -1,4 +1,5 @@
 #include "CModelNode.h"
+#include "CScene.h"
 #include "Core/Render/CDrawUtil.h"
 #include "Core/Render/CRenderer.h"
 #include "Core/Render/CGraphics.h"
@@ -35,6 +36,15 @@ void CModelNode::AddToRenderer(CRenderer *pRenderer, const SViewInfo& rkViewInfo
     if (!rkViewInfo.ViewFrustum.BoxInFrustum(AABox())) return;
     if (rkViewInfo.GameMode) return;
 
+    // World models map to a single world mesh, so they can be culled by the area octree
+    if (mWorldModel)
+    {
+        if (mpModel->GetSurfaceCount() > 0 && !mpScene->IsWorldMeshVisible(FindMeshID()))
+            return;
+
+        mpScene->CountSubmittedWorldSurfaces(mpModel->GetSurfaceCount());
+    }
+
     // Transparent world models should have each surface processed separately
     if (mWorldModel && mpModel->HasTransparency(mActiveMatSet))
     {
@@ -159,6 +169,13 @@ CColor CModelNode::TintColor(const SViewInfo& /*rkViewInfo*/) const
     return mTintColor;
 }
 
+bool CModelNode::SceneBounds(CAABox& rOutBounds) const
+{
+    if (!mpModel) return false;
+    rOutBounds = AABox();
+    return true;
+}
+
 void CModelNode::SetModel(CModel *pModel)
 {
     mpModel = pModel;
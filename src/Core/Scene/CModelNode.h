@@ -24,6 +24,7 @@ public:
     virtual void DrawSelection();
     virtual void RayAABoxIntersectTest(CRayCollisionTester& Tester, const SViewInfo& rkViewInfo);
     virtual SRayIntersection RayNodeIntersectTest(const CRay &Ray, uint32 AssetID, const SViewInfo& rkViewInfo);
+    virtual bool SceneBounds(CAABox& rOutBounds) const;
     virtual CColor TintColor(const SViewInfo& rkViewInfo) const;
 
     // Setters
@@ -9,6 +9,7 @@
 #include <Common/TString.h>
 #include <Common/Math/CRay.h>
 
+#include <algorithm>
 #include <list>
 #include <string>
 
@@ -20,6 +21,8 @@ CScene::CScene()
     , mpArea(nullptr)
     , mpWorld(nullptr)
     , mpAreaRootNode(nullptr)
+    , mCullWithAreaOctree(false)
+    , mFirstFreeNodeID(0)
 {
 }
 
@@ -34,7 +37,7 @@ bool CScene::IsNodeIDUsed(uint32 ID) const
     return (mNodeMap.find(ID) != mNodeMap.end());
 }
 
-uint32 CScene::CreateNodeID(uint32 SuggestedID /*= -1*/) const
+uint32 CScene::CreateNodeID(uint32 SuggestedID /*= -1*/)
 {
     if (SuggestedID != -1)
     {
@@ -44,11 +47,13 @@ uint32 CScene::CreateNodeID(uint32 SuggestedID /*= -1*/) const
             return SuggestedID;
     }
 
-    uint32 ID = 0;
+    // The returned ID is taken by the caller, so the next search can skip past it
+    uint32 ID = mFirstFreeNodeID;
 
     while (IsNodeIDUsed(ID))
         ID++;
 
+    mFirstFreeNodeID = ID + 1;
     return ID;
 }
 
@@ -60,6 +65,7 @@ CModelNode* CScene::CreateModelNode(CModel *pModel, uint32 NodeID /*= -1*/)
     CModelNode *pNode = new CModelNode(this, ID, mpAreaRootNode, pModel);
     mNodes[ENodeType::Model].push_back(pNode);
     mNodeMap[ID] = pNode;
+    TrackNode(pNode);
     mNumNodes++;
     return pNode;
 }
@@ -72,6 +78,7 @@ CStaticNode* CScene::CreateStaticNode(CStaticModel *pModel, uint32 NodeID /*= -1
     CStaticNode *pNode = new CStaticNode(this, ID, mpAreaRootNode, pModel);
     mNodes[ENodeType::Static].push_back(pNode);
     mNodeMap[ID] = pNode;
+    TrackNode(pNode);
     mNumNodes++;
     return pNode;
 }
@@ -84,6 +91,7 @@ CCollisionNode* CScene::CreateCollisionNode(CCollisionMeshGroup *pMesh, uint32 N
     CCollisionNode *pNode = new CCollisionNode(this, ID, mpAreaRootNode, pMesh);
     mNodes[ENodeType::Collision].push_back(pNode);
     mNodeMap[ID] = pNode;
+    TrackNode(pNode);
     mNumNodes++;
     return pNode;
 }
@@ -99,6 +107,7 @@ CScriptNode* CScene::CreateScriptNode(CScriptObject *pObj, uint32 NodeID /*= -1*
     mNodes[ENodeType::Script].push_back(pNode);
     mNodeMap[ID] = pNode;
     mScriptMap[InstanceID] = pNode;
+    TrackNode(pNode);
     pNode->BuildLightList(mpArea);
 
     // AreaAttributes check
@@ -122,6 +131,8 @@ CLightNode* CScene::CreateLightNode(CLight *pLight, uint32 NodeID /*= -1*/)
     CLightNode *pNode = new CLightNode(this, ID, mpAreaRootNode, pLight);
     mNodes[ENodeType::Light].push_back(pNode);
     mNodeMap[ID] = pNode;
+    mLightMap[pLight] = pNode;
+    TrackNode(pNode);
     mNumNodes++;
     return pNode;
 }
@@ -141,8 +152,16 @@ void CScene::DeleteNode(CSceneNode *pNode)
 
     auto MapIt = mNodeMap.find(pNode->ID());
     if (MapIt != mNodeMap.end())
+    {
         mNodeMap.erase(MapIt);
 
+        if (pNode->ID() < mFirstFreeNodeID)
+            mFirstFreeNodeID = pNode->ID();
+    }
+
+    if (Type == ENodeType::Light)
+        mLightMap.erase(static_cast<CLightNode*>(pNode)->Light());
+
     if (Type == ENodeType::Script)
     {
         CScriptNode *pScript = static_cast<CScriptNode*>(pNode);
@@ -167,6 +186,7 @@ void CScene::DeleteNode(CSceneNode *pNode)
         }
     }
 
+    UntrackNode(pNode);
     pNode->Unparent();
     delete pNode;
     mNumNodes--;
@@ -265,9 +285,16 @@ void CScene::ClearScene()
     }
 
     mNodes.clear();
+    mBVH.Clear();
+    mDirtyBVHNodes.clear();
+    mUnboundedNodes.clear();
+    mVisibleWorldMeshes.clear();
+    mCullWithAreaOctree = false;
     mAreaAttributesObjects.clear();
     mNodeMap.clear();
     mScriptMap.clear();
+    mLightMap.clear();
+    mFirstFreeNodeID = 0;
     mNumNodes = 0;
 
     mpArea = nullptr;
@@ -284,11 +311,23 @@ void CScene::AddSceneToRenderer(CRenderer *pRenderer, const SViewInfo& rkViewInf
     FShowFlags ShowFlags = (rkViewInfo.GameMode ? gkGameModeShowFlags : rkViewInfo.ShowFlags);
     FNodeFlags NodeFlags = NodeFlagsForShowFlags(ShowFlags);
 
-    for (CSceneIterator It(this, NodeFlags, false); It; ++It)
+    // Find the world meshes touching the frustum using the area octree; world geometry nodes
+    // check their meshes against this instead of submitting everything that passes the node test
+    CAreaOctree *pAreaOctree = (mpArea ? mpArea->AreaOctree() : nullptr);
+    mWorldCullStats = SWorldCullStats();
+    mCullWithAreaOctree = (pAreaOctree != nullptr);
+
+    if (mCullWithAreaOctree)
     {
-        if (rkViewInfo.GameMode || It->IsVisible())
-            It->AddToRenderer(pRenderer, rkViewInfo);
+        mWorldCullStats.OctreeNodesTested = pAreaOctree->FindVisibleMeshes(rkViewInfo.ViewFrustum, mVisibleWorldMeshes);
+        mWorldCullStats.WorldMeshesVisible = std::count(mVisibleWorldMeshes.begin(), mVisibleWorldMeshes.end(), 1);
     }
+
+    // Only nodes whose bounds touch the frustum need to be considered; they still do their own finer culling
+    ForEachNodeInFrustum(rkViewInfo.ViewFrustum, NodeFlags, rkViewInfo.GameMode, [&](CSceneNode *pNode)
+    {
+        pNode->AddToRenderer(pRenderer, rkViewInfo);
+    });
 }
 
 SRayIntersection CScene::SceneRayCast(const CRay& rkRay, const SViewInfo& rkViewInfo)
@@ -297,11 +336,18 @@ SRayIntersection CScene::SceneRayCast(const CRay& rkRay, const SViewInfo& rkView
     FNodeFlags NodeFlags = NodeFlagsForShowFlags(ShowFlags);
     CRayCollisionTester Tester(rkRay);
 
-    for (CSceneIterator It(this, NodeFlags, false); It; ++It)
+    UpdateBVH();
+
+    auto TestNode = [&](CSceneNode *pNode)
     {
-        if (It->IsVisible())
-            It->RayAABoxIntersectTest(Tester, rkViewInfo);
-    }
+        if ((pNode->NodeType() & NodeFlags) && pNode->IsVisible())
+            pNode->RayAABoxIntersectTest(Tester, rkViewInfo);
+    };
+
+    mBVH.QueryRay(rkRay, TestNode);
+
+    for (CSceneNode *pNode : mUnboundedNodes)
+        TestNode(pNode);
 
     return Tester.TestNodes(rkViewInfo);
 }
@@ -329,16 +375,8 @@ CScriptNode* CScene::NodeForInstance(CScriptObject *pObj)
 
 CLightNode* CScene::NodeForLight(CLight *pLight)
 {
-    // Slow. Is there a better way to do this?
-    std::vector<CSceneNode*>& rLights = mNodes[ENodeType::Light];
-
-    for (auto it = rLights.begin(); it != rLights.end(); it++)
-    {
-        CLightNode *pNode = static_cast<CLightNode*>(*it);
-        if (pNode->Light() == pLight) return pNode;
-    }
-
-    return nullptr;
+    auto it = mLightMap.find(pLight);
+    return (it == mLightMap.end() ? nullptr : it->second);
 }
 
 CModel* CScene::ActiveSkybox()
@@ -370,6 +408,103 @@ CGameArea* CScene::ActiveArea()
     return mpArea;
 }
 
+void CScene::MarkNodeBoundsDirty(const CSceneNode *pNode)
+{
+    // Child nodes (eg script node attachments) contribute to the bounds of the nearest tracked ancestor
+    while (pNode && !pNode->_mSceneTracked)
+        pNode = pNode->mpParent;
+
+    if (pNode && !pNode->_mSceneBoundsDirty)
+    {
+        pNode->_mSceneBoundsDirty = true;
+        mDirtyBVHNodes.push_back(const_cast<CSceneNode*>(pNode));
+    }
+}
+
+// ************ PROTECTED ************
+bool CScene::IsWorldMeshVisible(uint32 MeshIndex) const
+{
+    if (!mCullWithAreaOctree || MeshIndex >= mVisibleWorldMeshes.size())
+        return true;
+
+    return mVisibleWorldMeshes[MeshIndex] != 0;
+}
+
+void CScene::CountSubmittedWorldSurfaces(uint32 NumSurfaces)
+{
+    mWorldCullStats.WorldSurfacesSubmitted += NumSurfaces;
+}
+
+void CScene::TrackNode(CSceneNode *pNode)
+{
+    pNode->_mSceneTracked = true;
+    pNode->_mSceneProxy = -1;
+    pNode->_mSceneUnbounded = false;
+    pNode->_mSceneBoundsDirty = true;
+    mDirtyBVHNodes.push_back(pNode);
+}
+
+void CScene::UntrackNode(CSceneNode *pNode)
+{
+    if (!pNode->_mSceneTracked)
+        return;
+
+    if (pNode->_mSceneProxy != -1)
+        mBVH.DestroyProxy(pNode->_mSceneProxy);
+
+    if (pNode->_mSceneUnbounded)
+        mUnboundedNodes.erase( std::find(mUnboundedNodes.begin(), mUnboundedNodes.end(), pNode) );
+
+    if (pNode->_mSceneBoundsDirty)
+        mDirtyBVHNodes.erase( std::find(mDirtyBVHNodes.begin(), mDirtyBVHNodes.end(), pNode) );
+
+    pNode->_mSceneTracked = false;
+    pNode->_mSceneProxy = -1;
+    pNode->_mSceneUnbounded = false;
+    pNode->_mSceneBoundsDirty = false;
+}
+
+void CScene::UpdateBVH()
+{
+    for (CSceneNode *pNode : mDirtyBVHNodes)
+    {
+        pNode->_mSceneBoundsDirty = false;
+        CAABox Bounds;
+        bool Bounded = pNode->SceneBounds(Bounds) && CSceneBVH::IsBoundable(Bounds);
+
+        if (Bounded)
+        {
+            if (pNode->_mSceneUnbounded)
+            {
+                mUnboundedNodes.erase( std::find(mUnboundedNodes.begin(), mUnboundedNodes.end(), pNode) );
+                pNode->_mSceneUnbounded = false;
+            }
+
+            if (pNode->_mSceneProxy == -1)
+                pNode->_mSceneProxy = mBVH.CreateProxy(pNode, Bounds);
+            else
+                mBVH.MoveProxy(pNode->_mSceneProxy, Bounds);
+        }
+
+        else
+        {
+            if (pNode->_mSceneProxy != -1)
+            {
+                mBVH.DestroyProxy(pNode->_mSceneProxy);
+                pNode->_mSceneProxy = -1;
+            }
+
+            if (!pNode->_mSceneUnbounded)
+            {
+                mUnboundedNodes.push_back(pNode);
+                pNode->_mSceneUnbounded = true;
+            }
+        }
+    }
+
+    mDirtyBVHNodes.clear();
+}
+
 // ************ STATIC ************
 FShowFlags CScene::ShowFlagsForNodeFlags(FNodeFlags NodeFlags)
 {
@@ -2,6 +2,7 @@
 #define CSCENE_H
 
 #include "CSceneNode.h"
+#include "CSceneBVH.h"
 #include "CRootNode.h"
 #include "CLightNode.h"
 #include "CModelNode.h"
@@ -20,6 +21,17 @@
 #include <unordered_map>
 #include <vector>
 
+/** Per-frame world geometry culling statistics; reset by each call to AddSceneToRenderer */
+struct SWorldCullStats
+{
+    uint32 OctreeNodesTested;
+    uint32 WorldMeshesVisible;
+    uint32 WorldSurfacesSubmitted;
+
+    SWorldCullStats()
+        : OctreeNodesTested(0), WorldMeshesVisible(0), WorldSurfacesSubmitted(0) {}
+};
+
 /** Needs lots of changes, see CSceneNode for most of my thoughts on this */
 class CScene
 {
@@ -42,6 +54,21 @@ class CScene
     // Node Management
     std::unordered_map<uint32, CSceneNode*> mNodeMap;
     std::unordered_map<uint32, CScriptNode*> mScriptMap;
+    std::unordered_map<CLight*, CLightNode*> mLightMap;
+
+    // Every node ID below this is in use, so new IDs are searched for starting here
+    uint32 mFirstFreeNodeID;
+
+    // Bounding volume hierarchy over node bounds, used for ray casts and frustum culling.
+    // Nodes that can't be bounded are kept in a separate list and always tested.
+    CSceneBVH mBVH;
+    std::vector<CSceneNode*> mDirtyBVHNodes;
+    std::vector<CSceneNode*> mUnboundedNodes;
+
+    // World meshes that passed the area octree test this frame. Only valid while mCullWithAreaOctree is set.
+    std::vector<uint8> mVisibleWorldMeshes;
+    bool mCullWithAreaOctree;
+    SWorldCullStats mWorldCullStats;
 
 public:
     CScene();
@@ -49,7 +76,7 @@ public:
 
     // Scene Management
     bool IsNodeIDUsed(uint32 ID) const;
-    uint32 CreateNodeID(uint32 SuggestedID = -1) const;
+    uint32 CreateNodeID(uint32 SuggestedID = -1);
 
     CModelNode* CreateModelNode(CModel *pModel, uint32 NodeID = -1);
     CStaticNode* CreateStaticNode(CStaticModel *pModel, uint32 NodeID = -1);
@@ -68,7 +95,37 @@ public:
     CLightNode* NodeForLight(CLight *pLight);
     CModel* ActiveSkybox();
     CGameArea* ActiveArea();
+    void MarkNodeBoundsDirty(const CSceneNode *pNode);
+    bool IsWorldMeshVisible(uint32 MeshIndex) const;
+    void CountSubmittedWorldSurfaces(uint32 NumSurfaces);
 
+    inline const SWorldCullStats& WorldCullStats() const { return mWorldCullStats; }
+
+    // Calls rkCallback for every node of the given types whose bounds may touch the frustum.
+    // Hidden nodes are skipped unless IncludeHidden is set (game mode draws them regardless).
+    template<typename CallbackT>
+    void ForEachNodeInFrustum(const CFrustumPlanes& rkFrustum, FNodeFlags NodeFlags, bool IncludeHidden, const CallbackT& rkCallback)
+    {
+        UpdateBVH();
+
+        auto VisitNode = [&](CSceneNode *pNode)
+        {
+            if ((pNode->NodeType() & NodeFlags) && (IncludeHidden || pNode->IsVisible()))
+                rkCallback(pNode);
+        };
+
+        mBVH.QueryFrustum(rkFrustum, VisitNode);
+
+        for (CSceneNode *pNode : mUnboundedNodes)
+            VisitNode(pNode);
+    }
+
+protected:
+    void TrackNode(CSceneNode *pNode);
+    void UntrackNode(CSceneNode *pNode);
+    void UpdateBVH();
+
+public:
     // Static
     static FShowFlags ShowFlagsForNodeFlags(FNodeFlags NodeFlags);
     static FNodeFlags NodeFlagsForShowFlags(FShowFlags ShowFlags);
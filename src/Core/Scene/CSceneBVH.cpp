@@ -0,0 +1,309 @@
+#include "CSceneBVH.h"
+#include <Common/Macros.h>
+#include <Common/Math/MathUtil.h>
+#include <cmath>
+
+// Helpers
+static CAABox Union(const CAABox& rkA, const CAABox& rkB)
+{
+    CAABox Out = rkA;
+    Out.ExpandBounds(rkB);
+    return Out;
+}
+
+static float SurfaceArea(const CAABox& rkBox)
+{
+    CVector3f Size = rkBox.Size();
+    return 2.f * ((Size.X * Size.Y) + (Size.Y * Size.Z) + (Size.Z * Size.X));
+}
+
+static bool Contains(const CAABox& rkOuter, const CAABox& rkInner)
+{
+    return Union(rkOuter, rkInner) == rkOuter;
+}
+
+static CAABox FattenBounds(const CAABox& rkBounds)
+{
+    // Leave some room to move before the leaf needs to be reinserted
+    CAABox Out = rkBounds;
+    Out.ExpandBy( (rkBounds.Size() * 0.1f) + (CVector3f::skOne * 0.5f) );
+    return Out;
+}
+
+CSceneBVH::CSceneBVH()
+    : mRoot(skNullNode)
+    , mFreeList(skNullNode)
+    , mNumLeaves(0)
+{
+}
+
+void CSceneBVH::Clear()
+{
+    mNodes.clear();
+    mRoot = skNullNode;
+    mFreeList = skNullNode;
+    mNumLeaves = 0;
+}
+
+int32 CSceneBVH::CreateProxy(CSceneNode *pSceneNode, const CAABox& rkBounds)
+{
+    ASSERT(IsBoundable(rkBounds));
+    int32 Leaf = AllocateNode();
+    mNodes[Leaf].Bounds = FattenBounds(rkBounds);
+    mNodes[Leaf].pSceneNode = pSceneNode;
+    mNodes[Leaf].Height = 0;
+    InsertLeaf(Leaf);
+    mNumLeaves++;
+    return Leaf;
+}
+
+void CSceneBVH::DestroyProxy(int32 Proxy)
+{
+    ASSERT(Proxy >= 0 && Proxy < (int32) mNodes.size() && mNodes[Proxy].IsLeaf());
+    RemoveLeaf(Proxy);
+    FreeNode(Proxy);
+    mNumLeaves--;
+}
+
+bool CSceneBVH::MoveProxy(int32 Proxy, const CAABox& rkBounds)
+{
+    // Returns whether the leaf had to be reinserted
+    ASSERT(Proxy >= 0 && Proxy < (int32) mNodes.size() && mNodes[Proxy].IsLeaf());
+    ASSERT(IsBoundable(rkBounds));
+
+    if (Contains(mNodes[Proxy].Bounds, rkBounds))
+    {
+        // Still fits, but if it shrank a lot, tighten it up so it doesn't keep passing queries it shouldn't
+        if (SurfaceArea(mNodes[Proxy].Bounds) <= SurfaceArea(FattenBounds(rkBounds)) * 2.f)
+            return false;
+    }
+
+    RemoveLeaf(Proxy);
+    mNodes[Proxy].Bounds = FattenBounds(rkBounds);
+    InsertLeaf(Proxy);
+    return true;
+}
+
+bool CSceneBVH::IsBoundable(const CAABox& rkBounds)
+{
+    // Infinite bounds (used for nodes with no geometry) can't be placed in the tree
+    if (rkBounds == CAABox::skInfinite)
+        return false;
+
+    CVector3f Size = rkBounds.Size();
+    return std::isfinite(Size.X) && std::isfinite(Size.Y) && std::isfinite(Size.Z) &&
+           Size.X >= 0.f && Size.Y >= 0.f && Size.Z >= 0.f;
+}
+
+// ************ PROTECTED ************
+int32 CSceneBVH::AllocateNode()
+{
+    int32 Node;
+
+    if (mFreeList != skNullNode)
+    {
+        Node = mFreeList;
+        mFreeList = mNodes[Node].Parent;
+    }
+    else
+    {
+        Node = (int32) mNodes.size();
+        mNodes.emplace_back();
+    }
+
+    SNode& rNode = mNodes[Node];
+    rNode.pSceneNode = nullptr;
+    rNode.Parent = skNullNode;
+    rNode.Child1 = skNullNode;
+    rNode.Child2 = skNullNode;
+    rNode.Height = 0;
+    return Node;
+}
+
+void CSceneBVH::FreeNode(int32 Node)
+{
+    mNodes[Node].Parent = mFreeList;
+    mNodes[Node].Height = -1;
+    mNodes[Node].pSceneNode = nullptr;
+    mFreeList = Node;
+}
+
+void CSceneBVH::InsertLeaf(int32 Leaf)
+{
+    if (mRoot == skNullNode)
+    {
+        mRoot = Leaf;
+        mNodes[mRoot].Parent = skNullNode;
+        return;
+    }
+
+    // Find the best sibling for the new leaf using the surface area heuristic
+    CAABox LeafBounds = mNodes[Leaf].Bounds;
+    int32 Index = mRoot;
+
+    while (!mNodes[Index].IsLeaf())
+    {
+        const SNode& rkNode = mNodes[Index];
+        float Area = SurfaceArea(rkNode.Bounds);
+        float CombinedArea = SurfaceArea( Union(rkNode.Bounds, LeafBounds) );
+
+        // Cost of creating a new parent for this node and the new leaf
+        float Cost = 2.f * CombinedArea;
+
+        // Minimum cost of pushing the leaf further down the tree
+        float InheritanceCost = 2.f * (CombinedArea - Area);
+
+        auto DescendCost = [&](int32 Child) -> float
+        {
+            const SNode& rkChild = mNodes[Child];
+            float NewArea = SurfaceArea( Union(rkChild.Bounds, LeafBounds) );
+
+            if (rkChild.IsLeaf())
+                return NewArea + InheritanceCost;
+            else
+                return (NewArea - SurfaceArea(rkChild.Bounds)) + InheritanceCost;
+        };
+
+        float Cost1 = DescendCost(rkNode.Child1);
+        float Cost2 = DescendCost(rkNode.Child2);
+
+        if (Cost < Cost1 && Cost < Cost2)
+            break;
+
+        Index = (Cost1 < Cost2 ? rkNode.Child1 : rkNode.Child2);
+    }
+
+    // Create a new parent joining the sibling and the leaf
+    int32 Sibling = Index;
+    int32 OldParent = mNodes[Sibling].Parent;
+    int32 NewParent = AllocateNode();
+
+    mNodes[NewParent].Parent = OldParent;
+    mNodes[NewParent].Bounds = Union(LeafBounds, mNodes[Sibling].Bounds);
+    mNodes[NewParent].Height = mNodes[Sibling].Height + 1;
+    mNodes[NewParent].Child1 = Sibling;
+    mNodes[NewParent].Child2 = Leaf;
+    mNodes[Sibling].Parent = NewParent;
+    mNodes[Leaf].Parent = NewParent;
+
+    if (OldParent != skNullNode)
+    {
+        if (mNodes[OldParent].Child1 == Sibling)
+            mNodes[OldParent].Child1 = NewParent;
+        else
+            mNodes[OldParent].Child2 = NewParent;
+    }
+    else
+        mRoot = NewParent;
+
+    RefitAncestors(mNodes[Leaf].Parent);
+}
+
+void CSceneBVH::RemoveLeaf(int32 Leaf)
+{
+    if (Leaf == mRoot)
+    {
+        mRoot = skNullNode;
+        return;
+    }
+
+    int32 Parent = mNodes[Leaf].Parent;
+    int32 GrandParent = mNodes[Parent].Parent;
+    int32 Sibling = (mNodes[Parent].Child1 == Leaf ? mNodes[Parent].Child2 : mNodes[Parent].Child1);
+
+    // Replace the parent with the sibling
+    if (GrandParent != skNullNode)
+    {
+        if (mNodes[GrandParent].Child1 == Parent)
+            mNodes[GrandParent].Child1 = Sibling;
+        else
+            mNodes[GrandParent].Child2 = Sibling;
+
+        mNodes[Sibling].Parent = GrandParent;
+        FreeNode(Parent);
+        RefitAncestors(GrandParent);
+    }
+    else
+    {
+        mRoot = Sibling;
+        mNodes[Sibling].Parent = skNullNode;
+        FreeNode(Parent);
+    }
+
+    mNodes[Leaf].Parent = skNullNode;
+}
+
+void CSceneBVH::RefitAncestors(int32 Node)
+{
+    while (Node != skNullNode)
+    {
+        Node = Balance(Node);
+
+        SNode& rNode = mNodes[Node];
+        const SNode& rkChild1 = mNodes[rNode.Child1];
+        const SNode& rkChild2 = mNodes[rNode.Child2];
+        rNode.Height = 1 + Math::Max(rkChild1.Height, rkChild2.Height);
+        rNode.Bounds = Union(rkChild1.Bounds, rkChild2.Bounds);
+
+        Node = rNode.Parent;
+    }
+}
+
+int32 CSceneBVH::Balance(int32 A)
+{
+    // If either child subtree is more than one level taller than the other, rotate it up.
+    // Returns the index of the node that is now at A's position in the tree.
+    SNode& rA = mNodes[A];
+
+    if (rA.IsLeaf() || rA.Height < 2)
+        return A;
+
+    int32 B = rA.Child1;
+    int32 C = rA.Child2;
+    int32 HeightDiff = mNodes[C].Height - mNodes[B].Height;
+
+    if (HeightDiff > 1 || HeightDiff < -1)
+    {
+        // Rotate the taller child (Up) above A; its taller child stays with it and its shorter child moves to A
+        bool RotateC = (HeightDiff > 1);
+        int32 Up = (RotateC ? C : B);
+        int32 Other = (RotateC ? B : C);
+        SNode& rUp = mNodes[Up];
+        int32 F = rUp.Child1;
+        int32 G = rUp.Child2;
+
+        // Swap A and Up
+        rUp.Child1 = A;
+        rUp.Parent = rA.Parent;
+        rA.Parent = Up;
+
+        if (rUp.Parent != skNullNode)
+        {
+            if (mNodes[rUp.Parent].Child1 == A)
+                mNodes[rUp.Parent].Child1 = Up;
+            else
+                mNodes[rUp.Parent].Child2 = Up;
+        }
+        else
+            mRoot = Up;
+
+        // Keep the taller grandchild under Up, give the shorter one to A
+        int32 Keep = (mNodes[F].Height > mNodes[G].Height ? F : G);
+        int32 Give = (Keep == F ? G : F);
+
+        rUp.Child2 = Keep;
+
+        if (RotateC) rA.Child2 = Give;
+        else         rA.Child1 = Give;
+
+        mNodes[Give].Parent = A;
+
+        rA.Bounds = Union(mNodes[Other].Bounds, mNodes[Give].Bounds);
+        rA.Height = 1 + Math::Max(mNodes[Other].Height, mNodes[Give].Height);
+        rUp.Bounds = Union(rA.Bounds, mNodes[Keep].Bounds);
+        rUp.Height = 1 + Math::Max(rA.Height, mNodes[Keep].Height);
+        return Up;
+    }
+
+    return A;
+}
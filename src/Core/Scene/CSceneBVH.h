@@ -0,0 +1,102 @@
+#ifndef CSCENEBVH_H
+#define CSCENEBVH_H
+
+#include <Common/BasicTypes.h>
+#include <Common/Math/CAABox.h>
+#include <Common/Math/CFrustumPlanes.h>
+#include <Common/Math/CRay.h>
+#include <vector>
+
+class CSceneNode;
+
+/**
+ * Dynamic bounding volume hierarchy over scene node bounds, used by CScene to avoid testing every node
+ * for ray casts and frustum culling. Leaves store a slightly enlarged ("fat") copy of the node's bounds,
+ * so small movements only need the leaf to be checked rather than reinserted. The tree is kept balanced
+ * with AVL-style rotations as leaves are inserted and removed.
+ */
+class CSceneBVH
+{
+    static const int32 skNullNode = -1;
+
+    struct SNode
+    {
+        CAABox Bounds;
+        CSceneNode *pSceneNode;
+        int32 Parent;   // Also used as the next pointer when the node is on the free list
+        int32 Child1;
+        int32 Child2;
+        int32 Height;   // Leaves are 0; free nodes are -1
+
+        inline bool IsLeaf() const { return Child1 == skNullNode; }
+    };
+
+    std::vector<SNode> mNodes;
+    int32 mRoot;
+    int32 mFreeList;
+    uint32 mNumLeaves;
+
+public:
+    CSceneBVH();
+    void Clear();
+
+    int32 CreateProxy(CSceneNode *pSceneNode, const CAABox& rkBounds);
+    void DestroyProxy(int32 Proxy);
+    bool MoveProxy(int32 Proxy, const CAABox& rkBounds);
+
+    /** Calls rkCallback for every node whose bounds may intersect the frustum */
+    template<typename CallbackT>
+    void QueryFrustum(const CFrustumPlanes& rkFrustum, const CallbackT& rkCallback) const
+    {
+        QueryInternal([&rkFrustum](const CAABox& rkBox) { return rkFrustum.BoxInFrustum(rkBox); }, rkCallback);
+    }
+
+    /** Calls rkCallback for every node whose bounds intersect the ray */
+    template<typename CallbackT>
+    void QueryRay(const CRay& rkRay, const CallbackT& rkCallback) const
+    {
+        QueryInternal([&rkRay](const CAABox& rkBox) { return rkBox.IntersectsRay(rkRay).first; }, rkCallback);
+    }
+
+    inline uint32 NumLeaves() const     { return mNumLeaves; }
+    inline int32 Height() const         { return (mRoot == skNullNode ? 0 : mNodes[mRoot].Height); }
+
+    static bool IsBoundable(const CAABox& rkBounds);
+
+protected:
+    int32 AllocateNode();
+    void FreeNode(int32 Node);
+    void InsertLeaf(int32 Leaf);
+    void RemoveLeaf(int32 Leaf);
+    void RefitAncestors(int32 Node);
+    int32 Balance(int32 Node);
+
+    template<typename TestT, typename CallbackT>
+    void QueryInternal(const TestT& rkTest, const CallbackT& rkCallback) const
+    {
+        if (mRoot == skNullNode) return;
+
+        std::vector<int32> Stack;
+        Stack.reserve(64);
+        Stack.push_back(mRoot);
+
+        while (!Stack.empty())
+        {
+            const SNode& rkNode = mNodes[ Stack.back() ];
+            Stack.pop_back();
+
+            if (!rkTest(rkNode.Bounds))
+                continue;
+
+            if (rkNode.IsLeaf())
+                rkCallback(rkNode.pSceneNode);
+            else
+            {
+                Stack.push_back(rkNode.Child1);
+                Stack.push_back(rkNode.Child2);
+            }
+        }
+    }
+};
+
+#endif // CSCENEBVH_H
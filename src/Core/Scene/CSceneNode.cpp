@@ -1,4 +1,5 @@
 #include "CSceneNode.h"
+#include "CScene.h"
 #include "Core/GameProject/CResourceStore.h"
 #include "Core/Render/CRenderer.h"
 #include "Core/Render/CGraphics.h"
@@ -23,6 +24,10 @@ CSceneNode::CSceneNode(CScene *pScene, uint32 NodeID, CSceneNode *pParent)
     , _mInheritsPosition(true)
     , _mInheritsRotation(true)
     , _mInheritsScale(true)
+    , _mSceneProxy(-1)
+    , _mSceneTracked(false)
+    , _mSceneUnbounded(false)
+    , _mSceneBoundsDirty(false)
     , mLightLayerIndex(0)
     , mLightCount(0)
     , mMouseHovering(false)
@@ -46,7 +51,7 @@ CSceneNode::~CSceneNode()
 void CSceneNode::DrawSelection()
 {
     // Default implementation for virtual function
-    CDrawUtil::DrawWireCube(AABox(), CColor::skWhite);
+    CDrawUtil::BatchWireCube(AABox(), CColor::skWhite);
 }
 
 void CSceneNode::RayAABoxIntersectTest(CRayCollisionTester& rTester, const SViewInfo& /*rkViewInfo*/)
@@ -64,6 +69,13 @@ bool CSceneNode::IsVisible() const
     return mVisible;
 }
 
+bool CSceneNode::SceneBounds(CAABox& /*rOutBounds*/) const
+{
+    // Returns a box enclosing everything this node renders and ray tests, if there is one.
+    // Nodes that can't guarantee that are tested every time instead of going through the scene BVH.
+    return false;
+}
+
 CColor CSceneNode::TintColor(const SViewInfo& rkViewInfo) const
 {
     // Default implementation for virtual function
@@ -144,7 +156,7 @@ void CSceneNode::BuildLightList(CGameArea *pArea)
         SLightEntry(CLight *_pLight, float _Distance)
             : pLight(_pLight), Distance(_Distance) {}
 
-        bool operator<(const SLightEntry& rkOther) {
+        bool operator<(const SLightEntry& rkOther) const {
             return (Distance < rkOther.Distance);
         }
     };
@@ -154,31 +166,38 @@ void CSceneNode::BuildLightList(CGameArea *pArea)
     uint32 NumLights = pArea->NumLights(Index);
     if (NumLights == 0) mAmbientColor = CColor::skWhite;
 
-    for (uint32 iLight = 0; iLight < NumLights; iLight++)
-    {
-        CLight* pLight = pArea->Light(Index, iLight);
+    // Ambient lights should only be present one per layer; need to check how the game deals with multiple ambients
+    CAreaLightGrid *pLightGrid = pArea->LightGrid(Index);
+    if (!pLightGrid) return;
 
-        // Ambient lights should only be present one per layer; need to check how the game deals with multiple ambients
-        if (pLight->Type() == ELightType::LocalAmbient)
-            mAmbientColor = pLight->Color();
+    if (pLightGrid->AmbientLight())
+        mAmbientColor = pLightGrid->AmbientLight()->Color();
 
-        // Other lights will be used depending which are closest to the node
-        else
-        {
-            bool IsInRange = AABox().IntersectsSphere(pLight->Position(), pLight->GetRadius());
+    // Other lights will be used depending which are closest to the node. The grid only
+    // returns lights near the node, so the exact sphere test runs on a handful of lights.
+    CAABox Bounds = AABox();
+    std::vector<CLight*> Candidates;
+    pLightGrid->FindLights(Bounds, Candidates);
 
-            if (IsInRange)
-            {
-                float Dist = mPosition.Distance(pLight->Position());
-                LightEntries.push_back(SLightEntry(pLight, Dist));
-            }
+    for (uint32 iLight = 0; iLight < Candidates.size(); iLight++)
+    {
+        CLight *pLight = Candidates[iLight];
+
+        if (Bounds.IntersectsSphere(pLight->Position(), pLight->GetRadius()))
+        {
+            float Dist = mPosition.Distance(pLight->Position());
+            LightEntries.push_back(SLightEntry(pLight, Dist));
         }
     }
 
-    // Determine which lights are closest
-    std::sort(LightEntries.begin(), LightEntries.end());
+    // Determine which lights are closest; only the closest eight need to be in order
     mLightCount = (LightEntries.size() > 8) ? 8 : LightEntries.size();
 
+    if (LightEntries.size() > mLightCount)
+        std::nth_element(LightEntries.begin(), LightEntries.begin() + mLightCount, LightEntries.end());
+
+    std::sort(LightEntries.begin(), LightEntries.begin() + mLightCount);
+
     for (uint32 iLight = 0; iLight < mLightCount; iLight++)
         mLights[iLight] = LightEntries[iLight].pLight;
 }
@@ -253,7 +272,7 @@ void CSceneNode::DrawModelParts(CModel *pModel, FRenderOptions Options, uint32 M
 
 void CSceneNode::DrawBoundingBox() const
 {
-    CDrawUtil::DrawWireCube(AABox(), CColor::skWhite);
+    CDrawUtil::BatchWireCube(AABox(), CColor::skWhite);
 }
 
 void CSceneNode::DrawRotationArrow() const
@@ -335,6 +354,9 @@ void CSceneNode::ForceRecalculateTransform() const
 
 void CSceneNode::MarkTransformChanged() const
 {
+    if (mpScene)
+        mpScene->MarkNodeBoundsDirty(this);
+
     if (!_mTransformDirty)
     {
         for (auto it = mChildren.begin(); it != mChildren.end(); it++)
@@ -398,3 +420,15 @@ CAABox CSceneNode::AABox() const
 
     return _mCachedAABox;
 }
+
+void CSceneNode::SetSelected(bool Selected)
+{
+    if (mSelected != Selected)
+    {
+        mSelected = Selected;
+
+        // Some nodes draw extra things while selected, which can change their scene bounds
+        if (mpScene)
+            mpScene->MarkNodeBoundsDirty(this);
+    }
+}
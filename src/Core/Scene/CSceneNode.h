@@ -68,6 +68,8 @@ class CScene;
  */
 class CSceneNode : public IRenderable
 {
+    friend class CScene;
+
 private:
     mutable CTransform4f _mCachedTransform;
     mutable CAABox _mCachedAABox;
@@ -79,6 +81,12 @@ private:
 
     uint32 _mID;
 
+    // Scene BVH bookkeeping; managed by CScene
+    int32 _mSceneProxy;
+    bool _mSceneTracked;
+    bool _mSceneUnbounded;
+    mutable bool _mSceneBoundsDirty;
+
 protected:
     static uint32 smNumNodes;
     TString mName;
@@ -114,6 +122,7 @@ public:
     virtual bool AllowsRotate() const { return true; }
     virtual bool AllowsScale() const { return true; }
     virtual bool IsVisible() const;
+    virtual bool SceneBounds(CAABox& rOutBounds) const;
     virtual CColor TintColor(const SViewInfo& rkViewInfo) const;
     virtual CColor WireframeColor() const;
     virtual CStructRef GetProperties() const { return CStructRef(); }
@@ -175,7 +184,7 @@ public:
     void SetScale(const CVector3f& rkScale)         { mScale = rkScale; MarkTransformChanged(); }
     void SetLightLayerIndex(uint32 Index)           { mLightLayerIndex = Index; }
     void SetMouseHovering(bool Hovering)            { mMouseHovering = Hovering; }
-    void SetSelected(bool Selected)                 { mSelected = Selected; }
+    void SetSelected(bool Selected);
     void SetVisible(bool Visible)                   { mVisible = Visible; }
 
     // Static
@@ -8,6 +8,7 @@
 #include "Core/Resource/Script/CGameTemplate.h"
 #include "Core/Resource/Script/CScriptLayer.h"
 #include "Core/ScriptExtra/CScriptExtra.h"
+#include <Common/Hash/CFNV1A.h>
 #include <Common/Macros.h>
 #include <Common/Math/MathUtil.h>
 
@@ -150,6 +151,16 @@ void CScriptNode::AddToRenderer(CRenderer *pRenderer, const SViewInfo& rkViewInf
 
                 if (!pModel)
                     pRenderer->AddMesh(this, -1, AABox(), false, ERenderCommand::DrawMesh);
+
+                // Opaque static models can be drawn together with other nodes that use the same model
+                else if (pRenderer->RenderOptions().HasFlag(ERenderOption::EnableInstancing) &&
+                         !pModel->HasTransparency(0) && pModel->SupportsInstancing(0))
+                {
+                    SInstanceKey Key { pModel, 0, InstanceStateHash(rkViewInfo) };
+                    SInstance Instance { this, Transform(), TintColor(rkViewInfo), AABox() };
+                    pRenderer->AddInstancedModel(Key, Instance);
+                }
+
                 else
                     AddModelToRenderer(pRenderer, pModel, 0);
             }
@@ -175,29 +186,6 @@ void CScriptNode::Draw(FRenderOptions Options, int /*ComponentIndex*/, ERenderCo
     // Draw model
     if (UsesModel())
     {
-        EWorldLightingOptions LightingOptions = (mpLightParameters ? mpLightParameters->WorldLightingOptions() : eNormalLighting);
-
-        if (CGraphics::sLightMode == CGraphics::ELightingMode::World && LightingOptions == eDisableWorldLighting)
-        {
-            CGraphics::sNumLights = 0;
-            CGraphics::sVertexBlock.COLOR0_Amb = CColor::skBlack;
-            CGraphics::sPixelBlock.LightmapMultiplier = 1.f;
-            CGraphics::UpdateLightBlock();
-        }
-
-        else
-        {
-            // DKCR doesn't support world lighting yet, so light nodes that don't have ingame models with default lighting
-            if (Template()->Game() == EGame::DKCReturns && !mpInstance->HasInGameModel() && CGraphics::sLightMode == CGraphics::ELightingMode::World)
-            {
-                CGraphics::SetDefaultLighting();
-                CGraphics::sVertexBlock.COLOR0_Amb = CGraphics::skDefaultAmbientColor;
-            }
-
-            else
-                LoadLights(rkViewInfo);
-        }
-
         LoadModelMatrix();
 
         // Draw model if possible!
@@ -206,18 +194,14 @@ void CScriptNode::Draw(FRenderOptions Options, int /*ComponentIndex*/, ERenderCo
         if (pModel)
         {
             if (pModel->IsSkinned()) CGraphics::LoadIdentityBoneTransforms();
-
-            if (mpExtra) CGraphics::sPixelBlock.TevColor = mpExtra->TevColor();
-            else CGraphics::sPixelBlock.TevColor = CColor::skWhite;
-
-            CGraphics::sPixelBlock.TintColor = TintColor(rkViewInfo);
-            CGraphics::UpdatePixelBlock();
+            LoadModelDrawState(rkViewInfo);
             DrawModelParts(pModel, Options, 0, Command);
         }
 
         // If no model or billboard, default to drawing a purple box
         else
         {
+            LoadModelLighting(rkViewInfo);
             glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ZERO, GL_ZERO);
             glDepthMask(GL_TRUE);
             CGraphics::UpdateVertexBlock();
@@ -229,10 +213,46 @@ void CScriptNode::Draw(FRenderOptions Options, int /*ComponentIndex*/, ERenderCo
     // Draw billboard
     else if (mpDisplayAsset->Type() == EResourceType::Texture)
     {
-        CDrawUtil::DrawBillboard(ActiveBillboard(), mPosition, BillboardScale(), TintColor(rkViewInfo));
+        CDrawUtil::BatchBillboard(ActiveBillboard(), mPosition, BillboardScale(), TintColor(rkViewInfo));
     }
 }
 
+void CScriptNode::LoadModelDrawState(const SViewInfo& rkViewInfo)
+{
+    LoadModelLighting(rkViewInfo);
+
+    if (mpExtra) CGraphics::sPixelBlock.TevColor = mpExtra->TevColor();
+    else CGraphics::sPixelBlock.TevColor = CColor::skWhite;
+
+    CGraphics::sPixelBlock.TintColor = TintColor(rkViewInfo);
+    CGraphics::UpdatePixelBlock();
+}
+
+uint64 CScriptNode::InstanceStateHash(const SViewInfo& rkViewInfo) const
+{
+    // Covers everything LoadModelDrawState() loads apart from the tint color, which is per instance
+    CFNV1A Hash(CFNV1A::k64Bit);
+    EModelLighting Lighting = ModelLighting();
+    Hash.HashData(&Lighting, sizeof(Lighting));
+
+    if (Lighting == EModelLighting::NodeLights)
+    {
+        CGraphics::ELightingMode Mode = (rkViewInfo.GameMode ? CGraphics::ELightingMode::World : CGraphics::sLightMode);
+        Hash.HashData(&Mode, sizeof(Mode));
+
+        if (Mode == CGraphics::ELightingMode::World)
+        {
+            Hash.HashData(&mAmbientColor, sizeof(mAmbientColor));
+            Hash.HashData(&mLightCount, sizeof(mLightCount));
+            Hash.HashData(&mLights[0], mLightCount * sizeof(CLight*));
+        }
+    }
+
+    CColor TevColor = (mpExtra ? mpExtra->TevColor() : CColor::skWhite);
+    Hash.HashData(&TevColor, sizeof(TevColor));
+    return Hash.GetHash64();
+}
+
 void CScriptNode::DrawSelection()
 {
     glBlendFunc(GL_ONE, GL_ZERO);
@@ -264,22 +284,19 @@ void CScriptNode::DrawSelection()
 
     if (mpInstance)
     {
-        CGraphics::sMVPBlock.ModelMatrix = CMatrix4f::skIdentity;
-        CGraphics::UpdateMVPBlock();
-
         for (uint32 iIn = 0; iIn < mpInstance->NumLinks(ELinkType::Incoming); iIn++)
         {
             // Don't draw in links if the other object is selected.
             CLink *pLink = mpInstance->Link(ELinkType::Incoming, iIn);
             CScriptNode *pLinkNode = mpScene->NodeForInstanceID(pLink->SenderID());
-            if (pLinkNode && !pLinkNode->IsSelected()) CDrawUtil::DrawLine(CenterPoint(), pLinkNode->CenterPoint(), CColor::skTransparentRed);
+            if (pLinkNode && !pLinkNode->IsSelected()) CDrawUtil::BatchLine(CenterPoint(), pLinkNode->CenterPoint(), CColor::skTransparentRed);
         }
 
         for (uint32 iOut = 0; iOut < mpInstance->NumLinks(ELinkType::Outgoing); iOut++)
         {
             CLink *pLink = mpInstance->Link(ELinkType::Outgoing, iOut);
             CScriptNode *pLinkNode = mpScene->NodeForInstanceID(pLink->ReceiverID());
-            if (pLinkNode) CDrawUtil::DrawLine(CenterPoint(), pLinkNode->CenterPoint(), CColor::skTransparentGreen);
+            if (pLinkNode) CDrawUtil::BatchLine(CenterPoint(), pLinkNode->CenterPoint(), CColor::skTransparentGreen);
         }
     }
 }
@@ -344,6 +361,45 @@ void CScriptNode::RayAABoxIntersectTest(CRayCollisionTester& rTester, const SVie
         mAttachments[iAttach]->RayAABoxIntersectTest(rTester, rkViewInfo);
 }
 
+bool CScriptNode::SceneBounds(CAABox& rOutBounds) const
+{
+    // Script extras can render and ray test arbitrary things, and selected nodes always draw their
+    // selection and preview volume, so those are always tested instead of going through the scene BVH
+    if (!mpInstance || mpExtra || IsSelected())
+        return false;
+
+    if (UsesModel())
+        rOutBounds = AABox();
+
+    else
+    {
+        CVector2f BillScale = BillboardScale();
+        float ScaleXY = (BillScale.X > BillScale.Y ? BillScale.X : BillScale.Y);
+
+        rOutBounds = CAABox(mPosition + CVector3f(-ScaleXY, -ScaleXY, -BillScale.Y),
+                            mPosition + CVector3f( ScaleXY,  ScaleXY,  BillScale.Y));
+    }
+
+    CAABox CollisionBounds;
+    if (mpCollisionNode->SceneBounds(CollisionBounds))
+    {
+        if (!CSceneBVH::IsBoundable(CollisionBounds)) return false;
+        rOutBounds.ExpandBounds(CollisionBounds);
+    }
+
+    for (uint32 iAttach = 0; iAttach < mAttachments.size(); iAttach++)
+    {
+        CScriptAttachNode *pAttach = mAttachments[iAttach];
+        if (!pAttach->Model()) continue;
+
+        CAABox AttachBounds = pAttach->AABox();
+        if (!CSceneBVH::IsBoundable(AttachBounds)) return false;
+        rOutBounds.ExpandBounds(AttachBounds);
+    }
+
+    return true;
+}
+
 SRayIntersection CScriptNode::RayNodeIntersectTest(const CRay& rkRay, uint32 AssetID, const SViewInfo& rkViewInfo)
 {
     FRenderOptions Options = rkViewInfo.pRenderer->RenderOptions();
@@ -758,6 +814,42 @@ void CScriptNode::SetDisplayAsset(CResource *pRes)
         mpExtra->DisplayAssetChanged(pRes);
 }
 
+CScriptNode::EModelLighting CScriptNode::ModelLighting() const
+{
+    EWorldLightingOptions LightingOptions = (mpLightParameters ? mpLightParameters->WorldLightingOptions() : eNormalLighting);
+
+    if (CGraphics::sLightMode == CGraphics::ELightingMode::World && LightingOptions == eDisableWorldLighting)
+        return EModelLighting::Disabled;
+
+    // DKCR doesn't support world lighting yet, so light nodes that don't have ingame models with default lighting
+    if (Template()->Game() == EGame::DKCReturns && !mpInstance->HasInGameModel() && CGraphics::sLightMode == CGraphics::ELightingMode::World)
+        return EModelLighting::Default;
+
+    return EModelLighting::NodeLights;
+}
+
+void CScriptNode::LoadModelLighting(const SViewInfo& rkViewInfo)
+{
+    switch (ModelLighting())
+    {
+    case EModelLighting::Disabled:
+        CGraphics::sNumLights = 0;
+        CGraphics::sVertexBlock.COLOR0_Amb = CColor::skBlack;
+        CGraphics::sPixelBlock.LightmapMultiplier = 1.f;
+        CGraphics::UpdateLightBlock();
+        break;
+
+    case EModelLighting::Default:
+        CGraphics::SetDefaultLighting();
+        CGraphics::sVertexBlock.COLOR0_Amb = CGraphics::skDefaultAmbientColor;
+        break;
+
+    case EModelLighting::NodeLights:
+        LoadLights(rkViewInfo);
+        break;
+    }
+}
+
 void CScriptNode::CalculateTransform(CTransform4f& rOut) const
 {
     CScriptTemplate *pTemp = Template();
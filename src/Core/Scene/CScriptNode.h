@@ -40,8 +40,11 @@ public:
     void AddToRenderer(CRenderer *pRenderer, const SViewInfo& rkViewInfo);
     void Draw(FRenderOptions Options, int ComponentIndex, ERenderCommand Command, const SViewInfo& rkViewInfo);
     void DrawSelection();
+    void LoadModelDrawState(const SViewInfo& rkViewInfo);
+    uint64 InstanceStateHash(const SViewInfo& rkViewInfo) const;
     void RayAABoxIntersectTest(CRayCollisionTester& rTester, const SViewInfo& rkViewInfo);
     SRayIntersection RayNodeIntersectTest(const CRay& rkRay, uint32 AssetID, const SViewInfo& rkViewInfo);
+    bool SceneBounds(CAABox& rOutBounds) const;
     bool AllowsRotate() const;
     bool AllowsScale() const;
     bool IsVisible() const;
@@ -74,6 +77,13 @@ public:
     inline CResource* DisplayAsset() const                      { return mpDisplayAsset; }
 
 protected:
+    enum class EModelLighting
+    {
+        Disabled, Default, NodeLights
+    };
+
+    EModelLighting ModelLighting() const;
+    void LoadModelLighting(const SViewInfo& rkViewInfo);
     void SetDisplayAsset(CResource *pRes);
     void CalculateTransform(CTransform4f& rOut) const;
 };
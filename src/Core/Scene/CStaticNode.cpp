@@ -1,4 +1,5 @@
 #include "CStaticNode.h"
+#include "CScene.h"
 #include "Core/Render/CGraphics.h"
 #include "Core/Render/CDrawUtil.h"
 #include "Core/Render/CRenderer.h"
@@ -33,18 +34,58 @@ void CStaticNode::AddToRenderer(CRenderer *pRenderer, const SViewInfo& rkViewInf
     if (mpModel->IsOccluder()) return;
     if (!rkViewInfo.ViewFrustum.BoxInFrustum(AABox())) return;
 
+    uint32 NumSurfaces = mpModel->GetSurfaceCount();
+
     if (!mpModel->IsTransparent())
-        pRenderer->AddMesh(this, -1, AABox(), false, ERenderCommand::DrawMesh);
+    {
+        // Surfaces can come from several world meshes; count how many weren't culled by the area octree
+        uint32 NumVisible = 0;
+
+        for (uint32 iSurf = 0; iSurf < NumSurfaces; iSurf++)
+        {
+            if (mpScene->IsWorldMeshVisible(mpModel->GetSurface(iSurf)->MeshID))
+                NumVisible++;
+        }
+
+        // Draw the merged mesh if most of it is visible, otherwise just draw the visible surfaces
+        if (NumVisible * 2 > NumSurfaces)
+        {
+            pRenderer->AddMesh(this, -1, AABox(), false, ERenderCommand::DrawMesh, EDepthGroup::Midground, mpModel->GetMaterial());
+            mpScene->CountSubmittedWorldSurfaces(NumSurfaces);
+        }
+
+        else if (NumVisible > 0)
+        {
+            for (uint32 iSurf = 0; iSurf < NumSurfaces; iSurf++)
+            {
+                if (!mpScene->IsWorldMeshVisible(mpModel->GetSurface(iSurf)->MeshID))
+                    continue;
+
+                CAABox TransformedBox = mpModel->GetSurfaceAABox(iSurf).Transformed(Transform());
+
+                if (rkViewInfo.ViewFrustum.BoxInFrustum(TransformedBox))
+                {
+                    pRenderer->AddMesh(this, iSurf, TransformedBox, false, ERenderCommand::DrawMesh, EDepthGroup::Midground, mpModel->GetMaterial());
+                    mpScene->CountSubmittedWorldSurfaces(1);
+                }
+            }
+        }
+    }
 
     else
     {
-        uint32 NumSurfaces = mpModel->GetSurfaceCount();
         for (uint32 iSurf = 0; iSurf < NumSurfaces; iSurf++)
         {
+            if (!mpScene->IsWorldMeshVisible(mpModel->GetSurface(iSurf)->MeshID))
+                continue;
+
             CAABox TransformedBox = mpModel->GetSurfaceAABox(iSurf).Transformed(Transform());
 
             if (rkViewInfo.ViewFrustum.BoxInFrustum(TransformedBox))
+            {
                 pRenderer->AddMesh(this, iSurf, TransformedBox, true, ERenderCommand::DrawMesh);
+                mpScene->CountSubmittedWorldSurfaces(1);
+            }
         }
     }
 
@@ -136,3 +177,10 @@ SRayIntersection CStaticNode::RayNodeIntersectTest(const CRay& rkRay, uint32 Ass
 
     return Out;
 }
+
+bool CStaticNode::SceneBounds(CAABox& rOutBounds) const
+{
+    if (!mpModel) return false;
+    rOutBounds = AABox();
+    return true;
+}
@@ -17,6 +17,7 @@ public:
     void DrawSelection();
     void RayAABoxIntersectTest(CRayCollisionTester& rTester, const SViewInfo& rkViewInfo);
     SRayIntersection RayNodeIntersectTest(const CRay& rkRay, uint32 AssetID, const SViewInfo& rkViewInfo);
+    bool SceneBounds(CAABox& rOutBounds) const;
 };
 
 #endif // CSTATICNODE_H